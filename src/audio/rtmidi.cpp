@@ -20,6 +20,7 @@
 #include "rtmidi.h"
 #include "../ta-log.h"
 #include "taAudio.h"
+#include <chrono>
 
 String sanitizePortName(const String& name) {
 #if defined(_WIN32)
@@ -43,33 +44,68 @@ String sanitizePortName(const String& name) {
 
 // --- IN ---
 
+// called by RtMidi's thread as soon as a message arrives, so that it can be
+// timestamped before the next audio buffer gathers it.
+static void rtMidiInCallback(double t, std::vector<unsigned char>* msg, void* user) {
+  if (msg==NULL) return;
+  ((TAMidiInRtMidi*)user)->arrive(t,*msg);
+}
+
+void TAMidiInRtMidi::arrive(double t, const std::vector<unsigned char>& msg) {
+  if (msg.empty()) return;
+  TAMidiMessage m;
+
+  // parse message
+  m.time=t;
+  m.stamp=std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  m.type=msg[0];
+  if (m.type!=TA_MIDI_SYSEX && msg.size()>1) {
+    memcpy(m.data,msg.data()+1,MIN(msg.size()-1,7));
+  } else if (m.type==TA_MIDI_SYSEX) {
+    m.sysExData=std::shared_ptr<unsigned char>(new unsigned char[msg.size()],std::default_delete<unsigned char[]>());
+    m.sysExLen=msg.size();
+    logD("got a SysEx of length %ld!",msg.size());
+    memcpy(m.sysExData.get(),msg.data(),msg.size());
+  }
+
+  // drop the message if the ring is full
+  uint64_t wp=arrivedWrite.load(std::memory_order_relaxed);
+  if (wp-arrivedRead.load(std::memory_order_acquire)>=TA_MIDI_IN_RING) return;
+  arrived[wp&(TA_MIDI_IN_RING-1)]=m;
+  arrivedWrite.store(wp+1,std::memory_order_release);
+}
+
+// errors which happen in RtMidi's thread can't be thrown to us, so they are
+// reported here while the device is open.
+static void rtMidiInError(RtMidiError::Type type, const std::string& text, void* user) {
+  ((TAMidiInRtMidi*)user)->fail(type,text);
+}
+
+void TAMidiInRtMidi::fail(RtMidiError::Type type, const std::string& text) {
+  if (type==RtMidiError::WARNING || type==RtMidiError::DEBUG_WARNING) {
+    logW("MIDI input warning! %s",text);
+    return;
+  }
+  logE("MIDI input error! %s",text);
+  failed=true;
+}
+
 bool TAMidiInRtMidi::gather() {
-  std::vector<unsigned char> msg;
   if (port==NULL) return false;
-  try {
-    while (true) {
-      TAMidiMessage m;
-      double t=port->getMessage(&msg);
-      if (msg.empty()) break;
-
-      // parse message
-      m.time=t;
-      m.type=msg[0];
-      if (m.type!=TA_MIDI_SYSEX && msg.size()>1) {
-        memcpy(m.data,msg.data()+1,MIN(msg.size()-1,7));
-      } else if (m.type==TA_MIDI_SYSEX) {
-        m.sysExData=std::shared_ptr<unsigned char>(new unsigned char[msg.size()],std::default_delete<unsigned char[]>());
-        m.sysExLen=msg.size();
-        logD("got a SysEx of length %ld!",msg.size());
-        memcpy(m.sysExData.get(),msg.data(),msg.size());
-      }
-      queue.push(m);
-    }
-  } catch (RtMidiError& e) {
-    logE("MIDI input error! %s",e.what());
+  if (failed) {
+    failed=false;
     closeDevice();
     return false;
   }
+  uint64_t rp=arrivedRead.load(std::memory_order_relaxed);
+  uint64_t wp=arrivedWrite.load(std::memory_order_acquire);
+  for (; rp!=wp; rp++) {
+    TAMidiMessage& slot=arrived[rp&(TA_MIDI_IN_RING-1)];
+    queue.push(slot);
+    // the queue holds the SysEx data now
+    slot.sysExData.reset();
+  }
+  arrivedRead.store(rp,std::memory_order_release);
   return true;
 }
 
@@ -108,6 +144,7 @@ bool TAMidiInRtMidi::openDevice(String name) {
       if (portName==name) {
         logD("opening port %d...",i);
         port->openPort(i);
+        port->setErrorCallback(rtMidiInError,this);
         portOpen=true;
         break;
       }
@@ -126,6 +163,8 @@ bool TAMidiInRtMidi::closeDevice() {
   if (port==NULL) return false;
   if (!isOpen) return false;
   try {
+    // errors while closing are thrown to us again
+    port->setErrorCallback(NULL,NULL);
     port->closePort();
   } catch (RtMidiError& e) {
     logW("could not close MIDI in device! %s",e.what());
@@ -141,6 +180,7 @@ bool TAMidiInRtMidi::init() {
   try {
     port=new RtMidiIn;
     port->ignoreTypes(false,true,true);
+    port->setCallback(rtMidiInCallback,this);
   } catch (RtMidiError& e) {
     logW("could not initialize RtMidi in! %s",e.what());
     return false;
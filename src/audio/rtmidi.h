@@ -19,11 +19,23 @@
 
 #include "../../extern/rtmidi/RtMidi.h"
 #include "taAudio.h"
+#include <atomic>
+
+// size of the MIDI input ring (must be a power of 2)
+#define TA_MIDI_IN_RING 8192
 
 class TAMidiInRtMidi: public TAMidiIn {
   RtMidiIn* port;
   bool isOpen;
+  // messages received by RtMidi's thread, which is the only writer.
+  // gather() (the audio thread) is the only reader.
+  TAMidiMessage arrived[TA_MIDI_IN_RING];
+  std::atomic<uint64_t> arrivedRead, arrivedWrite;
+  // set by RtMidi's thread on error. the device is closed on the next gather().
+  std::atomic<bool> failed;
   public:
+    void arrive(double t, const std::vector<unsigned char>& msg);
+    void fail(RtMidiError::Type type, const std::string& text);
     bool gather();
     bool isDeviceOpen();
     bool openDevice(String name);
@@ -33,7 +45,10 @@ class TAMidiInRtMidi: public TAMidiIn {
     bool init();
     TAMidiInRtMidi():
       port(NULL),
-      isOpen(false) {}
+      isOpen(false),
+      arrivedRead(0),
+      arrivedWrite(0),
+      failed(false) {}
 };
 
 class TAMidiOutRtMidi: public TAMidiOut {
@@ -0,0 +1,470 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// protocol:
+// - client connects and sends a single line: `<format> [interleaved|planar]`
+//   where format is f32, s16 or s24 (24-bit packed little-endian).
+// - server replies with `OK <rate> <channels> <frames per block> <format> <layout>`
+//   or `ERR <reason>` (and closes the connection).
+// - server then streams blocks of audio in native byte order (except for s24).
+//   in planar layout each block contains all samples of channel 0, then channel 1, etc.
+
+#include <string.h>
+#include <chrono>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include "../ta-log.h"
+#include "socket.h"
+
+#ifdef MSG_NOSIGNAL
+#define TA_SOCKET_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define TA_SOCKET_SEND_FLAGS 0
+#endif
+
+static const char* socketFormatNames[]={
+  "f32", "s16", "s24"
+};
+
+// the conversion kernels below are kept branch-free over contiguous data
+// so that the compiler can vectorize them.
+
+static void socketDeinterleave(const float* in, float* out, size_t frames, int chans) {
+  for (int i=0; i<chans; i++) {
+    float* outC=out+i*frames;
+    const float* inC=in+i;
+    for (size_t j=0; j<frames; j++) {
+      outC[j]=inC[j*chans];
+    }
+  }
+}
+
+static void socketConvertS16(const float* in, short* out, size_t len) {
+  for (size_t i=0; i<len; i++) {
+    float s=in[i];
+    s=(s<-1.0f)?-1.0f:s;
+    s=(s>1.0f)?1.0f:s;
+    out[i]=(short)(s*32767.0f);
+  }
+}
+
+static void socketConvertS24(const float* in, unsigned char* out, size_t len) {
+  for (size_t i=0; i<len; i++) {
+    float s=in[i];
+    s=(s<-1.0f)?-1.0f:s;
+    s=(s>1.0f)?1.0f:s;
+    int v=(int)(s*8388607.0f);
+    out[i*3]=v&0xff;
+    out[i*3+1]=(v>>8)&0xff;
+    out[i*3+2]=(v>>16)&0xff;
+  }
+}
+
+static bool socketSendAll(int fd, const unsigned char* data, size_t len) {
+  while (len>0) {
+    ssize_t sent=send(fd,data,len,TA_SOCKET_SEND_FLAGS);
+    if (sent<0) {
+      if (errno==EINTR) continue;
+      return false;
+    }
+    data+=sent;
+    len-=sent;
+  }
+  return true;
+}
+
+void taSocketThread(void* inst) {
+  TAAudioSocket* in=(TAAudioSocket*)inst;
+  in->runThread();
+}
+
+void taSocketAcceptThread(void* inst) {
+  TAAudioSocket* in=(TAAudioSocket*)inst;
+  in->runAccept();
+}
+
+void taSocketClientThread(void* inst) {
+  TAAudioSocketClient* in=(TAAudioSocketClient*)inst;
+  in->run();
+}
+
+void TAAudioSocketClient::run() {
+  // the handshake happens here so that a slow client doesn't hold up the others
+  if (!parent->handshake(this)) {
+    alive=false;
+    return;
+  }
+
+  size_t frames=parent->desc.bufsize;
+  int chans=parent->desc.outChans;
+  size_t len=frames*chans;
+  bool warnedLag=false;
+
+  blockBuf=new float[len];
+  planarBuf=new float[len];
+  convBuf=new unsigned char[len*3];
+  // start at the live edge
+  readPos=parent->writePos.load(std::memory_order_acquire);
+
+  while (alive && parent->listening) {
+    uint64_t w=parent->writePos.load(std::memory_order_acquire);
+    if (readPos+frames>w) {
+      std::unique_lock<std::mutex> lock(parent->notifyLock);
+      parent->notifyCV.wait_for(lock,std::chrono::milliseconds(20));
+      continue;
+    }
+    if (w-readPos>parent->ringFrames-frames) {
+      // we fell behind. skip to the newest block.
+      if (!warnedLag) {
+        logW("socket client %d is too slow! skipping ahead.",fd);
+        warnedLag=true;
+      }
+      readPos=w-frames;
+    }
+
+    memcpy(blockBuf,&parent->ring[(readPos%parent->ringFrames)*chans],len*sizeof(float));
+
+    // the writer may have lapped us while copying.
+    // writeBegin is bumped before a block is written, so if the block being
+    // written now doesn't overlap ours, what we copied is intact.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (parent->writeBegin.load(std::memory_order_relaxed)-readPos>parent->ringFrames) {
+      continue;
+    }
+
+    const float* src=blockBuf;
+    if (planar) {
+      socketDeinterleave(blockBuf,planarBuf,frames,chans);
+      src=planarBuf;
+    }
+
+    const unsigned char* out=NULL;
+    size_t outLen=0;
+    switch (format) {
+      case TA_SOCKET_FORMAT_F32:
+        out=(const unsigned char*)src;
+        outLen=len*sizeof(float);
+        break;
+      case TA_SOCKET_FORMAT_S16:
+        socketConvertS16(src,(short*)convBuf,len);
+        out=convBuf;
+        outLen=len*sizeof(short);
+        break;
+      case TA_SOCKET_FORMAT_S24:
+        socketConvertS24(src,convBuf,len);
+        out=convBuf;
+        outLen=len*3;
+        break;
+    }
+
+    if (!socketSendAll(fd,out,outLen)) {
+      logI("socket client %d disconnected.",fd);
+      break;
+    }
+    readPos+=frames;
+  }
+
+  alive=false;
+}
+
+void TAAudioSocket::onProcess() {
+  if (audioProcCallback!=NULL) {
+    if (midiIn!=NULL) midiIn->gather();
+    audioProcCallback(audioProcCallbackUser,inBufs,outBufs,desc.inChans,desc.outChans,desc.bufsize);
+  }
+
+  if (ring==NULL) return;
+
+  uint64_t w=writePos.load(std::memory_order_relaxed);
+  writeBegin.store(w+desc.bufsize,std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  float* dest=&ring[(w%ringFrames)*desc.outChans];
+  for (size_t i=0; i<desc.outChans; i++) {
+    const float* src=outBufs[i];
+    for (size_t j=0; j<desc.bufsize; j++) {
+      dest[j*desc.outChans+i]=src[j];
+    }
+  }
+  writePos.store(w+desc.bufsize,std::memory_order_release);
+  notifyCV.notify_all();
+}
+
+void TAAudioSocket::runThread() {
+  // there is no device to pace us, so keep time ourselves
+  std::chrono::steady_clock::duration period=std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>((double)desc.bufsize/desc.rate));
+  std::chrono::steady_clock::time_point next=std::chrono::steady_clock::now();
+  while (running) {
+    onProcess();
+    next+=period;
+    std::chrono::steady_clock::time_point now=std::chrono::steady_clock::now();
+    if (next+period*8<now) {
+      // we are way too late. resynchronize instead of bursting.
+      next=now;
+    }
+    std::this_thread::sleep_until(next);
+  }
+}
+
+bool TAAudioSocket::handshake(TAAudioSocketClient* c) {
+  char line[64];
+  size_t lineLen=0;
+  memset(line,0,64);
+
+  struct timeval timeout;
+  timeout.tv_sec=2;
+  timeout.tv_usec=0;
+  setsockopt(c->fd,SOL_SOCKET,SO_RCVTIMEO,&timeout,sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+  int one=1;
+  setsockopt(c->fd,SOL_SOCKET,SO_NOSIGPIPE,&one,sizeof(one));
+#endif
+
+  while (lineLen<63) {
+    ssize_t got=recv(c->fd,&line[lineLen],1,0);
+    if (got<=0) {
+      if (got<0 && errno==EINTR) continue;
+      logW("socket client %d did not complete handshake.",c->fd);
+      return false;
+    }
+    if (line[lineLen]=='\n' || line[lineLen]=='\r') break;
+    lineLen++;
+  }
+  line[lineLen]=0;
+
+  String request=line;
+  bool formatOK=false;
+  c->format=TA_SOCKET_FORMAT_F32;
+  c->planar=false;
+  if (request.find("f32")==0) {
+    c->format=TA_SOCKET_FORMAT_F32;
+    formatOK=true;
+  } else if (request.find("s16")==0) {
+    c->format=TA_SOCKET_FORMAT_S16;
+    formatOK=true;
+  } else if (request.find("s24")==0) {
+    c->format=TA_SOCKET_FORMAT_S24;
+    formatOK=true;
+  }
+  if (request.find("planar")!=String::npos) {
+    c->planar=true;
+  }
+
+  if (!formatOK) {
+    const char* err="ERR unknown format (valid formats are f32, s16 and s24)\n";
+    socketSendAll(c->fd,(const unsigned char*)err,strlen(err));
+    logW("socket client %d requested invalid format: %s",c->fd,request);
+    return false;
+  }
+
+  String reply=fmt::sprintf("OK %d %d %d %s %s\n",(int)desc.rate,(int)desc.outChans,(int)desc.bufsize,socketFormatNames[c->format],c->planar?"planar":"interleaved");
+  if (!socketSendAll(c->fd,(const unsigned char*)reply.c_str(),reply.size())) {
+    return false;
+  }
+
+  logI("socket client %d connected (%s, %s).",c->fd,socketFormatNames[c->format],c->planar?"planar":"interleaved");
+  return true;
+}
+
+void TAAudioSocket::reapClients(bool all) {
+  for (size_t i=0; i<clients.size(); i++) {
+    TAAudioSocketClient* c=clients[i];
+    if (!all && c->alive) continue;
+    c->alive=false;
+    // unblock a pending send()
+    shutdown(c->fd,SHUT_RDWR);
+    if (c->thread) {
+      c->thread->join();
+      delete c->thread;
+    }
+    close(c->fd);
+    delete[] c->blockBuf;
+    delete[] c->planarBuf;
+    delete[] c->convBuf;
+    delete c;
+    clients.erase(clients.begin()+i);
+    i--;
+  }
+}
+
+void TAAudioSocket::runAccept() {
+  struct pollfd pfd;
+  while (listening) {
+    reapClients(false);
+
+    pfd.fd=listenFD;
+    pfd.events=POLLIN;
+    pfd.revents=0;
+    int ret=poll(&pfd,1,100);
+    if (ret<=0) continue;
+
+    int fd=accept(listenFD,NULL,NULL);
+    if (fd<0) continue;
+
+    TAAudioSocketClient* c=new TAAudioSocketClient;
+    c->parent=this;
+    c->fd=fd;
+    c->alive=true;
+    c->thread=new std::thread(taSocketClientThread,c);
+    clients.push_back(c);
+  }
+  reapClients(true);
+}
+
+void* TAAudioSocket::getContext() {
+  return NULL;
+}
+
+bool TAAudioSocket::quit() {
+  if (!initialized) return false;
+
+  if (running) {
+    running=false;
+    if (outThread) {
+      outThread->join();
+      delete outThread;
+      outThread=NULL;
+    }
+  }
+
+  listening=false;
+  notifyCV.notify_all();
+  if (acceptThread) {
+    acceptThread->join();
+    delete acceptThread;
+    acceptThread=NULL;
+  }
+
+  if (listenFD>=0) {
+    close(listenFD);
+    listenFD=-1;
+    unlink(sockPath.c_str());
+  }
+
+  for (int i=0; i<desc.outChans; i++) {
+    delete[] outBufs[i];
+  }
+
+  delete[] outBufs;
+
+  if (ring) {
+    delete[] ring;
+    ring=NULL;
+  }
+
+  initialized=false;
+  return true;
+}
+
+bool TAAudioSocket::setRun(bool run) {
+  if (!initialized) return false;
+
+  if (running!=run) {
+    running=run;
+    if (running) {
+      outThread=new std::thread(taSocketThread,this);
+    } else if (outThread) {
+      outThread->join();
+      delete outThread;
+      outThread=NULL;
+    }
+  }
+
+  return running;
+}
+
+std::vector<String> TAAudioSocket::listAudioDevices() {
+  std::vector<String> ret;
+
+  ret.push_back(TA_SOCKET_DEFAULT_PATH);
+
+  return ret;
+}
+
+bool TAAudioSocket::init(TAAudioDesc& request, TAAudioDesc& response) {
+  if (initialized) {
+    logE("audio already initialized");
+    return false;
+  }
+
+  desc=request;
+  desc.outFormat=TA_AUDIO_FORMAT_F32;
+  if (desc.outChans<1) {
+    logE("socket server needs at least one output channel!");
+    return false;
+  }
+
+  sockPath=desc.deviceName.empty()?TA_SOCKET_DEFAULT_PATH:desc.deviceName;
+  desc.deviceName=sockPath;
+
+  struct sockaddr_un addr;
+  memset(&addr,0,sizeof(addr));
+  addr.sun_family=AF_UNIX;
+  if (sockPath.size()>=sizeof(addr.sun_path)) {
+    logE("socket path is too long! (%s)",sockPath);
+    return false;
+  }
+  strncpy(addr.sun_path,sockPath.c_str(),sizeof(addr.sun_path)-1);
+
+  logV("opening socket %s for audio...",sockPath);
+
+  listenFD=socket(AF_UNIX,SOCK_STREAM,0);
+  if (listenFD<0) {
+    logE("could not create socket! (%s)",strerror(errno));
+    return false;
+  }
+  // remove a stale socket from a previous run
+  unlink(sockPath.c_str());
+  if (bind(listenFD,(struct sockaddr*)&addr,sizeof(addr))<0) {
+    logE("could not bind socket! (%s)",strerror(errno));
+    close(listenFD);
+    listenFD=-1;
+    return false;
+  }
+  if (listen(listenFD,8)<0) {
+    logE("could not listen on socket! (%s)",strerror(errno));
+    close(listenFD);
+    listenFD=-1;
+    unlink(sockPath.c_str());
+    return false;
+  }
+
+  outBufs=new float*[desc.outChans];
+  for (int i=0; i<desc.outChans; i++) {
+    outBufs[i]=new float[desc.bufsize];
+    memset(outBufs[i],0,desc.bufsize*sizeof(float));
+  }
+
+  ringFrames=(size_t)desc.bufsize*TA_SOCKET_RING_BLOCKS;
+  ring=new float[ringFrames*desc.outChans];
+  memset(ring,0,ringFrames*desc.outChans*sizeof(float));
+  writePos=0;
+  writeBegin=0;
+
+  listening=true;
+  acceptThread=new std::thread(taSocketAcceptThread,this);
+
+  response=desc;
+  initialized=true;
+  return true;
+}
@@ -0,0 +1,119 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "taAudio.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+// number of buffers held in the shared ring.
+// a client lagging further behind than this skips ahead.
+#define TA_SOCKET_RING_BLOCKS 32
+
+#define TA_SOCKET_DEFAULT_PATH "/tmp/furnace-audio.sock"
+
+enum TAAudioSocketFormat {
+  TA_SOCKET_FORMAT_F32=0,
+  TA_SOCKET_FORMAT_S16,
+  TA_SOCKET_FORMAT_S24
+};
+
+class TAAudioSocket;
+
+struct TAAudioSocketClient {
+  TAAudioSocket* parent;
+  int fd;
+  TAAudioSocketFormat format;
+  bool planar;
+  uint64_t readPos;
+  std::atomic<bool> alive;
+  std::thread* thread;
+
+  // one buffer worth of float data (interleaved, then planar if requested)
+  float* blockBuf;
+  float* planarBuf;
+  unsigned char* convBuf;
+
+  void run();
+
+  TAAudioSocketClient():
+    parent(NULL),
+    fd(-1),
+    format(TA_SOCKET_FORMAT_F32),
+    planar(false),
+    readPos(0),
+    alive(false),
+    thread(NULL),
+    blockBuf(NULL),
+    planarBuf(NULL),
+    convBuf(NULL) {}
+};
+
+/**
+ * local streaming server.
+ * the engine renders into a lock-free ring on its own clock, and every client
+ * connected to the Unix domain socket is fed from that ring by its own thread,
+ * in the format it requested during the handshake.
+ * a slow client only loses data; it never stalls the engine thread.
+ */
+class TAAudioSocket: public TAAudio {
+  friend struct TAAudioSocketClient;
+
+  std::thread* outThread;
+  std::thread* acceptThread;
+  int listenFD;
+  String sockPath;
+  std::atomic<bool> listening;
+
+  // interleaved float ring (TA_SOCKET_RING_BLOCKS*bufsize frames)
+  float* ring;
+  size_t ringFrames;
+  // end of the last complete block, and end of the block being written
+  std::atomic<uint64_t> writePos;
+  std::atomic<uint64_t> writeBegin;
+
+  std::mutex notifyLock;
+  std::condition_variable notifyCV;
+
+  std::vector<TAAudioSocketClient*> clients;
+
+  bool handshake(TAAudioSocketClient* c);
+  void reapClients(bool all);
+
+  public:
+    void runThread();
+    void runAccept();
+    void onProcess();
+
+    void* getContext();
+    bool quit();
+    bool setRun(bool run);
+    std::vector<String> listAudioDevices();
+    bool init(TAAudioDesc& request, TAAudioDesc& response);
+    TAAudioSocket():
+      outThread(NULL),
+      acceptThread(NULL),
+      listenFD(-1),
+      listening(false),
+      ring(NULL),
+      ringFrames(0),
+      writePos(0),
+      writeBegin(0) {}
+};
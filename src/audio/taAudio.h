@@ -109,6 +109,8 @@ enum TAMidiMessageTypes {
 
 struct TAMidiMessage {
   double time;
+  // arrival time (steady clock, in nanoseconds) or 0 if unknown
+  uint64_t stamp;
   unsigned char type;
   unsigned char data[7];
   std::shared_ptr<unsigned char> sysExData;
@@ -119,6 +121,7 @@ struct TAMidiMessage {
 
   TAMidiMessage(unsigned char t, unsigned char d0, unsigned char d1):
     time(0.0),
+    stamp(0),
     type(t),
     sysExData(NULL),
     sysExLen(0) {
@@ -129,6 +132,7 @@ struct TAMidiMessage {
 
   TAMidiMessage():
     time(0.0),
+    stamp(0),
     type(0),
     sysExData(NULL),
     sysExLen(0) {
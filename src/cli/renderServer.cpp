@@ -0,0 +1,557 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+// protocol:
+// - the client sends one job per line, and may send more jobs after a reply
+//   is complete. a path may be quoted with "" if it contains spaces.
+//   - `audio <path> [key=value...]`: render audio.
+//     keys: subsong, loops, fade (seconds), rate, chans, format (f32 or s16),
+//     start and end (order[:row], the end is not included), length (seconds).
+//     orders and rows are decimal (the order list shows orders in hex).
+//     leaving the range (at its end or through a jump) counts as a loop, and
+//     loops go back to the start.
+//   - `vgm <path> [key=value...]`: export VGM. keys: subsong, loop (0/1), direct (0/1).
+//   - `cmd <path> [key=value...]`: export command stream. keys: subsong.
+//   - `status`: get server status.
+// - errors are replied with `ERR <reason>`.
+// - audio replies with `OK <rate> <channels> <format>`, then streams the audio
+//   as it is rendered in `DATA <bytes>` blocks (interleaved, native byte order)
+//   and finishes with `END <frames>`.
+// - file exports reply with `OK <bytes>` followed by the file.
+// - status replies with `OK <engines> <busy engines> <jobs done>`.
+
+#include "renderServer.h"
+#include "../ta-log.h"
+#include "../fileutils.h"
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+#ifdef MSG_NOSIGNAL
+#define FUR_RENDER_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define FUR_RENDER_SEND_FLAGS 0
+#endif
+
+static std::atomic<bool> renderServerRunning(false);
+
+static void renderServerSignal(int) {
+  FurnaceRenderServer::requestStop();
+}
+
+void furRenderClientThread(void* inst) {
+  FurnaceRenderClient* in=(FurnaceRenderClient*)inst;
+  in->run();
+}
+
+// splits a job line into words. quotes group words together.
+static std::vector<String> renderServerSplit(const String& line) {
+  std::vector<String> ret;
+  String cur;
+  bool quoted=false;
+  bool inWord=false;
+  for (char i: line) {
+    if (i=='"') {
+      quoted=!quoted;
+      inWord=true;
+    } else if ((i==' ' || i=='\t') && !quoted) {
+      if (inWord) ret.push_back(cur);
+      cur="";
+      inWord=false;
+    } else {
+      cur+=i;
+      inWord=true;
+    }
+  }
+  if (inWord) ret.push_back(cur);
+  return ret;
+}
+
+// parses order[:row]
+static bool renderServerParsePos(const String& val, int& order, int& row) {
+  size_t sepPos=val.find(':');
+  order=std::stoi(val.substr(0,sepPos));
+  row=(sepPos==String::npos)?0:std::stoi(val.substr(sepPos+1));
+  return (order>=0 && row>=0);
+}
+
+static bool renderServerReadFile(const String& path, unsigned char** buf, size_t* len) {
+  FILE* f=ps_fopen(path.c_str(),"rb");
+  if (f==NULL) return false;
+  if (fseek(f,0,SEEK_END)<0) {
+    fclose(f);
+    return false;
+  }
+  ssize_t size=ftell(f);
+  if (size<1 || fseek(f,0,SEEK_SET)<0) {
+    fclose(f);
+    return false;
+  }
+  *buf=new unsigned char[size];
+  if (fread(*buf,1,(size_t)size,f)!=(size_t)size) {
+    fclose(f);
+    delete[] *buf;
+    *buf=NULL;
+    return false;
+  }
+  fclose(f);
+  *len=size;
+  return true;
+}
+
+bool FurnaceRenderClient::sendData(const void* data, size_t len) {
+  const unsigned char* d=(const unsigned char*)data;
+  while (len>0) {
+    ssize_t sent=send(fd,d,len,FUR_RENDER_SEND_FLAGS);
+    if (sent<0) {
+      if (errno==EINTR) continue;
+      return false;
+    }
+    d+=sent;
+    len-=sent;
+  }
+  return true;
+}
+
+bool FurnaceRenderClient::reply(const String& line) {
+  String out=line+"\n";
+  return sendData(out.c_str(),out.size());
+}
+
+bool FurnaceRenderClient::runJob(const String& line) {
+  std::vector<String> args=renderServerSplit(line);
+  if (args.empty()) return true;
+  const String& type=args[0];
+
+  if (type=="status") {
+    int busy=0;
+    parent->engineLock.lock();
+    for (FurnaceRenderEngine* i: parent->engines) {
+      if (i->busy) busy++;
+    }
+    int count=parent->engines.size();
+    parent->engineLock.unlock();
+    return reply(fmt::sprintf("OK %d %d %u",count,busy,parent->jobCount.load()));
+  }
+
+  if (type!="audio" && type!="vgm" && type!="cmd") {
+    return reply(fmt::sprintf("ERR unknown job type %s",type));
+  }
+  if (args.size()<2) {
+    return reply("ERR no file given");
+  }
+  const String& path=args[1];
+
+  // options
+  int subsong=0;
+  bool s16=false;
+  bool vgmLoop=true;
+  bool vgmDirect=false;
+  DivAudioExportOptions options;
+  for (size_t i=2; i<args.size(); i++) {
+    size_t eqPos=args[i].find('=');
+    if (eqPos==String::npos) {
+      return reply(fmt::sprintf("ERR invalid option %s",args[i]));
+    }
+    String key=args[i].substr(0,eqPos);
+    String val=args[i].substr(eqPos+1);
+    try {
+      if (key=="subsong") {
+        subsong=std::stoi(val);
+      } else if (key=="loops") {
+        options.loops=std::stoi(val);
+      } else if (key=="fade") {
+        options.fadeOut=std::stod(val);
+      } else if (key=="rate") {
+        options.sampleRate=std::stoi(val);
+      } else if (key=="chans") {
+        options.chans=std::stoi(val);
+      } else if (key=="format") {
+        if (val=="s16") {
+          s16=true;
+        } else if (val!="f32") {
+          return reply(fmt::sprintf("ERR invalid format %s (valid formats are f32 and s16)",val));
+        }
+      } else if (key=="start") {
+        if (!renderServerParsePos(val,options.orderBegin,options.rowBegin)) {
+          return reply("ERR invalid start position");
+        }
+      } else if (key=="end") {
+        if (!renderServerParsePos(val,options.orderEnd,options.rowEnd)) {
+          return reply("ERR invalid end position");
+        }
+      } else if (key=="length") {
+        options.duration=std::stod(val);
+      } else if (key=="loop") {
+        vgmLoop=(std::stoi(val)!=0);
+      } else if (key=="direct") {
+        vgmDirect=(std::stoi(val)!=0);
+      } else {
+        return reply(fmt::sprintf("ERR unknown option %s",key));
+      }
+    } catch (std::exception& e) {
+      return reply(fmt::sprintf("ERR invalid value for %s",key));
+    }
+  }
+  if (options.loops<0) options.loops=0;
+  if (options.fadeOut<0.0) options.fadeOut=0.0;
+  if (options.duration<0.0) options.duration=0.0;
+  if (options.sampleRate<8000 || options.sampleRate>384000) {
+    return reply("ERR the rate must be between 8000 and 384000");
+  }
+  if (options.chans<1 || options.chans>DIV_MAX_OUTPUTS) {
+    return reply(fmt::sprintf("ERR the number of channels must be between 1 and %d",DIV_MAX_OUTPUTS));
+  }
+
+  struct stat st;
+  if (stat(path.c_str(),&st)!=0) {
+    return reply(fmt::sprintf("ERR could not open file! (%s)",strerror(errno)));
+  }
+
+  FurnaceRenderEngine* eng=parent->acquire(path,(int64_t)st.st_mtime,(int64_t)st.st_size);
+  if (eng==NULL) return reply("ERR the server is shutting down");
+  DivEngine* e=eng->e;
+
+  // load the song unless the engine has it already
+  if (eng->songPath!=path || eng->songTime!=(int64_t)st.st_mtime || eng->songSize!=(int64_t)st.st_size) {
+    unsigned char* file=NULL;
+    size_t len=0;
+    eng->songPath="";
+    if (!renderServerReadFile(path,&file,&len)) {
+      parent->release(eng);
+      return reply(fmt::sprintf("ERR could not read file! (%s)",strerror(errno)));
+    }
+    parent->setupLock.lock();
+    bool loaded=e->load(file,len,path.c_str());
+    parent->setupLock.unlock();
+    if (!loaded) {
+      String err=e->getLastError();
+      parent->release(eng);
+      return reply(fmt::sprintf("ERR could not load file! (%s)",err));
+    }
+    eng->songPath=path;
+    eng->songTime=st.st_mtime;
+    eng->songSize=st.st_size;
+    logD("render server: loaded %s",path);
+  } else {
+    logD("render server: %s is loaded already",path);
+  }
+
+  if (subsong<0 || subsong>=(int)e->song.subsong.size()) {
+    parent->release(eng);
+    return reply(fmt::sprintf("ERR invalid subsong %d",subsong));
+  }
+  if (e->getCurrentSubSong()!=(size_t)subsong) {
+    e->changeSongP(subsong);
+  }
+
+  bool ok=true;
+  if (type=="audio") {
+    parent->setupLock.lock();
+    bool began=e->renderBegin(options,FUR_RENDER_SERVER_BLOCK);
+    parent->setupLock.unlock();
+    if (!began) {
+      String err=e->getLastError();
+      parent->release(eng);
+      return reply(fmt::sprintf("ERR could not render! (%s)",err));
+    }
+
+    const int chans=options.chans;
+    float* outBuf[DIV_MAX_OUTPUTS];
+    for (int i=0; i<chans; i++) {
+      outBuf[i]=new float[FUR_RENDER_SERVER_BLOCK];
+    }
+    float* interleaved=new float[FUR_RENDER_SERVER_BLOCK*chans];
+    short* interleaved16=new short[FUR_RENDER_SERVER_BLOCK*chans];
+    uint64_t frames=0;
+
+    ok=reply(fmt::sprintf("OK %d %d %s",options.sampleRate,chans,s16?"s16":"f32"));
+    while (ok) {
+      size_t got=e->renderNext(outBuf,FUR_RENDER_SERVER_BLOCK);
+      if (got==0) break;
+      for (int i=0; i<chans; i++) {
+        for (size_t j=0; j<got; j++) {
+          interleaved[j*chans+i]=outBuf[i][j];
+        }
+      }
+      const void* data=interleaved;
+      size_t dataLen=got*chans*sizeof(float);
+      if (s16) {
+        for (size_t j=0; j<got*chans; j++) {
+          interleaved16[j]=(short)(interleaved[j]*32767.0f);
+        }
+        data=interleaved16;
+        dataLen=got*chans*sizeof(short);
+      }
+      ok=reply(fmt::sprintf("DATA %d",(int)dataLen));
+      if (ok) ok=sendData(data,dataLen);
+      frames+=got;
+    }
+
+    delete[] interleaved;
+    delete[] interleaved16;
+    for (int i=0; i<chans; i++) {
+      delete[] outBuf[i];
+    }
+
+    parent->setupLock.lock();
+    e->renderEnd();
+    parent->setupLock.unlock();
+    if (ok) ok=reply(fmt::sprintf("END %" PRIu64,frames));
+  } else {
+    SafeWriter* w=NULL;
+    if (type=="vgm") {
+      w=e->saveVGM(NULL,vgmLoop,0x171,false,vgmDirect);
+    } else {
+      w=e->saveCommand(NULL);
+    }
+    if (w==NULL) {
+      ok=reply(fmt::sprintf("ERR could not export! (%s)",e->getLastError()));
+    } else {
+      ok=reply(fmt::sprintf("OK %d",(int)w->size()));
+      if (ok) ok=sendData(w->getFinalBuf(),w->size());
+      w->finish();
+      delete w;
+    }
+  }
+
+  parent->jobCount++;
+  parent->release(eng);
+  return ok;
+}
+
+void FurnaceRenderClient::run() {
+  String line;
+  char buf[1024];
+  while (alive && renderServerRunning) {
+    struct pollfd pfd;
+    pfd.fd=fd;
+    pfd.events=POLLIN;
+    pfd.revents=0;
+    int ret=poll(&pfd,1,100);
+    if (ret<0 && errno!=EINTR) break;
+    if (ret<=0) continue;
+
+    ssize_t got=recv(fd,buf,1024,0);
+    if (got<0 && errno==EINTR) continue;
+    if (got<=0) break;
+    bool failed=false;
+    for (ssize_t i=0; i<got; i++) {
+      if (buf[i]=='\n') {
+        if (!line.empty() && line.back()=='\r') line.pop_back();
+        if (!runJob(line)) {
+          failed=true;
+          break;
+        }
+        line="";
+      } else if (line.size()<4096) {
+        line+=buf[i];
+      }
+    }
+    if (failed) break;
+  }
+  logV("render server: client %d disconnected.",fd);
+  alive=false;
+}
+
+FurnaceRenderEngine* FurnaceRenderServer::acquire(const String& path, int64_t time, int64_t size) {
+  std::unique_lock<std::mutex> lock(engineLock);
+  while (renderServerRunning) {
+    FurnaceRenderEngine* best=NULL;
+    for (FurnaceRenderEngine* i: engines) {
+      if (i->busy) continue;
+      // an engine with the song loaded already
+      if (i->songPath==path && i->songTime==time && i->songSize==size) {
+        best=i;
+        break;
+      }
+      // otherwise the one which has been idle the longest
+      if (best==NULL || i->lastUse<best->lastUse) best=i;
+    }
+    if (best!=NULL) {
+      best->busy=true;
+      best->lastUse=++useCount;
+      return best;
+    }
+    engineFree.wait_for(lock,std::chrono::milliseconds(100));
+  }
+  return NULL;
+}
+
+void FurnaceRenderServer::release(FurnaceRenderEngine* eng) {
+  engineLock.lock();
+  eng->busy=false;
+  engineLock.unlock();
+  engineFree.notify_one();
+}
+
+void FurnaceRenderServer::reapClients(bool all) {
+  for (size_t i=0; i<clients.size(); i++) {
+    FurnaceRenderClient* c=clients[i];
+    if (!all && c->alive) continue;
+    c->alive=false;
+    // unblock a pending send()
+    shutdown(c->fd,SHUT_RDWR);
+    if (c->thread) {
+      c->thread->join();
+      delete c->thread;
+    }
+    close(c->fd);
+    delete c;
+    clients.erase(clients.begin()+i);
+    i--;
+  }
+}
+
+bool FurnaceRenderServer::init(const String& path, int engineCount) {
+  sockPath=path.empty()?FUR_RENDER_SERVER_DEFAULT_PATH:path;
+
+  if (engineCount<1) {
+    engineCount=std::thread::hardware_concurrency();
+    if (engineCount<1) engineCount=1;
+  }
+
+  struct sockaddr_un addr;
+  memset(&addr,0,sizeof(addr));
+  addr.sun_family=AF_UNIX;
+  if (sockPath.size()>=sizeof(addr.sun_path)) {
+    logE("socket path is too long! (%s)",sockPath);
+    return false;
+  }
+  strncpy(addr.sun_path,sockPath.c_str(),sizeof(addr.sun_path)-1);
+
+  // warm up the engines
+  logI("starting %d engines...",engineCount);
+  for (int i=0; i<engineCount; i++) {
+    FurnaceRenderEngine* eng=new FurnaceRenderEngine;
+    eng->e=new DivEngine;
+    eng->e->setAudio(DIV_AUDIO_DUMMY);
+    eng->e->preInit(true);
+    if (!eng->e->init()) {
+      logE("could not initialize engine %d!",i);
+      eng->e->quit(false);
+      delete eng->e;
+      delete eng;
+      break;
+    }
+    engines.push_back(eng);
+  }
+  if (engines.empty()) return false;
+
+  listenFD=socket(AF_UNIX,SOCK_STREAM,0);
+  if (listenFD<0) {
+    logE("could not create socket! (%s)",strerror(errno));
+    return false;
+  }
+  // remove a stale socket from a previous run
+  unlink(sockPath.c_str());
+  if (bind(listenFD,(struct sockaddr*)&addr,sizeof(addr))<0) {
+    logE("could not bind socket! (%s)",strerror(errno));
+    close(listenFD);
+    listenFD=-1;
+    return false;
+  }
+  if (listen(listenFD,16)<0) {
+    logE("could not listen on socket! (%s)",strerror(errno));
+    close(listenFD);
+    listenFD=-1;
+    unlink(sockPath.c_str());
+    return false;
+  }
+
+  renderServerRunning=true;
+  logI("render server listening on %s.",sockPath);
+  return true;
+}
+
+void FurnaceRenderServer::run() {
+  struct sigaction sa;
+  memset(&sa,0,sizeof(sa));
+  sa.sa_handler=renderServerSignal;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT,&sa,NULL);
+  sigaction(SIGTERM,&sa,NULL);
+
+  struct pollfd pfd;
+  while (renderServerRunning) {
+    reapClients(false);
+
+    pfd.fd=listenFD;
+    pfd.events=POLLIN;
+    pfd.revents=0;
+    int ret=poll(&pfd,1,100);
+    if (ret<=0) continue;
+
+    int fd=accept(listenFD,NULL,NULL);
+    if (fd<0) continue;
+#ifdef SO_NOSIGPIPE
+    int one=1;
+    setsockopt(fd,SOL_SOCKET,SO_NOSIGPIPE,&one,sizeof(one));
+#endif
+
+    FurnaceRenderClient* c=new FurnaceRenderClient;
+    c->parent=this;
+    c->fd=fd;
+    c->alive=true;
+    c->thread=new std::thread(furRenderClientThread,c);
+    clients.push_back(c);
+    logV("render server: client %d connected.",fd);
+  }
+  logI("stopping render server...");
+}
+
+void FurnaceRenderServer::requestStop() {
+  renderServerRunning=false;
+}
+
+void FurnaceRenderServer::quit() {
+  renderServerRunning=false;
+  engineFree.notify_all();
+  reapClients(true);
+
+  if (listenFD>=0) {
+    close(listenFD);
+    listenFD=-1;
+    unlink(sockPath.c_str());
+  }
+
+  for (FurnaceRenderEngine* i: engines) {
+    i->e->quit(false);
+    delete i->e;
+    delete i;
+  }
+  engines.clear();
+}
+
+FurnaceRenderServer::FurnaceRenderServer():
+  listenFD(-1),
+  useCount(0),
+  jobCount(0) {
+}
+
+FurnaceRenderServer::~FurnaceRenderServer() {
+  quit();
+}
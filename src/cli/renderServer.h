@@ -0,0 +1,126 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _FUR_RENDER_SERVER_H
+#define _FUR_RENDER_SERVER_H
+
+#include "../engine/engine.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#define FUR_RENDER_SERVER_DEFAULT_PATH "/tmp/furnace-render.sock"
+// frames per block of streamed audio
+#define FUR_RENDER_SERVER_BLOCK 2048
+
+class FurnaceRenderServer;
+
+// an engine in the pool
+struct FurnaceRenderEngine {
+  DivEngine* e;
+  bool busy;
+  // the song it has loaded (used to skip loading it again)
+  String songPath;
+  int64_t songTime, songSize;
+  uint64_t lastUse;
+
+  FurnaceRenderEngine():
+    e(NULL),
+    busy(false),
+    songTime(0),
+    songSize(-1),
+    lastUse(0) {}
+};
+
+struct FurnaceRenderClient {
+  FurnaceRenderServer* parent;
+  int fd;
+  std::atomic<bool> alive;
+  std::thread* thread;
+
+  bool reply(const String& line);
+  bool sendData(const void* data, size_t len);
+  bool runJob(const String& line);
+  void run();
+
+  FurnaceRenderClient():
+    parent(NULL),
+    fd(-1),
+    alive(false),
+    thread(NULL) {}
+};
+
+/**
+ * headless render server.
+ * keeps a pool of engines ready (config and sample ROMs loaded once) and
+ * accepts jobs over a Unix domain socket. every connection is served by its
+ * own thread, and a job takes an idle engine for itself, so jobs from
+ * different connections render concurrently.
+ * an engine keeps its last song, and jobs on the same file go to it first.
+ */
+class FurnaceRenderServer {
+  friend struct FurnaceRenderClient;
+
+  int listenFD;
+  String sockPath;
+  std::vector<FurnaceRenderEngine*> engines;
+  std::mutex engineLock;
+  std::condition_variable engineFree;
+  uint64_t useCount;
+  // songs are loaded and chip cores switched one engine at a time, as some
+  // cores set up shared tables when they are first created
+  std::mutex setupLock;
+  std::atomic<unsigned int> jobCount;
+
+  std::vector<FurnaceRenderClient*> clients;
+
+  FurnaceRenderEngine* acquire(const String& path, int64_t time, int64_t size);
+  void release(FurnaceRenderEngine* eng);
+  void reapClients(bool all);
+
+  public:
+    /**
+     * create the engines and start listening.
+     * @param path socket path.
+     * @param engineCount number of engines (0 for one per CPU core).
+     * @return whether the server could start.
+     */
+    bool init(const String& path, int engineCount);
+
+    /**
+     * serve clients until requestStop() is called.
+     */
+    void run();
+
+    /**
+     * stop run() (safe to call from a signal handler).
+     */
+    static void requestStop();
+
+    /**
+     * close every connection and free the engines.
+     */
+    void quit();
+
+    FurnaceRenderServer();
+    ~FurnaceRenderServer();
+};
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "allocTracker.h"
+
+#ifdef FURNACE_ALLOC_TRACKER
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <atomic>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#include <execinfo.h>
+#include <unistd.h>
+#define HAVE_ALLOC_BACKTRACE
+#endif
+
+static thread_local int audioDepth=0;
+// set while reporting (printing a backtrace may allocate too)
+static thread_local bool reporting=false;
+static std::atomic<size_t> audioAllocs(0);
+
+DivAudioSection::DivAudioSection() {
+  audioDepth++;
+}
+
+DivAudioSection::~DivAudioSection() {
+  audioDepth--;
+}
+
+size_t divAllocTrackerCount() {
+  return audioAllocs.load();
+}
+
+static void reportAlloc(size_t size) {
+  if (audioDepth<1 || reporting) return;
+  reporting=true;
+  audioAllocs++;
+
+  // no logger here - it may allocate or lock
+  char msg[128];
+  snprintf(msg,128,"ALLOCATION IN AUDIO THREAD! (%lu bytes)\n",(unsigned long)size);
+  fputs(msg,stderr);
+#ifdef HAVE_ALLOC_BACKTRACE
+  void* frames[48];
+  int count=backtrace(frames,48);
+  backtrace_symbols_fd(frames,count,STDERR_FILENO);
+#endif
+
+  reporting=false;
+}
+
+static void* trackedAlloc(size_t size) {
+  reportAlloc(size);
+  void* ret=malloc(size?size:1);
+  if (ret==NULL) throw std::bad_alloc();
+  return ret;
+}
+
+void* operator new(size_t size) {
+  return trackedAlloc(size);
+}
+
+void* operator new[](size_t size) {
+  return trackedAlloc(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  reportAlloc(size);
+  return malloc(size?size:1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  reportAlloc(size);
+  return malloc(size?size:1);
+}
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+  free(ptr);
+}
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _ALLOC_TRACKER_H
+#define _ALLOC_TRACKER_H
+
+#include <stddef.h>
+
+// debug aid for the audio thread, enabled with WITH_ALLOC_TRACKER.
+// while an audio section is active on a thread, every allocation made through
+// operator new on that thread is reported to stderr (with a backtrace if possible).
+#ifdef FURNACE_ALLOC_TRACKER
+
+struct DivAudioSection {
+  DivAudioSection();
+  ~DivAudioSection();
+};
+
+/**
+ * get the number of allocations done in audio sections so far.
+ */
+size_t divAllocTrackerCount();
+
+#define DIV_AUDIO_SECTION DivAudioSection _audioSection
+
+#else
+
+#define DIV_AUDIO_SECTION
+
+#endif
+
+#endif
@@ -0,0 +1,500 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "engine.h"
+#include "effect/convolution.h"
+#include "workPool.h"
+#include "../ta-log.h"
+#include "../fileutils.h"
+#include <fmt/printf.h>
+#include <inttypes.h>
+#include <chrono>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#define BENCH_BUFSIZE 2048
+// seek is measured this many times and averaged
+#define BENCH_SEEK_RUNS 5
+// don't render more than this (in seconds) per song
+#define BENCH_MAX_AUDIO 1200
+// timings below this (in seconds) are too noisy to be flagged as regressions
+#define BENCH_MIN_TIME 0.005
+
+static const char* benchTimedKeys[]={
+  "loadSeconds",
+  "saveSeconds",
+  "renderSeconds",
+  "seekSeconds",
+  "walkSeconds",
+  "vgmSeconds",
+  "cmdSeconds",
+  NULL
+};
+
+static const char* benchHashKeys[]={
+  "saveHash",
+  "renderHash",
+  "vgmHash",
+  "cmdHash",
+  NULL
+};
+
+// FNV-1a
+static uint64_t benchHash(uint64_t h, const void* data, size_t len) {
+  const unsigned char* d=(const unsigned char*)data;
+  for (size_t i=0; i<len; i++) {
+    h^=d[i];
+    h*=0x100000001b3ULL;
+  }
+  return h;
+}
+
+#define BENCH_HASH_INIT 0xcbf29ce484222325ULL
+
+static double benchNow() {
+  return (double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()/1000000.0;
+}
+
+// peak resident set size of the process (in bytes), or 0 if unknown
+static uint64_t benchPeakRSS() {
+#ifdef _WIN32
+  return 0;
+#else
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF,&ru)!=0) return 0;
+#ifdef __APPLE__
+  return (uint64_t)ru.ru_maxrss;
+#else
+  return (uint64_t)ru.ru_maxrss*1024;
+#endif
+#endif
+}
+
+static String benchEscape(const String& s) {
+  String ret;
+  for (char i: s) {
+    if (i=='"' || i=='\\') {
+      ret+='\\';
+      ret+=i;
+    } else if ((unsigned char)i<0x20) {
+      ret+=' ';
+    } else {
+      ret+=i;
+    }
+  }
+  return ret;
+}
+
+// the report is written one song per line, so these only need to look within a line.
+static bool benchFindString(const String& line, const char* key, String& out) {
+  String pattern=fmt::sprintf("\"%s\":\"",key);
+  size_t pos=line.find(pattern);
+  if (pos==String::npos) return false;
+  out="";
+  for (size_t i=pos+pattern.size(); i<line.size(); i++) {
+    if (line[i]=='\\' && i+1<line.size()) {
+      out+=line[++i];
+    } else if (line[i]=='"') {
+      return true;
+    } else {
+      out+=line[i];
+    }
+  }
+  return false;
+}
+
+static bool benchFindNumber(const String& line, const char* key, double& out) {
+  String pattern=fmt::sprintf("\"%s\":",key);
+  size_t pos=line.find(pattern);
+  if (pos==String::npos) return false;
+  try {
+    out=std::stod(line.substr(pos+pattern.size()));
+  } catch (std::exception& e) {
+    return false;
+  }
+  return true;
+}
+
+static bool benchReadFile(const String& path, unsigned char** buf, size_t* len) {
+  FILE* f=ps_fopen(path.c_str(),"rb");
+  if (f==NULL) return false;
+  if (fseek(f,0,SEEK_END)<0) {
+    fclose(f);
+    return false;
+  }
+  ssize_t size=ftell(f);
+  if (size<1 || fseek(f,0,SEEK_SET)<0) {
+    fclose(f);
+    return false;
+  }
+  *buf=new unsigned char[size];
+  if (fread(*buf,1,(size_t)size,f)!=(size_t)size) {
+    fclose(f);
+    delete[] *buf;
+    *buf=NULL;
+    return false;
+  }
+  fclose(f);
+  *len=size;
+  return true;
+}
+
+String DivEngine::benchmarkSong(const String& path, const String& name) {
+  unsigned char* file=NULL;
+  size_t len=0;
+  double t;
+
+  if (!benchReadFile(path,&file,&len)) {
+    logE("%s: could not read file! (%s)",name,strerror(errno));
+    return "";
+  }
+
+  // load
+  stop();
+  t=benchNow();
+  if (!load(file,len,path.c_str())) {
+    logE("%s: could not load! (%s)",name,getLastError());
+    return "";
+  }
+  double loadTime=benchNow()-t;
+
+  // save
+  t=benchNow();
+  SafeWriter* w=saveFur();
+  double saveTime=benchNow()-t;
+  uint64_t saveHash=BENCH_HASH_INIT;
+  if (w!=NULL) {
+    saveHash=benchHash(saveHash,w->getFinalBuf(),w->size());
+    w->finish();
+    delete w;
+  }
+
+  // render
+  float* outBuf[2];
+  outBuf[0]=new float[BENCH_BUFSIZE];
+  outBuf[1]=new float[BENCH_BUFSIZE];
+  prepareAudioBuffers(BENCH_BUFSIZE);
+  uint64_t frames=0;
+  uint64_t maxFrames=(uint64_t)got.rate*BENCH_MAX_AUDIO;
+
+  auto renderOnce=[this,&outBuf,&frames,maxFrames]() -> uint64_t {
+    uint64_t hash=BENCH_HASH_INIT;
+    frames=0;
+    curOrder=0;
+    prevOrder=0;
+    remainingLoops=1;
+    playSub(false);
+    while (playing && frames<maxFrames) {
+      nextBuf(NULL,outBuf,0,2,BENCH_BUFSIZE);
+      hash=benchHash(hash,outBuf[0],BENCH_BUFSIZE*sizeof(float));
+      hash=benchHash(hash,outBuf[1],BENCH_BUFSIZE*sizeof(float));
+      frames+=BENCH_BUFSIZE;
+    }
+    return hash;
+  };
+
+  bool oldParallelTick=parallelTick;
+  parallelTick=false;
+  t=benchNow();
+  uint64_t renderHash=renderOnce();
+  double renderTime=benchNow()-t;
+  double audioTime=(double)frames/(double)got.rate;
+  if (playing) {
+    logW("%s: stopped rendering after %d seconds.",name,BENCH_MAX_AUDIO);
+  }
+  stop();
+
+  // render again ticking chips in parallel (one thread per chip), which shall
+  // produce exactly the same output
+  bool hasParallel=(song.systemLen>=DIV_PARALLEL_TICK_MIN);
+  uint64_t parallelHash=BENCH_HASH_INIT;
+  if (hasParallel) {
+    DivWorkPool* oldPool=renderPool;
+    renderPool=new DivWorkPool(song.systemLen);
+    parallelTick=true;
+    parallelHash=renderOnce();
+    stop();
+    delete renderPool;
+    renderPool=oldPool;
+  }
+  parallelTick=oldParallelTick;
+  delete[] outBuf[0];
+  delete[] outBuf[1];
+
+  // seek
+  double seekTime=0.0;
+  for (int i=0; i<BENCH_SEEK_RUNS; i++) {
+    curOrder=curSubSong->ordersLen-1;
+    prevOrder=curSubSong->ordersLen-1;
+    t=benchNow();
+    playSub(false);
+    seekTime+=benchNow()-t;
+  }
+  seekTime/=BENCH_SEEK_RUNS;
+  stop();
+
+  // walk
+  t=benchNow();
+  calcSongTimestamps();
+  double walkTime=benchNow()-t;
+
+  // VGM export (not every song can be exported)
+  t=benchNow();
+  w=saveVGM();
+  double vgmTime=benchNow()-t;
+  uint64_t vgmHash=BENCH_HASH_INIT;
+  bool hasVGM=(w!=NULL);
+  if (w!=NULL) {
+    vgmHash=benchHash(vgmHash,w->getFinalBuf(),w->size());
+    w->finish();
+    delete w;
+  }
+
+  // command stream export
+  t=benchNow();
+  w=saveCommand();
+  double cmdTime=benchNow()-t;
+  uint64_t cmdHash=BENCH_HASH_INIT;
+  bool hasCmd=(w!=NULL);
+  if (w!=NULL) {
+    cmdHash=benchHash(cmdHash,w->getFinalBuf(),w->size());
+    w->finish();
+    delete w;
+  }
+
+  String ret=fmt::sprintf(
+    "{\"file\":\"%s\",\"loadSeconds\":%.6f,\"saveSeconds\":%.6f,\"saveHash\":\"%016" PRIx64 "\","
+    "\"renderSeconds\":%.6f,\"audioSeconds\":%.3f,\"speed\":%.2f,\"renderHash\":\"%016" PRIx64 "\","
+    "\"seekSeconds\":%.6f,\"walkSeconds\":%.6f",
+    benchEscape(name),
+    loadTime,saveTime,saveHash,
+    renderTime,audioTime,(renderTime>0.0)?(audioTime/renderTime):0.0,renderHash,
+    seekTime,walkTime
+  );
+  if (hasParallel) {
+    ret+=fmt::sprintf(",\"parallelHash\":\"%016" PRIx64 "\"",parallelHash);
+  }
+  if (hasVGM) {
+    ret+=fmt::sprintf(",\"vgmSeconds\":%.6f,\"vgmHash\":\"%016" PRIx64 "\"",vgmTime,vgmHash);
+  }
+  if (hasCmd) {
+    ret+=fmt::sprintf(",\"cmdSeconds\":%.6f,\"cmdHash\":\"%016" PRIx64 "\"",cmdTime,cmdHash);
+  }
+  ret+=fmt::sprintf(",\"peakRSS\":%" PRIu64 "}",benchPeakRSS());
+
+  printf("%-48s %8.2fx %10.3fs\n",name.c_str(),(renderTime>0.0)?(audioTime/renderTime):0.0,renderTime);
+  return ret;
+}
+
+int DivEngine::benchmarkSuite(const char* corpusPath, const char* reportPath, const char* baselinePath, double threshold) {
+  std::vector<String> corpus;
+  std::vector<String> results;
+  int failed=0;
+
+  // read the corpus (one file per line, relative to the corpus file)
+  FILE* f=ps_fopen(corpusPath,"rb");
+  if (f==NULL) {
+    logE("could not open corpus! (%s)",strerror(errno));
+    return -1;
+  }
+  String corpusDir=corpusPath;
+  size_t sepPos=corpusDir.find_last_of("/\\");
+  if (sepPos==String::npos) {
+    corpusDir="";
+  } else {
+    corpusDir=corpusDir.substr(0,sepPos+1);
+  }
+  char line[4096];
+  while (fgets(line,4095,f)!=NULL) {
+    String entry=line;
+    while (!entry.empty() && (entry.back()=='\n' || entry.back()=='\r' || entry.back()==' ')) entry.pop_back();
+    if (entry.empty() || entry[0]=='#') continue;
+    corpus.push_back(entry);
+  }
+  fclose(f);
+
+  if (corpus.empty()) {
+    logE("the corpus is empty!");
+    return -1;
+  }
+
+  logI("running benchmark suite (%d songs)...",(int)corpus.size());
+  printf("%-48s %9s %11s\n","song","speed","render");
+  for (String& i: corpus) {
+    String path=(i[0]=='/' || corpusDir.empty())?i:(corpusDir+i);
+    String result=benchmarkSong(path,i);
+    if (result.empty()) {
+      failed++;
+      continue;
+    }
+    String renderHash, parallelHash;
+    if (benchFindString(result,"parallelHash",parallelHash)) {
+      benchFindString(result,"renderHash",renderHash);
+      if (parallelHash!=renderHash) {
+        printf("[MISMATCH] %s: parallel tick output differs (%s != %s)\n",i.c_str(),parallelHash.c_str(),renderHash.c_str());
+        failed++;
+      }
+    }
+    results.push_back(result);
+  }
+
+  // write report
+  f=ps_fopen(reportPath,"wb");
+  if (f==NULL) {
+    logE("could not open report file! (%s)",strerror(errno));
+    return -1;
+  }
+  fprintf(f,"{\"version\":1,\"rate\":%d,\"songs\":[\n",(int)got.rate);
+  for (size_t i=0; i<results.size(); i++) {
+    fprintf(f,"%s%s\n",results[i].c_str(),(i+1<results.size())?",":"");
+  }
+  fprintf(f,"]}\n");
+  fclose(f);
+  logI("report written to %s.",reportPath);
+
+  if (baselinePath==NULL) return failed;
+
+  // compare against baseline
+  std::vector<String> baseline;
+  f=ps_fopen(baselinePath,"rb");
+  if (f==NULL) {
+    logE("could not open baseline! (%s)",strerror(errno));
+    return -1;
+  }
+  String baseLine;
+  int c;
+  while ((c=fgetc(f))!=EOF) {
+    if (c=='\n') {
+      if (baseLine.find("{\"file\":")!=String::npos) baseline.push_back(baseLine);
+      baseLine="";
+    } else {
+      baseLine+=(char)c;
+    }
+  }
+  if (baseLine.find("{\"file\":")!=String::npos) baseline.push_back(baseLine);
+  fclose(f);
+
+  int issues=0;
+  for (String& i: results) {
+    String name, baseName;
+    benchFindString(i,"file",name);
+    const String* base=NULL;
+    for (String& j: baseline) {
+      if (benchFindString(j,"file",baseName) && baseName==name) {
+        base=&j;
+        break;
+      }
+    }
+    if (base==NULL) {
+      logW("%s: not in baseline.",name);
+      continue;
+    }
+
+    for (int j=0; benchTimedKeys[j]; j++) {
+      double cur, prev;
+      if (!benchFindNumber(i,benchTimedKeys[j],cur)) continue;
+      if (!benchFindNumber(*base,benchTimedKeys[j],prev)) continue;
+      if (prev<BENCH_MIN_TIME && cur<BENCH_MIN_TIME) continue;
+      double change=(prev>0.0)?(100.0*(cur-prev)/prev):100.0;
+      if (change>threshold) {
+        printf("[REGRESSION] %s: %s %.6f -> %.6f (+%.1f%%)\n",name.c_str(),benchTimedKeys[j],prev,cur,change);
+        issues++;
+      }
+    }
+    for (int j=0; benchHashKeys[j]; j++) {
+      String cur, prev;
+      bool hasCur=benchFindString(i,benchHashKeys[j],cur);
+      bool hasPrev=benchFindString(*base,benchHashKeys[j],prev);
+      if (!hasCur && !hasPrev) continue;
+      if (cur!=prev) {
+        printf("[CHANGED] %s: %s %s -> %s\n",name.c_str(),benchHashKeys[j],hasPrev?prev.c_str():"none",hasCur?cur.c_str():"none");
+        issues++;
+      }
+    }
+  }
+
+  if (issues) {
+    printf("[RESULT] %d regressions/changes against baseline\n",issues);
+  } else {
+    printf("[RESULT] no regressions against baseline\n");
+  }
+  return failed+issues;
+}
+
+// convolution reverb benchmark
+#define BENCH_CONV_RATE 48000
+#define BENCH_CONV_AUDIO 10
+
+static uint64_t benchConvRun(DivEffectConvolution& conv, double& seconds) {
+  float inL[DIV_CONV_BLOCK], inR[DIV_CONV_BLOCK];
+  float outL[DIV_CONV_BLOCK], outR[DIV_CONV_BLOCK];
+  float* in[2]={inL,inR};
+  float* out[2]={outL,outR};
+  uint64_t hash=BENCH_HASH_INIT;
+  unsigned int seed=1;
+
+  conv.reset();
+  double timeStart=benchNow();
+  for (int i=0; i<BENCH_CONV_RATE*BENCH_CONV_AUDIO; i+=DIV_CONV_BLOCK) {
+    for (int j=0; j<DIV_CONV_BLOCK; j++) {
+      seed=seed*1103515245+12345;
+      inL[j]=(float)((int)(seed>>16)&0x7fff)/16384.0f-1.0f;
+      inR[j]=-inL[j];
+    }
+    conv.acquire(in,out,DIV_CONV_BLOCK);
+    hash=benchHash(hash,outL,sizeof(outL));
+    hash=benchHash(hash,outR,sizeof(outR));
+  }
+  seconds=benchNow()-timeStart;
+  return hash;
+}
+
+int DivEngine::benchmarkConvolution() {
+  const int irSeconds[3]={1,4,10};
+  int failed=0;
+
+  for (int i=0; i<3; i++) {
+    // exponentially decaying noise
+    size_t irLen=(size_t)irSeconds[i]*BENCH_CONV_RATE;
+    std::vector<float> ir(irLen);
+    unsigned int seed=irSeconds[i];
+    for (size_t j=0; j<irLen; j++) {
+      seed=seed*1103515245+12345;
+      float noise=(float)((int)(seed>>16)&0x7fff)/16384.0f-1.0f;
+      ir[j]=noise*expf(-6.9f*(float)j/(float)irLen)*0.05f;
+    }
+
+    DivEffectConvolution conv;
+    conv.init(this,BENCH_CONV_RATE,0,NULL,0);
+    conv.setOffline(true);
+    conv.setImpulse(ir.data(),irLen);
+
+    // run twice to check that output doesn't depend on timing
+    double t1=0.0, t2=0.0;
+    uint64_t hash1=benchConvRun(conv,t1);
+    uint64_t hash2=benchConvRun(conv,t2);
+    conv.quit();
+
+    double perSecond=MIN(t1,t2)/(double)BENCH_CONV_AUDIO;
+    printf("[RESULT] %2ds IR: %.3fms per second of audio (%.2f%% of real time)%s\n",irSeconds[i],perSecond*1000.0,perSecond*100.0,(hash1==hash2)?"":" NOT DETERMINISTIC!");
+    if (hash1!=hash2) failed++;
+  }
+  return failed;
+}
@@ -440,7 +440,9 @@ constexpr size_t OSCBUF_PREC=(sizeof(size_t)>=8)?16:16;
 constexpr size_t OSCBUF_MASK=(UINTMAX_C(1)<<OSCBUF_PREC)-1;
 
 #define putSampleIKnowWhatIAmDoing(_ob,_pos,_val) \
-  _ob->data[_pos]=_val;
+  do { \
+    _ob->data[_pos]=_val; \
+  } while (0)
 
 // the actual output of all DivDispatchOscBuffer instanced runs at 65536Hz.
 struct DivDispatchOscBuffer {
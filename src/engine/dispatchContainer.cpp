@@ -106,6 +106,63 @@ void DivDispatchContainer::setRates(double gotRate) {
     blip_set_rates(bb[i],dispatch->rate,gotRate);
   }
   rateMemory=gotRate;
+
+  // check whether we can skip blip_buf
+  int prevRatio=nativeRatio;
+  nativeRatio=0;
+  if (resampler!=DIV_RESAMPLER_BLIP && !dispatch->hasAcquireDirect() && gotRate>=1.0) {
+    int ratio=(int)round((double)dispatch->rate/gotRate);
+    if (ratio>=1 && ratio<=DIV_NATIVE_MAX_RATIO && fabs((double)dispatch->rate-gotRate*ratio)<0.001) {
+      nativeRatio=ratio;
+    }
+  }
+
+  if (nativeTaps!=NULL) {
+    delete[] nativeTaps;
+    nativeTaps=NULL;
+  }
+  nativeTapCount=0;
+  if (nativeRatio>1 && resampler!=DIV_RESAMPLER_NATIVE_FAST) {
+    // windowed sinc low-pass at 90% of the output Nyquist frequency
+    nativeTapCount=16*nativeRatio+1;
+    nativeTaps=new float[nativeTapCount];
+    const double cutoff=0.45/(double)nativeRatio;
+    const int center=nativeTapCount/2;
+    double sum=0.0;
+    for (int i=0; i<nativeTapCount; i++) {
+      double x=(double)(i-center);
+      double sinc=(i==center)?(2.0*cutoff):(sin(2.0*M_PI*cutoff*x)/(M_PI*x));
+      // Blackman window
+      double w=0.42-0.5*cos(2.0*M_PI*i/(nativeTapCount-1))+0.08*cos(4.0*M_PI*i/(nativeTapCount-1));
+      nativeTaps[i]=sinc*w;
+      sum+=nativeTaps[i];
+    }
+    for (int i=0; i<nativeTapCount; i++) {
+      nativeTaps[i]/=sum;
+    }
+  }
+  for (int i=0; i<DIV_MAX_OUTPUTS; i++) {
+    if (nativeHist[i]!=NULL) {
+      delete[] nativeHist[i];
+      nativeHist[i]=NULL;
+    }
+    if (i<outs && nativeTapCount>1) {
+      nativeHist[i]=new short[nativeTapCount-1];
+      memset(nativeHist[i],0,(nativeTapCount-1)*sizeof(short));
+    }
+  }
+
+  if (nativeRatio!=prevRatio) {
+    if (nativeRatio>0) {
+      logV("using native rate path (1:%d)",nativeRatio);
+    }
+    if (bb[0]!=NULL) clear();
+  }
+  if (reserveLen>0) reserve(reserveLen);
+}
+
+void DivDispatchContainer::setResampler(int mode) {
+  resampler=mode;
 }
 
 void DivDispatchContainer::setQuality(bool lowQual, bool dcHiPass) {
@@ -127,6 +184,28 @@ void DivDispatchContainer::grow(size_t size) {
   }
 }
 
+// makes room for rendering size output samples at once, so that the audio
+// thread doesn't have to grow the buffers. called again when the rate changes.
+void DivDispatchContainer::reserve(unsigned int size) {
+  reserveLen=size;
+  if (dispatch==NULL || size==0) return;
+  size_t total;
+  if (nativeRatio>0) {
+    total=(size_t)size*nativeRatio;
+  } else {
+    total=(size_t)ceil((double)dispatch->rate*(double)size/MAX(1.0,rateMemory))+16;
+  }
+  if (total+256>bbInLen) {
+    logD("growing dispatch %p bbIn to %d",(void*)this,(int)(total+256));
+    grow(total+256);
+  }
+  if (nativeTapCount>1 && nativeWorkLen<total+nativeTapCount) {
+    if (nativeWork!=NULL) delete[] nativeWork;
+    nativeWorkLen=total+nativeTapCount+256;
+    nativeWork=new short[nativeWorkLen];
+  }
+}
+
 #define CHECK_MISSING_BUFS \
   int outs=dispatch->getOutputCount(); \
  \
@@ -173,6 +252,18 @@ void DivDispatchContainer::acquire(size_t count) {
   }
 }
 
+int DivDispatchContainer::samplesAvail() {
+  // the native path never has leftover samples
+  if (nativeRatio>0) return 0;
+  if (bb[0]==NULL) return 0;
+  return blip_samples_avail(bb[0]);
+}
+
+int DivDispatchContainer::clocksNeeded(int count) {
+  if (nativeRatio>0) return count*nativeRatio;
+  return blip_clocks_needed(bb[0],count);
+}
+
 void DivDispatchContainer::flush(size_t offset, size_t count) {
   int outs=dispatch->getOutputCount();
 
@@ -182,9 +273,84 @@ void DivDispatchContainer::flush(size_t offset, size_t count) {
   }
 }
 
+void DivDispatchContainer::fillNative(size_t runtotal, size_t offset, size_t size) {
+  int outs=dispatch->getOutputCount();
+  const float dcMul=hiPass?(1.0f-1.0f/512.0f):1.0f;
+
+  if (dcOffCompensation && runtotal>0) {
+    dcOffCompensation=false;
+    if (hiPass) {
+      for (int i=0; i<outs; i++) {
+        if (bbIn[i]==NULL) continue;
+        prevSample[i]=bbIn[i][0];
+      }
+    }
+  }
+
+  // history plus this run
+  if (nativeTapCount>1 && nativeWorkLen<runtotal+nativeTapCount) {
+    if (nativeWork!=NULL) delete[] nativeWork;
+    nativeWorkLen=runtotal+nativeTapCount+256;
+    nativeWork=new short[nativeWorkLen];
+  }
+
+  for (int i=0; i<outs; i++) {
+    if (bbIn[i]==NULL || bbOut[i]==NULL) continue;
+    const short* in=bbIn[i];
+    short* out=bbOut[i]+offset;
+    float dc=nativeDC[i];
+    int prev=prevSample[i];
+
+    if (nativeRatio==1) {
+      memcpy(out,in,size*sizeof(short));
+    } else if (nativeTapCount<=1) {
+      // average
+      for (size_t j=0; j<size; j++) {
+        int sum=0;
+        for (int k=0; k<nativeRatio; k++) {
+          sum+=in[j*nativeRatio+k];
+        }
+        out[j]=sum/nativeRatio;
+      }
+    } else {
+      // polyphase decimation (only the samples we keep are filtered)
+      const int histLen=nativeTapCount-1;
+      memcpy(nativeWork,nativeHist[i],histLen*sizeof(short));
+      memcpy(nativeWork+histLen,in,runtotal*sizeof(short));
+      for (size_t j=0; j<size; j++) {
+        const short* src=nativeWork+j*nativeRatio+nativeRatio-1;
+        float sum=0.0f;
+        for (int k=0; k<nativeTapCount; k++) {
+          sum+=nativeTaps[k]*src[k];
+        }
+        out[j]=(short)CLAMP((int)lrintf(sum),-32768,32767);
+      }
+      memcpy(nativeHist[i],nativeWork+runtotal,histLen*sizeof(short));
+    }
+
+    // DC high-pass (same as blip_buf's)
+    for (size_t j=0; j<size; j++) {
+      int x=out[j];
+      dc=dc*dcMul+(float)(x-prev);
+      prev=x;
+      out[j]=(short)CLAMP((int)dc,-32768,32767);
+    }
+    nativeDC[i]=dc;
+    prevSample[i]=prev;
+    temp[i]=prev;
+
+    dispatch->postProcess(out,i,size,rateMemory);
+  }
+}
+
 void DivDispatchContainer::fillBuf(size_t runtotal, size_t offset, size_t size) {
   CHECK_MISSING_BUFS;
 
+  if (nativeRatio>0) {
+    fillNative(runtotal,offset,size);
+    return;
+  }
+
   if (!dispatch->hasAcquireDirect()) {
     if (dcOffCompensation && runtotal>0) {
       dcOffCompensation=false;
@@ -216,11 +382,30 @@ void DivDispatchContainer::fillBuf(size_t runtotal, size_t offset, size_t size)
   }
 }
 
+void DivDispatchContainer::perfRecord(uint64_t begin, uint64_t mid, uint64_t end) {
+  perfAcquireAccum+=mid-begin;
+  perfFillBufAccum+=end-mid;
+  perfSlice+=end-begin;
+  if (perfTrace) {
+    perfEvents.push_back(DivPerfEvent(begin,mid-begin,-1,DIV_PERF_CHIP_ACQUIRE));
+    perfEvents.push_back(DivPerfEvent(mid,end-mid,-1,DIV_PERF_CHIP_FILLBUF));
+  }
+}
+
+void DivDispatchContainer::perfCommit() {
+  perfAcquire.add(perfAcquireAccum);
+  perfFillBuf.add(perfFillBufAccum);
+  perfAcquireAccum=0;
+  perfFillBufAccum=0;
+}
+
 void DivDispatchContainer::clear() {
   for (int i=0; i<DIV_MAX_OUTPUTS; i++) {
     if (bb[i]!=NULL) blip_clear(bb[i]);
     temp[i]=0;
     prevSample[i]=0;
+    nativeDC[i]=0.0f;
+    if (nativeHist[i]!=NULL) memset(nativeHist[i],0,(nativeTapCount-1)*sizeof(short));
   }
 
   if (dispatch->getDCOffRequired() && hiPass) {
@@ -797,6 +982,7 @@ void DivDispatchContainer::init(DivSystem sys, DivEngine* eng, int chanCount, do
       break;
   }
   dispatch->init(eng,chanCount,gotRate,flags);
+  resampler=flags.getInt("resampler",DIV_RESAMPLER_AUTO);
 
   // initialize output buffers
   int outs=dispatch->getOutputCount();
@@ -836,6 +1022,22 @@ void DivDispatchContainer::quit() {
       blip_delete(bb[i]);
       bb[i]=NULL;
     }
+    if (nativeHist[i]!=NULL) {
+      delete[] nativeHist[i];
+      nativeHist[i]=NULL;
+    }
   }
   bbInLen=0;
+
+  if (nativeTaps!=NULL) {
+    delete[] nativeTaps;
+    nativeTaps=NULL;
+  }
+  if (nativeWork!=NULL) {
+    delete[] nativeWork;
+    nativeWork=NULL;
+  }
+  nativeTapCount=0;
+  nativeWorkLen=0;
+  nativeRatio=0;
 }
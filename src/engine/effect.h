@@ -147,6 +147,21 @@ class DivEffect {
      */
     virtual String getDynamicText(size_t id);
 
+    /**
+     * notify that samples have been rendered (their data may have changed).
+     */
+    virtual void notifySampleChange();
+
+    /**
+     * notify that two samples have been exchanged.
+     */
+    virtual void notifySampleExchange(int one, int two);
+
+    /**
+     * notify deletion of a sample.
+     */
+    virtual void notifySampleDeletion(int index);
+
     /**
      * load effect data.
      * @param version effect data version. may be zero.
@@ -64,6 +64,15 @@ String DivEffect::getDynamicText(size_t id) {
   return "";
 }
 
+void DivEffect::notifySampleChange() {
+}
+
+void DivEffect::notifySampleExchange(int one, int two) {
+}
+
+void DivEffect::notifySampleDeletion(int index) {
+}
+
 bool DivEffect::load(unsigned short version, const unsigned char* data, size_t len) {
   return false;
 }
@@ -0,0 +1,624 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "convolution.h"
+#include "../engine.h"
+#include "../fftPlan.h"
+#include "../../ta-log.h"
+#include <fmt/printf.h>
+#include <math.h>
+#include <chrono>
+#include <stdexcept>
+
+// stage
+
+bool DivConvolutionStage::init(const float* ir, size_t len, int blockLen) {
+  quit();
+  if (len==0 || ir==NULL) return false;
+
+  block=blockLen;
+  fftLen=block*2;
+  bins=block+1;
+  parts=(len+block-1)/block;
+  fdlPos=0;
+
+  timeBuf=(double*)fftw_malloc(fftLen*sizeof(double));
+  spec=(fftw_complex*)fftw_malloc(bins*sizeof(fftw_complex));
+  acc=(fftw_complex*)fftw_malloc(bins*sizeof(fftw_complex));
+  irSpec=(fftw_complex*)fftw_malloc(parts*bins*sizeof(fftw_complex));
+  for (int i=0; i<DIV_CONV_CHANS; i++) {
+    fdl[i]=(fftw_complex*)fftw_malloc(parts*bins*sizeof(fftw_complex));
+    window[i]=(double*)fftw_malloc(fftLen*sizeof(double));
+  }
+  planF=divPlanR2C(fftLen,timeBuf,spec);
+  planI=divPlanC2R(fftLen,spec,timeBuf);
+
+  // transform each partition (normalization is folded in here)
+  double norm=1.0/(double)fftLen;
+  for (int p=0; p<parts; p++) {
+    memset(timeBuf,0,fftLen*sizeof(double));
+    for (int i=0; i<block; i++) {
+      size_t pos=(size_t)p*block+i;
+      if (pos>=len) break;
+      timeBuf[i]=ir[pos]*norm;
+    }
+    fftw_execute(planF);
+    memcpy(&irSpec[p*bins],spec,bins*sizeof(fftw_complex));
+  }
+
+  clear();
+  return true;
+}
+
+void DivConvolutionStage::process(float** in, float** out) {
+  if (parts==0) return;
+  for (int c=0; c<DIV_CONV_CHANS; c++) {
+    // slide the input window and transform it
+    double* w=window[c];
+    memmove(w,&w[block],block*sizeof(double));
+    for (int i=0; i<block; i++) {
+      w[block+i]=in[c][i];
+    }
+    memcpy(timeBuf,w,fftLen*sizeof(double));
+    fftw_execute(planF);
+    memcpy(&fdl[c][fdlPos*bins],spec,bins*sizeof(fftw_complex));
+
+    // multiply-accumulate every partition with the matching past input
+    memset(acc,0,bins*sizeof(fftw_complex));
+    int slot=fdlPos;
+    for (int p=0; p<parts; p++) {
+      const fftw_complex* x=&fdl[c][slot*bins];
+      const fftw_complex* h=&irSpec[p*bins];
+      for (int k=0; k<bins; k++) {
+        acc[k][0]+=x[k][0]*h[k][0]-x[k][1]*h[k][1];
+        acc[k][1]+=x[k][0]*h[k][1]+x[k][1]*h[k][0];
+      }
+      if (--slot<0) slot=parts-1;
+    }
+
+    // back to time domain (the second half is valid)
+    memcpy(spec,acc,bins*sizeof(fftw_complex));
+    fftw_execute(planI);
+    for (int i=0; i<block; i++) {
+      out[c][i]+=timeBuf[block+i];
+    }
+  }
+  if (++fdlPos>=parts) fdlPos=0;
+}
+
+void DivConvolutionStage::skip(size_t count) {
+  if (parts==0) return;
+  // after this many blocks of silence nothing is left
+  if (count>=(size_t)MAX(parts,2)) {
+    clear();
+    return;
+  }
+  for (size_t n=0; n<count; n++) {
+    for (int c=0; c<DIV_CONV_CHANS; c++) {
+      double* w=window[c];
+      memmove(w,&w[block],block*sizeof(double));
+      memset(&w[block],0,block*sizeof(double));
+      memset(&fdl[c][fdlPos*bins],0,bins*sizeof(fftw_complex));
+    }
+    if (++fdlPos>=parts) fdlPos=0;
+  }
+}
+
+void DivConvolutionStage::clear() {
+  if (parts==0) return;
+  for (int i=0; i<DIV_CONV_CHANS; i++) {
+    memset(fdl[i],0,parts*bins*sizeof(fftw_complex));
+    memset(window[i],0,fftLen*sizeof(double));
+  }
+  fdlPos=0;
+}
+
+void DivConvolutionStage::quit() {
+  if (planF!=NULL) {
+    divDestroyPlan(planF);
+    planF=NULL;
+  }
+  if (planI!=NULL) {
+    divDestroyPlan(planI);
+    planI=NULL;
+  }
+  if (timeBuf!=NULL) {
+    fftw_free(timeBuf);
+    timeBuf=NULL;
+  }
+  if (spec!=NULL) {
+    fftw_free(spec);
+    spec=NULL;
+  }
+  if (acc!=NULL) {
+    fftw_free(acc);
+    acc=NULL;
+  }
+  if (irSpec!=NULL) {
+    fftw_free(irSpec);
+    irSpec=NULL;
+  }
+  for (int i=0; i<DIV_CONV_CHANS; i++) {
+    if (fdl[i]!=NULL) {
+      fftw_free(fdl[i]);
+      fdl[i]=NULL;
+    }
+    if (window[i]!=NULL) {
+      fftw_free(window[i]);
+      window[i]=NULL;
+    }
+  }
+  parts=0;
+}
+
+DivConvolutionStage::~DivConvolutionStage() {
+  quit();
+}
+
+// effect
+
+static void _runTail(void* d) {
+  ((DivEffectConvolution*)d)->runTail();
+}
+
+bool DivEffectConvolution::anyQueued() {
+  for (int i=0; i<DIV_CONV_TAIL_SLOTS; i++) {
+    if (tailSlots[i].state.load(std::memory_order_acquire)==DIV_CONV_SLOT_QUEUED) return true;
+  }
+  return false;
+}
+
+void DivEffectConvolution::runTail() {
+  // the response the tail stage was last run with, and the block expected next
+  DivConvolutionIR* ir=NULL;
+  uint64_t next=0;
+  std::vector<DivConvolutionIR*> toFree;
+
+  while (!tailQuit.load()) {
+    // collect replaced responses, and free those no queued block refers to
+    unsigned int r=retiredRead.load(std::memory_order_relaxed);
+    while (r!=retiredWrite.load(std::memory_order_acquire)) {
+      toFree.push_back(retired[r%DIV_CONV_RETIRED]);
+      retiredRead.store(++r,std::memory_order_release);
+    }
+    for (size_t i=0; i<toFree.size(); i++) {
+      bool used=false;
+      for (int j=0; j<DIV_CONV_TAIL_SLOTS; j++) {
+        DivConvolutionTailSlot& s=tailSlots[j];
+        if (s.state.load(std::memory_order_acquire)==DIV_CONV_SLOT_QUEUED && s.ir==toFree[i]) {
+          used=true;
+          break;
+        }
+      }
+      if (used) continue;
+      if (ir==toFree[i]) ir=NULL;
+      delete toFree[i];
+      toFree.erase(toFree.begin()+i);
+      i--;
+    }
+
+    // take the oldest queued block
+    DivConvolutionTailSlot* job=NULL;
+    for (int i=0; i<DIV_CONV_TAIL_SLOTS; i++) {
+      DivConvolutionTailSlot& s=tailSlots[i];
+      if (s.state.load(std::memory_order_acquire)!=DIV_CONV_SLOT_QUEUED) continue;
+      if (job==NULL || s.index<job->index) job=&s;
+    }
+    if (job==NULL) {
+      // acquire() doesn't lock when queueing, so a wake-up may be missed
+      std::unique_lock<std::mutex> lock(tailLock);
+      tailCV.wait_for(lock,std::chrono::milliseconds(2),[this]() {
+        return tailQuit.load() || anyQueued();
+      });
+      continue;
+    }
+
+    if (job->ir!=ir || job->clear) {
+      ir=job->ir;
+      ir->tail.clear();
+    } else if (job->index>next) {
+      // blocks which could not be queued are silence
+      ir->tail.skip(job->index-next);
+    }
+    for (int i=0; i<DIV_CONV_CHANS; i++) {
+      memset(job->out[i],0,DIV_CONV_TAIL_BLOCK*sizeof(float));
+    }
+    ir->tail.process(job->in,job->out);
+    next=job->index+1;
+
+    job->state.store(DIV_CONV_SLOT_DONE,std::memory_order_release);
+    {
+      // so that waitTail() can't miss this
+      std::lock_guard<std::mutex> lock(tailLock);
+    }
+    doneCV.notify_all();
+  }
+
+  unsigned int r=retiredRead.load(std::memory_order_relaxed);
+  while (r!=retiredWrite.load(std::memory_order_acquire)) {
+    toFree.push_back(retired[r%DIV_CONV_RETIRED]);
+    retiredRead.store(++r,std::memory_order_release);
+  }
+  for (DivConvolutionIR* i: toFree) {
+    delete i;
+  }
+}
+
+void DivEffectConvolution::waitTail(uint64_t index) {
+  DivConvolutionTailSlot& s=tailSlots[index%DIV_CONV_TAIL_SLOTS];
+  std::unique_lock<std::mutex> lock(tailLock);
+  doneCV.wait(lock,[&s,index]() {
+    return s.state.load(std::memory_order_acquire)!=DIV_CONV_SLOT_QUEUED || s.index!=index;
+  });
+}
+
+void DivEffectConvolution::processBlock(bool wait) {
+  float* in[DIV_CONV_CHANS];
+  float* out[DIV_CONV_CHANS];
+  for (int i=0; i<DIV_CONV_CHANS; i++) {
+    in[i]=inBuf[i];
+    out[i]=outBuf[i];
+    memset(outBuf[i],0,DIV_CONV_BLOCK*sizeof(float));
+  }
+
+  // head
+  cur->head.process(in,out);
+
+  if (!cur->hasTail) return;
+
+  // tail (output of the tail block before last)
+  for (int i=0; i<DIV_CONV_CHANS; i++) {
+    const float* t=&tailOut[i][tailPos];
+    for (int j=0; j<DIV_CONV_BLOCK; j++) {
+      outBuf[i][j]+=t[j];
+    }
+    memcpy(&tailAcc[i][tailPos],inBuf[i],DIV_CONV_BLOCK*sizeof(float));
+  }
+  tailPos+=DIV_CONV_BLOCK;
+  if (tailPos<DIV_CONV_TAIL_BLOCK) return;
+  tailPos=0;
+
+  const uint64_t n=tailBlock++;
+
+  // collect the result of block n-1, which plays next.
+  // one that is a block late is still mixed in. older ones are dropped.
+  if (wait && n>0) waitTail(n-1);
+  for (int i=0; i<DIV_CONV_CHANS; i++) {
+    memset(tailOut[i],0,DIV_CONV_TAIL_BLOCK*sizeof(float));
+  }
+  for (int i=0; i<DIV_CONV_TAIL_SLOTS; i++) {
+    DivConvolutionTailSlot& s=tailSlots[i];
+    if (s.state.load(std::memory_order_acquire)!=DIV_CONV_SLOT_DONE) continue;
+    if (s.index>=tailFirst && s.index+2>=n) {
+      for (int j=0; j<DIV_CONV_CHANS; j++) {
+        for (int k=0; k<DIV_CONV_TAIL_BLOCK; k++) {
+          tailOut[j][k]+=s.out[j][k];
+        }
+      }
+    }
+    s.state.store(DIV_CONV_SLOT_EMPTY,std::memory_order_relaxed);
+  }
+
+  // hand over block n (if the tail thread is too far behind, it is skipped)
+  DivConvolutionTailSlot& s=tailSlots[n%DIV_CONV_TAIL_SLOTS];
+  if (wait && s.state.load(std::memory_order_acquire)==DIV_CONV_SLOT_QUEUED) waitTail(s.index);
+  if (s.state.load(std::memory_order_acquire)==DIV_CONV_SLOT_DONE) {
+    // finished after the loop above, and too late anyway
+    s.state.store(DIV_CONV_SLOT_EMPTY,std::memory_order_relaxed);
+  }
+  if (s.state.load(std::memory_order_acquire)==DIV_CONV_SLOT_EMPTY) {
+    for (int i=0; i<DIV_CONV_CHANS; i++) {
+      memcpy(s.in[i],tailAcc[i],DIV_CONV_TAIL_BLOCK*sizeof(float));
+    }
+    s.ir=cur;
+    s.index=n;
+    s.clear=tailClear;
+    tailClear=false;
+    s.state.store(DIV_CONV_SLOT_QUEUED,std::memory_order_release);
+    if (wait) {
+      std::lock_guard<std::mutex> lock(tailLock);
+    }
+    tailCV.notify_one();
+  }
+}
+
+void DivEffectConvolution::clearState() {
+  cur->head.clear();
+  for (int i=0; i<DIV_CONV_CHANS; i++) {
+    memset(inBuf[i],0,DIV_CONV_BLOCK*sizeof(float));
+    memset(outBuf[i],0,DIV_CONV_BLOCK*sizeof(float));
+    if (tailAcc[i]!=NULL) {
+      memset(tailAcc[i],0,DIV_CONV_TAIL_BLOCK*sizeof(float));
+      memset(tailOut[i],0,DIV_CONV_TAIL_BLOCK*sizeof(float));
+    }
+  }
+  blockPos=0;
+  tailPos=0;
+  // results still in flight belong to the previous state
+  tailFirst=tailBlock;
+  tailClear=true;
+}
+
+void DivEffectConvolution::setImpulse(const float* ir, size_t len) {
+  // prepare the new response (this is the slow part)
+  DivConvolutionIR* next=new DivConvolutionIR;
+  size_t headLen=MIN(len,(size_t)DIV_CONV_TAIL_BLOCK*2);
+  next->head.init(ir,headLen,DIV_CONV_BLOCK);
+  if (len>headLen && tailThread!=NULL) {
+    next->hasTail=next->tail.init(&ir[headLen],len-headLen,DIV_CONV_TAIL_BLOCK);
+  }
+  logV("convolution: %d samples (%s)",(int)len,next->hasTail?"head and tail":"head only");
+
+  // then hand it to acquire(). one it didn't take yet is never used
+  DivConvolutionIR* prev=pendingIR.exchange(next);
+  if (prev!=NULL) delete prev;
+}
+
+void DivEffectConvolution::setOffline(bool enable) {
+  offline=enable;
+}
+
+void DivEffectConvolution::loadImpulse() {
+  std::vector<float> ir;
+  sampleRev=0;
+  if (parent!=NULL && sampleIndex>=0 && sampleIndex<parent->song.sampleLen) {
+    DivSample* s=parent->song.sample[sampleIndex];
+    sampleRev=s->renderRev;
+    float vol=pow(10.0f,gain/20.0f);
+    if (s->depth==DIV_SAMPLE_DEPTH_16BIT && s->data16!=NULL) {
+      ir.reserve(s->samples);
+      for (unsigned int i=0; i<s->samples; i++) {
+        ir.push_back(vol*(float)s->data16[i]/32768.0f);
+      }
+    } else if (s->depth==DIV_SAMPLE_DEPTH_8BIT && s->data8!=NULL) {
+      ir.reserve(s->samples);
+      for (unsigned int i=0; i<s->samples; i++) {
+        ir.push_back(vol*(float)s->data8[i]/128.0f);
+      }
+    } else {
+      logW("convolution: sample %d is not 8-bit or 16-bit!",sampleIndex);
+    }
+  }
+  setImpulse(ir.empty()?NULL:ir.data(),ir.size());
+}
+
+void DivEffectConvolution::acquire(float** in, float** out, size_t len) {
+  // take a new impulse response. the previous one goes to the tail thread,
+  // which frees it (if its queue is full, this waits for the next call)
+  if (pendingIR.load(std::memory_order_relaxed)!=NULL && tailThread!=NULL) {
+    unsigned int w=retiredWrite.load(std::memory_order_relaxed);
+    if (w-retiredRead.load(std::memory_order_acquire)<DIV_CONV_RETIRED) {
+      DivConvolutionIR* next=pendingIR.exchange(NULL);
+      if (next!=NULL) {
+        retired[w%DIV_CONV_RETIRED]=cur;
+        retiredWrite.store(w+1,std::memory_order_release);
+        cur=next;
+        resetPending=true;
+      }
+    }
+  }
+  if (resetPending.load(std::memory_order_relaxed)) {
+    resetPending=false;
+    clearState();
+  }
+
+  // rendering faster than real time: wait for the tail thread
+  const bool wait=offline || (parent!=NULL && parent->isExporting());
+
+  for (size_t i=0; i<len; i++) {
+    for (int j=0; j<DIV_CONV_CHANS; j++) {
+      inBuf[j][blockPos]=in[j][i];
+      out[j][i]=outBuf[j][blockPos];
+    }
+    if (++blockPos>=DIV_CONV_BLOCK) {
+      blockPos=0;
+      processBlock(wait);
+    }
+  }
+}
+
+void DivEffectConvolution::reset() {
+  // done by acquire(), which owns the state
+  resetPending=true;
+}
+
+void DivEffectConvolution::notifySampleChange() {
+  if (parent==NULL || sampleIndex<0 || sampleIndex>=parent->song.sampleLen) return;
+  if (parent->song.sample[sampleIndex]->renderRev!=sampleRev) {
+    loadImpulse();
+  }
+}
+
+void DivEffectConvolution::notifySampleExchange(int one, int two) {
+  if (sampleIndex==one) {
+    sampleIndex=two;
+  } else if (sampleIndex==two) {
+    sampleIndex=one;
+  }
+}
+
+void DivEffectConvolution::notifySampleDeletion(int index) {
+  if (sampleIndex==index) {
+    sampleIndex=-1;
+    loadImpulse();
+  } else if (sampleIndex>index) {
+    sampleIndex--;
+  }
+}
+
+int DivEffectConvolution::getInputCount() {
+  return DIV_CONV_CHANS;
+}
+
+int DivEffectConvolution::getOutputCount() {
+  return DIV_CONV_CHANS;
+}
+
+String DivEffectConvolution::getParam(size_t param) {
+  switch (param) {
+    case 0:
+      return fmt::sprintf("%d",sampleIndex);
+    case 1:
+      return fmt::sprintf("%g",gain);
+  }
+  throw std::out_of_range("param");
+}
+
+bool DivEffectConvolution::setParam(size_t param, String value) {
+  try {
+    switch (param) {
+      case 0:
+        sampleIndex=std::stoi(value);
+        break;
+      case 1:
+        gain=std::stof(value);
+        break;
+      default:
+        return false;
+    }
+  } catch (std::exception&) {
+    return false;
+  }
+  loadImpulse();
+  return true;
+}
+
+const char* DivEffectConvolution::getParams() {
+  return
+    "0:i:Sample:impulse response\n"
+    "1:f:Gain:in dB";
+}
+
+size_t DivEffectConvolution::getParamCount() {
+  return 2;
+}
+
+bool DivEffectConvolution::load(unsigned short version, const unsigned char* data, size_t len) {
+  if (data==NULL || len<8) return true;
+  int s;
+  float g;
+  memcpy(&s,data,4);
+  memcpy(&g,data+4,4);
+  sampleIndex=s;
+  gain=g;
+  return true;
+}
+
+unsigned char* DivEffectConvolution::save(unsigned short* version, size_t* len) {
+  unsigned char* ret=new unsigned char[8];
+  memcpy(ret,&sampleIndex,4);
+  memcpy(ret+4,&gain,4);
+  *version=1;
+  *len=8;
+  return ret;
+}
+
+bool DivEffectConvolution::init(DivEngine* p, double rate, unsigned short version, const unsigned char* data, size_t len) {
+  parent=p;
+  if (!load(version,data,len)) return false;
+  // the tail thread is started here so that setImpulse() never has to
+  if (tailThread==NULL) {
+    for (int i=0; i<DIV_CONV_CHANS; i++) {
+      tailAcc[i]=new float[DIV_CONV_TAIL_BLOCK];
+      tailOut[i]=new float[DIV_CONV_TAIL_BLOCK];
+      memset(tailAcc[i],0,DIV_CONV_TAIL_BLOCK*sizeof(float));
+      memset(tailOut[i],0,DIV_CONV_TAIL_BLOCK*sizeof(float));
+      for (int j=0; j<DIV_CONV_TAIL_SLOTS; j++) {
+        tailSlots[j].in[i]=new float[DIV_CONV_TAIL_BLOCK];
+        tailSlots[j].out[i]=new float[DIV_CONV_TAIL_BLOCK];
+      }
+    }
+    for (int i=0; i<DIV_CONV_TAIL_SLOTS; i++) {
+      tailSlots[i].state=DIV_CONV_SLOT_EMPTY;
+    }
+    tailQuit=false;
+    tailThread=new std::thread(_runTail,this);
+  }
+  loadImpulse();
+  return true;
+}
+
+void DivEffectConvolution::quit() {
+  if (tailThread!=NULL) {
+    tailQuit=true;
+    {
+      std::lock_guard<std::mutex> lock(tailLock);
+    }
+    tailCV.notify_all();
+    tailThread->join();
+    delete tailThread;
+    tailThread=NULL;
+  }
+  DivConvolutionIR* pending=pendingIR.exchange(NULL);
+  if (pending!=NULL) delete pending;
+  cur->head.quit();
+  cur->tail.quit();
+  cur->hasTail=false;
+  for (int i=0; i<DIV_CONV_CHANS; i++) {
+    if (tailAcc[i]!=NULL) delete[] tailAcc[i];
+    if (tailOut[i]!=NULL) delete[] tailOut[i];
+    tailAcc[i]=NULL;
+    tailOut[i]=NULL;
+    for (int j=0; j<DIV_CONV_TAIL_SLOTS; j++) {
+      DivConvolutionTailSlot& s=tailSlots[j];
+      if (s.in[i]!=NULL) delete[] s.in[i];
+      if (s.out[i]!=NULL) delete[] s.out[i];
+      s.in[i]=NULL;
+      s.out[i]=NULL;
+    }
+  }
+  for (int i=0; i<DIV_CONV_TAIL_SLOTS; i++) {
+    tailSlots[i].ir=NULL;
+    tailSlots[i].state=DIV_CONV_SLOT_EMPTY;
+  }
+}
+
+DivEffectConvolution::DivEffectConvolution():
+  cur(new DivConvolutionIR),
+  pendingIR(NULL),
+  resetPending(false),
+  offline(false),
+  sampleIndex(-1),
+  sampleRev(0),
+  gain(0.0f),
+  blockPos(0),
+  tailPos(0),
+  tailBlock(0),
+  tailFirst(0),
+  tailClear(true),
+  retiredWrite(0),
+  retiredRead(0),
+  tailThread(NULL),
+  tailQuit(false) {
+  parent=NULL;
+  for (int i=0; i<DIV_CONV_CHANS; i++) {
+    tailAcc[i]=NULL;
+    tailOut[i]=NULL;
+  }
+  for (int i=0; i<DIV_CONV_RETIRED; i++) {
+    retired[i]=NULL;
+  }
+  memset(inBuf,0,sizeof(inBuf));
+  memset(outBuf,0,sizeof(outBuf));
+}
+
+DivEffectConvolution::~DivEffectConvolution() {
+  quit();
+  delete cur;
+}
@@ -0,0 +1,234 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _EFFECT_CONVOLUTION_H
+#define _EFFECT_CONVOLUTION_H
+
+#include "../effect.h"
+#include <fftw3.h>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+// head partition size (this is also the latency)
+#define DIV_CONV_BLOCK 128
+// tail partition size (must be a multiple of DIV_CONV_BLOCK)
+#define DIV_CONV_TAIL_BLOCK 2048
+#define DIV_CONV_CHANS 2
+// tail blocks which may be in flight (so the tail thread may fall behind)
+#define DIV_CONV_TAIL_SLOTS 4
+// replaced impulse responses waiting to be freed by the tail thread
+#define DIV_CONV_RETIRED 8
+
+/**
+ * one stage of uniformly partitioned overlap-save convolution.
+ */
+class DivConvolutionStage {
+  int block, fftLen, bins, parts, fdlPos;
+  double* timeBuf;
+  fftw_complex* spec;
+  fftw_complex* acc;
+  // impulse response spectrum, one per partition
+  fftw_complex* irSpec;
+  // frequency-domain delay line, one spectrum per partition
+  fftw_complex* fdl[DIV_CONV_CHANS];
+  // last two blocks of input
+  double* window[DIV_CONV_CHANS];
+  fftw_plan planF, planI;
+
+  public:
+    /**
+     * prepare the stage for an impulse response segment.
+     * @param ir the segment. may be NULL if len is 0.
+     * @param len segment length.
+     * @param blockLen partition size.
+     * @return whether the stage is active (len>0).
+     */
+    bool init(const float* ir, size_t len, int blockLen);
+
+    /**
+     * convolve one block (blockLen samples per channel) and add the result to out.
+     */
+    void process(float** in, float** out);
+
+    /**
+     * advance by count blocks of silence without producing output.
+     */
+    void skip(size_t count);
+
+    void clear();
+    void quit();
+
+    DivConvolutionStage():
+      block(0),
+      fftLen(0),
+      bins(0),
+      parts(0),
+      fdlPos(0),
+      timeBuf(NULL),
+      spec(NULL),
+      acc(NULL),
+      irSpec(NULL),
+      planF(NULL),
+      planI(NULL) {
+      for (int i=0; i<DIV_CONV_CHANS; i++) {
+        fdl[i]=NULL;
+        window[i]=NULL;
+      }
+    }
+    ~DivConvolutionStage();
+};
+
+/**
+ * a prepared impulse response.
+ */
+struct DivConvolutionIR {
+  DivConvolutionStage head, tail;
+  bool hasTail;
+
+  DivConvolutionIR():
+    hasTail(false) {}
+};
+
+enum DivConvolutionSlotState {
+  DIV_CONV_SLOT_EMPTY=0,
+  DIV_CONV_SLOT_QUEUED,
+  DIV_CONV_SLOT_DONE
+};
+
+/**
+ * a block of tail input and its result.
+ * the audio thread owns a slot unless it is queued, in which case the tail
+ * thread does.
+ */
+struct DivConvolutionTailSlot {
+  float* in[DIV_CONV_CHANS];
+  float* out[DIV_CONV_CHANS];
+  DivConvolutionIR* ir;
+  uint64_t index;
+  // clear the tail stage before processing this block
+  bool clear;
+  std::atomic<int> state;
+
+  DivConvolutionTailSlot():
+    ir(NULL),
+    index(0),
+    clear(false),
+    state(DIV_CONV_SLOT_EMPTY) {
+    for (int i=0; i<DIV_CONV_CHANS; i++) {
+      in[i]=NULL;
+      out[i]=NULL;
+    }
+  }
+};
+
+/**
+ * convolution reverb.
+ * the first 2*DIV_CONV_TAIL_BLOCK samples of the impulse response are
+ * processed in small partitions within acquire(), and the rest in large
+ * partitions on a background thread, which has a full tail block of time
+ * to finish before its output is due.
+ * acquire() doesn't lock or wait. a late tail block is mixed one block later
+ * (or dropped if it is later than that). when the engine is exporting (or
+ * setOffline() was called) it waits for the tail, so that output does not
+ * depend on timing.
+ * a new impulse response is prepared by whoever sets it, and taken by
+ * acquire() through pendingIR. the one it replaces is freed by the tail
+ * thread once no queued block uses it.
+ */
+class DivEffectConvolution: public DivEffect {
+  // audio thread
+  DivConvolutionIR* cur;
+  std::atomic<DivConvolutionIR*> pendingIR;
+  std::atomic<bool> resetPending;
+  bool offline;
+
+  int sampleIndex;
+  // renderRev of the sample when it was loaded
+  uint64_t sampleRev;
+  float gain;
+
+  float inBuf[DIV_CONV_CHANS][DIV_CONV_BLOCK];
+  float outBuf[DIV_CONV_CHANS][DIV_CONV_BLOCK];
+  int blockPos;
+
+  // tail input being collected, and the tail output being played
+  float* tailAcc[DIV_CONV_CHANS];
+  float* tailOut[DIV_CONV_CHANS];
+  int tailPos;
+  // index of the tail block being collected, the first one whose result may
+  // be played (results from before a reset are not), and whether the next
+  // one should clear the tail stage
+  uint64_t tailBlock, tailFirst;
+  bool tailClear;
+
+  DivConvolutionTailSlot tailSlots[DIV_CONV_TAIL_SLOTS];
+
+  // single-producer single-consumer queue (audio thread to tail thread)
+  DivConvolutionIR* retired[DIV_CONV_RETIRED];
+  std::atomic<unsigned int> retiredWrite, retiredRead;
+
+  std::thread* tailThread;
+  std::mutex tailLock;
+  // the tail thread waits on tailCV, and offline rendering on doneCV
+  std::condition_variable tailCV, doneCV;
+  std::atomic<bool> tailQuit;
+
+  void processBlock(bool wait);
+  void waitTail(uint64_t index);
+  void clearState();
+  bool anyQueued();
+
+  public:
+    void runTail();
+
+    /**
+     * set the impulse response directly (used by the benchmark).
+     */
+    void setImpulse(const float* ir, size_t len);
+
+    /**
+     * always wait for the tail, even when the engine is not exporting (used
+     * by the benchmark).
+     */
+    void setOffline(bool enable);
+    void loadImpulse();
+
+    void acquire(float** in, float** out, size_t len);
+    void reset();
+    void notifySampleChange();
+    void notifySampleExchange(int one, int two);
+    void notifySampleDeletion(int index);
+    int getInputCount();
+    int getOutputCount();
+    String getParam(size_t param);
+    bool setParam(size_t param, String value);
+    const char* getParams();
+    size_t getParamCount();
+    bool load(unsigned short version, const unsigned char* data, size_t len);
+    unsigned char* save(unsigned short* version, size_t* len);
+    bool init(DivEngine* parent, double rate, unsigned short version, const unsigned char* data, size_t len);
+    void quit();
+
+    DivEffectConvolution();
+    ~DivEffectConvolution();
+};
+
+#endif
@@ -19,6 +19,7 @@
 
 #include "engine.h"
 #include "effect/dummy.h"
+#include "effect/convolution.h"
 
 void DivEffectContainer::preAcquire(size_t count) {
   if (!count) return;
@@ -68,6 +69,9 @@ void DivEffectContainer::acquire(size_t count) {
 
 bool DivEffectContainer::init(DivEffectType effectType, DivEngine* eng, double rate, unsigned short version, const unsigned char* data, size_t len) {
   switch (effectType) {
+    case DIV_EFFECT_CONVOLUTION:
+      effect=new DivEffectConvolution;
+      break;
     case DIV_EFFECT_DUMMY:
     default:
       effect=new DivEffectDummy;
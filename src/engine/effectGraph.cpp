@@ -0,0 +1,193 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "effectGraph.h"
+#include "effect.h"
+#include "../ta-log.h"
+#include <utility>
+
+static inline bool isEffectPortSet(unsigned short portSet) {
+  return portSet>=DIV_PORTSET_EFFECT && portSet<DIV_PORTSET_EFFECT+DIV_MAX_EFFECT_NODES;
+}
+
+void DivEffectGraph::allocArena(size_t len) {
+  if (arena!=NULL) {
+    delete[] arena;
+    arena=NULL;
+  }
+  arenaLen=len;
+
+  arenaBufs=0;
+  for (DivEffectGraphNode& i: nodes) {
+    arenaBufs+=i.inCount+i.outCount;
+  }
+  if (arenaBufs==0 || arenaLen==0) {
+    for (DivEffectGraphNode& i: nodes) {
+      memset(i.in,0,DIV_MAX_OUTPUTS*sizeof(float*));
+      memset(i.out,0,DIV_MAX_OUTPUTS*sizeof(float*));
+    }
+    return;
+  }
+
+  arena=new float[arenaBufs*arenaLen];
+  memset(arena,0,arenaBufs*arenaLen*sizeof(float));
+
+  float* next=arena;
+  for (DivEffectGraphNode& i: nodes) {
+    for (int j=0; j<i.inCount; j++) {
+      i.in[j]=next;
+      next+=arenaLen;
+    }
+    for (int j=0; j<i.outCount; j++) {
+      i.out[j]=next;
+      next+=arenaLen;
+    }
+  }
+}
+
+void DivEffectGraph::build(DivEngine* eng, const std::vector<unsigned int>& patchbay, const std::vector<DivEffect*>& effects, const std::vector<float>& dryWet, size_t bufLen) {
+  nodes.clear();
+  levelStart.clear();
+  outConns.clear();
+  memset(nodeOf,-1,DIV_MAX_EFFECT_NODES*sizeof(int));
+
+  size_t effectCount=MIN(effects.size(),(size_t)DIV_MAX_EFFECT_NODES);
+
+  // gather the inputs of every effect, and the edges between effects
+  std::vector<std::vector<unsigned int>> conns(effectCount);
+  std::vector<std::vector<int>> next(effectCount);
+  std::vector<int> pending(effectCount,0);
+  for (unsigned int i: patchbay) {
+    const unsigned short srcPortSet=i>>20;
+    const unsigned short destPortSet=(i>>4)&0xfff;
+
+    if (destPortSet==0x000) {
+      outConns.push_back(i);
+      continue;
+    }
+    if (!isEffectPortSet(destPortSet)) continue;
+    size_t dest=destPortSet-DIV_PORTSET_EFFECT;
+    if (dest>=effectCount) continue;
+    if (effects[dest]==NULL) continue;
+    conns[dest].push_back(i);
+
+    if (isEffectPortSet(srcPortSet)) {
+      size_t src=srcPortSet-DIV_PORTSET_EFFECT;
+      if (src>=effectCount) continue;
+      next[src].push_back(dest);
+      pending[dest]++;
+    }
+  }
+
+  // sort (Kahn's algorithm, one level at a time)
+  std::vector<int> cur, upcoming;
+  for (size_t i=0; i<effectCount; i++) {
+    if (effects[i]==NULL) continue;
+    if (pending[i]==0) cur.push_back(i);
+  }
+  int curLevel=0;
+  while (!cur.empty()) {
+    levelStart.push_back(nodes.size());
+    upcoming.clear();
+    for (int i: cur) {
+      DivEffectGraphNode node;
+      node.parent=eng;
+      node.effect=effects[i];
+      node.index=i;
+      node.level=curLevel;
+      node.inCount=MIN(MAX(0,node.effect->getInputCount()),DIV_MAX_OUTPUTS);
+      node.outCount=MIN(MAX(0,node.effect->getOutputCount()),DIV_MAX_OUTPUTS);
+      node.dryWet=(i<(int)dryWet.size())?dryWet[i]:1.0f;
+      node.conns=conns[i];
+      nodeOf[i]=nodes.size();
+      nodes.push_back(node);
+
+      for (int j: next[i]) {
+        if (--pending[j]==0) upcoming.push_back(j);
+      }
+    }
+    cur.swap(upcoming);
+    curLevel++;
+  }
+  levelStart.push_back(nodes.size());
+
+  // anything left is part of a feedback loop
+  for (size_t i=0; i<effectCount; i++) {
+    if (effects[i]==NULL) continue;
+    if (nodeOf[i]<0) {
+      logW("effect %d is in a feedback loop! it won't be processed.",(int)i);
+    }
+  }
+
+  allocArena(bufLen);
+  logV("effect graph: %d nodes in %d levels, %d output connections",(int)nodes.size(),curLevel,(int)outConns.size());
+}
+
+void DivEffectGraph::reserve(size_t len) {
+  if (len<=arenaLen) return;
+  allocArena(len);
+}
+
+void DivEffectGraph::setRate(double r) {
+  if (r==rate) return;
+  rate=r;
+  for (DivEffectGraphNode& i: nodes) {
+    i.effect->rateChanged(rate);
+  }
+}
+
+float* DivEffectGraph::getOutput(unsigned short port) {
+  const unsigned short portSet=port>>4;
+  const unsigned char subPort=port&15;
+  if (!isEffectPortSet(portSet)) return NULL;
+  int node=nodeOf[portSet-DIV_PORTSET_EFFECT];
+  if (node<0) return NULL;
+  if (subPort>=nodes[node].outCount) return NULL;
+  return nodes[node].out[subPort];
+}
+
+void DivEffectGraph::swap(DivEffectGraph& other) {
+  std::swap(rate,other.rate);
+  std::swap(arena,other.arena);
+  std::swap(arenaBufs,other.arenaBufs);
+  std::swap(arenaLen,other.arenaLen);
+  nodes.swap(other.nodes);
+  levelStart.swap(other.levelStart);
+  outConns.swap(other.outConns);
+  for (int i=0; i<DIV_MAX_EFFECT_NODES; i++) {
+    std::swap(nodeOf[i],other.nodeOf[i]);
+  }
+}
+
+void DivEffectGraph::clear() {
+  nodes.clear();
+  levelStart.clear();
+  outConns.clear();
+  memset(nodeOf,-1,DIV_MAX_EFFECT_NODES*sizeof(int));
+  if (arena!=NULL) {
+    delete[] arena;
+    arena=NULL;
+  }
+  arenaBufs=0;
+  arenaLen=0;
+}
+
+DivEffectGraph::~DivEffectGraph() {
+  clear();
+}
@@ -0,0 +1,135 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _EFFECT_GRAPH_H
+#define _EFFECT_GRAPH_H
+
+#include <vector>
+#include <string.h>
+#include "defines.h"
+
+class DivEngine;
+class DivEffect;
+
+// effect N occupies portset DIV_PORTSET_EFFECT+N (inputs and outputs)
+#define DIV_PORTSET_EFFECT 0x800
+#define DIV_MAX_EFFECT_NODES 256
+
+struct DivEffectGraphNode {
+  DivEngine* parent;
+  DivEffect* effect;
+  // index in song.effects
+  int index;
+  // longest path from a chip (nodes on the same level don't depend on each other)
+  int level;
+  int inCount, outCount;
+  float dryWet;
+  // patchbay connections feeding this node
+  std::vector<unsigned int> conns;
+  // buffers in the arena
+  float* in[DIV_MAX_OUTPUTS];
+  float* out[DIV_MAX_OUTPUTS];
+  // length of the current run
+  size_t len;
+
+  DivEffectGraphNode():
+    parent(NULL),
+    effect(NULL),
+    index(-1),
+    level(0),
+    inCount(0),
+    outCount(0),
+    dryWet(1.0f),
+    len(0) {
+    memset(in,0,DIV_MAX_OUTPUTS*sizeof(float*));
+    memset(out,0,DIV_MAX_OUTPUTS*sizeof(float*));
+  }
+};
+
+/**
+ * the patchbay, compiled into a processing graph.
+ * chips and internal sources feed effect nodes, which feed other nodes or the
+ * system outputs.
+ * nodes are kept in topological order and grouped into levels, so that every
+ * node of a level may run in parallel.
+ * all node buffers live in a single arena which is only reallocated when the
+ * graph changes or the buffer size grows.
+ * graphs are built away from the audio thread and swapped in while the
+ * engine is locked.
+ */
+class DivEffectGraph {
+  double rate;
+
+  float* arena;
+  size_t arenaBufs, arenaLen;
+
+  void allocArena(size_t len);
+
+  public:
+    std::vector<DivEffectGraphNode> nodes;
+    // nodes[levelStart[i]] to nodes[levelStart[i+1]-1] make up level i
+    std::vector<size_t> levelStart;
+    // connections to the system outputs
+    std::vector<unsigned int> outConns;
+    // node index by effect index (-1 if the effect was left out)
+    int nodeOf[DIV_MAX_EFFECT_NODES];
+
+    /**
+     * rebuild the graph. effects in a feedback loop are left out.
+     * @param effects effect instances, by effect index.
+     * @param dryWet dry/wet ratio of each effect.
+     * @param bufLen initial buffer length.
+     */
+    void build(DivEngine* eng, const std::vector<unsigned int>& patchbay, const std::vector<DivEffect*>& effects, const std::vector<float>& dryWet, size_t bufLen);
+
+    /**
+     * make sure node buffers can hold len samples.
+     */
+    void reserve(size_t len);
+
+    /**
+     * notify effects of a sample rate change if necessary.
+     */
+    void setRate(double r);
+
+    /**
+     * get an output buffer of a node.
+     * @param port source port (in the effect portset range).
+     * @return the buffer, or NULL if not available.
+     */
+    float* getOutput(unsigned short port);
+
+    /**
+     * exchange this graph with another one (doesn't allocate).
+     */
+    void swap(DivEffectGraph& other);
+
+    void clear();
+
+    DivEffectGraph():
+      rate(0.0),
+      arena(NULL),
+      arenaBufs(0),
+      arenaLen(0) {
+      memset(nodeOf,-1,DIV_MAX_EFFECT_NODES*sizeof(int));
+    }
+    ~DivEffectGraph();
+};
+
+#endif
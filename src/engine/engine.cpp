@@ -24,6 +24,7 @@
 #include "instrument.h"
 #include "safeReader.h"
 #include "workPool.h"
+#include "allocTracker.h"
 #include "../ta-log.h"
 #include "../fileutils.h"
 #ifdef HAVE_SDL2
@@ -40,12 +41,16 @@
 #include "../audio/asio.h"
 #endif
 #include "../audio/pipe.h"
+#ifdef HAVE_SOCKET_AUDIO
+#include "../audio/socket.h"
+#endif
 #include <math.h>
 #include <float.h>
 #include <fmt/printf.h>
 #include <chrono>
 
 void process(void* u, float** in, float** out, int inChans, int outChans, unsigned int size) {
+  if (((DivEngine*)u)->pullRenderAhead(out,outChans,size)) return;
   ((DivEngine*)u)->nextBuf(in,out,inChans,outChans,size);
 }
 
@@ -215,26 +220,62 @@ double DivEngine::benchmarkPlayback() {
   float* outBuf[2];
   outBuf[0]=new float[EXPORT_BUFSIZE];
   outBuf[1]=new float[EXPORT_BUFSIZE];
+  prepareAudioBuffers(EXPORT_BUFSIZE);
 
-  curOrder=0;
-  prevOrder=0;
-  remainingLoops=1;
-  playSub(false);
+  auto runOnce=[this,&outBuf]() -> double {
+    curOrder=0;
+    prevOrder=0;
+    remainingLoops=1;
+    playSub(false);
+    resetPerf();
 
-  std::chrono::high_resolution_clock::time_point timeStart=std::chrono::high_resolution_clock::now();
+    std::chrono::high_resolution_clock::time_point timeStart=std::chrono::high_resolution_clock::now();
 
-  // benchmark
-  while (playing) {
-    nextBuf(NULL,outBuf,0,2,EXPORT_BUFSIZE);
+    // benchmark
+    while (playing) {
+      nextBuf(NULL,outBuf,0,2,EXPORT_BUFSIZE);
+    }
+
+    std::chrono::high_resolution_clock::time_point timeEnd=std::chrono::high_resolution_clock::now();
+    return (double)(std::chrono::duration_cast<std::chrono::microseconds>(timeEnd-timeStart).count())/1000000.0;
+  };
+
+  bool anyNative=false;
+  for (int i=0; i<song.systemLen; i++) {
+    if (disCont[i].nativeRatio>0) {
+      logI("%d: %s: native rate path (1:%d)",i,getSystemName(song.system[i]),disCont[i].nativeRatio);
+      anyNative=true;
+    }
   }
 
-  std::chrono::high_resolution_clock::time_point timeEnd=std::chrono::high_resolution_clock::now();
+  double t=runOnce();
+  printPerfStats();
+  printf("[RESULT] %fs\n",t);
+
+  // run again with blip_buf on every chip to see what the native path saves
+  if (anyNative) {
+    double fillNative[DIV_MAX_CHIPS];
+    for (int i=0; i<song.systemLen; i++) {
+      fillNative[i]=(disCont[i].nativeRatio>0)?((double)disCont[i].perfFillBuf.total.load()/1000000.0):-1.0;
+      disCont[i].setResampler(DIV_RESAMPLER_BLIP);
+      disCont[i].setRates(got.rate);
+    }
+    double tBlip=runOnce();
+    for (int i=0; i<song.systemLen; i++) {
+      if (fillNative[i]<0.0) continue;
+      double fillBlip=(double)disCont[i].perfFillBuf.total.load()/1000000.0;
+      printf("%d: %s fillBuf: %.3fms native, %.3fms blip_buf\n",i,getSystemName(song.system[i]),fillNative[i],fillBlip);
+    }
+    for (int i=0; i<song.systemLen; i++) {
+      disCont[i].setResampler(song.systemFlags[i].getInt("resampler",DIV_RESAMPLER_AUTO));
+      disCont[i].setRates(got.rate);
+    }
+    printf("[RESULT] %fs with blip_buf only (%.2fx)\n",tBlip,(t>0.0)?(tBlip/t):0.0);
+  }
 
   delete[] outBuf[0];
   delete[] outBuf[1];
 
-  double t=(double)(std::chrono::duration_cast<std::chrono::microseconds>(timeEnd-timeStart).count())/1000000.0;
-  printf("[RESULT] %fs\n",t);
   return t;
 }
 
@@ -420,8 +461,13 @@ void DivEngine::renderSamples(int whichSample) {
       song.sample[i]->render(formatMask);
     }
   } else if (whichSample>=0 && whichSample<song.sampleLen) {
+    song.sample[whichSample]->editRev++;
     song.sample[whichSample]->render(formatMask);
   }
+  // effects which use sample data pick up changes here
+  for (DivEffectContainer& i: effectInst) {
+    if (i.effect!=NULL) i.effect->notifySampleChange();
+  }
 
   // step 2: render samples to dispatch
   for (int i=0; i<song.systemLen; i++) {
@@ -995,7 +1041,7 @@ void DivEngine::delUnusedSamples() {
   }
 
   // render
-  renderSamples();
+  renderSamples(-2);
 
   delete[] isUsed;
 
@@ -1155,6 +1201,7 @@ bool DivEngine::addSystem(DivSystem which) {
       }
     }
   }
+  recalcPatchbay();
   saveLock.unlock();
   renderSamples();
   reset();
@@ -1210,6 +1257,7 @@ bool DivEngine::duplicateSystem(int index, bool pat, bool end) {
       }
     }
   }
+  recalcPatchbay();
 
   // duplicate patterns
   if (pat) {
@@ -1482,6 +1530,95 @@ bool DivEngine::swapSystem(int src, int dest, bool preserveOrder) {
   return true;
 }
 
+bool DivEngine::addEffect(DivEffectType which) {
+  if (song.effects.size()>=DIV_MAX_EFFECT_NODES) {
+    lastError=fmt::sprintf(_("max number of effects is %d"),DIV_MAX_EFFECT_NODES);
+    return false;
+  }
+  BUSY_BEGIN;
+  saveLock.lock();
+  DivEffectStorage storage;
+  storage.id=which;
+  storage.slot=song.effects.size();
+  DivEffectContainer inst;
+  if (!inst.init(which,this,got.rate,0,NULL,0)) {
+    inst.quit();
+    saveLock.unlock();
+    BUSY_END;
+    lastError=_("could not initialize effect");
+    return false;
+  }
+  song.effects.push_back(storage);
+  effectInst.push_back(inst);
+  recalcPatchbay();
+  saveLock.unlock();
+  BUSY_END;
+  return true;
+}
+
+bool DivEngine::removeEffect(int index) {
+  if (index<0 || index>=(int)song.effects.size()) {
+    lastError=_("invalid index");
+    return false;
+  }
+  BUSY_BEGIN;
+  saveLock.lock();
+  const unsigned int portSet=DIV_PORTSET_EFFECT+index;
+
+  // patchbay (remove connections and move later effects down)
+  for (size_t i=0; i<song.patchbay.size(); i++) {
+    unsigned int srcPortSet=(song.patchbay[i]>>20)&0xfff;
+    unsigned int destPortSet=(song.patchbay[i]>>4)&0xfff;
+    if (srcPortSet==portSet || destPortSet==portSet) {
+      song.patchbay.erase(song.patchbay.begin()+i);
+      i--;
+      continue;
+    }
+    if (srcPortSet>portSet && srcPortSet<DIV_PORTSET_EFFECT+DIV_MAX_EFFECT_NODES) {
+      song.patchbay[i]-=0x100000;
+    }
+    if (destPortSet>portSet && destPortSet<DIV_PORTSET_EFFECT+DIV_MAX_EFFECT_NODES) {
+      song.patchbay[i]-=0x10;
+    }
+  }
+
+  if (index<(int)effectInst.size()) {
+    if (effectInst[index].effect!=NULL) effectInst[index].quit();
+    effectInst.erase(effectInst.begin()+index);
+  }
+  if (song.effects[index].storage!=NULL) {
+    delete[] song.effects[index].storage;
+  }
+  song.effects.erase(song.effects.begin()+index);
+  for (size_t i=index; i<song.effects.size(); i++) {
+    song.effects[i].slot=i;
+  }
+  recalcPatchbay();
+  saveLock.unlock();
+  BUSY_END;
+  return true;
+}
+
+void DivEngine::initEffects() {
+  quitEffects();
+  for (DivEffectStorage& i: song.effects) {
+    DivEffectContainer inst;
+    if (!inst.init(i.id,this,got.rate,i.storageVer,i.storage,i.storageLen)) {
+      logW("could not initialize effect %d!",(int)i.slot);
+    }
+    effectInst.push_back(inst);
+  }
+  recalcPatchbay();
+}
+
+void DivEngine::quitEffects() {
+  for (DivEffectContainer& i: effectInst) {
+    if (i.effect!=NULL) i.quit();
+  }
+  effectInst.clear();
+  effectGraph.clear();
+}
+
 void DivEngine::poke(int sys, unsigned int addr, unsigned short val) {
   if (sys<0 || sys>=song.systemLen) return;
   BUSY_BEGIN;
@@ -1589,6 +1726,11 @@ DivDispatch* DivEngine::getDispatch(int index) {
   return disCont[index].dispatch;
 }
 
+DivEffect* DivEngine::getEffect(int index) {
+  if (index<0 || index>=(int)effectInst.size()) return NULL;
+  return effectInst[index].effect;
+}
+
 void DivEngine::setLoops(int loops) {
   remainingLoops=loops;
 }
@@ -1695,11 +1837,12 @@ void DivEngine::syncFilePlayer() {
 }
 
 void DivEngine::playSub(bool preserveDrift, int goalRow) {
+  DivMacroReadSection readSection(macroReader);
   logV("playSub() called");
   std::chrono::high_resolution_clock::time_point timeStart=std::chrono::high_resolution_clock::now();
   for (int i=0; i<song.systemLen; i++) disCont[i].dispatch->setSkipRegisterWrites(false);
   reset();
-  if (preserveDrift && curOrder==0) {
+  if (preserveDrift && curOrder==0 && goalRow==0) {
     logV("preserveDrift && curOrder is true");
     return;
   }
@@ -2811,6 +2954,22 @@ void DivEngine::delInstrument(int index) {
   BUSY_END;
 }
 
+void DivEngine::compactMacros() {
+  size_t usage=0;
+  for (DivInstrument* i: song.ins) {
+    i->compactMacros();
+    usage+=i->getMacroMemoryUsage();
+  }
+  DivMacroValues::collect();
+  logV("macro values: %d bytes (%d with fixed-size macros)",(int)usage,(int)(song.ins.size()*DIV_MACRO_COUNT*DIV_MACRO_VALS*sizeof(int)));
+}
+
+void DivEngine::collectMacroValues() {
+  if (!DivMacroValues::hasReleased()) return;
+  // no locking needed: collect() only frees storage no audio thread can see
+  DivMacroValues::collect();
+}
+
 int DivEngine::addWave() {
   if (song.wave.size()>=32768) {
     lastError=_("too many wavetables!");
@@ -3023,7 +3182,7 @@ int DivEngine::addSample() {
   sPreview.dir=false;
   checkAssetDir(song.sampleDir,song.sample.size());
   saveLock.unlock();
-  renderSamples();
+  renderSamples(sampleCount);
   BUSY_END;
   return sampleCount;
 }
@@ -3041,7 +3200,7 @@ int DivEngine::addSamplePtr(DivSample* which) {
   song.sampleLen=sampleCount+1;
   checkAssetDir(song.sampleDir,song.sample.size());
   saveLock.unlock();
-  renderSamples();
+  renderSamples(sampleCount);
   BUSY_END;
   return sampleCount;
 }
@@ -3072,8 +3231,11 @@ void DivEngine::delSampleUnsafe(int index, bool render) {
         }
       }
     }
+    for (DivEffectContainer& i: effectInst) {
+      if (i.effect!=NULL) i.effect->notifySampleDeletion(index);
+    }
 
-    if (render) renderSamples();
+    if (render) renderSamples(-2);
   }
 }
 
@@ -3309,6 +3471,9 @@ void DivEngine::exchangeSample(int one, int two) {
       }
     }
   }
+  for (DivEffectContainer& i: effectInst) {
+    if (i.effect!=NULL) i.effect->notifySampleExchange(one,two);
+  }
 }
 
 bool DivEngine::moveInsUp(int which) {
@@ -3352,7 +3517,7 @@ bool DivEngine::moveSampleUp(int which) {
   moveAsset(song.sampleDir,which,which-1);
   exchangeSample(which,which-1);
   saveLock.unlock();
-  renderSamples();
+  renderSamples(-2);
   BUSY_END;
   return true;
 }
@@ -3398,7 +3563,7 @@ bool DivEngine::moveSampleDown(int which) {
   exchangeSample(which,which+1);
   moveAsset(song.sampleDir,which,which+1);
   saveLock.unlock();
-  renderSamples();
+  renderSamples(-2);
   BUSY_END;
   return true;
 }
@@ -3444,7 +3609,7 @@ bool DivEngine::swapSamples(int a, int b) {
   exchangeSample(a,b);
   moveAsset(song.sampleDir,a,b);
   saveLock.unlock();
-  renderSamples();
+  renderSamples(-2);
   BUSY_END;
   return true;
 }
@@ -3493,23 +3658,48 @@ void DivEngine::autoPatchbayP() {
   BUSY_BEGIN;
   saveLock.lock();
   autoPatchbay();
+  recalcPatchbay();
   saveLock.unlock();
   BUSY_END;
 }
 
-void DivEngine::recalcPatchbay() {
+void DivEngine::buildEffectGraph(DivEffectGraph& graph, const std::vector<unsigned int>& patchbay) {
+  std::vector<DivEffect*> effects;
+  std::vector<float> dryWet;
+  effects.reserve(effectInst.size());
+  dryWet.reserve(effectInst.size());
+  for (size_t i=0; i<effectInst.size(); i++) {
+    effects.push_back(effectInst[i].effect);
+    dryWet.push_back((i<song.effects.size())?song.effects[i].dryWet:1.0f);
+  }
+  graph.build(this,patchbay,effects,dryWet,MAX(got.bufsize,preparedBufSize));
+  graph.setRate(got.rate);
+}
 
+void DivEngine::recalcPatchbay() {
+  DivEffectGraph graph;
+  buildEffectGraph(graph,song.patchbay);
+  effectGraph.swap(graph);
 }
 
+// the patchbay functions below build the new graph before locking the engine,
+// and only swap it in while locked.
+
 bool DivEngine::patchConnect(unsigned int src, unsigned int dest) {
   unsigned int armed=(src<<16)|(dest&0xffff);
   for (unsigned int i: song.patchbay) {
     if (i==armed) return false;
   }
+  std::vector<unsigned int> patchbay=song.patchbay;
+  patchbay.push_back(armed);
+  DivEffectGraph graph;
+  buildEffectGraph(graph,patchbay);
+
   BUSY_BEGIN;
   saveLock.lock();
-  song.patchbay.push_back(armed);
+  song.patchbay.swap(patchbay);
   song.patchbayAuto=false;
+  effectGraph.swap(graph);
   saveLock.unlock();
   BUSY_END;
   return true;
@@ -3517,12 +3707,18 @@ bool DivEngine::patchConnect(unsigned int src, unsigned int dest) {
 
 bool DivEngine::patchDisconnect(unsigned int src, unsigned int dest) {
   unsigned int armed=(src<<16)|(dest&0xffff);
-  for (auto i=song.patchbay.begin(); i!=song.patchbay.end(); i++) {
-    if (*i==armed) {
+  for (size_t i=0; i<song.patchbay.size(); i++) {
+    if (song.patchbay[i]==armed) {
+      std::vector<unsigned int> patchbay=song.patchbay;
+      patchbay.erase(patchbay.begin()+i);
+      DivEffectGraph graph;
+      buildEffectGraph(graph,patchbay);
+
       BUSY_BEGIN;
       saveLock.lock();
-      song.patchbay.erase(i);
+      song.patchbay.swap(patchbay);
       song.patchbayAuto=false;
+      effectGraph.swap(graph);
       saveLock.unlock();
       BUSY_END;
       return true;
@@ -3532,29 +3728,28 @@ bool DivEngine::patchDisconnect(unsigned int src, unsigned int dest) {
 }
 
 void DivEngine::patchDisconnectAll(unsigned int portSet) {
-  BUSY_BEGIN;
-  saveLock.lock();
-
+  std::vector<unsigned int> patchbay;
+  patchbay.reserve(song.patchbay.size());
   if (portSet&0x1000) {
     portSet&=0xfff;
 
-    for (size_t i=0; i<song.patchbay.size(); i++) {
-      if ((song.patchbay[i]&0xfff0)==(portSet<<4)) {
-        song.patchbay.erase(song.patchbay.begin()+i);
-        i--;
-      }
+    for (unsigned int i: song.patchbay) {
+      if ((i&0xfff0)!=(portSet<<4)) patchbay.push_back(i);
     }
   } else {
     portSet&=0xfff;
 
-    for (size_t i=0; i<song.patchbay.size(); i++) {
-      if ((song.patchbay[i]&0xfff00000)==(portSet<<20)) {
-        song.patchbay.erase(song.patchbay.begin()+i);
-        i--;
-      }
+    for (unsigned int i: song.patchbay) {
+      if ((i&0xfff00000)!=(portSet<<20)) patchbay.push_back(i);
     }
   }
+  DivEffectGraph graph;
+  buildEffectGraph(graph,patchbay);
 
+  BUSY_BEGIN;
+  saveLock.lock();
+  song.patchbay.swap(patchbay);
+  effectGraph.swap(graph);
   saveLock.unlock();
   BUSY_END;
 }
@@ -3766,6 +3961,7 @@ void DivEngine::setOrder(unsigned char order) {
 void DivEngine::updateSysFlags(int system, bool restart, bool render) {
   BUSY_BEGIN_SOFT;
   disCont[system].dispatch->setFlags(song.systemFlags[system]);
+  disCont[system].setResampler(song.systemFlags[system].getInt("resampler",DIV_RESAMPLER_AUTO));
   disCont[system].setRates(got.rate);
   if (render) renderSamples();
 
@@ -3773,6 +3969,7 @@ void DivEngine::updateSysFlags(int system, bool restart, bool render) {
   if (song.patchbayAuto) {
     saveLock.lock();
     autoPatchbay();
+    recalcPatchbay();
     saveLock.unlock();
   }
 
@@ -3803,6 +4000,10 @@ void DivEngine::setAudio(DivAudioEngines which) {
   audioEngine=which;
 }
 
+void DivEngine::setAudioSocketPath(String path) {
+  audioSocketPath=path;
+}
+
 void DivEngine::setView(DivStatusView which) {
   view=which;
 }
@@ -3848,6 +4049,7 @@ bool DivEngine::switchMaster(bool full) {
     if (curFilePlayer!=NULL) {
       curFilePlayer->setOutputRate(got.rate);
     }
+    startRenderAhead();
     if (!output->setRun(true)) {
       logE("error while activating audio!");
       return false;
@@ -3880,6 +4082,12 @@ void DivEngine::setMidiCallback(std::function<int(const TAMidiMessage&)> what) {
   midiCallback=what;
 }
 
+void DivEngine::setTickCallback(std::function<void()> what) {
+  BUSY_BEGIN_SOFT;
+  tickCallback=what;
+  BUSY_END;
+}
+
 void DivEngine::setMidiDebug(bool enable) {
   midiDebug=enable;
 }
@@ -4004,7 +4212,11 @@ void DivEngine::initDispatch(bool isRender) {
     autoPatchbay();
     saveLock.unlock();
   }
+  initEffects();
   song.recalcChans();
+  // the song was replaced or its systems changed
+  markSongModified();
+  prepareAudioBuffers(MAX(preparedBufSize,got.bufsize));
   BUSY_END;
 }
 
@@ -4014,6 +4226,7 @@ void DivEngine::quitDispatch() {
   for (int i=0; i<song.systemLen; i++) {
     disCont[i].quit();
   }
+  quitEffects();
   cycles=0;
   clockDrift=0;
   midiClockCycles=0;
@@ -4066,6 +4279,8 @@ bool DivEngine::initAudioBackend() {
       audioEngine=DIV_AUDIO_PORTAUDIO;
     } else if (getConfString("audioEngine","SDL")=="ASIO") {
       audioEngine=DIV_AUDIO_ASIO;
+    } else if (getConfString("audioEngine","SDL")=="Socket") {
+      audioEngine=DIV_AUDIO_SOCKET;
     } else {
       audioEngine=DIV_AUDIO_SDL;
     }
@@ -4095,6 +4310,10 @@ bool DivEngine::initAudioBackend() {
   if (previewVol<0.0f) previewVol=0.0f;
   if (previewVol>1.0f) previewVol=1.0f;
   renderPoolThreads=getConfInt("renderPoolThreads",0);
+  parallelTick=getConfInt("parallelTick",0);
+  renderAheadBufs=getConfInt("renderAheadBufs",0);
+  if (renderAheadBufs<0) renderAheadBufs=0;
+  if (renderAheadBufs>16) renderAheadBufs=16;
 
   if (lowLatency) logI("using low latency mode.");
 
@@ -4155,6 +4374,14 @@ bool DivEngine::initAudioBackend() {
     case DIV_AUDIO_PIPE:
       output=new TAAudioPipe;
       break;
+    case DIV_AUDIO_SOCKET:
+#ifdef HAVE_SOCKET_AUDIO
+      output=new TAAudioSocket;
+#else
+      logE("Furnace was not compiled with socket server support!");
+      output=new TAAudio;
+#endif
+      break;
     case DIV_AUDIO_DUMMY:
       output=new TAAudio;
       break;
@@ -4176,6 +4403,10 @@ bool DivEngine::initAudioBackend() {
   want.wasapiEx=getConfInt("wasapiEx",0);
   want.name="Furnace";
 
+  if (audioEngine==DIV_AUDIO_SOCKET) {
+    want.deviceName=audioSocketPath.empty()?getConfString("audioSocketPath",""):audioSocketPath;
+  }
+
   if (want.outChans<1) want.outChans=1;
   if (want.outChans>16) want.outChans=16;
 
@@ -4198,6 +4429,7 @@ bool DivEngine::initAudioBackend() {
     }
     memset(oscBuf[i],0,32768*sizeof(float));
   }
+  prepareAudioBuffers(got.bufsize);
 
   logI("initializing MIDI.");
   if (output->initMidi(false)) {
@@ -4236,6 +4468,8 @@ bool DivEngine::initAudioBackend() {
 }
 
 bool DivEngine::deinitAudioBackend(bool dueToSwitchMaster) {
+  // the render-ahead thread may be using the MIDI input
+  stopRenderAhead();
   if (output!=NULL) {
     logI("closing audio output.");
     output->quit();
@@ -4261,6 +4495,62 @@ bool DivEngine::deinitAudioBackend(bool dueToSwitchMaster) {
   return true;
 }
 
+void DivEngine::startRenderAhead() {
+  stopRenderAhead();
+  if (renderAheadBufs<1 || output==NULL) return;
+  renderAhead=new DivRenderAhead;
+  if (!renderAhead->start(this,got.outChans,got.bufsize,renderAheadBufs)) {
+    delete renderAhead;
+    renderAhead=NULL;
+  }
+}
+
+void DivEngine::stopRenderAhead() {
+  if (renderAhead==NULL) return;
+  // stop the producer first, then make sure the audio callback is no longer reading
+  renderAhead->stop();
+  DivRenderAhead* old=renderAhead;
+  renderAhead=NULL;
+  if (output!=NULL) output->setRun(false);
+  delete old;
+}
+
+bool DivEngine::pullRenderAhead(float** out, int outChans, unsigned int size) {
+  DivRenderAhead* ra=renderAhead;
+  if (ra==NULL) return false;
+
+  // hand MIDI input over to the producer
+  if (output!=NULL) if (output->midiIn!=NULL) while (!output->midiIn->queue.empty()) {
+    if (!ra->pushMidi(output->midiIn->queue.front())) break;
+    output->midiIn->queue.pop();
+  }
+
+  ra->read(out,outChans,size);
+
+  // the oscilloscope follows what is actually heard
+  int writePos=oscWritePos.load(std::memory_order_relaxed);
+  for (unsigned int i=0; i<size; i++) {
+    for (int j=0; j<outChans; j++) {
+      if (oscBuf[j]==NULL) continue;
+      oscBuf[j][writePos]=out[j][i];
+    }
+    if (++writePos>=32768) writePos=0;
+  }
+  oscWritePos.store(writePos,std::memory_order_release);
+  oscSize=size;
+  return true;
+}
+
+unsigned int DivEngine::getRenderAheadLatency() {
+  if (renderAhead==NULL) return 0;
+  return renderAhead->getLatency();
+}
+
+unsigned int DivEngine::getRenderAheadUnderruns() {
+  if (renderAhead==NULL) return 0;
+  return renderAhead->getUnderruns();
+}
+
 bool DivEngine::prePreInit() {
   // init config
   initConfDir();
@@ -4419,6 +4709,7 @@ bool DivEngine::init() {
       logE("output is NULL!");
       return false;
     }
+    startRenderAhead();
     if (!output->setRun(true)) {
       logE("error while activating!");
       return false;
@@ -4430,6 +4721,9 @@ bool DivEngine::init() {
 bool DivEngine::quit(bool saveConfig) {
   deinitAudioBackend();
   quitDispatch();
+#ifdef FURNACE_ALLOC_TRACKER
+  logI("allocations in the audio thread: %d",(int)divAllocTrackerCount());
+#endif
   if (saveConfig) {
     logI("saving config.");
     saveConf();
@@ -4447,9 +4741,11 @@ bool DivEngine::quit(bool saveConfig) {
     delete curFilePlayer;
     curFilePlayer=NULL;
   }
+  regTrace.reset();
   if (yrw801ROM!=NULL) delete[] yrw801ROM;
   if (tg100ROM!=NULL) delete[] tg100ROM;
   if (mu5ROM!=NULL) delete[] mu5ROM;
   song.unload();
+  DivMacroValues::collect();
   return true;
 }
@@ -30,9 +30,15 @@
 #include "sysDef.h"
 #include "cmdStream.h"
 #include "filePlayer.h"
+#include "profiler.h"
+#include "renderAhead.h"
+#include "regTrace.h"
+#include "effectGraph.h"
 #include "../audio/taAudio.h"
 #include "blip_buf.h"
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <initializer_list>
 #include <thread>
 #include "../fixedQueue.h"
@@ -79,6 +85,7 @@ enum DivAudioEngines {
   DIV_AUDIO_PORTAUDIO=2,
   DIV_AUDIO_PIPE=3,
   DIV_AUDIO_ASIO=4,
+  DIV_AUDIO_SOCKET=5,
 
   DIV_AUDIO_NULL=126,
   DIV_AUDIO_DUMMY=127
@@ -133,7 +140,15 @@ struct DivAudioExportOptions {
   int chans;
   int loops;
   double fadeOut;
+  // range to render. rendering starts at orderBegin/rowBegin (-1 for the
+  // start of the song) and stops before orderEnd/rowEnd (-1 for the end of
+  // the song). loops go back to the start of the range.
+  // the start is reached by running the song from its first order without
+  // rendering audio, every time the range starts.
   int orderBegin, orderEnd;
+  int rowBegin, rowEnd;
+  // stop after this many seconds (0 for no limit)
+  double duration;
   bool channelMask[DIV_MAX_CHANS];
   int bitRate;
   float vbrQuality;
@@ -148,6 +163,9 @@ struct DivAudioExportOptions {
     fadeOut(0.0),
     orderBegin(-1),
     orderEnd(-1),
+    rowBegin(0),
+    rowEnd(0),
+    duration(0.0),
     bitRate(128000),
     vbrQuality(6.0f) {
     for (int i=0; i<DIV_MAX_CHANS; i++) {
@@ -173,6 +191,8 @@ struct DivChannelState {
   int midiNote, curMidiNote, midiPitch;
   size_t midiAge;
   bool midiAftertouch;
+  // incremented on every instrument command (the chip may reload the instrument after it)
+  unsigned int insCmds;
 
   DivChannelState():
     note(-1),
@@ -240,7 +260,8 @@ struct DivChannelState {
     curMidiNote(-1),
     midiPitch(-1),
     midiAge(0),
-    midiAftertouch(false) {}
+    midiAftertouch(false),
+    insCmds(0) {}
 };
 
 struct DivNoteEvent {
@@ -268,6 +289,21 @@ struct DivNoteEvent {
     fromMIDI(false) {}
 };
 
+// resampling path of a chip (the "resampler" system flag)
+enum DivResampler {
+  // skip blip_buf if the chip rate is an integer multiple of the output rate
+  DIV_RESAMPLER_AUTO=0,
+  // always use blip_buf
+  DIV_RESAMPLER_BLIP,
+  // like auto, but decimate by averaging instead of band-limiting
+  DIV_RESAMPLER_NATIVE_FAST
+};
+
+// largest chip/output rate ratio for the native path
+#define DIV_NATIVE_MAX_RATIO 16
+// tick chips in parallel when there are at least this many
+#define DIV_PARALLEL_TICK_MIN 4
+
 struct DivDispatchContainer {
   DivDispatch* dispatch;
   blip_buffer_t* bb[DIV_MAX_OUTPUTS];
@@ -279,16 +315,41 @@ struct DivDispatchContainer {
   bool lowQuality, dcOffCompensation, hiPass;
   double rateMemory;
 
+  // native rate path (0 if blip_buf is used, or chip samples per output sample)
+  int resampler, nativeRatio;
+  float nativeDC[DIV_MAX_OUTPUTS];
+  short* nativeHist[DIV_MAX_OUTPUTS];
+  float* nativeTaps;
+  int nativeTapCount;
+  short* nativeWork;
+  size_t nativeWorkLen;
+  // buffer size to make room for (see reserve())
+  unsigned int reserveLen;
+
   // used in multi-thread
   int cycles;
   unsigned int size;
+  bool tickIsSys;
+
+  // profiling
+  DivPerfCounter perfAcquire, perfFillBuf;
+  uint64_t perfAcquireAccum, perfFillBufAccum, perfSlice;
+  bool perfTrace;
+  std::vector<DivPerfEvent> perfEvents;
 
   void setRates(double gotRate);
+  void setResampler(int mode);
   void setQuality(bool lowQual, bool dcHiPass);
+  int samplesAvail();
+  int clocksNeeded(int count);
+  void fillNative(size_t runtotal, size_t offset, size_t size);
   void grow(size_t size);
+  void reserve(unsigned int size);
   void acquire(size_t count);
   void flush(size_t offset, size_t count);
   void fillBuf(size_t runtotal, size_t offset, size_t size);
+  void perfRecord(uint64_t begin, uint64_t mid, uint64_t end);
+  void perfCommit();
   void clear();
   void init(DivSystem sys, DivEngine* eng, int chanCount, double gotRate, const DivConfig& flags, bool isRender=false);
   void quit();
@@ -303,14 +364,28 @@ struct DivDispatchContainer {
     dcOffCompensation(false),
     hiPass(true),
     rateMemory(0.0),
+    resampler(DIV_RESAMPLER_AUTO),
+    nativeRatio(0),
+    nativeTaps(NULL),
+    nativeTapCount(0),
+    nativeWork(NULL),
+    nativeWorkLen(0),
+    reserveLen(0),
     cycles(0),
-    size(0) {
+    size(0),
+    tickIsSys(false),
+    perfAcquireAccum(0),
+    perfFillBufAccum(0),
+    perfSlice(0),
+    perfTrace(false) {
     memset(bb,0,DIV_MAX_OUTPUTS*sizeof(blip_buffer_t*));
     memset(temp,0,DIV_MAX_OUTPUTS*sizeof(int));
     memset(prevSample,0,DIV_MAX_OUTPUTS*sizeof(int));
     memset(bbIn,0,DIV_MAX_OUTPUTS*sizeof(short*));
     memset(bbInMapped,0,DIV_MAX_OUTPUTS*sizeof(short*));
     memset(bbOut,0,DIV_MAX_OUTPUTS*sizeof(short*));
+    memset(nativeDC,0,DIV_MAX_OUTPUTS*sizeof(float));
+    memset(nativeHist,0,DIV_MAX_OUTPUTS*sizeof(short*));
   }
 };
 
@@ -366,8 +441,9 @@ class DivEngine {
   bool midiIsDirect;
   bool midiIsDirectProgram;
   bool lowLatency;
-  bool systemsRegistered;
-  bool romExportsRegistered;
+  // the definitions are shared by every engine in the process
+  static bool systemsRegistered;
+  static bool romExportsRegistered;
   bool hasLoadedSomething;
   bool midiOutClock;
   bool midiOutTime;
@@ -379,9 +455,13 @@ class DivEngine {
   int subticks, ticks, curRow, curOrder, prevRow, prevOrder, remainingLoops, totalLoops, lastLoopPos, exportLoopCount, curExportChan, nextSpeed, prevSpeed, elapsedBars, elapsedBeats, curSpeed;
   size_t curSubSongIndex;
   size_t bufferPos;
+  // steady clock time (in nanoseconds) which maps to the start of the buffer for MIDI input
+  uint64_t midiBufBegin;
   double divider;
   int cycles;
   double clockDrift;
+  // set when an effect resets the tick clock (used by the register trace)
+  bool clockReset;
   int midiClockCycles;
   double midiClockDrift;
   int midiTimeCycles;
@@ -399,6 +479,7 @@ class DivEngine {
   DivHaltPositions haltOn;
   DivChannelState chan[DIV_MAX_CHANS];
   DivAudioEngines audioEngine;
+  String audioSocketPath;
   DivAudioExportModes exportMode;
   DivAudioExportFormats exportFormat;
   DivAudioExportWavFormats wavFormat;
@@ -406,6 +487,11 @@ class DivEngine {
   double exportFadeOut;
   bool isFadingOut;
   int exportOutputs;
+  // in-memory rendering (see renderBegin())
+  size_t renderFadeSamples, renderFadePos;
+  // export range (see DivAudioExportOptions)
+  int exportBeginOrder, exportBeginRow, exportEndOrder, exportEndRow;
+  size_t exportLength, exportPos;
   int exportBitRate;
   float exportVBRQuality;
   bool exportChannelMask[DIV_MAX_CHANS];
@@ -414,7 +500,7 @@ class DivEngine {
   // bitfield
   unsigned char walked[8192];
   bool isMuted[DIV_MAX_CHANS];
-  std::mutex isBusy, saveLock, playPosLock;
+  std::mutex isBusy, saveLock, playPosLock, regTraceLock;
   String configPath;
   String configFile;
   String lastError;
@@ -424,6 +510,7 @@ class DivEngine {
   std::vector<String> midiOuts;
   std::vector<DivCommand> cmdStream;
   std::vector<DivEffectContainer> effectInst;
+  DivEffectGraph effectGraph;
   std::vector<int> curChanMask;
   static DivSysDef* sysDefs[DIV_MAX_CHIP_DEFS];
   static DivSystem sysFileMapFur[DIV_MAX_CHIP_DEFS];
@@ -477,6 +564,8 @@ class DivEngine {
 
   float* filePlayerBuf[DIV_MAX_OUTPUTS];
   size_t filePlayerBufLen;
+  // largest buffer nextBuf() can take without allocating
+  unsigned int preparedBufSize;
   DivFilePlayer* curFilePlayer;
   bool filePlayerSync;
   TimeMicros filePlayerCue;
@@ -487,9 +576,32 @@ class DivEngine {
 
   unsigned int renderPoolThreads;
   DivWorkPool* renderPool;
+  // tick chips in the render pool during playback (checked by -benchsuite)
+  bool parallelTick;
+
+  // decoupled live playback
+  DivRenderAhead* renderAhead;
+  int renderAheadBufs;
+
+  // cached register trace for ROM exports
+  std::shared_ptr<DivRegisterTrace> regTrace;
+  // bumped whenever the song is edited or replaced
+  std::atomic<uint64_t> songRev;
+
+  // keeps macro storage replaced by edits alive while the engine ticks
+  // (nextBuf(), and nextTick()/playSub() when called by anything else)
+  DivMacroReader macroReader;
+
+  // profiler
+  DivPerfCounter perfStage[DIV_PERF_MAX];
+  bool perfTrace;
+  uint64_t perfTraceBegin;
+  std::vector<DivPerfEvent> perfEvents;
 
   // MIDI stuff
   std::function<int(const TAMidiMessage&)> midiCallback=[](const TAMidiMessage&) -> int {return -3;};
+  // called on every tick before the dispatches are ticked
+  std::function<void()> tickCallback;
 
   void processRowPre(int i);
   void processRow(int i, bool afterDelay);
@@ -497,15 +609,25 @@ class DivEngine {
   void nextRow();
   void performVGMWrite(SafeWriter* w, DivSystem sys, DivRegWrite& write, int streamOff, double* loopTimer, double* loopFreq, int* loopSample, bool* sampleDir, bool isSecond, int* pendingFreq, int* playingSample, int* setPos, unsigned int* sampleOff8, unsigned int* sampleLen8, size_t bankOffset, bool directStream, bool* sampleStoppable, bool dpcm07, DivDispatch** writeNES, int rateCorrection);
   // returns true if end of song.
-  bool nextTick(bool noAccum=false, bool inhibitLowLat=false);
+  bool nextTick(bool noAccum=false, bool inhibitLowLat=false, bool parallel=false);
   bool perSystemEffect(int ch, unsigned char effect, unsigned char effectVal);
   bool perSystemPostEffect(int ch, unsigned char effect, unsigned char effectVal);
   bool perSystemPreEffect(int ch, unsigned char effect, unsigned char effectVal);
   void reset();
   void playSub(bool preserveDrift, int goalRow=0);
+  // profiler helpers. these return the end time or the elapsed time.
+  uint64_t perfEndStage(DivPerfStage stage, uint64_t begin);
+  uint64_t perfTraceEvent(DivPerfStage stage, uint64_t begin);
+  void perfEndRenderSlice(uint64_t begin, uint64_t& renderAccum, uint64_t& poolAccum);
+  void processMidiIn(TAMidiMessage& msg);
   void runMidiClock(int totalCycles=1);
   void runMidiTime(int totalCycles=1);
   bool shallSwitchCores();
+  void prepareAudioBuffers(unsigned int size);
+  bool setExportRange(const DivAudioExportOptions& options);
+  void playExportRange();
+  bool exportLengthReached();
+  bool exportRangeLeft();
 
   void testFunction();
 
@@ -551,6 +673,9 @@ class DivEngine {
 
   bool initAudioBackend();
   bool deinitAudioBackend(bool dueToSwitchMaster=false);
+  void startRenderAhead();
+  void stopRenderAhead();
+  void captureRegisterTrace(DivRegisterTrace* t);
 
   void registerSystems();
   void registerROMExports();
@@ -565,8 +690,17 @@ class DivEngine {
   void stompChannel(int ch);
   bool sysChanCountChange(int firstChan, int before, int after);
 
+  // build an effect graph out of a patchbay (doesn't need the engine lock)
+  void buildEffectGraph(DivEffectGraph& graph, const std::vector<unsigned int>& patchbay);
+
   // recalculate patchbay (UNSAFE)
   void recalcPatchbay();
+  // mix a patchbay connection's source into dest
+  void mixPort(unsigned int conn, float* dest, size_t size, float masterVol);
+  void processEffectNode(DivEffectGraphNode* node);
+  // (re)create/destroy effect instances (UNSAFE)
+  void initEffects();
+  void quitEffects();
 
   // change song (UNSAFE)
   void changeSong(size_t songIndex);
@@ -595,7 +729,9 @@ class DivEngine {
     bool keyHit[DIV_MAX_CHANS];
     float* oscBuf[DIV_MAX_OUTPUTS];
     float oscSize;
-    int oscReadPos, oscWritePos;
+    int oscReadPos;
+    // published after every block, so other threads can follow the ring buffer
+    std::atomic<int> oscWritePos;
     int tickMult;
     int lastNBIns, lastNBOuts, lastNBSize;
     std::atomic<size_t> processTime;
@@ -603,11 +739,18 @@ class DivEngine {
     float chipPeak[DIV_MAX_CHIPS][DIV_MAX_OUTPUTS];
 
     void runExportThread();
-    void nextBuf(float** in, float** out, int inChans, int outChans, unsigned int size);
+    // fromRenderAhead is set by the render-ahead thread (skips the oscilloscope and yields to export).
+    void nextBuf(float** in, float** out, int inChans, int outChans, unsigned int size, bool fromRenderAhead=false);
+    // called by the audio callback. returns false if render-ahead is off.
+    bool pullRenderAhead(float** out, int outChans, unsigned int size);
+    // render-ahead latency in frames (0 if off).
+    unsigned int getRenderAheadLatency();
+    unsigned int getRenderAheadUnderruns();
     DivInstrument* getIns(int index, DivInstrumentType fallbackType=DIV_INS_FM);
     DivWavetable* getWave(int index);
     DivSample* getSample(int index);
     DivDispatch* getDispatch(int index);
+    DivEffect* getEffect(int index);
     // parse old system setup description
     String decodeSysDesc(String desc);
     // start fresh
@@ -662,6 +805,14 @@ class DivEngine {
     bool haltAudioFile();
     // return back to playback cores if necessary
     void finishAudioFile();
+    // render audio to memory instead of a file. call renderNext() until it returns 0, then renderEnd().
+    // only sampleRate, chans, loops, fadeOut and the range in the options are used.
+    // maxLen is the largest len renderNext() will be called with.
+    bool renderBegin(const DivAudioExportOptions& options, unsigned int maxLen);
+    // render up to len frames (planar, exportOutputs channels). returns the number of frames rendered.
+    size_t renderNext(float** out, unsigned int len);
+    // finish rendering to memory and return to playback
+    void renderEnd();
     // notify instrument parameter change
     void notifyInsChange(int ins);
     // notify wavetable change
@@ -681,11 +832,58 @@ class DivEngine {
     // convert old flags
     static void convertOldFlags(unsigned int oldFlags, DivConfig& newFlags, DivSystem sys);
 
+    // profiler
+    DivPerfCounter* getPerfCounter(DivPerfStage stage);
+    // get per-chip profiler counters. which is 0 for acquire and 1 for fillBuf.
+    DivPerfCounter* getChipPerfCounter(int chip, int which);
+    void resetPerf();
+    // start/stop recording trace events (memory grows while enabled!)
+    void setPerfTrace(bool enable);
+    // write collected trace events and statistics in Chrome trace event format.
+    bool writePerfTrace(const char* path);
+    // print per-stage and per-chip statistics to stdout.
+    void printPerfStats();
+
+    /**
+     * get the register writes of the current sub-song, played once from the beginning.
+     * the trace is cached until the song changes, so it may be shared by several exports.
+     * a new trace is captured on this engine (not a copy of it) while it is
+     * soft-locked, so playback is stopped and edits wait until it is done.
+     */
+    std::shared_ptr<const DivRegisterTrace> getRegisterTrace();
+
+    /**
+     * mark the song as edited (this invalidates cached data such as the register trace).
+     */
+    void markSongModified();
+
     // benchmark (returns time in seconds)
     double benchmarkPlayback();
     double benchmarkSeek();
     double benchmarkWalk();
 
+    /**
+     * run a song through load, save, render, seek, walk, VGM and command stream export.
+     * songs with enough chips are rendered again with parallel ticking.
+     * @return the report line for this song, or an empty string on failure.
+     */
+    String benchmarkSong(const String& path, const String& name);
+
+    /**
+     * run the benchmark suite over a corpus (a list of song files, one per line).
+     * writes a JSON report to reportPath. if baselinePath isn't NULL, the results
+     * are compared against it, flagging slowdowns beyond threshold (in percent)
+     * and any output change.
+     * @return the number of failed songs plus regressions, or -1 on error.
+     */
+    int benchmarkSuite(const char* corpusPath, const char* reportPath, const char* baselinePath, double threshold);
+
+    /**
+     * measure the cost of the convolution reverb with 1, 4 and 10 second impulse responses.
+     * @return the number of runs whose output was not deterministic.
+     */
+    int benchmarkConvolution();
+
     // returns the minimum VGM version which may carry the specified system, or 0 if none.
     int minVGMVersion(DivSystem which);
 
@@ -977,6 +1175,12 @@ class DivEngine {
     void delInstrument(int index);
     void delInstrumentUnsafe(int index);
 
+    // UNSAFE shrink macro storage of all instruments to the used part - only execute when locked
+    void compactMacros();
+
+    // free macro storage which is no longer used
+    void collectMacroValues();
+
     // add wavetable
     int addWave();
 
@@ -1118,6 +1322,9 @@ class DivEngine {
     // set the audio system.
     void setAudio(DivAudioEngines which);
 
+    // set the path of the socket used by the socket server audio system.
+    void setAudioSocketPath(String path);
+
     // set the view mode.
     void setView(DivStatusView which);
 
@@ -1270,6 +1477,11 @@ class DivEngine {
     // if the specified function returns -3, note feedback will be inhibited.
     void setMidiCallback(std::function<int(const TAMidiMessage&)> what);
 
+    // set tick callback
+    // it runs in the audio thread (with the engine locked) on every tick, and may call dispatchCmd().
+    // pass NULL to remove it.
+    void setTickCallback(std::function<void()> what);
+
     // send MIDI message
     bool sendMidiMessage(TAMidiMessage& msg);
 
@@ -1356,8 +1568,6 @@ class DivEngine {
       midiIsDirect(false),
       midiIsDirectProgram(false),
       lowLatency(false),
-      systemsRegistered(false),
-      romExportsRegistered(false),
       hasLoadedSomething(false),
       midiOutClock(false),
       midiOutTime(false),
@@ -1384,9 +1594,11 @@ class DivEngine {
       curSpeed(0),
       curSubSongIndex(0),
       bufferPos(0),
+      midiBufBegin(0),
       divider(60),
       cycles(0),
       clockDrift(0),
+      clockReset(false),
       midiClockCycles(0),
       midiClockDrift(0),
       midiTimeCycles(0),
@@ -1418,6 +1630,14 @@ class DivEngine {
       exportFadeOut(0.0),
       isFadingOut(false),
       exportOutputs(2),
+      renderFadeSamples(0),
+      renderFadePos(0),
+      exportBeginOrder(0),
+      exportBeginRow(0),
+      exportEndOrder(-1),
+      exportEndRow(0),
+      exportLength(0),
+      exportPos(0),
       exportBitRate(128000),
       exportVBRQuality(6.0f),
       cmdStreamInt(NULL),
@@ -1441,6 +1661,7 @@ class DivEngine {
       metroVol(1.0f),
       previewVol(1.0f),
       filePlayerBufLen(0),
+      preparedBufSize(0),
       curFilePlayer(NULL),
       filePlayerSync(false),
       filePlayerCue(0,0),
@@ -1449,6 +1670,12 @@ class DivEngine {
       totalProcessed(0),
       renderPoolThreads(0),
       renderPool(NULL),
+      parallelTick(false),
+      renderAhead(NULL),
+      renderAheadBufs(0),
+      songRev(0),
+      perfTrace(false),
+      perfTraceBegin(0),
       curOrders(NULL),
       curPat(NULL),
       tempIns(NULL),
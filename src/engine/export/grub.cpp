@@ -59,103 +59,64 @@ void DivExportGRUB::run() {
 
   size_t tickCount=0;
 
-  e->stop();
-  e->repeatPattern=false;
-  e->setOrder(0);
-
   logAppend("playing and logging register writes...");
 
   int oldFreq = 0;
   int freq = 0;
 
-  e->synchronizedSoft([&]() {
-    double origRate = e->got.rate;
-    double rate = MIN(e->curSubSong->hz,1000.0);
-    logAppendf("export rate is %d hz",(int)rate);
-    int tempo = (int)(60000.0/(1000.0/rate));
-    e->got.rate=rate;
-
-    // Determine loop point.
-    e->calcSongTimestamps();
-    int loopOrder=e->curSubSong->ts.loopStart.order;
-    int loopRow=e->curSubSong->ts.loopStart.row;
-    logAppendf("loop point: %d %d",loopOrder,loopRow);
-    e->warnings="";
-
-    auto w = new SafeWriter;
-    w->init(); 
-
-    // Reset the playback state.
-    e->curOrder=0;
-    e->freelance=false;
-    e->playing=false;
-    e->extValuePresent=false;
-    e->remainingLoops=-1;
-
-    e->disCont[BEEPER].dispatch->toggleRegisterDump(true);
-
-    // Prepare to write song data.
-    e->playSub(false);
-    bool done=false;
-
-    logAppend("writing data...");
-    progress[0].amount=0.15f;
-
-    int wait_tempo = 0;
-    if (grubExportBin)  
-      w->writeI(tempo); // write tempo  
-    else
-      w->writeText(fmt::sprintf("%d",tempo)); // write tempo
-
-    while (!done) {
-      if (e->nextTick(false,true) || !e->playing) {
-        done=true;
-      }
-
-      // get register dumps
-      uint8_t* regPool = e->disCont[BEEPER].dispatch->getRegisterPool();
-      int chipClock = e->disCont[BEEPER].dispatch->chipClock;
-      freq = (int)(regPool[0]|(regPool[1]<<8));
-      if (freq > 0) freq = chipClock/freq;
-
-      // write wait
-      tickCount++;
-      int totalWait=e->cycles;
-      if (totalWait>0 && !done) {
-        while (totalWait) {
-          wait_tempo++;
-          if (freq != oldFreq || wait_tempo == 65535) {
-            if (grubExportBin) {
-              w->writeS(oldFreq); // pitch
-              w->writeS(wait_tempo); // duration
-            } else {
-              w->writeText(fmt::sprintf(" %d %d", oldFreq, wait_tempo));
-            }
-            oldFreq = freq;
-            wait_tempo = 0;
-          }
-          totalWait--;
-          tickCount++;
+  double rate = MIN(e->curSubSong->hz,1000.0);
+  logAppendf("export rate is %d hz",(int)rate);
+  int tempo = (int)(60000.0/(1000.0/rate));
+
+  std::shared_ptr<const DivRegisterTrace> trace=e->getRegisterTrace();
+  logAppendf("loop point: %d %d",trace->loopOrder,trace->loopRow);
+  DivRegisterTraceClock clock(rate);
+  int chipClock = e->disCont[BEEPER].dispatch->chipClock;
+
+  auto w = new SafeWriter;
+  w->init(); 
+
+  logAppend("writing data...");
+  progress[0].amount=0.15f;
+
+  int wait_tempo = 0;
+  if (grubExportBin)  
+    w->writeI(tempo); // write tempo  
+  else
+    w->writeText(fmt::sprintf("%d",tempo)); // write tempo
+
+  // the last tick belongs to the loop
+  size_t traceTicks=trace->getTickCount();
+  for (size_t i=0; i+1<traceTicks; i++) {
+    // get register dumps
+    const unsigned char* regPool = trace->getPool(BEEPER,i);
+    freq = (regPool==NULL)?0:(int)(regPool[0]|(regPool[1]<<8));
+    if (freq > 0) freq = chipClock/freq;
+
+    // write wait
+    tickCount++;
+    int totalWait=clock.advance(*trace,i);
+    while (totalWait>0) {
+      wait_tempo++;
+      if (freq != oldFreq || wait_tempo == 65535) {
+        if (grubExportBin) {
+          w->writeS(oldFreq); // pitch
+          w->writeS(wait_tempo); // duration
+        } else {
+          w->writeText(fmt::sprintf(" %d %d", oldFreq, wait_tempo));
         }
+        oldFreq = freq;
+        wait_tempo = 0;
       }
+      totalWait--;
+      tickCount++;
     }
+  }
 
-    if (!grubExportBin) w->writeText(fmt::sprintf("\n")); // end song
-    // end of song
-
-    // done - close out.
-    e->got.rate=origRate;
-    e->disCont[BEEPER].dispatch->getRegisterWrites().clear();
-    e->disCont[BEEPER].dispatch->toggleRegisterDump(false);
-
-    e->remainingLoops=-1;
-    e->playing=false;
-    e->freelance=false;
-    e->extValuePresent=false;
-
-    output.push_back(DivROMExportOutput(grubExportBin?"export.bin":"export.txt",w));
-  });
+  if (!grubExportBin) w->writeText(fmt::sprintf("\n")); // end song
+  // end of song
 
+  output.push_back(DivROMExportOutput(grubExportBin?"export.bin":"export.txt",w));
 
   progress[0].amount=1.0f;
   
@@ -61,91 +61,51 @@ void DivExportiPod::run() {
 
   double rate = 1000.0;
 
-  e->stop();
-  e->repeatPattern=false;
-  e->setOrder(0);
-
   logAppend("playing and logging register writes...");
 
   int oldFreq = 0;
   int freq = 0;
 
-  e->synchronizedSoft([&]() {
-    double origRate = e->got.rate;
-    e->got.rate=rate;
-
-    // Determine loop point.
-    e->calcSongTimestamps();
-    int loopOrder=e->curSubSong->ts.loopStart.order;
-    int loopRow=e->curSubSong->ts.loopStart.row;
-    logAppendf("loop point: %d %d",loopOrder,loopRow);
-    e->warnings="";
-
-    auto w = new SafeWriter;
-    w->init(); 
-
-    w->writeText(fmt::sprintf("%s\n", e->song.name));
-
-    // Reset the playback state.
-    e->curOrder=0;
-    e->freelance=false;
-    e->playing=false;
-    e->extValuePresent=false;
-    e->remainingLoops=-1;
-
-    e->disCont[BEEPER].dispatch->toggleRegisterDump(true);
-
-    // Prepare to write song data.
-    e->playSub(false);
-    bool done=false;
-
-    logAppend("writing data...");
-    progress[0].amount=0.15f;
-
-    int wait_ms = 0;
-
-    while (!done) {
-      if (e->nextTick(false,true) || !e->playing) {
-        done=true;
+  std::shared_ptr<const DivRegisterTrace> trace=e->getRegisterTrace();
+  logAppendf("loop point: %d %d",trace->loopOrder,trace->loopRow);
+  DivRegisterTraceClock clock(rate);
+  int chipClock = e->disCont[BEEPER].dispatch->chipClock;
+
+  auto w = new SafeWriter;
+  w->init(); 
+
+  w->writeText(fmt::sprintf("%s\n", e->song.name));
+
+  logAppend("writing data...");
+  progress[0].amount=0.15f;
+
+  int wait_ms = 0;
+
+  // the last tick belongs to the loop
+  size_t traceTicks=trace->getTickCount();
+  for (size_t i=0; i+1<traceTicks; i++) {
+    // get register dumps
+    const unsigned char* regPool = trace->getPool(BEEPER,i);
+    freq = (regPool==NULL)?0:(int)(regPool[0]|(regPool[1]<<8));
+    if (freq > 0) freq = chipClock/freq;
+
+    // write wait
+    tickCount++;
+    int totalWait=clock.advance(*trace,i);
+    while (totalWait>0) {
+      wait_ms++;
+      if (freq != oldFreq) {
+        w->writeText(fmt::sprintf("%d %d\n", oldFreq, wait_ms));
+        oldFreq = freq;
+        wait_ms = 0;
       }
-
-      // get register dumps
-      uint8_t* regPool = e->disCont[BEEPER].dispatch->getRegisterPool();
-      int chipClock = e->disCont[BEEPER].dispatch->chipClock;
-      freq = (int)(regPool[0]|(regPool[1]<<8));
-      if (freq > 0) freq = chipClock/freq;
-
-      // write wait
+      totalWait--;
       tickCount++;
-      int totalWait=e->cycles;
-      if (totalWait>0 && !done) {
-        while (totalWait) {
-          wait_ms++;
-          if (freq != oldFreq) {
-            w->writeText(fmt::sprintf("%d %d\n", oldFreq, wait_ms));
-            oldFreq = freq;
-            wait_ms = 0;
-          }
-          totalWait--;
-          tickCount++;
-        }
-      }
     }
-    // end of song
-
-    // done - close out.
-    e->got.rate=origRate;
-    e->disCont[BEEPER].dispatch->getRegisterWrites().clear();
-    e->disCont[BEEPER].dispatch->toggleRegisterDump(false);
-
-    e->remainingLoops=-1;
-    e->playing=false;
-    e->freelance=false;
-    e->extValuePresent=false;
-
-    output.push_back(DivROMExportOutput("export.tone",w));
-  });
+  }
+  // end of song
 
+  output.push_back(DivROMExportOutput("export.tone",w));
 
   progress[0].amount=1.0f;
   
@@ -81,76 +81,40 @@ void DivExportSAPR::run() {
   double sapRate = (palTiming?50:60) * (double)scanlinesPerFrame / (double)sapScanlines;
 
 
-  e->stop();
-  e->repeatPattern=false;
-  e->setOrder(0);
-
   logAppend("playing and logging register writes...");
 
-  e->synchronizedSoft([&]() {
-    double origRate = e->got.rate;
-    e->got.rate=sapRate;
-
-    // Determine loop point.
-    e->calcSongTimestamps();
-    int loopOrder=e->curSubSong->ts.loopStart.order;
-    int loopRow=e->curSubSong->ts.loopStart.row;
-    logAppendf("loop point: %d %d",loopOrder,loopRow);
-    e->warnings="";
-
-    // Reset the playback state.
-    e->curOrder=0;
-    e->freelance=false;
-    e->playing=false;
-    e->extValuePresent=false;
-    e->remainingLoops=-1;
-
-    // Prepare to write song data.
-    e->playSub(false);
-    bool done=false;
-    e->disCont[POKEY].dispatch->toggleRegisterDump(true);
-    std::array<uint8_t, 9> currRegs;
-
-    while (!done) {
-      if (e->nextTick(false,true) || !e->playing) {
-        done=true;
-        for (int i=0; i<e->song.systemLen; i++) {
-          e->disCont[i].dispatch->getRegisterWrites().clear();
-        }
-        break;
-      }
-      // get register dumps
-      std::vector<DivRegWrite>& writes=e->disCont[POKEY].dispatch->getRegisterWrites();
-      if (writes.size() > 0) {
-        logAppendf("saprOps: found %d messages",writes.size());
-        for (DivRegWrite& write: writes)
-          if ((write.addr & 0xF) < 9)
-            currRegs[write.addr & 0xF] = write.val;
-        writes.clear();
-      }
+  std::shared_ptr<const DivRegisterTrace> trace=e->getRegisterTrace();
+  logAppendf("loop point: %d %d",trace->loopOrder,trace->loopRow);
+
+  DivRegisterTraceClock clock(sapRate);
+  std::array<uint8_t, 9> currRegs;
+  currRegs.fill(0);
+
+  // the last tick belongs to the loop
+  size_t traceTicks=trace->getTickCount();
+  for (size_t i=0; i+1<traceTicks; i++) {
+    // get register dumps
+    size_t found=0;
+    for (unsigned int j=trace->tickFirstWrite[i]; j<trace->tickFirstWrite[i+1]; j++) {
+      if (trace->writeChip[j]!=POKEY) continue;
+      found++;
+      if ((trace->writeAddr[j] & 0xF) < 9)
+        currRegs[trace->writeAddr[j] & 0xF] = trace->writeVal[j];
+    }
+    if (found>0) {
+      logAppendf("saprOps: found %d messages",(int)found);
+    }
 
-      // write wait
+    // write wait
+    tickCount++;
+    int totalWait=clock.advance(*trace,i);
+    while (totalWait>0) {
+      regs.push_back(currRegs);
+      totalWait--;
       tickCount++;
-      int totalWait=e->cycles;
-      if (totalWait>0 && !done) {
-        while (totalWait) {
-          regs.push_back(currRegs);
-          totalWait--;
-          tickCount++;
-        }
-      }
     }
-    // end of song
-
-    // done - close out.
-    e->got.rate=origRate;
-    e->disCont[POKEY].dispatch->toggleRegisterDump(false);
-
-    e->remainingLoops=-1;
-    e->playing=false;
-    e->freelance=false;
-    e->extValuePresent=false;
-  });
+  }
+  // end of song
 
   logAppend("writing data...");
   progress[0].amount=0.95f;
@@ -192,143 +192,119 @@ void DivExportTiuna::run() {
   int otherBankSize=conf.getInt("otherBankSize",4096-48);
   int tiaIdx=conf.getInt("sysToExport",-1);
 
-  e->stop();
-  e->repeatPattern=false;
-  e->shallStop=false;
-  e->setOrder(0);
-  e->synchronizedSoft([&]() {
-    // determine loop point
-    // bool stopped=false;
-    e->calcSongTimestamps();
-    loopOrder=e->curSubSong->ts.loopStart.order;
-    loopOrderRow=e->curSubSong->ts.loopStart.row;
-    logAppendf("loop point: %d %d",loopOrder,loopOrderRow);
-
-    w=new SafeWriter;
-    w->init();
-
-    if (tiaIdx<0 || tiaIdx>=e->song.systemLen) {
-      tiaIdx=-1;
-      for (int i=0; i<e->song.systemLen; i++) {
-        if (e->song.system[i]==DIV_SYSTEM_TIA) {
-          tiaIdx=i;
-          break;
-        }
-      }
-      if (tiaIdx<0) {
-        logAppend("ERROR: selected TIA system not found");
-        failed=true;
-        running=false;
-        return;
+  if (tiaIdx<0 || tiaIdx>=e->song.systemLen) {
+    tiaIdx=-1;
+    for (int i=0; i<e->song.systemLen; i++) {
+      if (e->song.system[i]==DIV_SYSTEM_TIA) {
+        tiaIdx=i;
+        break;
       }
-    } else if (e->song.system[tiaIdx]!=DIV_SYSTEM_TIA) {
-      logAppend("ERROR: selected chip is not a TIA!");
+    }
+    if (tiaIdx<0) {
+      logAppend("ERROR: selected TIA system not found");
       failed=true;
       running=false;
       return;
     }
+  } else if (e->song.system[tiaIdx]!=DIV_SYSTEM_TIA) {
+    logAppend("ERROR: selected chip is not a TIA!");
+    failed=true;
+    running=false;
+    return;
+  }
 
-    e->disCont[tiaIdx].dispatch->toggleRegisterDump(true);
+  // write patterns
+  // bool writeLoop=false;
+  logAppend("recording sequence...");
+  std::shared_ptr<const DivRegisterTrace> trace=e->getRegisterTrace();
+  // bool stopped=trace->stopped;
+  loopOrder=trace->loopOrder;
+  loopOrderRow=trace->loopRow;
+  logAppendf("loop point: %d %d",loopOrder,loopOrderRow);
 
-    // write patterns
-    // bool writeLoop=false;
-    logAppend("recording sequence...");
-    bool done=false;
-    e->playSub(false);
-    
-    // int loopTick=-1;
-    TiunaLast last[2];
-    TiunaNew news[2];
-    while (!done) {
-      // TODO implement loop
-      // if (loopTick<0 && loopOrder==curOrder && loopOrderRow==curRow
-      //   && (ticks-((tempoAccum+virtualTempoN)/virtualTempoD))<=0
-      // ) {
-      //   writeLoop=true;
-      //   loopTick=tick;
-      //   // invalidate last register state so it always force an absolute write after loop
-      //   for (int i=0; i<2; i++) {
-      //     last[i]=TiunaLast();
-      //     last[i].pitch=-1;
-      //     last[i].ins=-1;
-      //     last[i].vol=-1;
-      //   }
-      // }
-      if (e->nextTick(false,true) || !e->playing) {
-        // stopped=!playing;
-        done=true;
-        break;
-      }
-      for (int i=0; i<2; i++) {
-        news[i]=TiunaNew();
+  w=new SafeWriter;
+  w->init();
+
+  // int loopTick=-1;
+  TiunaLast last[2];
+  TiunaNew news[2];
+  // the last tick belongs to the loop
+  size_t traceTicks=trace->getTickCount();
+  for (size_t t=0; t+1<traceTicks; t++) {
+    // TODO implement loop
+    // if (loopTick<0 && loopOrder==trace->tickOrder[t] && loopOrderRow==trace->tickRow[t]
+    //   && trace->tickTicks[t]<=1
+    // ) {
+    //   writeLoop=true;
+    //   loopTick=tick;
+    //   // invalidate last register state so it always force an absolute write after loop
+    //   for (int i=0; i<2; i++) {
+    //     last[i]=TiunaLast();
+    //     last[i].pitch=-1;
+    //     last[i].ins=-1;
+    //     last[i].vol=-1;
+    //   }
+    // }
+    for (int i=0; i<2; i++) {
+      news[i]=TiunaNew();
+    }
+    // get register dumps (the first tick includes the writes made when starting playback)
+    for (unsigned int j=(t==0)?0:trace->tickFirstWrite[t]; j<trace->tickFirstWrite[t+1]; j++) {
+      if (trace->writeChip[j]!=tiaIdx) continue;
+      unsigned int addr=trace->writeAddr[j];
+      unsigned int val=trace->writeVal[j];
+      switch (addr) {
+        case 0xfffe0000:
+        case 0xfffe0001:
+          news[addr&1].pitch=val;
+          break;
+        case 0xfffe0002:
+          news[0].sync=val;
+          break;
+        case 0x15:
+        case 0x16:
+          news[addr-0x15].ins=val;
+          break;
+        case 0x19:
+        case 0x1a:
+          news[addr-0x19].vol=val;
+          break;
+        default: break;
       }
-      // get register dumps
-      std::vector<DivRegWrite>& writes=e->disCont[tiaIdx].dispatch->getRegisterWrites();
-      for (const DivRegWrite& i: writes) {
-        switch (i.addr) {
-          case 0xfffe0000:
-          case 0xfffe0001:
-            news[i.addr&1].pitch=i.val;
-            break;
-          case 0xfffe0002:
-            news[0].sync=i.val;
-            break;
-          case 0x15:
-          case 0x16:
-            news[i.addr-0x15].ins=i.val;
-            break;
-          case 0x19:
-          case 0x1a:
-            news[i.addr-0x19].vol=i.val;
-            break;
-          default: break;
+    }
+    // collect changes
+    for (int i=0; i<2; i++) {
+      TiunaCmd cmds;
+      bool hasCmd=false;
+      if (news[i].pitch>=0 && (last[i].forcePitch || news[i].pitch!=last[i].pitch)) {
+        int dt=news[i].pitch-last[i].pitch;
+        if (!last[i].forcePitch && abs(dt)<=16) {
+          if (dt<0) cmds.pitchChange=15-dt;
+          else cmds.pitchChange=dt-1;
         }
+        else cmds.pitchSet=news[i].pitch;
+        last[i].pitch=news[i].pitch;
+        last[i].forcePitch=false;
+        hasCmd=true;
       }
-      writes.clear();
-      // collect changes
-      for (int i=0; i<2; i++) {
-        TiunaCmd cmds;
-        bool hasCmd=false;
-        if (news[i].pitch>=0 && (last[i].forcePitch || news[i].pitch!=last[i].pitch)) {
-          int dt=news[i].pitch-last[i].pitch;
-          if (!last[i].forcePitch && abs(dt)<=16) {
-            if (dt<0) cmds.pitchChange=15-dt;
-            else cmds.pitchChange=dt-1;
-          }
-          else cmds.pitchSet=news[i].pitch;
-          last[i].pitch=news[i].pitch;
-          last[i].forcePitch=false;
-          hasCmd=true;
-        }
-        if (news[i].ins>=0 && news[i].ins!=last[i].ins) {
-          cmds.ins=news[i].ins;
-          last[i].ins=news[i].ins;
-          hasCmd=true;
-        }
-        if (news[i].vol>=0 && news[i].vol!=last[i].vol) {
-          cmds.vol=(news[i].vol-last[i].vol)&0xf;
-          last[i].vol=news[i].vol;
-          hasCmd=true;
-        }
-        if (news[i].sync>=0) {
-          cmds.sync=news[i].sync;
-          hasCmd=true;
-        }
-        if (hasCmd) allCmds[i][tick]=cmds;
+      if (news[i].ins>=0 && news[i].ins!=last[i].ins) {
+        cmds.ins=news[i].ins;
+        last[i].ins=news[i].ins;
+        hasCmd=true;
       }
-      e->cmdStream.clear();
-      tick++;
-    }
-    for (int i=0; i<e->song.systemLen; i++) {
-      e->disCont[i].dispatch->getRegisterWrites().clear();
-      e->disCont[i].dispatch->toggleRegisterDump(false);
+      if (news[i].vol>=0 && news[i].vol!=last[i].vol) {
+        cmds.vol=(news[i].vol-last[i].vol)&0xf;
+        last[i].vol=news[i].vol;
+        hasCmd=true;
+      }
+      if (news[i].sync>=0) {
+        cmds.sync=news[i].sync;
+        hasCmd=true;
+      }
+      if (hasCmd) allCmds[i][tick]=cmds;
     }
-
-    e->remainingLoops=-1;
-    e->playing=false;
-    e->freelance=false;
-    e->extValuePresent=false;
-  });
+    tick++;
+  }
 
   if (failed) return;
 
@@ -566,140 +566,115 @@ void DivExportZSM::run() {
 
   DivZSM zsm;
 
-  e->stop();
-  e->repeatPattern=false;
-  e->setOrder(0);
-  e->synchronizedSoft([&]() {
-    double origRate=e->got.rate;
-    e->got.rate=zsmrate&0xffff;
-
-    // determine loop point
-    e->calcSongTimestamps();
-    int loopOrder=e->curSubSong->ts.loopStart.order;
-    int loopRow=e->curSubSong->ts.loopStart.row;
-    logAppendf("loop point: %d %d",loopOrder,loopRow);
-
-    zsm.init(zsmrate);
-
-    // reset the playback state
-    e->curOrder=0;
-    e->freelance=false;
-    e->playing=false;
-    e->extValuePresent=false;
-    e->remainingLoops=-1;
-
-    // Prepare to write song data
-    e->playSub(false);
-    //size_t tickCount=0;
-    bool done=false;
-    bool loopNow=false;
-    int loopPos=-1;
-    if (VERA>=0) e->disCont[VERA].dispatch->toggleRegisterDump(true);
-    if (YM>=0) {
-      e->disCont[YM].dispatch->toggleRegisterDump(true);
-      // emit LFO initialization commands
-      zsm.writeYM(0x18,0);    // freq=0
-      zsm.writeYM(0x19,0x7F); // AMD =7F
-      zsm.writeYM(0x19,0xFF); // PMD =7F
-      // TODO: incorporate the Furnace meta-command for init data and filter
-      //       out writes to otherwise-unused channels.
-    }
-    // Indicate the song's tuning as a sync meta-event
-    // specified in terms of how many 1/256th semitones
-    // the song is offset from standard A-440 tuning.
-    // This is mainly to benefit visualizations in players
-    // for non-standard tunings so that they can avoid
-    // displaying the entire song held in pitch bend.
-    // Tunings offsets that exceed a half semitone
-    // will simply be represented in a different key
-    // by nature of overflowing the signed char value
-    signed char tuningoffset=(signed char)(round(3072*(log(e->song.tuning/440.0)/log(2))))&0xff;
-    zsm.writeSync(0x01,tuningoffset);
-    // Set optimize flag, which mainly buffers PSG writes
-    // whenever the channel is silent
-    zsm.setOptimize(optimize);
-
-    while (!done) {
-      if (loopPos==-1) {
-        if (loopOrder==e->curOrder && loopRow==e->curRow && loop)
-          loopNow=true;
-        if (loopNow) {
-          // If Virtual Tempo is in use, our exact loop point
-          // might be skipped due to quantization error.
-          // If this happens, the tick immediately following is our loop point.
-          if (e->ticks==1 || !(loopOrder==e->curOrder && loopRow==e->curRow)) {
-            loopPos=zsm.getoffset();
-            zsm.setLoopPoint();
-            loopNow=false;
-          }
+  std::shared_ptr<const DivRegisterTrace> trace=e->getRegisterTrace();
+  int loopOrder=trace->loopOrder;
+  int loopRow=trace->loopRow;
+  logAppendf("loop point: %d %d",loopOrder,loopRow);
+
+  zsm.init(zsmrate);
+
+  // Prepare to write song data
+  DivRegisterTraceClock clock(zsmrate&0xffff);
+  //size_t tickCount=0;
+  bool done=false;
+  bool loopNow=false;
+  int loopPos=-1;
+  if (YM>=0) {
+    // emit LFO initialization commands
+    zsm.writeYM(0x18,0);    // freq=0
+    zsm.writeYM(0x19,0x7F); // AMD =7F
+    zsm.writeYM(0x19,0xFF); // PMD =7F
+    // TODO: incorporate the Furnace meta-command for init data and filter
+    //       out writes to otherwise-unused channels.
+  }
+  // Indicate the song's tuning as a sync meta-event
+  // specified in terms of how many 1/256th semitones
+  // the song is offset from standard A-440 tuning.
+  // This is mainly to benefit visualizations in players
+  // for non-standard tunings so that they can avoid
+  // displaying the entire song held in pitch bend.
+  // Tunings offsets that exceed a half semitone
+  // will simply be represented in a different key
+  // by nature of overflowing the signed char value
+  signed char tuningoffset=(signed char)(round(3072*(log(e->song.tuning/440.0)/log(2))))&0xff;
+  zsm.writeSync(0x01,tuningoffset);
+  // Set optimize flag, which mainly buffers PSG writes
+  // whenever the channel is silent
+  zsm.setOptimize(optimize);
+
+  size_t traceTicks=trace->getTickCount();
+  for (size_t t=0; t<traceTicks; t++) {
+    int curOrder=trace->tickOrder[t];
+    int curRow=trace->tickRow[t];
+    if (loopPos==-1) {
+      if (loopOrder==curOrder && loopRow==curRow && loop)
+        loopNow=true;
+      if (loopNow) {
+        // If Virtual Tempo is in use, our exact loop point
+        // might be skipped due to quantization error.
+        // If this happens, the tick immediately following is our loop point.
+        if (trace->tickTicks[t]==1 || !(loopOrder==curOrder && loopRow==curRow)) {
+          loopPos=zsm.getoffset();
+          zsm.setLoopPoint();
+          loopNow=false;
         }
       }
-      if (e->nextTick() || !e->playing) {
-        done=true;
-        if (!loop) {
-          for (int i=0; i<e->song.systemLen; i++) {
-            e->disCont[i].dispatch->getRegisterWrites().clear();
-          }
-          break;
-        }
-        if (!e->playing) {
-          loopPos=-1;
+    }
+    if (t+1>=traceTicks) {
+      done=true;
+      if (!loop) {
+        break;
+      }
+      if (trace->stopped) {
+        loopPos=-1;
+      }
+    }
+    // get register dumps
+    for (int j=0; j<2; j++) {
+      int i=0;
+      // dump YM writes first
+      if (j==0) {
+        if (YM<0) {
+          continue;
+        } else {
+          i=YM;
         }
       }
-      // get register dumps
-      for (int j=0; j<2; j++) {
-        int i=0;
-        // dump YM writes first
-        if (j==0) {
-          if (YM<0) {
-            continue;
-          } else {
-            i=YM;
-          }
+      // dump VERA writes second
+      if (j==1) {
+        if (VERA<0) {
+          continue;
+        } else {
+          i=VERA;
         }
-        // dump VERA writes second
-        if (j==1) {
-          if (VERA<0) {
-            continue;
-          } else {
-            i=VERA;
-          }
+      }
+      int count=0;
+      for (unsigned int k=trace->tickFirstWrite[t]; k<trace->tickFirstWrite[t+1]; k++) {
+        if (trace->writeChip[k]!=i) continue;
+        unsigned int addr=trace->writeAddr[k];
+        unsigned int val=trace->writeVal[k];
+        count++;
+        if (i==YM) {
+          if (done && addr==0x08 && (val&0x78)>0) continue; // don't process keydown on lookahead
+          zsm.writeYM(addr&0xff,val);
         }
-        std::vector<DivRegWrite>& writes=e->disCont[i].dispatch->getRegisterWrites();
-        if (writes.size()>0)
-          logD("zsmOps: Writing %d messages to chip %d",writes.size(),i);
-        for (DivRegWrite& write: writes) {
-          if (i==YM) {
-            if (done && write.addr==0x08 && (write.val&0x78)>0) continue; // don't process keydown on lookahead
-            zsm.writeYM(write.addr&0xff,write.val);
-          }
-          if (i==VERA) {
-            if (done && write.addr>=64) continue; // don't process any PCM or sync events on the loop lookahead
-            zsm.writePSG(write.addr&0xff,write.val);
-          }
+        if (i==VERA) {
+          if (done && addr>=64) continue; // don't process any PCM or sync events on the loop lookahead
+          zsm.writePSG(addr&0xff,val);
         }
-        writes.clear();
       }
+      if (count>0)
+        logD("zsmOps: Writing %d messages to chip %d",count,i);
+    }
 
-      // write wait
-      int totalWait=e->cycles;
-      if (totalWait>0 && !done) {
-        zsm.tick(totalWait);
-        //tickCount+=totalWait;
-      }
+    // write wait
+    int totalWait=clock.advance(*trace,t);
+    if (totalWait>0 && !done) {
+      zsm.tick(totalWait);
+      //tickCount+=totalWait;
     }
-    // end of song
-
-    // done - close out.
-    e->got.rate=origRate;
-    if (VERA>=0) e->disCont[VERA].dispatch->toggleRegisterDump(false);
-    if (YM>=0) e->disCont[YM].dispatch->toggleRegisterDump(false);
-
-    e->remainingLoops=-1;
-    e->playing=false;
-    e->freelance=false;
-    e->extValuePresent=false;
-  });
+  }
+  // end of song
 
   progress[0].amount=1.0f;
 
@@ -20,6 +20,7 @@
 #include "engine.h"
 
 DivROMExportDef* DivEngine::romExportDefs[DIV_ROM_MAX];
+bool DivEngine::romExportsRegistered=false;
 
 const DivROMExportDef* DivEngine::getROMExportDef(DivROMExportOptions opt) {
   return romExportDefs[opt];
@@ -142,4 +143,6 @@ void DivEngine::registerROMExports() {
     },
     false, DIV_REQPOL_ANY
   );
+
+  romExportsRegistered=true;
 }
@@ -0,0 +1,39 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "fftPlan.h"
+#include <mutex>
+
+static std::mutex planLock;
+
+fftw_plan divPlanR2C(int n, double* in, fftw_complex* out) {
+  std::lock_guard<std::mutex> lock(planLock);
+  return fftw_plan_dft_r2c_1d(n,in,out,FFTW_ESTIMATE);
+}
+
+fftw_plan divPlanC2R(int n, fftw_complex* in, double* out) {
+  std::lock_guard<std::mutex> lock(planLock);
+  return fftw_plan_dft_c2r_1d(n,in,out,FFTW_ESTIMATE);
+}
+
+void divDestroyPlan(fftw_plan plan) {
+  if (plan==NULL) return;
+  std::lock_guard<std::mutex> lock(planLock);
+  fftw_destroy_plan(plan);
+}
@@ -0,0 +1,33 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _FFT_PLAN_H
+#define _FFT_PLAN_H
+
+#include <fftw3.h>
+
+// FFTW's planner is not thread-safe (only fftw_execute() is), and plans are
+// made by the GUI, the audio analyzer and effects on different threads.
+// these create and destroy plans with a global lock held.
+
+fftw_plan divPlanR2C(int n, double* in, fftw_complex* out);
+fftw_plan divPlanC2R(int n, fftw_complex* in, double* out);
+void divDestroyPlan(fftw_plan plan);
+
+#endif
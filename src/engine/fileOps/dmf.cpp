@@ -682,7 +682,7 @@ bool DivEngine::loadDMF(unsigned char* file, size_t len) {
               ins->std.algMacro.val[j]=-(ins->std.volMacro.val[j]-18);
             }
             ins->std.volMacro.len=0;
-            memset(ins->std.volMacro.val,0,256*sizeof(int));
+            ins->std.volMacro.val.clear();
           }
           for (int j=0; j<ins->std.dutyMacro.len; j++) {
             ins->std.dutyMacro.val[j]-=12;
@@ -1097,7 +1097,7 @@ bool DivEngine::loadDMF(unsigned char* file, size_t len) {
           i->std.waveMacro.loop=i->std.dutyMacro.loop;
           i->std.waveMacro.mode=i->std.dutyMacro.mode;
           i->std.waveMacro.open=i->std.dutyMacro.open;
-          memcpy(i->std.waveMacro.val,i->std.dutyMacro.val,sizeof(i->std.waveMacro.val));
+          i->std.waveMacro.val=i->std.dutyMacro.val;
           for (int j=0; j<i->std.waveMacro.len; j++) {
             i->std.waveMacro.val[j]++;
           }
@@ -1191,6 +1191,7 @@ bool DivEngine::loadDMF(unsigned char* file, size_t len) {
     saveLock.lock();
     song.unload();
     song=ds;
+    compactMacros();
     hasLoadedSomething=true;
     changeSong(0);
     // always convert to normal sample mode (I have no idea how will I do export)
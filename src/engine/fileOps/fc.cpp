@@ -672,6 +672,7 @@ bool DivEngine::loadFC(unsigned char* file, size_t len) {
     saveLock.lock();
     song.unload();
     song=ds;
+    compactMacros();
     hasLoadedSomething=true;
     changeSong(0);
     saveLock.unlock();
@@ -2827,6 +2827,7 @@ bool DivEngine::loadFTM(unsigned char* file, size_t len, bool dnft, bool dnft_si
     saveLock.lock();
     song.unload();
     song=ds;
+    compactMacros();
     hasLoadedSomething=true;
     changeSong(0);
     saveLock.unlock();
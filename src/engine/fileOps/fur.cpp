@@ -2434,6 +2434,7 @@ bool DivEngine::loadFur(unsigned char* file, size_t len, int variantID) {
     saveLock.lock();
     song.unload();
     song=ds;
+    compactMacros();
     hasLoadedSomething=true;
     changeSong(0);
     // removal of legacy sample mode
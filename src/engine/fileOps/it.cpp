@@ -1705,6 +1705,7 @@ bool DivEngine::loadIT(unsigned char* file, size_t len) {
     saveLock.lock();
     song.unload();
     song=ds;
+    compactMacros();
     hasLoadedSomething=true;
     changeSong(0);
     saveLock.unlock();
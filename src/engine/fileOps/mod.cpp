@@ -440,6 +440,7 @@ bool DivEngine::loadMod(unsigned char* file, size_t len) {
     saveLock.lock();
     song.unload();
     song=ds;
+    compactMacros();
     hasLoadedSomething=true;
     changeSong(0);
     saveLock.unlock();
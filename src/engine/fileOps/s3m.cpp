@@ -1217,6 +1217,7 @@ bool DivEngine::loadS3M(unsigned char* file, size_t len) {
     saveLock.lock();
     song.unload();
     song=ds;
+    compactMacros();
     hasLoadedSomething=true;
     changeSong(0);
     saveLock.unlock();
@@ -395,7 +395,7 @@ void DivEngine::loadDMP(SafeReader& reader, std::vector<DivInstrument*>& ret, St
             ins->std.algMacro.val[j]=-(ins->std.volMacro.val[j]-18);
           }
           ins->std.volMacro.len=0;
-          memset(ins->std.volMacro.val,0,256*sizeof(int));
+          ins->std.volMacro.val.clear();
         }
         for (int j=0; j<ins->std.dutyMacro.len; j++) {
           ins->std.dutyMacro.val[j]-=12;
@@ -2110,5 +2110,8 @@ std::vector<DivInstrument*> DivEngine::instrumentFromFile(const char* path, bool
   }
 
   delete[] buf; // since we're done with this buffer
+  for (DivInstrument* i: ret) {
+    i->compactMacros();
+  }
   return ret;
 }
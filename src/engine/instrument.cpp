@@ -25,6 +25,185 @@
 
 const DivInstrument defaultIns;
 
+/// macro storage
+
+// storage is freed once every reader which was in a read section when it was
+// released has left it. sections are tagged with the release epoch at their
+// beginning, and released storage with the epoch after its release.
+// storage may be shared between instruments of different engines, so this
+// waits for all of them.
+struct DivMacroReleased {
+  void* block;
+  uint64_t epoch;
+  DivMacroReleased(void* b, uint64_t e):
+    block(b),
+    epoch(e) {}
+};
+
+static std::mutex macroReleasedLock;
+static std::vector<DivMacroReleased> macroReleased;
+static std::vector<DivMacroReader*> macroReaders;
+static std::atomic<size_t> macroReleasedCount(0);
+static std::atomic<uint64_t> macroEpoch(1);
+
+void DivMacroReader::begin() {
+  if (depth++>0) return;
+  epoch.store(macroEpoch.load());
+  // pairs with the one in collect(), so that either collect() sees this
+  // section or the section sees the new storage
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void DivMacroReader::end() {
+  if (--depth>0) return;
+  epoch.store(0,std::memory_order_release);
+}
+
+DivMacroReader::DivMacroReader():
+  epoch(0),
+  depth(0) {
+  std::lock_guard<std::mutex> lock(macroReleasedLock);
+  macroReaders.push_back(this);
+}
+
+DivMacroReader::~DivMacroReader() {
+  std::lock_guard<std::mutex> lock(macroReleasedLock);
+  for (size_t i=0; i<macroReaders.size(); i++) {
+    if (macroReaders[i]==this) {
+      macroReaders.erase(macroReaders.begin()+i);
+      break;
+    }
+  }
+}
+
+DivMacroValues::Block* DivMacroValues::newBlock(int cap) {
+  unsigned char* mem=new unsigned char[sizeof(Block)+cap*sizeof(int)];
+  Block* b=new (mem) Block;
+  b->refs=1;
+  b->cap=cap;
+  memset(mem+sizeof(Block),0,cap*sizeof(int));
+  return b;
+}
+
+void DivMacroValues::release(Block* b) {
+  if (b==NULL) return;
+  if (b->refs.fetch_sub(1)!=1) return;
+  std::lock_guard<std::mutex> lock(macroReleasedLock);
+  // sections which begin from now on can't see this storage anymore
+  macroReleased.push_back(DivMacroReleased(b,++macroEpoch));
+  macroReleasedCount=macroReleased.size();
+}
+
+void DivMacroValues::collect() {
+  std::lock_guard<std::mutex> lock(macroReleasedLock);
+  if (macroReleased.empty()) return;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  // oldest section still running
+  uint64_t oldest=UINT64_MAX;
+  for (DivMacroReader* i: macroReaders) {
+    uint64_t e=i->epoch.load(std::memory_order_acquire);
+    if (e!=0 && e<oldest) oldest=e;
+  }
+
+  size_t kept=0;
+  for (DivMacroReleased& i: macroReleased) {
+    if (i.epoch<=oldest) {
+      ((Block*)i.block)->~Block();
+      delete[] (unsigned char*)i.block;
+    } else {
+      macroReleased[kept++]=i;
+    }
+  }
+  macroReleased.erase(macroReleased.begin()+kept,macroReleased.end());
+  macroReleasedCount=kept;
+}
+
+bool DivMacroValues::hasReleased() {
+  return macroReleasedCount>0;
+}
+
+int* DivMacroValues::data() {
+  Block* cur=block.load(std::memory_order_relaxed);
+  if (cur!=NULL && cur->cap==DIV_MACRO_VALS && cur->refs.load()==1) return blockData(cur);
+  Block* b=newBlock(DIV_MACRO_VALS);
+  if (cur!=NULL) {
+    memcpy(blockData(b),blockData(cur),MIN(cur->cap,DIV_MACRO_VALS)*sizeof(int));
+  }
+  block.store(b,std::memory_order_release);
+  release(cur);
+  return blockData(b);
+}
+
+void DivMacroValues::compact() {
+  Block* cur=block.load(std::memory_order_relaxed);
+  if (cur==NULL) return;
+  int newCap=cur->cap;
+  while (newCap>0 && blockData(cur)[newCap-1]==0) newCap--;
+  if (newCap==cur->cap) return;
+  Block* b=NULL;
+  if (newCap>0) {
+    b=newBlock(newCap);
+    memcpy(blockData(b),blockData(cur),newCap*sizeof(int));
+  }
+  block.store(b,std::memory_order_release);
+  release(cur);
+}
+
+void DivMacroValues::clear() {
+  Block* cur=block.load(std::memory_order_relaxed);
+  block.store(NULL,std::memory_order_release);
+  release(cur);
+}
+
+size_t DivMacroValues::getMemoryUsage() const {
+  Block* cur=block.load(std::memory_order_relaxed);
+  if (cur==NULL) return 0;
+  // shared storage is split between its users
+  return (sizeof(Block)+cur->cap*sizeof(int))/MAX(1,cur->refs.load());
+}
+
+bool DivMacroValues::operator==(const DivMacroValues& other) const {
+  Block* a=block.load(std::memory_order_relaxed);
+  Block* b=other.block.load(std::memory_order_relaxed);
+  if (a==b) return true;
+  int cap=MAX((a==NULL)?0:a->cap,(b==NULL)?0:b->cap);
+  for (int i=0; i<cap; i++) {
+    if ((*this)[i]!=other[i]) return false;
+  }
+  return true;
+}
+
+DivMacroValues& DivMacroValues::operator=(const DivMacroValues& other) {
+  Block* cur=block.load(std::memory_order_relaxed);
+  Block* b=other.block.load(std::memory_order_relaxed);
+  if (b==cur) return *this;
+  if (b!=NULL) b->refs++;
+  block.store(b,std::memory_order_release);
+  release(cur);
+  return *this;
+}
+
+DivMacroValues::DivMacroValues(const DivMacroValues& other):
+  block(other.block.load(std::memory_order_relaxed)) {
+  Block* b=block.load(std::memory_order_relaxed);
+  if (b!=NULL) b->refs++;
+}
+
+DivMacroValues::~DivMacroValues() {
+  release(block.load(std::memory_order_relaxed));
+}
+
+static_assert(sizeof(DivInstrumentSTD)==DIV_MACRO_COUNT*sizeof(DivInstrumentMacro),"DivInstrumentSTD must only contain macros");
+
+DivInstrumentMacro& DivInstrumentSTD::getMacro(int index) {
+  return ((DivInstrumentMacro*)this)[index];
+}
+
+const DivInstrumentMacro& DivInstrumentSTD::getMacro(int index) const {
+  return ((const DivInstrumentMacro*)this)[index];
+}
+
 /// instrument compilation
 
 #define WRITE_HEADER_COMMON \
@@ -858,53 +1037,229 @@ void MemPatch::applyAndReverse(void* target, size_t targetSize) {
   }
 }
 
+#define INS_STD_BEGIN offsetof(DivInstrumentPOD,std)
+#define INS_STD_END (offsetof(DivInstrumentPOD,std)+sizeof(DivInstrumentSTD))
+// offset of a macro's value handle in DivInstrumentPOD
+#define INS_MACRO_VAL(k) (INS_STD_BEGIN+(k)*sizeof(DivInstrumentMacro)+offsetof(DivInstrumentMacro,val))
+
+// macro values live outside the POD, so their handles are never patched as
+// bytes. this finds the next handle in a range (which must not split one).
+// @return the end of the bytes before it (or the range end if there is none).
+static size_t nextMacroVal(size_t pos, size_t end, int& k) {
+  k=-1;
+  if (pos>=INS_STD_END || end<=INS_STD_BEGIN) return end;
+  size_t index=0;
+  if (pos>INS_MACRO_VAL(0)) {
+    index=(pos-INS_MACRO_VAL(0)+sizeof(DivInstrumentMacro)-1)/sizeof(DivInstrumentMacro);
+  }
+  if (index>=DIV_MACRO_COUNT || INS_MACRO_VAL(index)>=end) return end;
+  k=index;
+  return INS_MACRO_VAL(index);
+}
+
+static inline DivMacroValues& podMacroVal(unsigned char* pod, int k) {
+  return ((DivInstrumentPOD*)pod)->std.getMacro(k).val;
+}
+
+static inline const DivMacroValues& podMacroVal(const unsigned char* pod, int k) {
+  return ((const DivInstrumentPOD*)pod)->std.getMacro(k).val;
+}
+
+DivInstrumentUndoStep::~DivInstrumentUndoStep() {
+  for (MemPatch* i: podPatches) {
+    delete i;
+  }
+  podPatches.clear();
+}
+
 void DivInstrumentUndoStep::applyAndReverse(DivInstrument* target) {
   if (nameValid) {
     name.swap(target->name);
   }
-  podPatch.applyAndReverse((DivInstrumentPOD*)target, sizeof(DivInstrumentPOD));
+  unsigned char* targetBytes=(unsigned char*)(DivInstrumentPOD*)target;
+  // patches don't overlap, so order doesn't matter
+  for (MemPatch* i: podPatches) {
+    // leave macro value handles as they are
+    int k;
+    size_t pos=i->offset;
+    size_t end=i->offset+i->size;
+    while (pos<end) {
+      pos=nextMacroVal(pos,end,k);
+      if (k<0) break;
+      memcpy(i->data+(pos-i->offset),targetBytes+pos,sizeof(DivMacroValues));
+      pos+=sizeof(DivMacroValues);
+    }
+    i->applyAndReverse(targetBytes,sizeof(DivInstrumentPOD));
+  }
+  for (DivInstrumentMacroPatch& i: macroPatches) {
+    target->std.getMacro(i.index).val.swap(i.val);
+  }
+}
+
+bool DivInstrumentUndoStep::addRangePatch(const unsigned char* pre, const unsigned char* post, size_t offset, size_t len) {
+  size_t end=offset+len;
+  size_t firstDiff=end;
+  size_t lastDiff=0;
+  bool changed=false;
+
+  size_t pos=offset;
+  while (pos<end) {
+    int k;
+    size_t gapEnd=nextMacroVal(pos,end,k);
+    // early-out for the common case (no change)
+    if (gapEnd>pos && memcmp(pre+pos,post+pos,gapEnd-pos)!=0) {
+      for (size_t i=pos; i<gapEnd; i++) {
+        if (pre[i]!=post[i]) {
+          if (firstDiff==end) firstDiff=i;
+          lastDiff=i;
+        }
+      }
+    }
+    if (k<0) break;
+    if (podMacroVal(pre,k)!=podMacroVal(post,k)) {
+      macroPatches.push_back(DivInstrumentMacroPatch(k,podMacroVal(pre,k)));
+      changed=true;
+    }
+    pos=gapEnd+sizeof(DivMacroValues);
+  }
+
+  if (firstDiff<end) {
+    // the patch makes post into pre, so it holds pre's bytes
+    MemPatch* patch=new MemPatch;
+    patch->offset=firstDiff;
+    patch->size=lastDiff-firstDiff+1;
+    patch->data=new unsigned char[patch->size];
+    memcpy(patch->data,pre+firstDiff,patch->size);
+    podPatches.push_back(patch);
+    changed=true;
+  }
+  return changed;
 }
 
 bool DivInstrumentUndoStep::makeUndoPatch(size_t processTime_, const DivInstrument* pre, const DivInstrument* post) {
   processTime=processTime_;
 
   // create the patch that will make post into pre
-  podPatch.calcDiff((const DivInstrumentPOD*)post, (const DivInstrumentPOD*)pre, sizeof(DivInstrumentPOD));
+  addRangePatch((const unsigned char*)(const DivInstrumentPOD*)pre, (const unsigned char*)(const DivInstrumentPOD*)post, 0, sizeof(DivInstrumentPOD));
   if (pre->name!=post->name) {
     nameValid=true;
     name=pre->name;
   }
 
-  return nameValid || podPatch.isValid();
+  return nameValid || !podPatches.empty() || !macroPatches.empty();
+}
+
+void DivInstrument::pushUndoStep(DivInstrumentUndoStep* step) {
+  // make room
+  if (undoHist.size()>=undoHist.capacity()) {
+    delete undoHist.front();
+    undoHist.pop_front();
+  }
+
+  // clear redo
+  while (!redoHist.empty()) {
+    delete redoHist.back();
+    redoHist.pop_back();
+  }
+
+  undoHist.push_back(step);
 }
 
 bool DivInstrument::recordUndoStepIfChanged(size_t processTime, const DivInstrument* old) {
-  DivInstrumentUndoStep step;
+  DivInstrumentUndoStep* step=new DivInstrumentUndoStep;
 
   // generate a patch to go back to old
-  if (step.makeUndoPatch(processTime, old, this)) {
-    
-      // make room
-    if (undoHist.size()>=undoHist.capacity()) {
-      delete undoHist.front();
-      undoHist.pop_front();
-    }
+  if (step->makeUndoPatch(processTime, old, this)) {
+    pushUndoStep(step);
+    return true;
+  }
+
+  delete step;
+  return false;
+}
+
+DivInstrumentChangeTracker::~DivInstrumentChangeTracker() {
+  bind(NULL);
+}
 
-    // clear redo
-    while (!redoHist.empty()) {
-      delete redoHist.back();
-      redoHist.pop_back();
+void DivInstrumentChangeTracker::bind(DivInstrument* which) {
+  ins=which;
+  if (ins==NULL) {
+    if (shadow!=NULL) {
+      for (int i=0; i<DIV_MACRO_COUNT; i++) {
+        podMacroVal(shadow,i).~DivMacroValues();
+      }
+      delete[] shadow;
+      shadow=NULL;
     }
+    shadowName="";
+    return;
+  }
+  if (shadow==NULL) {
+    // all zeros is a valid (empty) macro value handle
+    shadow=new unsigned char[sizeof(DivInstrumentPOD)];
+    memset(shadow,0,sizeof(DivInstrumentPOD));
+  }
+  resync();
+}
+
+DivInstrument* DivInstrumentChangeTracker::getBound() {
+  return ins;
+}
+
+void DivInstrumentChangeTracker::resync() {
+  if (ins==NULL || shadow==NULL) return;
+  const unsigned char* cur=(const unsigned char*)(const DivInstrumentPOD*)ins;
+  for (int i=0; i<DIV_MACRO_COUNT; i++) {
+    podMacroVal(shadow,i).~DivMacroValues();
+  }
+  memcpy(shadow,cur,sizeof(DivInstrumentPOD));
+  // the shadow shares macro values with the instrument
+  for (int i=0; i<DIV_MACRO_COUNT; i++) {
+    new (&podMacroVal(shadow,i)) DivMacroValues(podMacroVal(cur,i));
+  }
+  shadowName=ins->name;
+}
 
-    DivInstrumentUndoStep* stepPtr=new DivInstrumentUndoStep;
-    *stepPtr=step;
-    step.podPatch.data=NULL; // don't let it delete the data ptr that's been copied!
-    undoHist.push_back(stepPtr);
+bool DivInstrumentChangeTracker::compareRange(DivInstrumentUndoStep* step, size_t offset, size_t len) {
+  const unsigned char* cur=(const unsigned char*)(const DivInstrumentPOD*)ins;
+  if (!step->addRangePatch(shadow,cur,offset,len)) return false;
+  // fold the changes back, keeping the shadow's handles valid
+  size_t pos=offset;
+  size_t end=offset+len;
+  while (pos<end) {
+    int k;
+    size_t gapEnd=nextMacroVal(pos,end,k);
+    memcpy(shadow+pos,cur+pos,gapEnd-pos);
+    if (k<0) break;
+    podMacroVal(shadow,k)=podMacroVal(cur,k);
+    pos=gapEnd+sizeof(DivMacroValues);
+  }
+  return true;
+}
+
+bool DivInstrumentChangeTracker::commit(size_t processTime) {
+  if (ins==NULL || shadow==NULL) return false;
+
+  DivInstrumentUndoStep* step=new DivInstrumentUndoStep;
+  step->processTime=processTime;
+
+  // macro values which share storage with the shadow are skipped without
+  // looking at them
+  compareRange(step,0,sizeof(DivInstrumentPOD));
+
+  if (ins->name!=shadowName) {
+    step->nameValid=true;
+    step->name=shadowName;
+    shadowName=ins->name;
+  }
 
-    // logI("DivInstrument::undoHist push (%u off, %u size)", stepPtr->podPatch.offset, stepPtr->podPatch.size);
+  if (step->nameValid || !step->podPatches.empty() || !step->macroPatches.empty()) {
+    ins->pushUndoStep(step);
     return true;
   }
 
+  delete step;
   return false;
 }
 
@@ -913,7 +1268,6 @@ int DivInstrument::undo() {
 
   DivInstrumentUndoStep* step=undoHist.back();
   undoHist.pop_back();
-  // logI("DivInstrument::undo (%u off, %u size)", step->podPatch.offset, step->podPatch.size);
   step->applyAndReverse(this);
 
   // make room
@@ -932,7 +1286,6 @@ int DivInstrument::redo() {
 
   DivInstrumentUndoStep* step = redoHist.back();
   redoHist.pop_back();
-  // logI("DivInstrument::redo (%u off, %u size)", step->podPatch.offset, step->podPatch.size);
   step->applyAndReverse(this);
 
   // make room
@@ -946,6 +1299,20 @@ int DivInstrument::redo() {
   return 1;
 }
 
+void DivInstrument::compactMacros() {
+  for (int i=0; i<DIV_MACRO_COUNT; i++) {
+    std.getMacro(i).val.compact();
+  }
+}
+
+size_t DivInstrument::getMacroMemoryUsage() const {
+  size_t ret=0;
+  for (int i=0; i<DIV_MACRO_COUNT; i++) {
+    ret+=std.getMacro(i).val.getMemoryUsage();
+  }
+  return ret;
+}
+
 void DivInstrument::writeMacro(SafeWriter* w, const DivInstrumentMacro& m) {
   if (!m.len) return;
 
@@ -3225,7 +3592,7 @@ DivDataErrors DivInstrument::readInsDataNew(SafeReader& reader, short version, b
 
   // <187 C64 cutoff macro compatibility
   if (type==DIV_INS_C64 && volIsCutoff && version<187) {
-    memcpy(&std.algMacro,&std.volMacro,sizeof(DivInstrumentMacro));
+    std.algMacro=std.volMacro;
     std.algMacro.macroType=DIV_MACRO_ALG;
     std.volMacro=DivInstrumentMacro(DIV_MACRO_VOL,true);
 
@@ -3989,7 +4356,7 @@ DivDataErrors DivInstrument::readInsDataOld(SafeReader &reader, short version) {
 
   // <187 C64 cutoff macro compatibility
   if (type==DIV_INS_C64 && volIsCutoff && version<187) {
-    memcpy(&std.algMacro,&std.volMacro,sizeof(DivInstrumentMacro));
+    std.algMacro=std.volMacro;
     std.algMacro.macroType=DIV_MACRO_ALG;
     std.volMacro=DivInstrumentMacro(DIV_MACRO_VOL,true);
 
@@ -4138,7 +4505,7 @@ bool DivInstrument::save(const char* path, DivSong* song, bool writeInsName) {
     w->finish();
     return false;
   }
-  if (fwrite(w->getFinalBuf(),1,w->size(),outFile)!=w->size()) {
+  if (!w->writeTo(outFile)) {
     logW("did not write entire instrument!");
   }
   fclose(outFile);
@@ -4330,7 +4697,7 @@ bool DivInstrument::saveDMP(const char* path) {
     w->finish();
     return false;
   }
-  if (fwrite(w->getFinalBuf(),1,w->size(),outFile)!=w->size()) {
+  if (!w->writeTo(outFile)) {
     logW("did not write entire instrument!");
   }
   fclose(outFile);
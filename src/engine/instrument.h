@@ -25,6 +25,7 @@
 #include "../pch.h"
 #include "../fixedQueue.h"
 #include <initializer_list>
+#include <atomic>
 
 struct DivSong;
 struct DivInstrument;
@@ -297,9 +298,142 @@ struct DivCompileMacroDef {
     type(t), format(f), minRange(x1), maxRange(x2) {}
 };
 
+// maximum macro length
+#define DIV_MACRO_VALS 256
+
+/**
+ * the values of a macro.
+ * only the used part is stored (values past it read as 0), and copies share
+ * their storage until one of them is written to (copy-on-write).
+ * data() (or the non-const operator[]) is the only way to write values. it
+ * gives the writer its own storage if it was shared, so a copy can tell
+ * whether values may have changed by comparing storage (see operator==).
+ * reading through a const reference never allocates, so the audio thread
+ * only reads macros that way.
+ * storage that is no longer used is freed by collect() once no DivMacroReader
+ * (the audio thread of an engine) may still be reading it.
+ */
+class DivMacroValues {
+  struct Block {
+    std::atomic<int> refs;
+    int cap;
+  };
+  // written by one thread only, but read by the audio thread
+  std::atomic<Block*> block;
+
+  static Block* newBlock(int cap);
+  static void release(Block* b);
+  static int* blockData(Block* b) {
+    return (int*)(b+1);
+  }
+
+  public:
+    const int& operator[](size_t index) const {
+      static const int zero=0;
+      Block* b=block.load(std::memory_order_acquire);
+      if (b==NULL || index>=(size_t)b->cap) return zero;
+      return blockData(b)[index];
+    }
+
+    int& operator[](size_t index) {
+      return data()[index];
+    }
+
+    /**
+     * get all DIV_MACRO_VALS values for writing.
+     * this makes the storage private and full-size.
+     */
+    int* data();
+
+    /**
+     * shrink storage to the last non-zero value.
+     */
+    void compact();
+
+    /**
+     * set all values to 0.
+     */
+    void clear();
+
+    /**
+     * get the number of bytes used by this macro's storage.
+     */
+    size_t getMemoryUsage() const;
+
+    bool operator==(const DivMacroValues& other) const;
+    bool operator!=(const DivMacroValues& other) const {
+      return !(*this==other);
+    }
+
+    void swap(DivMacroValues& other) {
+      Block* b=block.load(std::memory_order_relaxed);
+      block.store(other.block.load(std::memory_order_relaxed),std::memory_order_release);
+      other.block.store(b,std::memory_order_release);
+    }
+
+    /**
+     * free released storage which no reader may still be using.
+     * the rest is kept for a later call.
+     */
+    static void collect();
+
+    /**
+     * whether there is released storage to be freed.
+     */
+    static bool hasReleased();
+
+    DivMacroValues& operator=(const DivMacroValues& other);
+    DivMacroValues(const DivMacroValues& other);
+    DivMacroValues():
+      block(NULL) {}
+    ~DivMacroValues();
+};
+
+/**
+ * something which reads macro values while they may be replaced (an engine
+ * owns one of these, and enters a read section whenever it ticks).
+ * storage released while a read section is active is kept until it ends.
+ * sections may be nested. a reader must only be used by one thread at a time
+ * (for an engine this is whoever holds the engine lock).
+ */
+class DivMacroReader {
+  // release epoch when the outermost section began, or 0 if outside of one
+  std::atomic<uint64_t> epoch;
+  int depth;
+  friend class DivMacroValues;
+
+  public:
+    /**
+     * begin a read section (or enter a nested one).
+     */
+    void begin();
+
+    /**
+     * end a read section (or leave a nested one).
+     */
+    void end();
+
+    DivMacroReader();
+    ~DivMacroReader();
+};
+
+/**
+ * read section for the duration of a scope.
+ */
+struct DivMacroReadSection {
+  DivMacroReader& reader;
+  DivMacroReadSection(DivMacroReader& r):
+    reader(r) {
+    reader.begin();
+  }
+  ~DivMacroReadSection() {
+    reader.end();
+  }
+};
+
 // this is getting out of hand
 struct DivInstrumentMacro {
-  int val[256];
+  DivMacroValues val;
   unsigned int mode;
   unsigned char open;
   unsigned char len, delay, speed, loop, rel;
@@ -331,10 +465,12 @@ struct DivInstrumentMacro {
     loop(255),
     rel(255),
     macroType(initType) {
-    memset(val,0,256*sizeof(int));
   }
 };
 
+// number of macros in DivInstrumentSTD (including operator macros)
+#define DIV_MACRO_COUNT (22+4*20)
+
 struct DivInstrumentSTD {
   DivInstrumentMacro volMacro;
   DivInstrumentMacro arpMacro;
@@ -392,6 +528,12 @@ struct DivInstrumentSTD {
 
   DivInstrumentMacro* macroByType(DivMacroType type);
 
+  /**
+   * get a macro by its position in this struct (0 to DIV_MACRO_COUNT-1).
+   */
+  DivInstrumentMacro& getMacro(int index);
+  const DivInstrumentMacro& getMacro(int index) const;
+
   DivInstrumentSTD():
     volMacro(DIV_MACRO_VOL,true),
     arpMacro(DIV_MACRO_ARP),
@@ -1090,6 +1232,15 @@ struct MemPatch {
   size_t size;
 };
 
+// previous values of a macro (by index in DivInstrumentSTD)
+struct DivInstrumentMacroPatch {
+  int index;
+  DivMacroValues val;
+  DivInstrumentMacroPatch(int i, const DivMacroValues& v):
+    index(i),
+    val(v) {}
+};
+
 struct DivInstrumentUndoStep {
   DivInstrumentUndoStep():
     name(""),
@@ -1097,13 +1248,24 @@ struct DivInstrumentUndoStep {
     processTime(0) {
   }
 
-  MemPatch podPatch;
+  ~DivInstrumentUndoStep();
+
+  // disjoint patches over DivInstrumentPOD (macro values excluded)
+  std::vector<MemPatch*> podPatches;
+  std::vector<DivInstrumentMacroPatch> macroPatches;
   String name;
   bool nameValid;
   size_t processTime;
 
   void applyAndReverse(DivInstrument* target);
   bool makeUndoPatch(size_t processTime_, const DivInstrument* pre, const DivInstrument* post);
+  /**
+   * add a patch which makes post into pre, limited to a range of DivInstrumentPOD.
+   * pre and post point to the start of the POD.
+   * the range must not split a macro.
+   * @return whether the range differs.
+   */
+  bool addRangePatch(const unsigned char* pre, const unsigned char* post, size_t offset, size_t len);
 };
 
 struct DivInstrument: DivInstrumentPOD {
@@ -1132,9 +1294,20 @@ struct DivInstrument: DivInstrumentPOD {
   FixedQueue<DivInstrumentUndoStep*, 128> undoHist;
   FixedQueue<DivInstrumentUndoStep*, 128> redoHist;
   bool recordUndoStepIfChanged(size_t processTime, const DivInstrument* old);
+  void pushUndoStep(DivInstrumentUndoStep* step);
   int undo();
   int redo();
 
+  /**
+   * shrink macro value storage to the used part of every macro.
+   */
+  void compactMacros();
+
+  /**
+   * get the number of bytes used by macro values.
+   */
+  size_t getMacroMemoryUsage() const;
+
   /**
    * these are internal functions.
    */
@@ -1236,4 +1409,45 @@ struct DivInstrument: DivInstrumentPOD {
    */
   bool saveDMP(const char* path);
 };
+
+/**
+ * tracks edits to an instrument without keeping a full copy of it per edit.
+ * a shadow of the POD is taken on bind(). it shares macro values with the
+ * instrument, so no values are copied. any write to macro values (which must
+ * go through DivMacroValues::data()) gives the instrument its own storage,
+ * so commit() compares macro values only where storage differs. the rest of
+ * the POD is small and compared as bytes.
+ * changes become an undo step and are folded back into the shadow.
+ */
+class DivInstrumentChangeTracker {
+  DivInstrument* ins;
+  unsigned char* shadow;
+  String shadowName;
+
+  bool compareRange(DivInstrumentUndoStep* step, size_t offset, size_t len);
+
+  public:
+    /**
+     * start tracking an instrument (or stop tracking if NULL).
+     */
+    void bind(DivInstrument* which);
+    DivInstrument* getBound();
+
+    /**
+     * refresh the shadow copy after the instrument was changed outside of
+     * tracking (e.g. undo/redo).
+     */
+    void resync();
+
+    /**
+     * record an undo step if anything changed since the last commit.
+     * @return whether a step was recorded.
+     */
+    bool commit(size_t processTime);
+
+    DivInstrumentChangeTracker():
+      ins(NULL),
+      shadow(NULL) {}
+    ~DivInstrumentChangeTracker();
+};
 #endif
@@ -0,0 +1,444 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "libraryIndex.h"
+#include "engine.h"
+#include "../fileutils.h"
+#include "../ta-log.h"
+#include <inttypes.h>
+
+#define DIV_LIBRARY_INDEX_VERSION 1
+
+static const char* insExtensions[]={
+  "fui", "dmp", "tfi", "vgi", "eif", "s3i", "sbi", "opli", "opni", "y12", "bnk", "ff", "gyb", "opm", "wopl", "wopn", NULL
+};
+
+static const char* sampleExtensions[]={
+  "wav", "aif", "aiff", "aifc", "flac", "ogg", "opus", "mp3", "brr", "dmc", "vox", NULL
+};
+
+static String getExtension(const String& path) {
+  String ret;
+  size_t dot=path.rfind('.');
+  if (dot==String::npos) return ret;
+  size_t sep=path.rfind(DIR_SEPARATOR);
+  if (sep!=String::npos && sep>dot) return ret;
+  ret=path.substr(dot+1);
+  for (char& i: ret) {
+    if (i>='A' && i<='Z') i+='a'-'A';
+  }
+  return ret;
+}
+
+static bool hasExtension(const char** list, const String& ext) {
+  for (int i=0; list[i]; i++) {
+    if (ext==list[i]) return true;
+  }
+  return false;
+}
+
+// names and paths are stored at the end of a line
+static String sanitize(const String& what) {
+  String ret=what;
+  for (char& i: ret) {
+    if (i=='\n' || i=='\r') i=' ';
+  }
+  return ret;
+}
+
+static void _libraryWorker(DivLibraryIndex* index, int which) {
+  index->runWorker(which);
+}
+
+bool DivLibraryIndex::isIndexable(const String& path) {
+  String ext=getExtension(path);
+  if (ext.empty()) return false;
+  return hasExtension(insExtensions,ext) || hasExtension(sampleExtensions,ext);
+}
+
+void DivLibraryIndex::parse(DivEngine* eng, const String& path, int64_t mtime, uint64_t size, DivLibraryEntry& entry, std::vector<DivInstrument*>& ins) {
+  entry=DivLibraryEntry();
+  entry.mtime=mtime;
+  entry.size=size;
+
+  // anything that isn't a sample is tried as an instrument
+  String ext=getExtension(path);
+  if (hasExtension(sampleExtensions,ext)) {
+    std::vector<DivSample*> samples=eng->sampleFromFile(path.c_str());
+    for (DivSample* i: samples) {
+      DivLibraryAsset a;
+      a.kind=DIV_LIBRARY_SAMPLE;
+      a.name=i->name;
+      a.sampleLen=i->samples;
+      a.sampleRate=i->centerRate;
+      entry.assets.push_back(a);
+      delete i;
+    }
+    entry.ok=!samples.empty();
+  } else {
+    ins=eng->instrumentFromFile(path.c_str(),false,true);
+    for (DivInstrument* i: ins) {
+      DivLibraryAsset a;
+      a.kind=DIV_LIBRARY_INS;
+      a.name=i->name;
+      a.insType=i->type;
+      a.ops=i->fm.ops;
+      a.alg=i->fm.alg;
+      a.fb=i->fm.fb;
+      entry.assets.push_back(a);
+    }
+    entry.ok=!ins.empty();
+  }
+}
+
+void DivLibraryIndex::putCache(const String& path, int64_t mtime, uint64_t size, std::vector<DivInstrument*>& ins) {
+  std::lock_guard<std::mutex> l(cacheLock);
+  auto old=cache.find(path);
+  if (old!=cache.end()) {
+    for (DivInstrument* i: old->second.ins) delete i;
+    cache.erase(old);
+  }
+  if (ins.empty()) return;
+
+  // evict the least recently used file
+  if (cache.size()>=DIV_LIBRARY_CACHE_SIZE) {
+    auto oldest=cache.begin();
+    for (auto i=cache.begin(); i!=cache.end(); i++) {
+      if (i->second.lastUse<oldest->second.lastUse) oldest=i;
+    }
+    for (DivInstrument* i: oldest->second.ins) delete i;
+    cache.erase(oldest);
+  }
+
+  CachedFile& c=cache[path];
+  c.mtime=mtime;
+  c.size=size;
+  c.lastUse=++useCounter;
+  c.ins=ins;
+  ins.clear();
+}
+
+void DivLibraryIndex::runWorker(int index) {
+  DivEngine* eng=scratch[index];
+  std::unique_lock<std::mutex> l(lock);
+  while (true) {
+    while (!quitting && queue.empty()) notify.wait(l);
+    if (quitting) break;
+
+    String path=queue.front();
+    queue.pop_front();
+    queued.erase(path);
+    busyWorkers++;
+
+    bool had=false;
+    int64_t prevMtime=0;
+    uint64_t prevSize=0;
+    auto prev=entries.find(path);
+    if (prev!=entries.end()) {
+      had=true;
+      prevMtime=prev->second.mtime;
+      prevSize=prev->second.size;
+    }
+    l.unlock();
+
+    uint64_t size=0;
+    int64_t mtime=0;
+    DivLibraryEntry entry;
+    std::vector<DivInstrument*> ins;
+    bool exists=fileInfo(path.c_str(),&size,&mtime);
+    bool update=false;
+    if (exists && (!had || prevMtime!=mtime || prevSize!=size)) {
+      parse(eng,path,mtime,size,entry,ins);
+      update=true;
+    }
+    if (update) putCache(path,mtime,size,ins);
+
+    l.lock();
+    checked.insert(path);
+    if (!exists && had) {
+      entries.erase(path);
+      changed=true;
+      revision++;
+    } else if (update) {
+      entries[path]=entry;
+      changed=true;
+      revision++;
+    }
+    busyWorkers--;
+
+    // write the index once everything is done
+    if (queue.empty() && busyWorkers==0 && changed) {
+      l.unlock();
+      save();
+      l.lock();
+    }
+  }
+}
+
+bool DivLibraryIndex::lookup(const String& path, DivLibraryEntry& out) {
+  if (!isIndexable(path)) return false;
+  std::lock_guard<std::mutex> l(lock);
+  if (!workers.empty() && !quitting) {
+    if (checked.find(path)==checked.end() && queued.find(path)==queued.end()) {
+      queue.push_back(path);
+      queued.insert(path);
+      notify.notify_one();
+    }
+  }
+  auto i=entries.find(path);
+  if (i==entries.end()) return false;
+  out=i->second;
+  return true;
+}
+
+std::vector<DivInstrument*> DivLibraryIndex::getInstruments(const String& path) {
+  std::vector<DivInstrument*> ret;
+  uint64_t size=0;
+  int64_t mtime=0;
+  if (!fileInfo(path.c_str(),&size,&mtime)) return ret;
+
+  {
+    std::lock_guard<std::mutex> l(cacheLock);
+    auto i=cache.find(path);
+    if (i!=cache.end() && i->second.mtime==mtime && i->second.size==size) {
+      i->second.lastUse=++useCounter;
+      for (DivInstrument* j: i->second.ins) {
+        DivInstrument* copy=new DivInstrument;
+        *copy=*j;
+        ret.push_back(copy);
+      }
+      return ret;
+    }
+  }
+
+  // not cached - parse now
+  DivLibraryEntry entry;
+  std::vector<DivInstrument*> ins;
+  fgLock.lock();
+  if (fgEngine==NULL) fgEngine=new DivEngine;
+  parse(fgEngine,path,mtime,size,entry,ins);
+  fgLock.unlock();
+
+  for (DivInstrument* i: ins) {
+    DivInstrument* copy=new DivInstrument;
+    *copy=*i;
+    ret.push_back(copy);
+  }
+  putCache(path,mtime,size,ins);
+
+  if (isIndexable(path)) {
+    std::lock_guard<std::mutex> l(lock);
+    entries[path]=entry;
+    checked.insert(path);
+    changed=true;
+    revision++;
+  }
+  return ret;
+}
+
+unsigned int DivLibraryIndex::getRevision() {
+  return revision;
+}
+
+bool DivLibraryIndex::isBusy() {
+  std::lock_guard<std::mutex> l(lock);
+  return (!queue.empty() || busyWorkers>0);
+}
+
+size_t DivLibraryIndex::getCount() {
+  std::lock_guard<std::mutex> l(lock);
+  return entries.size();
+}
+
+bool DivLibraryIndex::load() {
+  FILE* f=ps_fopen(indexPath.c_str(),"rb");
+  if (f==NULL) {
+    logV("no library index yet");
+    return false;
+  }
+
+  String data;
+  char buf[4096];
+  size_t got;
+  while ((got=fread(buf,1,4096,f))>0) {
+    data.append(buf,got);
+  }
+  fclose(f);
+
+  std::map<String,DivLibraryEntry> loaded;
+  DivLibraryEntry* cur=NULL;
+  size_t pos=0;
+  bool first=true;
+  while (pos<data.size()) {
+    size_t next=data.find('\n',pos);
+    if (next==String::npos) next=data.size();
+    String line=data.substr(pos,next-pos);
+    pos=next+1;
+    if (line.empty()) continue;
+
+    if (first) {
+      int version=0;
+      if (sscanf(line.c_str(),"FurnaceLibraryIndex %d",&version)!=1 || version!=DIV_LIBRARY_INDEX_VERSION) {
+        logW("library index is invalid or from another version. it will be rebuilt.");
+        return false;
+      }
+      first=false;
+      continue;
+    }
+
+    int nameOff=0;
+    switch (line[0]) {
+      case 'f': {
+        int64_t mtime=0;
+        uint64_t size=0;
+        int ok=0;
+        if (sscanf(line.c_str(),"f %" SCNd64 " %" SCNu64 " %d %n",&mtime,&size,&ok,&nameOff)<3 || nameOff<=0) {
+          cur=NULL;
+          break;
+        }
+        cur=&loaded[line.substr(nameOff)];
+        cur->mtime=mtime;
+        cur->size=size;
+        cur->ok=ok;
+        break;
+      }
+      case 'i': {
+        if (cur==NULL) break;
+        int type=0, ops=0, alg=0, fb=0;
+        if (sscanf(line.c_str(),"i %d %d %d %d %n",&type,&ops,&alg,&fb,&nameOff)<4 || nameOff<=0) break;
+        if (type<0 || type>=DIV_INS_MAX) break;
+        DivLibraryAsset a;
+        a.kind=DIV_LIBRARY_INS;
+        a.insType=(DivInstrumentType)type;
+        a.ops=ops;
+        a.alg=alg;
+        a.fb=fb;
+        a.name=line.substr(nameOff);
+        cur->assets.push_back(a);
+        break;
+      }
+      case 's': {
+        if (cur==NULL) break;
+        unsigned int len=0;
+        int rate=0;
+        if (sscanf(line.c_str(),"s %u %d %n",&len,&rate,&nameOff)<2 || nameOff<=0) break;
+        DivLibraryAsset a;
+        a.kind=DIV_LIBRARY_SAMPLE;
+        a.sampleLen=len;
+        a.sampleRate=rate;
+        a.name=line.substr(nameOff);
+        cur->assets.push_back(a);
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  std::lock_guard<std::mutex> l(lock);
+  entries.swap(loaded);
+  revision++;
+  logI("loaded library index (%d files)",(int)entries.size());
+  return true;
+}
+
+bool DivLibraryIndex::save() {
+  if (indexPath.empty()) return false;
+  std::lock_guard<std::mutex> sl(saveLock);
+
+  String out=fmt::sprintf("FurnaceLibraryIndex %d\n",DIV_LIBRARY_INDEX_VERSION);
+  {
+    std::lock_guard<std::mutex> l(lock);
+    for (auto& i: entries) {
+      out+=fmt::sprintf("f %" PRId64 " %" PRIu64 " %d %s\n",i.second.mtime,i.second.size,i.second.ok?1:0,sanitize(i.first).c_str());
+      for (DivLibraryAsset& j: i.second.assets) {
+        if (j.kind==DIV_LIBRARY_SAMPLE) {
+          out+=fmt::sprintf("s %u %d %s\n",j.sampleLen,j.sampleRate,sanitize(j.name).c_str());
+        } else {
+          out+=fmt::sprintf("i %d %d %d %d %s\n",(int)j.insType,(int)j.ops,(int)j.alg,(int)j.fb,sanitize(j.name).c_str());
+        }
+      }
+    }
+    changed=false;
+  }
+
+  FILE* f=ps_fopen(indexPath.c_str(),"wb");
+  if (f==NULL) {
+    logW("could not save library index: %s",strerror(errno));
+    return false;
+  }
+  if (fwrite(out.c_str(),1,out.size(),f)!=out.size()) {
+    logW("could not write library index!");
+    fclose(f);
+    return false;
+  }
+  fclose(f);
+  logV("saved library index");
+  return true;
+}
+
+bool DivLibraryIndex::init(const String& path, int threads) {
+  indexPath=path;
+  quitting=false;
+  load();
+
+  if (threads<1) threads=1;
+  if (threads>16) threads=16;
+  for (int i=0; i<threads; i++) {
+    scratch.push_back(new DivEngine);
+  }
+  for (int i=0; i<threads; i++) {
+    workers.push_back(new std::thread(_libraryWorker,this,i));
+  }
+  logV("library index: %d workers",threads);
+  return true;
+}
+
+void DivLibraryIndex::quit() {
+  {
+    std::lock_guard<std::mutex> l(lock);
+    quitting=true;
+    queue.clear();
+    queued.clear();
+  }
+  notify.notify_all();
+  for (std::thread* i: workers) {
+    i->join();
+    delete i;
+  }
+  workers.clear();
+  for (DivEngine* i: scratch) {
+    delete i;
+  }
+  scratch.clear();
+
+  if (changed) save();
+
+  {
+    std::lock_guard<std::mutex> l(cacheLock);
+    for (auto& i: cache) {
+      for (DivInstrument* j: i.second.ins) delete j;
+    }
+    cache.clear();
+  }
+  if (fgEngine!=NULL) {
+    delete fgEngine;
+    fgEngine=NULL;
+  }
+}
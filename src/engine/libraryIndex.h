@@ -0,0 +1,170 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _LIBRARY_INDEX_H
+#define _LIBRARY_INDEX_H
+
+#include "../ta-utils.h"
+#include "instrument.h"
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+class DivEngine;
+struct DivSample;
+
+// number of files whose parsed contents are kept for previews
+#define DIV_LIBRARY_CACHE_SIZE 256
+
+enum DivLibraryAssetKind: unsigned char {
+  DIV_LIBRARY_INS=0,
+  DIV_LIBRARY_SAMPLE
+};
+
+/**
+ * summary of an instrument or sample in a file.
+ */
+struct DivLibraryAsset {
+  DivLibraryAssetKind kind;
+  String name;
+  // instrument
+  DivInstrumentType insType;
+  unsigned char ops, alg, fb;
+  // sample
+  unsigned int sampleLen;
+  int sampleRate;
+
+  DivLibraryAsset():
+    kind(DIV_LIBRARY_INS),
+    insType(DIV_INS_FM),
+    ops(0),
+    alg(0),
+    fb(0),
+    sampleLen(0),
+    sampleRate(0) {}
+};
+
+struct DivLibraryEntry {
+  int64_t mtime;
+  uint64_t size;
+  // false if the file couldn't be parsed
+  bool ok;
+  std::vector<DivLibraryAsset> assets;
+
+  DivLibraryEntry():
+    mtime(0),
+    size(0),
+    ok(false) {}
+};
+
+/**
+ * an index of instrument and sample files, keyed by path.
+ * files are parsed by worker threads (each with its own scratch engine, so
+ * that the song is never touched) and checked against their size and
+ * modification time.
+ * the index is saved to disk, and the parsed contents of recently indexed
+ * files are kept so that previews don't have to read them again.
+ */
+class DivLibraryIndex {
+  String indexPath;
+  std::mutex lock;
+  std::condition_variable notify;
+  std::map<String,DivLibraryEntry> entries;
+  // paths which were checked against the file system during this session
+  std::set<String> checked;
+  std::deque<String> queue;
+  std::set<String> queued;
+  std::vector<std::thread*> workers;
+  std::vector<DivEngine*> scratch;
+  bool quitting, changed;
+  int busyWorkers;
+  std::atomic<unsigned int> revision;
+
+  struct CachedFile {
+    int64_t mtime;
+    uint64_t size;
+    uint64_t lastUse;
+    std::vector<DivInstrument*> ins;
+  };
+  std::mutex cacheLock;
+  std::map<String,CachedFile> cache;
+  uint64_t useCounter;
+  // scratch engine for parsing on the calling thread
+  std::mutex fgLock;
+  DivEngine* fgEngine;
+  std::mutex saveLock;
+
+  void parse(DivEngine* eng, const String& path, int64_t mtime, uint64_t size, DivLibraryEntry& entry, std::vector<DivInstrument*>& ins);
+  void putCache(const String& path, int64_t mtime, uint64_t size, std::vector<DivInstrument*>& ins);
+  bool load();
+
+  public:
+    void runWorker(int index);
+
+    /**
+     * whether a file may be indexed, by extension.
+     */
+    static bool isIndexable(const String& path);
+
+    /**
+     * look up a file. if it hasn't been checked yet, it is queued for indexing.
+     * @param path the file.
+     * @param out the entry (stale entries are returned until the file is checked).
+     * @return whether an entry is available.
+     */
+    bool lookup(const String& path, DivLibraryEntry& out);
+
+    /**
+     * get the instruments in a file, from the cache if possible.
+     * @return copies which the caller must delete.
+     */
+    std::vector<DivInstrument*> getInstruments(const String& path);
+
+    /**
+     * incremented every time an entry changes.
+     */
+    unsigned int getRevision();
+
+    /**
+     * whether files are waiting to be indexed.
+     */
+    bool isBusy();
+
+    size_t getCount();
+
+    bool save();
+    bool init(const String& path, int threads);
+    void quit();
+
+    DivLibraryIndex():
+      quitting(false),
+      changed(false),
+      busyWorkers(0),
+      revision(0),
+      useCounter(0),
+      fgEngine(NULL) {}
+};
+
+#endif
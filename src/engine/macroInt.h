@@ -30,7 +30,7 @@ struct DivMacroStruct {
   bool has, had, actualHad, finished, will, linger, began, masked, activeRelease, lfoDir;
   unsigned int mode, type;
   unsigned char macroType;
-  void doMacro(DivInstrumentMacro& source, bool released, bool tick);
+  void doMacro(const DivInstrumentMacro& source, bool released, bool tick);
   void init() {
     pos=lastPos=mode=type=delay=0;
     has=had=actualHad=will=false;
@@ -40,7 +40,7 @@ struct DivMacroStruct {
     // TODO: test whether this breaks anything?
     val=0;
   }
-  void prepare(DivInstrumentMacro& source, DivEngine* e);
+  void prepare(const DivInstrumentMacro& source, DivEngine* e);
   DivMacroStruct(unsigned char mType):
     pos(0),
     lastPos(0),
@@ -65,7 +65,7 @@ class DivMacroInt {
   DivEngine* e;
   DivInstrument* ins;
   DivMacroStruct* macroList[128];
-  DivInstrumentMacro* macroSource[128];
+  const DivInstrumentMacro* macroSource[128];
   size_t macroListLen;
   int subTick;
   bool released;
@@ -1458,50 +1458,57 @@ const DivMemoryComposition* DivPlatformES5506::getMemCompo(int index) {
 }
 
 void DivPlatformES5506::renderSamples(int sysID) {
-  memset(sampleMem,0,getSampleMemCapacity());
   memset(sampleOffES5506,0,32768*sizeof(unsigned int));
   memset(sampleLoaded,0,32768*sizeof(bool));
 
   memCompo=DivMemoryComposition();
   memCompo.name="Sample Memory";
 
-  size_t memPos=getSampleMemOffset(); // add silent at begin and end of each bank for reverse playback and add 1 for loop
+  // take out the injected loop samples so that memory matches sample data again
+  for (int i=(int)loopPatches.size()-1; i>=0; i--) {
+    sampleMem[loopPatches[i].first]=loopPatches[i].second;
+  }
+  loopPatches.clear();
+
+  // add silence at begin and end of each bank for reverse playback and add 1 for loop
+  const size_t bankGuard=getSampleMemOffset();
+  std::vector<DivSamplePackItem> items;
+  items.resize(parent->song.sampleLen);
   for (int i=0; i<parent->song.sampleLen; i++) {
     DivSample* s=parent->song.sample[i];
-    if (!s->renderOn[0][sysID]) {
-      sampleOffES5506[i]=0;
-      continue;
-    }
+    if (!s->renderOn[0][sysID]) continue;
 
     unsigned int length=s->length16;
     // fit sample size to single bank size
-    if (length>(4194304-getSampleMemOffset())) {
-      length=4194304-getSampleMemOffset();
+    if (length>(4194304-bankGuard*2)) {
+      length=4194304-bankGuard*2;
     }
-    if ((memPos&0xc00000)!=((memPos+length+getSampleMemOffset())&0xc00000)) {
-      memPos=((memPos+0x3fffff)&0xffc00000)+getSampleMemOffset();
-    }
-    if (memPos>=(getSampleMemCapacity()-getSampleMemOffset())) {
-      logW("out of ES5506 memory for sample %d!",i);
-      break;
+    size_t pad=0;
+    if (s->loop && s->loopEnd>=(int)s->samples && s->loopStart>=0 && s->loopStart<(int)s->samples) {
+      pad=2;
     }
-    if (memPos+length>=(getSampleMemCapacity()-getSampleMemOffset())) {
-      memcpy(sampleMem+(memPos/sizeof(short)),s->data16,(getSampleMemCapacity()-getSampleMemOffset())-memPos);
-      logW("out of ES5506 memory for sample %d!",i);
-    } else {
-      memcpy(sampleMem+(memPos/sizeof(short)),s->data16,length);
-      // inject loop sample
-      if (s->loop && s->loopEnd>=0 && s->loopEnd<=(int)s->samples && s->loopStart>=0 && s->loopStart<(int)s->samples) {
-        sampleMem[(memPos/sizeof(short))+s->loopEnd]=s->data16[s->loopStart];
-        if (s->loopEnd>=(int)s->samples) length+=2;
+    items[i]=DivSamplePackItem((const unsigned char*)s->data16,length,s->renderRev,pad);
+  }
+  packer.setMemory((unsigned char*)sampleMem,getSampleMemCapacity(),4194304,2,bankGuard);
+  packer.pack(items);
+
+  for (int i=0; i<parent->song.sampleLen; i++) {
+    if (!items[i].use) continue;
+    DivSample* s=parent->song.sample[i];
+    sampleOffES5506[i]=packer.getOffset(i);
+    sampleLoaded[i]=packer.isPlaced(i);
+    if (!sampleLoaded[i]) continue;
+    // inject loop sample
+    if (s->loop && s->loopEnd>=0 && s->loopEnd<=(int)s->samples && s->loopStart>=0 && s->loopStart<(int)s->samples) {
+      if ((size_t)s->loopEnd*sizeof(short)<items[i].len+items[i].pad) {
+        size_t pos=(sampleOffES5506[i]/sizeof(short))+s->loopEnd;
+        loopPatches.push_back(std::pair<size_t,signed short>(pos,sampleMem[pos]));
+        sampleMem[pos]=s->data16[s->loopStart];
       }
     }
-    sampleOffES5506[i]=memPos;
-    sampleLoaded[i]=true;
-    memCompo.entries.push_back(DivMemoryEntry(DIV_MEMORY_SAMPLE,"Sample",i,memPos,memPos+length));
-    memPos+=length;
   }
-  sampleMemLen=memPos+256;
+  packer.fillComposition(memCompo);
+  sampleMemLen=packer.getEnd()+256;
 
   memCompo.used=sampleMemLen;
   memCompo.capacity=16777216;
@@ -1528,6 +1535,8 @@ int DivPlatformES5506::init(DivEngine* p, int channels, int sugRate, const DivCo
 }
 
 void DivPlatformES5506::quit() {
+  packer.reset();
+  loopPatches.clear();
   delete[] sampleMem;
   for (int i=0; i<32; i++) {
     delete oscBuf[i];
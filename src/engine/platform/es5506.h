@@ -25,6 +25,7 @@
 #include "../../fixedQueue.h"
 #include "../macroInt.h"
 #include "../sample.h"
+#include "../samplePacker.h"
 #include "vgsound_emu/src/es550x/es5506.hpp"
 
 class DivPlatformES5506: public DivDispatch, public es550x_intf {
@@ -234,6 +235,9 @@ class DivPlatformES5506: public DivDispatch, public es550x_intf {
   size_t sampleMemLen;
   unsigned int* sampleOffES5506;
   bool* sampleLoaded;
+  DivSamplePacker packer;
+  // injected loop samples (position in memory and the value they replaced)
+  std::vector<std::pair<size_t,signed short>> loopPatches;
   struct QueuedHostIntf {
       unsigned char state;
       unsigned char step;
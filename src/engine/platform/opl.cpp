@@ -3298,12 +3298,6 @@ void DivPlatformOPL::renderInstruments() {
 
 void DivPlatformOPL::renderSamples(int sysID) {
   if (adpcmChan<0 && pcmChanOffs<0) return;
-  if (adpcmChan>=0 && adpcmBMem!=NULL) {
-    memset(adpcmBMem,0,262144);
-  }
-  if (pcmChanOffs>=0 && pcmMem!=NULL) {
-    memset(pcmMem,0,4194304);
-  }
   memset(sampleOffPCM,0,32768*sizeof(unsigned int));
   memset(sampleOffB,0,32768*sizeof(unsigned int));
   memset(sampleLoaded,0,32768*sizeof(bool));
@@ -3312,8 +3306,16 @@ void DivPlatformOPL::renderSamples(int sysID) {
   memCompo.name="Sample Memory";
 
   if (pcmChanOffs>=0) { // OPL4 PCM
-    size_t memPos=(PCM_IN_RAM?0x200600:0x1800);
+    // the header table and samples move when the RAM size changes
+    if (ramSize!=pcmPackedRamSize) {
+      memset(pcmMem,0,4194304);
+      packer.reset();
+      pcmPackedRamSize=ramSize;
+    }
+    const size_t memBase=(PCM_IN_RAM?0x200600:0x1800);
     const int maxSample=PCM_IN_RAM?128:512;
+    // renderInstruments() writes the headers of used samples only
+    memset(pcmMem+(PCM_IN_RAM?0x200000:0),0,maxSample*12);
     int sampleCount=parent->song.sampleLen;
     if (sampleCount>maxSample) {
       // mark the rest as unavailable
@@ -3322,12 +3324,12 @@ void DivPlatformOPL::renderSamples(int sysID) {
       }
       sampleCount=maxSample;
     }
+    if ((int)pcmStage.size()<sampleCount) pcmStage.resize(sampleCount);
+    std::vector<DivSamplePackItem> items;
+    items.resize(sampleCount);
     for (int i=0; i<sampleCount; i++) {
       DivSample* s=parent->song.sample[i];
-      if (!s->renderOn[0][sysID]) {
-        sampleOffPCM[i]=0;
-        continue;
-      }
+      if (!s->renderOn[0][sysID]) continue;
 
       int length;
       int sampleLength;
@@ -3352,34 +3354,50 @@ void DivPlatformOPL::renderSamples(int sysID) {
           break;
       }
       if (sampleLength<1) length=0;
-      int actualLength=MIN((int)(getSampleMemCapacity(0)-memPos),length);
-      if (actualLength>0) {
+
+      // convert the sample again only if it changed
+      PCMStage& stage=pcmStage[i];
+      if (s->renderRev==0 || stage.renderRev!=s->renderRev || stage.depth!=s->depth || stage.sampleLength!=sampleLength) {
+        stage.data.resize(length);
         if (s->depth==DIV_SAMPLE_DEPTH_16BIT) {
-          for (int i=0, j=0; i<actualLength; i++, j++) {
+          for (int k=0, j=0; k<length; k++, j++) {
             if (j>=sampleLength) j=sampleLength-2;
 #ifdef TA_BIG_ENDIAN
-            pcmMem[memPos+i]=src[j];
+            stage.data[k]=src[j];
 #else
-            pcmMem[memPos+i]=src[j^1];
+            stage.data[k]=src[j^1];
 #endif
           }
         } else {
-          for (int i=0, j=0; i<actualLength; i++, j++) {
+          for (int k=0, j=0; k<length; k++, j++) {
             if (j>=sampleLength && s->depth!=DIV_SAMPLE_DEPTH_12BIT) j=sampleLength-1;
-            pcmMem[memPos+i]=src[j];
+            stage.data[k]=src[j];
           }
         }
-        sampleOffPCM[i]=memPos;
-        memCompo.entries.push_back(DivMemoryEntry(DIV_MEMORY_SAMPLE,"Sample",i,memPos,memPos+length));
-        memPos+=length;
+        stage.renderRev=s->renderRev;
+        stage.depth=s->depth;
+        stage.sampleLength=sampleLength;
+        stage.rev=++pcmStageRev;
       }
-      if (actualLength<length) {
-        logW("out of OPL4 PCM memory for sample %d!",i);
-        break;
+      items[i]=DivSamplePackItem(stage.data.empty()?NULL:stage.data.data(),stage.data.size(),stage.rev);
+    }
+    packer.setMemory(pcmMem+memBase,getSampleMemCapacity(0)-memBase,0,1);
+    packer.pack(items);
+
+    for (int i=0; i<sampleCount; i++) {
+      if (!items[i].use) continue;
+      sampleLoaded[i]=packer.isPlaced(i);
+      if (sampleLoaded[i] && items[i].len>0) {
+        sampleOffPCM[i]=memBase+packer.getOffset(i);
       }
-      sampleLoaded[i]=true;
     }
-    pcmMemLen=memPos+256;
+    size_t firstEntry=memCompo.entries.size();
+    packer.fillComposition(memCompo);
+    for (size_t i=firstEntry; i<memCompo.entries.size(); i++) {
+      memCompo.entries[i].begin+=memBase;
+      memCompo.entries[i].end+=memBase;
+    }
+    pcmMemLen=memBase+packer.getEnd()+256;
 
     renderInstruments();
     if (PCM_IN_RAM) {
@@ -3388,34 +3406,25 @@ void DivPlatformOPL::renderSamples(int sysID) {
 
     memCompo.used=pcmMemLen;
   } else if (adpcmChan>=0) { // ADPCM
-    size_t memPos=0;
+    std::vector<DivSamplePackItem> items;
+    items.resize(parent->song.sampleLen);
     for (int i=0; i<parent->song.sampleLen; i++) {
       DivSample* s=parent->song.sample[i];
-      if (!s->renderOn[0][sysID]) {
-        sampleOffB[i]=0;
-        continue;
-      }
+      if (!s->renderOn[0][sysID]) continue;
 
       int paddedLen=(s->lengthB+255)&(~0xff);
-      if ((memPos&0xf00000)!=((memPos+paddedLen)&0xf00000)) {
-        memPos=(memPos+0xfffff)&0xf00000;
-      }
-      if (memPos>=getSampleMemCapacity(0)) {
-        logW("out of ADPCM memory for sample %d!",i);
-        break;
-      }
-      if (memPos+paddedLen>=getSampleMemCapacity(0)) {
-        memcpy(adpcmBMem+memPos,s->dataB,getSampleMemCapacity(0)-memPos);
-        logW("out of ADPCM memory for sample %d!",i);
-      } else {
-        memcpy(adpcmBMem+memPos,s->dataB,paddedLen);
-        sampleLoaded[i]=true;
-      }
-      sampleOffB[i]=memPos;
-      memCompo.entries.push_back(DivMemoryEntry(DIV_MEMORY_SAMPLE,"Sample",i,memPos,memPos+paddedLen));
-      memPos+=paddedLen;
+      items[i]=DivSamplePackItem((const unsigned char*)s->dataB,paddedLen,s->renderRev);
+    }
+    packer.setMemory(adpcmBMem,getSampleMemCapacity(0),0x100000,256);
+    packer.pack(items);
+
+    for (int i=0; i<parent->song.sampleLen; i++) {
+      if (!items[i].use) continue;
+      sampleOffB[i]=packer.getOffset(i);
+      sampleLoaded[i]=packer.isPlaced(i);
     }
-    adpcmBMemLen=memPos+256;
+    packer.fillComposition(memCompo);
+    adpcmBMemLen=packer.getEnd()+256;
 
     memCompo.used=adpcmBMemLen;
   }
@@ -3471,6 +3480,7 @@ int DivPlatformOPL::init(DivEngine* p, int channels, int sugRate, const DivConfi
   if (pcmChanOffs>=0) {
     pcmMem=new unsigned char[4194304];
     pcmMemLen=0;
+    pcmPackedRamSize=-1;
     iface.pcmMem=pcmMem;
     pcmMemory.memory=pcmMem;
   }
@@ -3490,6 +3500,8 @@ void DivPlatformOPL::quit() {
   if (pcmChanOffs>=0) {
     delete[] pcmMem;
   }
+  packer.reset();
+  pcmStage.clear();
   if (fm_ymfm1!=NULL) {
     delete fm_ymfm1;
     fm_ymfm1=NULL;
@@ -3519,6 +3531,8 @@ DivPlatformOPL::DivPlatformOPL():
   sampleOffPCM=new unsigned int[32768];
   sampleOffB=new unsigned int[32768];
   sampleLoaded=new bool[32768];
+  pcmStageRev=0;
+  pcmPackedRamSize=-1;
 }
 
 DivPlatformOPL::~DivPlatformOPL() {
@@ -22,6 +22,7 @@
 
 #include "../dispatch.h"
 #include "../../fixedQueue.h"
+#include "../samplePacker.h"
 #include "../../../extern/opl/opl3.h"
 extern "C" {
 #include "../../../extern/YM3812-LLE/fmopl2.h"
@@ -124,6 +125,22 @@ class DivPlatformOPL: public DivDispatch {
     unsigned int* sampleOffB;
     unsigned int* sampleOffPCM;
     bool* sampleLoaded;
+    DivSamplePacker packer;
+    // OPL4 PCM samples as they are in memory (byte-swapped and padded)
+    struct PCMStage {
+      std::vector<unsigned char> data;
+      uint64_t renderRev, rev;
+      int depth, sampleLength;
+      PCMStage():
+        renderRev(0),
+        rev(0),
+        depth(-1),
+        sampleLength(-1) {}
+    };
+    std::vector<PCMStage> pcmStage;
+    uint64_t pcmStageRev;
+    // RAM size the packed PCM memory was laid out for
+    int pcmPackedRamSize;
   
     ymfm::adpcm_b_engine* adpcmB;
     const unsigned char** slotsNonDrums;
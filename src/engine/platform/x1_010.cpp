@@ -971,47 +971,34 @@ const DivMemoryComposition* DivPlatformX1_010::getMemCompo(int index) {
 }
 
 void DivPlatformX1_010::renderSamples(int sysID) {
-  memset(sampleMem,0,16777216);
   memset(sampleOffX1,0,32768*sizeof(unsigned int));
   memset(sampleLoaded,0,32768*sizeof(bool));
 
   memCompo=DivMemoryComposition();
   memCompo.name="Sample ROM";
 
-  size_t memPos=0;
+  std::vector<DivSamplePackItem> items;
+  items.resize(parent->song.sampleLen);
   for (int i=0; i<parent->song.sampleLen; i++) {
     DivSample* s=parent->song.sample[i];
-    if (!s->renderOn[0][sysID]) {
-      sampleOffX1[i]=0;
-      continue;
-    }
-    
+    if (!s->renderOn[0][sysID]) continue;
+
     int paddedLen=(s->length8+4095)&(~0xfff);
-    if (isBanked) {
     // fit sample bank size to 128KB for Seta 2 external bankswitching logic (not emulated yet!)
-      if (paddedLen>131072) {
-        paddedLen=131072;
-      }
-      if ((memPos&0xfe0000)!=((memPos+paddedLen)&0xfe0000)) {
-        memPos=(memPos+0x1ffff)&0xfe0000;
-      }
+    if (isBanked && paddedLen>131072) {
+      paddedLen=131072;
     }
-    if (memPos>=getSampleMemCapacity()) {
-      logW("out of X1-010 memory for sample %d!",i);
-      break;
-    }
-    if (memPos+paddedLen>=getSampleMemCapacity()) {
-      memcpy(sampleMem+memPos,s->data8,getSampleMemCapacity()-memPos);
-      logW("out of X1-010 memory for sample %d!",i);
-    } else {
-      memcpy(sampleMem+memPos,s->data8,paddedLen);
-      sampleLoaded[i]=true;
-    }
-    sampleOffX1[i]=memPos;
-    memCompo.entries.push_back(DivMemoryEntry(DIV_MEMORY_SAMPLE,"Sample",i,memPos,memPos+paddedLen));
-    memPos+=paddedLen;
+    items[i]=DivSamplePackItem((const unsigned char*)s->data8,paddedLen,s->renderRev);
+  }
+  packer.setMemory(sampleMem,getSampleMemCapacity(),isBanked?131072:0,4096);
+  packer.pack(items);
+  for (int i=0; i<parent->song.sampleLen; i++) {
+    if (!items[i].use) continue;
+    sampleOffX1[i]=packer.getOffset(i);
+    sampleLoaded[i]=packer.isPlaced(i);
   }
-  sampleMemLen=memPos+256;
+  packer.fillComposition(memCompo);
+  sampleMemLen=packer.getEnd()+256;
 
   memCompo.used=sampleMemLen;
   memCompo.capacity=getSampleMemCapacity(0);
@@ -1039,6 +1026,7 @@ void DivPlatformX1_010::quit() {
     delete oscBuf[i];
   }
   delete[] sampleMem;
+  packer.reset();
 }
 
 // initialization of important arrays
@@ -23,6 +23,7 @@
 #include "../dispatch.h"
 #include "../engine.h"
 #include "../waveSynth.h"
+#include "../samplePacker.h"
 #include "vgsound_emu/src/x1_010/x1_010.hpp"
 
 class DivPlatformX1_010: public DivDispatch, public vgsound_emu_mem_intf {
@@ -119,6 +120,7 @@ class DivPlatformX1_010: public DivDispatch, public vgsound_emu_mem_intf {
   bool* sampleLoaded;
 
   DivMemoryComposition memCompo;
+  DivSamplePacker packer;
 
   unsigned char regPool[0x2000];
   double NoteX1_010(int ch, int note);
@@ -1950,41 +1950,28 @@ const DivMemoryComposition* DivPlatformYM2608::getMemCompo(int index) {
 }
 
 void DivPlatformYM2608::renderSamples(int sysID) {
-  memset(adpcmBMem,0,getSampleMemCapacity(0));
   memset(sampleOffB,0,32768*sizeof(unsigned int));
   memset(sampleLoaded,0,32768*sizeof(bool));
 
   memCompo=DivMemoryComposition();
   memCompo.name="ADPCM";
 
-  size_t memPos=0;
+  std::vector<DivSamplePackItem> items;
+  items.resize(parent->song.sampleLen);
   for (int i=0; i<parent->song.sampleLen; i++) {
     DivSample* s=parent->song.sample[i];
-    if (!s->renderOn[0][sysID]) {
-      sampleOffB[i]=0;
-      continue;
-    }
-
-    int paddedLen=(s->lengthB+255)&(~0xff);
-    if ((memPos&0xf00000)!=((memPos+paddedLen)&0xf00000)) {
-      memPos=(memPos+0xfffff)&0xf00000;
-    }
-    if (memPos>=getSampleMemCapacity(0)) {
-      logW("out of ADPCM memory for sample %d!",i);
-      break;
-    }
-    if (memPos+paddedLen>=getSampleMemCapacity(0)) {
-      memcpy(adpcmBMem+memPos,s->dataB,getSampleMemCapacity(0)-memPos);
-      logW("out of ADPCM memory for sample %d!",i);
-    } else {
-      memcpy(adpcmBMem+memPos,s->dataB,paddedLen);
-      sampleLoaded[i]=true;
-    }
-    sampleOffB[i]=memPos;
-    memCompo.entries.push_back(DivMemoryEntry(DIV_MEMORY_SAMPLE,"Sample",i,memPos,memPos+paddedLen));
-    memPos+=paddedLen;
+    if (!s->renderOn[0][sysID]) continue;
+    items[i]=DivSamplePackItem((const unsigned char*)s->dataB,(s->lengthB+255)&(~0xff),s->renderRev);
+  }
+  packer.setMemory(adpcmBMem,getSampleMemCapacity(0),0x100000,256);
+  packer.pack(items);
+  for (int i=0; i<parent->song.sampleLen; i++) {
+    if (!items[i].use) continue;
+    sampleOffB[i]=packer.getOffset(i);
+    sampleLoaded[i]=packer.isPlaced(i);
   }
-  adpcmBMemLen=memPos+256;
+  packer.fillComposition(memCompo);
+  adpcmBMemLen=packer.getEnd()+256;
 
   memCompo.used=adpcmBMemLen;
   memCompo.capacity=getSampleMemCapacity(0);
@@ -2105,6 +2092,7 @@ void DivPlatformYM2608::quit() {
   delete ay;
   delete fm;
   delete[] adpcmBMem;
+  packer.reset();
 }
 
 // initialization of important arrays
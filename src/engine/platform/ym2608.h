@@ -21,6 +21,7 @@
 #define _YM2608_H
 
 #include "fmshared_OPN.h"
+#include "../samplePacker.h"
 #include "sound/ymfm/ymfm_opn.h"
 extern "C" {
 #include "../../../extern/YM2608-LLE/fmopna_2608.h"
@@ -77,6 +78,7 @@ class DivPlatformYM2608: public DivPlatformOPN {
     unsigned char prescale, nukedMult, memConfig;
 
     DivMemoryComposition memCompo;
+    DivSamplePacker packer;
   
     double NOTE_OPNB(int ch, int note);
     double NOTE_ADPCMB(int note);
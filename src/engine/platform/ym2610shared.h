@@ -22,6 +22,7 @@
 
 #include "fmshared_OPN.h"
 #include "../engine.h"
+#include "../samplePacker.h"
 #include "../../ta-log.h"
 #include "ay.h"
 #include "sound/ymfm/ymfm.h"
@@ -72,6 +73,7 @@ class DivPlatformYM2610Base: public DivPlatformOPN {
     unsigned char* adpcmBMem;
     size_t adpcmBMemLen;
     DivYM2610Interface iface;
+    DivSamplePacker packerA, packerB;
 
     unsigned int* sampleOffA;
     unsigned int* sampleOffB;
@@ -221,7 +223,6 @@ class DivPlatformYM2610Base: public DivPlatformOPN {
     }
 
     void renderSamples(int sysID) {
-      memset(adpcmAMem,0,getSampleMemCapacity(0));
       memset(sampleOffA,0,32768*sizeof(unsigned int));
       memset(sampleOffB,0,32768*sizeof(unsigned int));
       memset(sampleLoaded[0],0,32768*sizeof(bool));
@@ -233,68 +234,44 @@ class DivPlatformYM2610Base: public DivPlatformOPN {
       memCompoB=DivMemoryComposition();
       memCompoB.name="ADPCM-B";
 
-      size_t memPos=0;
+      // samples may not cross a 1MB boundary
+      std::vector<DivSamplePackItem> items;
+      items.resize(parent->song.sampleLen);
       for (int i=0; i<parent->song.sampleLen; i++) {
         DivSample* s=parent->song.sample[i];
-        if (!s->renderOn[0][sysID]) {
-          sampleOffA[i]=0;
-          continue;
-        }
-
-        int paddedLen=(s->lengthA+255)&(~0xff);
-        if ((memPos&0xf00000)!=((memPos+paddedLen)&0xf00000)) {
-          memPos=(memPos+0xfffff)&0xf00000;
-        }
-        if (memPos>=getSampleMemCapacity(0)) {
-          logW("out of ADPCM-A memory for sample %d!",i);
-          break;
-        }
-        if (memPos+paddedLen>=getSampleMemCapacity(0)) {
-          memcpy(adpcmAMem+memPos,s->dataA,getSampleMemCapacity(0)-memPos);
-          logW("out of ADPCM-A memory for sample %d!",i);
-        } else {
-          memcpy(adpcmAMem+memPos,s->dataA,paddedLen);
-          sampleLoaded[0][i]=true;
-        }
-        sampleOffA[i]=memPos;
-        memCompoA.entries.push_back(DivMemoryEntry(DIV_MEMORY_SAMPLE,"Sample",i,memPos,memPos+paddedLen));
-        memPos+=paddedLen;
+        if (!s->renderOn[0][sysID]) continue;
+        items[i]=DivSamplePackItem((const unsigned char*)s->dataA,(s->lengthA+255)&(~0xff),s->renderRev);
+      }
+      packerA.setMemory(adpcmAMem,getSampleMemCapacity(0),0x100000,256);
+      packerA.pack(items);
+      for (int i=0; i<parent->song.sampleLen; i++) {
+        if (!items[i].use) continue;
+        sampleOffA[i]=packerA.getOffset(i);
+        sampleLoaded[0][i]=packerA.isPlaced(i);
       }
-      adpcmAMemLen=memPos+256;
+      packerA.fillComposition(memCompoA);
+      adpcmAMemLen=packerA.getEnd()+256;
 
       memCompoA.used=adpcmAMemLen;
       memCompoA.capacity=getSampleMemCapacity(0);
 
-      memset(adpcmBMem,0,getSampleMemCapacity(1));
-
-      memPos=0;
       for (int i=0; i<parent->song.sampleLen; i++) {
         DivSample* s=parent->song.sample[i];
         if (!s->renderOn[1][sysID]) {
-          sampleOffB[i]=0;
+          items[i]=DivSamplePackItem();
           continue;
         }
-
-        int paddedLen=(s->lengthB+255)&(~0xff);
-        if ((memPos&0xf00000)!=((memPos+paddedLen)&0xf00000)) {
-          memPos=(memPos+0xfffff)&0xf00000;
-        }
-        if (memPos>=getSampleMemCapacity(1)) {
-          logW("out of ADPCM-B memory for sample %d!",i);
-          break;
-        }
-        if (memPos+paddedLen>=getSampleMemCapacity(1)) {
-          memcpy(adpcmBMem+memPos,s->dataB,getSampleMemCapacity(1)-memPos);
-          logW("out of ADPCM-B memory for sample %d!",i);
-        } else {
-          memcpy(adpcmBMem+memPos,s->dataB,paddedLen);
-          sampleLoaded[1][i]=true;
-        }
-        sampleOffB[i]=memPos;
-        memCompoB.entries.push_back(DivMemoryEntry(DIV_MEMORY_SAMPLE,"Sample",i,memPos,memPos+paddedLen));
-        memPos+=paddedLen;
+        items[i]=DivSamplePackItem((const unsigned char*)s->dataB,(s->lengthB+255)&(~0xff),s->renderRev);
+      }
+      packerB.setMemory(adpcmBMem,getSampleMemCapacity(1),0x100000,256);
+      packerB.pack(items);
+      for (int i=0; i<parent->song.sampleLen; i++) {
+        if (!items[i].use) continue;
+        sampleOffB[i]=packerB.getOffset(i);
+        sampleLoaded[1][i]=packerB.isPlaced(i);
       }
-      adpcmBMemLen=memPos+256;
+      packerB.fillComposition(memCompoB);
+      adpcmBMemLen=packerB.getEnd()+256;
 
       memCompoB.used=adpcmBMemLen;
       memCompoB.capacity=getSampleMemCapacity(1);
@@ -359,6 +336,8 @@ class DivPlatformYM2610Base: public DivPlatformOPN {
       delete ay;
       delete[] adpcmAMem;
       delete[] adpcmBMem;
+      packerA.reset();
+      packerB.reset();
     }
 
     DivPlatformYM2610Base(int ext, int psg, int adpcmA, int adpcmB, int chanCount):
@@ -28,6 +28,7 @@
 #include "dispatch.h"
 #include "engine.h"
 #include "workPool.h"
+#include "allocTracker.h"
 #include "../ta-log.h"
 #include <math.h>
 
@@ -376,6 +377,7 @@ int DivEngine::dispatchCmd(DivCommand c) {
     }
   }
   totalCmds++;
+  if (c.cmd==DIV_CMD_INSTRUMENT && c.chan<song.chans) chan[c.chan].insCmds++;
   // up to 2000 commands can be queued in the command queue (used by the GUI for pattern visualizer)
   if (cmdStreamEnabled && cmdStream.size()<2000) {
     cmdStream.push_back(c);
@@ -1268,6 +1270,7 @@ void DivEngine::processRow(int i, bool afterDelay) {
         if (divider<1) divider=1;
         cycles=got.rate/divider;
         clockDrift=0;
+        clockReset=true;
         subticks=0;
         break;
       case 0xdc: // delayed mute
@@ -1468,6 +1471,7 @@ void DivEngine::processRow(int i, bool afterDelay) {
         if (divider<1) divider=1;
         cycles=got.rate/divider;
         clockDrift=0;
+        clockReset=true;
         subticks=0;
         break;
       case 0xf3: // fine volume slide up
@@ -2000,8 +2004,12 @@ void DivEngine::nextRow() {
 // it is called by nextBuf(), playSub() nd the export functions.
 // noAccum will prevent the playback time from increasing.
 // if inhibitLowLat is on, low-latency mode is not taken into account. this is used by the export functions.
+// if parallel is on, chip dispatches are ticked in the render pool. only nextBuf() does this (if enabled).
 // returns whether the song has ended.
-bool DivEngine::nextTick(bool noAccum, bool inhibitLowLat) {
+bool DivEngine::nextTick(bool noAccum, bool inhibitLowLat, bool parallel) {
+  // macro values are read from here on (the export functions tick outside of
+  // nextBuf())
+  DivMacroReadSection readSection(macroReader);
   bool ret=false;
   // prevent a division by zero
   if (divider<1) divider=1;
@@ -2152,6 +2160,14 @@ bool DivEngine::nextTick(bool noAccum, bool inhibitLowLat) {
               logV("acknowledging scheduled stop");
               shallStop=true;
               break;
+            } else if (exporting && !skipping && exportRangeLeft()) {
+              // we're about to play a row outside of the export range (its end, or
+              // somewhere a jump took us). count it as a loop and go back to the start
+              logV("end of export range reached");
+              ret=true;
+              curOrder=exportBeginOrder;
+              curRow=exportBeginRow;
+              playSub(true,exportBeginRow);
             } else if (endOfSong) {
               // COMPAT FLAG: loop modality
               // - 0: reset channels. call playSub() to seek back to the loop position
@@ -2584,8 +2600,27 @@ bool DivEngine::nextTick(bool noAccum, bool inhibitLowLat) {
     return ret;
   }
 
+  // live parameter changes (not during export)
+  if (tickCallback && !exporting) tickCallback();
+
   // tick all chip dispatches (the argument determines whether it is a system tick or a sub-tick)
-  for (int i=0; i<song.systemLen; i++) disCont[i].dispatch->tick(subticks==tickMult);
+  // a dispatch only touches its own state here (macros, channel state and its
+  // write queue), so they can be ticked in parallel with the same result.
+  // everything before this point (rows, effects and commands) runs in order.
+  const bool sysTick=(subticks==tickMult);
+  if (parallel && renderPool!=NULL && song.systemLen>=DIV_PARALLEL_TICK_MIN) {
+    for (int i=0; i<song.systemLen; i++) {
+      disCont[i].tickIsSys=sysTick;
+      renderPool->push([](void* d) {
+        DIV_AUDIO_SECTION;
+        DivDispatchContainer* dc=(DivDispatchContainer*)d;
+        dc->dispatch->tick(dc->tickIsSys);
+      },&disCont[i]);
+    }
+    renderPool->wait();
+  } else {
+    for (int i=0; i<song.systemLen; i++) disCont[i].dispatch->tick(sysTick);
+  }
 
   // update playback time
   if (!freelance) {
@@ -2797,7 +2832,212 @@ void _runDispatch2(void* d) {
 
 // this fills the audio buffer and runs tbe engine.
 // called by the audio backend and during audio export.
-void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsigned int size) {
+void DivEngine::mixPort(unsigned int conn, float* dest, size_t size, float masterVol) {
+  // there are 4096 portsets. each portset may have up to 16 outputs (subports).
+  const unsigned short srcPort=conn>>16;
+  const unsigned short srcPortSet=srcPort>>4;
+  const unsigned char srcSubPort=srcPort&15;
+  const unsigned char destSubPort=conn&15;
+
+  if (srcPortSet<song.systemLen) {
+    // chip outputs
+    if (!playing || halted) return;
+    if (srcSubPort>=disCont[srcPortSet].dispatch->getOutputCount()) return;
+    float vol=song.systemVol[srcPortSet]*disCont[srcPortSet].dispatch->getPostAmp()*masterVol;
+
+    // apply volume and panning
+    switch (destSubPort&3) {
+      case 0:
+        vol*=MIN(1.0f,1.0f-song.systemPan[srcPortSet])*MIN(1.0f,1.0f+song.systemPanFR[srcPortSet]);
+        break;
+      case 1:
+        vol*=MIN(1.0f,1.0f+song.systemPan[srcPortSet])*MIN(1.0f,1.0f+song.systemPanFR[srcPortSet]);
+        break;
+      case 2:
+        vol*=MIN(1.0f,1.0f-song.systemPan[srcPortSet])*MIN(1.0f,1.0f-song.systemPanFR[srcPortSet]);
+        break;
+      case 3:
+        vol*=MIN(1.0f,1.0f+song.systemPan[srcPortSet])*MIN(1.0f,1.0f-song.systemPanFR[srcPortSet]);
+        break;
+    }
+
+    for (size_t j=0; j<size; j++) {
+      dest[j]+=((float)disCont[srcPortSet].bbOut[srcSubPort][j]/32768.0)*vol;
+    }
+  } else if (srcPortSet>=DIV_PORTSET_EFFECT && srcPortSet<DIV_PORTSET_EFFECT+DIV_MAX_EFFECT_NODES) {
+    // effect outputs
+    float* src=effectGraph.getOutput(srcPort);
+    if (src==NULL) return;
+    for (size_t j=0; j<size; j++) {
+      dest[j]+=src[j]*masterVol;
+    }
+  } else if (srcPortSet==0xffc) {
+    // file player
+    for (size_t j=0; j<size; j++) {
+      dest[j]+=filePlayerBuf[srcSubPort][j];
+    }
+  } else if (srcPortSet==0xffd) {
+    // sample preview
+    for (size_t j=0; j<size; j++) {
+      dest[j]+=previewVol*(samp_bbOut[j]/32768.0);
+    }
+  } else if (srcPortSet==0xffe && playing && !halted) {
+    // metronome
+    for (size_t j=0; j<size; j++) {
+      dest[j]+=metroBuf[j];
+    }
+  }
+
+  // nothing/invalid
+}
+
+void DivEngine::processEffectNode(DivEffectGraphNode* node) {
+  for (int i=0; i<node->inCount; i++) {
+    memset(node->in[i],0,node->len*sizeof(float));
+  }
+  for (unsigned int i: node->conns) {
+    const unsigned char destSubPort=i&15;
+    if (destSubPort>=node->inCount) continue;
+    // master volume is applied when leaving the graph
+    mixPort(i,node->in[destSubPort],node->len,1.0f);
+  }
+
+  node->effect->acquire(node->in,node->out,node->len);
+
+  // mix dry signal (only for matching inputs and outputs)
+  if (node->dryWet<1.0f) {
+    float dry=1.0f-node->dryWet;
+    for (int i=0; i<MIN(node->inCount,node->outCount); i++) {
+      float* in=node->in[i];
+      float* out=node->out[i];
+      for (size_t j=0; j<node->len; j++) {
+        out[j]=in[j]*dry+out[j]*node->dryWet;
+      }
+    }
+  }
+}
+
+// this is called by nextBuf() once a MIDI input event is due.
+void DivEngine::processMidiIn(TAMidiMessage& msg) {
+  // print MIDI events if MIDI debug is enabled
+  if (midiDebug) {
+    if (msg.type==TA_MIDI_SYSEX) {
+      logD("MIDI debug: %.2X SysEx",msg.type);
+    } else {
+      logD("MIDI debug: %.2X %.2X %.2X",msg.type,msg.data[0],msg.data[1]);
+    }
+  }
+  // call the MIDI callback, which may process this event further.
+  // the function should return an instrument index, which will be used
+  // for all forthcoming notes.
+  // special values:
+  // - -1: don't change
+  // - -2: "preview" instrument
+  // - -3: cancel event (do not add to pending notes)
+  int ins=-1;
+  if ((ins=midiCallback(msg))!=-3) {
+    // process event if not canceled
+    int chan=msg.type&15;
+    switch (msg.type&0xf0) {
+      case TA_MIDI_NOTE_OFF: {
+        if (midiIsDirect) {
+          // in direct mode, map the event directly to the channel
+          if (chan<0 || chan>=song.chans) break;
+          pendingNotes.push_back(DivNoteEvent(chan,-1,-1,-1,false,false,true));
+        } else {
+          // find a suitable channel and add this event to the queue
+          autoNoteOff(msg.type&15,msg.data[0]-12,msg.data[1]);
+        }
+        // start the engine if necessary
+        if (!playing) {
+          reset();
+          freelance=true;
+          playing=true;
+        }
+        break;
+      }
+      case TA_MIDI_NOTE_ON: {
+        // trigger note off if the velocity is 0
+        if (msg.data[1]==0) {
+          if (midiIsDirect) {
+            // in direct mode, map the event directly to the channel
+            if (chan<0 || chan>=song.chans) break;
+            pendingNotes.push_back(DivNoteEvent(chan,-1,-1,-1,false,false,true));
+          } else {
+            // find a suitable channel and add this event to the queue
+            autoNoteOff(msg.type&15,msg.data[0]-12,msg.data[1]);
+          }
+        } else {
+          if (midiIsDirect) {
+            // in direct mode, map the event directly to the channel
+            if (chan<0 || chan>=song.chans) break;
+            pendingNotes.push_back(DivNoteEvent(chan,ins,msg.data[0]-12,msg.data[1],true,false,true));
+          } else {
+            // find a suitable channel and add this event to the queue
+            autoNoteOn(msg.type&15,ins,msg.data[0]-12,msg.data[1]);
+          }
+        }
+        break;
+      }
+      case TA_MIDI_PROGRAM: {
+        // program changes in direct mode are handled here
+        // the GUI should cancel this event and change the current instrument
+        if (midiIsDirect && midiIsDirectProgram) {
+          pendingNotes.push_back(DivNoteEvent(chan,msg.data[0],0,0,false,true,true));
+        }
+        break;
+      }
+    }
+  } else if (midiDebug) {
+    logD("callback wants ignore");
+  }
+}
+
+// allocates what nextBuf() needs for buffers of up to size samples, so that
+// the audio thread doesn't have to. called when the dispatches or the audio
+// backend are set up (with the engine locked or the audio thread stopped).
+void DivEngine::prepareAudioBuffers(unsigned int size) {
+  if (size<1) size=1024;
+
+  if (metroTickLen<size) {
+    if (metroTick!=NULL) delete[] metroTick;
+    metroTick=new unsigned char[size];
+    metroTickLen=size;
+  }
+  if (filePlayerBufLen<size) {
+    for (int i=0; i<DIV_MAX_OUTPUTS; i++) {
+      if (filePlayerBuf[i]!=NULL) delete[] filePlayerBuf[i];
+      filePlayerBuf[i]=new float[size];
+    }
+    filePlayerBufLen=size;
+  }
+  if (metroBufLen<size || metroBuf==NULL) {
+    if (metroBuf!=NULL) delete[] metroBuf;
+    metroBuf=new float[size];
+    metroBufLen=size;
+  }
+  effectGraph.reserve(size);
+  effectGraph.setRate(got.rate);
+  for (int i=0; i<song.systemLen; i++) {
+    disCont[i].reserve(size);
+  }
+  // dispatchCmd() stops logging at 2000 commands
+  cmdStream.reserve(2000);
+
+  // set up the render thread pool
+  if (renderPool==NULL) {
+    unsigned int howManyThreads=song.systemLen;
+    if (howManyThreads<2) howManyThreads=0;
+    // in render-ahead mode each chip gets its own thread unless a limit was set
+    if (howManyThreads>renderPoolThreads && !(renderAheadBufs>0 && renderPoolThreads==0)) howManyThreads=renderPoolThreads;
+    renderPool=new DivWorkPool(howManyThreads);
+  }
+  if (size>preparedBufSize) preparedBufSize=size;
+}
+
+void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsigned int size, bool fromRenderAhead) {
+  DIV_AUDIO_SECTION;
+
   // debug information
   lastNBIns=inChans;
   lastNBOuts=outChans;
@@ -2828,97 +3068,56 @@ void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsi
   } else {
     isBusy.lock();
   }
+  // audio export has priority over the render-ahead thread
+  if (fromRenderAhead && exporting) {
+    isBusy.unlock();
+    return;
+  }
+  // macro values may be read from here on (also by the render pool)
+  macroReader.begin();
   got.bufsize=size;
 
   // this is used to calculate audio load
   std::chrono::steady_clock::time_point ts_processBegin=std::chrono::steady_clock::now();
 
-  // set up the render thread pool
-  if (renderPool==NULL) {
-    unsigned int howManyThreads=song.systemLen;
-    if (howManyThreads<2) howManyThreads=0;
-    if (howManyThreads>renderPoolThreads) howManyThreads=renderPoolThreads;
-    renderPool=new DivWorkPool(howManyThreads);
+  // profiler accumulators (committed at the end)
+  uint64_t perfBufBegin=divPerfNow();
+  uint64_t perfTickAccum=0;
+  uint64_t perfRenderAccum=0;
+  uint64_t perfPoolAccum=0;
+  uint64_t perfStageBegin=perfBufBegin;
+
+  // buffers and the render pool are set up beforehand (see prepareAudioBuffers()).
+  // this only happens if we get a larger buffer than the audio backend said.
+  if (renderPool==NULL || size>preparedBufSize) {
+    prepareAudioBuffers(size);
   }
 
   // process MIDI input events
-  if (output) if (output->midiIn) while (!output->midiIn->queue.empty()) {
-    TAMidiMessage& msg=output->midiIn->queue.front();
-    // print MIDI events if MIDI debug is enabled
-    if (midiDebug) {
-      if (msg.type==TA_MIDI_SYSEX) {
-        logD("MIDI debug: %.2X SysEx",msg.type);
-      } else {
-        logD("MIDI debug: %.2X %.2X %.2X",msg.type,msg.data[0],msg.data[1]);
-      }
-    }
-    // call the MIDI callback, which may process this event further.
-    // the function should return an instrument index, which will be used
-    // for all forthcoming notes.
-    // special values:
-    // - -1: don't change
-    // - -2: "preview" instrument
-    // - -3: cancel event (do not add to pending notes)
-    int ins=-1;
-    if ((ins=midiCallback(msg))!=-3) {
-      // process event if not canceled
-      int chan=msg.type&15;
-      switch (msg.type&0xf0) {
-        case TA_MIDI_NOTE_OFF: {
-          if (midiIsDirect) {
-            // in direct mode, map the event directly to the channel
-            if (chan<0 || chan>=song.chans) break;
-            pendingNotes.push_back(DivNoteEvent(chan,-1,-1,-1,false,false,true));
-          } else {
-            // find a suitable channel and add this event to the queue
-            autoNoteOff(msg.type&15,msg.data[0]-12,msg.data[1]);
-          }
-          // start the engine if necessary
-          if (!playing) {
-            reset();
-            freelance=true;
-            playing=true;
-          }
-          break;
-        }
-        case TA_MIDI_NOTE_ON: {
-          // trigger note off if the velocity is 0
-          if (msg.data[1]==0) {
-            if (midiIsDirect) {
-              // in direct mode, map the event directly to the channel
-              if (chan<0 || chan>=song.chans) break;
-              pendingNotes.push_back(DivNoteEvent(chan,-1,-1,-1,false,false,true));
-            } else {
-              // find a suitable channel and add this event to the queue
-              autoNoteOff(msg.type&15,msg.data[0]-12,msg.data[1]);
-            }
-          } else {
-            if (midiIsDirect) {
-              // in direct mode, map the event directly to the channel
-              if (chan<0 || chan>=song.chans) break;
-              pendingNotes.push_back(DivNoteEvent(chan,ins,msg.data[0]-12,msg.data[1],true,false,true));
-            } else {
-              // find a suitable channel and add this event to the queue
-              autoNoteOn(msg.type&15,ins,msg.data[0]-12,msg.data[1]);
-            }
-          }
-          break;
-        }
-        case TA_MIDI_PROGRAM: {
-          // program changes in direct mode are handled here
-          // the GUI should cancel this event and change the current instrument
-          if (midiIsDirect && midiIsDirectProgram) {
-            pendingNotes.push_back(DivNoteEvent(chan,msg.data[0],0,0,false,true,true));
-          }
-          break;
-        }
+  // events are timestamped on arrival and mapped to the previous buffer's
+  // period, so that they are processed at the tick they fall into rather than
+  // at the beginning of the buffer.
+  // the ones that can't be placed (the engine isn't playing yet) are
+  // processed right away.
+  // in render-ahead mode the audio callback passes them on through the
+  // render-ahead queue, and they are all processed at the beginning.
+  uint64_t midiBufEnd=std::chrono::duration_cast<std::chrono::nanoseconds>(ts_processBegin.time_since_epoch()).count();
+  uint64_t midiBufLen=((uint64_t)size*1000000000ULL)/MAX(1,(uint64_t)got.rate);
+  if (midiBufBegin<midiBufEnd-midiBufLen || midiBufBegin>midiBufEnd) midiBufBegin=midiBufEnd-midiBufLen;
+  if (fromRenderAhead) {
+    if (renderAhead!=NULL) {
+      TAMidiMessage msg;
+      while (renderAhead->popMidi(msg)) {
+        processMidiIn(msg);
       }
-    } else if (midiDebug) {
-      logD("callback wants ignore");
     }
-    //logD("%.2x",msg.type);
+  } else if (output) if (output->midiIn) while (!output->midiIn->queue.empty()) {
+    TAMidiMessage& msg=output->midiIn->queue.front();
+    if (playing && msg.stamp>midiBufBegin) break;
+    processMidiIn(msg);
     output->midiIn->queue.pop();
   }
+  perfStageBegin=perfEndStage(DIV_PERF_MIDI,perfStageBegin);
   
   // process sample/wave preview (not during audio export)
   if (((sPreview.sample>=0 && sPreview.sample<(int)song.sample.size()) || (sPreview.wave>=0 && sPreview.wave<(int)song.wave.size())) && !exporting) {
@@ -3075,6 +3274,7 @@ void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsi
   } else {
     memset(samp_bbOut,0,size*sizeof(short));
   }
+  perfStageBegin=perfEndStage(DIV_PERF_PREVIEW,perfStageBegin);
 
   // process audio (run the engine)
   bool mustPlay=playing && !halted;
@@ -3085,13 +3285,6 @@ void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsi
       disCont[i].runPos=0;
     }
 
-    // resize the metronome tick buffer if necessary
-    if (metroTickLen<size) {
-      if (metroTick!=NULL) delete[] metroTick;
-      metroTick=new unsigned char[size];
-      metroTickLen=size;
-    }
-
     // reset the metronome tick buffer
     memset(metroTick,0,size);
 
@@ -3111,8 +3304,19 @@ void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsi
 
       // 2. check whether we gonna tick
       if (cycles<=0) {
+        // process MIDI input events which arrived before this point
+        if (!fromRenderAhead) if (output) if (output->midiIn) while (!output->midiIn->queue.empty()) {
+          TAMidiMessage& msg=output->midiIn->queue.front();
+          if (msg.stamp>midiBufBegin+(midiBufLen*bufferPos)/size) break;
+          processMidiIn(msg);
+          output->midiIn->queue.pop();
+        }
+
         // we have to tick
-        if (nextTick()) {
+        uint64_t perfTickBegin=divPerfNow();
+        bool songEnded=nextTick(false,false,parallelTick);
+        perfTickAccum+=perfTraceEvent(DIV_PERF_TICK,perfTickBegin);
+        if (songEnded) {
           /*totalTicks=0;
           totalSeconds=0;*/
           // used by audio export to determine how many samples to write (otherwise it'll add silence at the end)
@@ -3166,13 +3370,16 @@ void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsi
         if (cycles<runLeftG) {
           // a tick will happen before the buffer ends
           // run until the end of this tick
+          uint64_t perfSliceBegin=divPerfNow();
           for (int i=0; i<song.systemLen; i++) {
             disCont[i].cycles=cycles;
             disCont[i].size=size;
+            disCont[i].perfSlice=0;
             renderPool->push([](void* d) {
+              DIV_AUDIO_SECTION;
               DivDispatchContainer* dc=(DivDispatchContainer*)d;
 
-              int lastAvail=blip_samples_avail(dc->bb[0]);
+              int lastAvail=dc->samplesAvail();
               if (lastAvail>0) {
                 if (lastAvail>=dc->cycles) {
                   dc->flush(dc->runPos,dc->cycles);
@@ -3186,30 +3393,37 @@ void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsi
               }
               
               // if the buffer is too small, resize it
-              int total=blip_clocks_needed(dc->bb[0],dc->cycles);
+              int total=dc->clocksNeeded(dc->cycles);
               if (total>(int)dc->bbInLen) {
                 logD("growing dispatch %p bbIn to %d",(void*)dc,total+256);
                 dc->grow(total+256);
               }
+              uint64_t perfBegin=divPerfNow();
               dc->acquire(total);
+              uint64_t perfMid=divPerfNow();
               dc->fillBuf(total,dc->runPos,dc->cycles);
+              dc->perfRecord(perfBegin,perfMid,divPerfNow());
               // advance run position
               dc->runPos+=dc->cycles;
             },&disCont[i]);
           }
           renderPool->wait();
+          perfEndRenderSlice(perfSliceBegin,perfRenderAccum,perfPoolAccum);
           runLeftG-=cycles;
           cycles=0;
         } else {
           // the buffer will end before a tick happens
           // run until the end of this audio buffer
           cycles-=runLeftG;
+          uint64_t perfSliceBegin=divPerfNow();
           for (int i=0; i<song.systemLen; i++) {
             disCont[i].cycles=runLeftG;
+            disCont[i].perfSlice=0;
             renderPool->push([](void* d) {
+              DIV_AUDIO_SECTION;
               DivDispatchContainer* dc=(DivDispatchContainer*)d;
 
-              int lastAvail=blip_samples_avail(dc->bb[0]);
+              int lastAvail=dc->samplesAvail();
               if (lastAvail>0) {
                 if (lastAvail>=dc->cycles) {
                   dc->flush(dc->runPos,dc->cycles);
@@ -3222,18 +3436,22 @@ void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsi
                 }
               }
 
-              int total=blip_clocks_needed(dc->bb[0],dc->cycles);
+              int total=dc->clocksNeeded(dc->cycles);
               if (total>(int)dc->bbInLen) {
                 logD("growing dispatch %p bbIn to %d",(void*)dc,total+256);
                 dc->grow(total+256);
               }
+              uint64_t perfBegin=divPerfNow();
               dc->acquire(total);
+              uint64_t perfMid=divPerfNow();
               dc->fillBuf(total,dc->runPos,dc->cycles);
+              dc->perfRecord(perfBegin,perfMid,divPerfNow());
             },&disCont[i]);
           }
           // at this point runLeftG will be zero and we can break out of the loop
           runLeftG=0;
           renderPool->wait();
+          perfEndRenderSlice(perfSliceBegin,perfRenderAccum,perfPoolAccum);
         }
       }
     }
@@ -3266,15 +3484,15 @@ void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsi
     renderPool->wait();
   }
 
-  // process file player
-  // resize file player audio buffer if necessary
-  if (filePlayerBufLen<size) {
-    for (int i=0; i<DIV_MAX_OUTPUTS; i++) {
-      if (filePlayerBuf[i]!=NULL) delete[] filePlayerBuf[i];
-      filePlayerBuf[i]=new float[size];
-    }
-    filePlayerBufLen=size;
+  // process the remaining MIDI input events (they'll be applied on the next tick)
+  if (!fromRenderAhead) if (output) if (output->midiIn) while (!output->midiIn->queue.empty()) {
+    processMidiIn(output->midiIn->queue.front());
+    output->midiIn->queue.pop();
   }
+  if (!fromRenderAhead) midiBufBegin=midiBufEnd;
+
+  // process file player
+  perfStageBegin=divPerfNow();
   if (curFilePlayer!=NULL && !exporting) {
     curFilePlayer->mix(filePlayerBuf,outChans,size);
   } else {
@@ -3284,13 +3502,6 @@ void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsi
   }
 
   // process metronome
-  // resize the metronome's audio buffer if necessary
-  if (metroBufLen<size || metroBuf==NULL) {
-    if (metroBuf!=NULL) delete[] metroBuf;
-    metroBuf=new float[size];
-    metroBufLen=size;
-  }
-
   memset(metroBuf,0,metroBufLen*sizeof(float));
 
   // insert metronome ticks
@@ -3333,81 +3544,51 @@ void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsi
     }
   }
 
-  // now mix everything (resolve patchbay)
-  for (unsigned int i: song.patchbay) {
-    // there are 4096 portsets. each portset may have up to 16 outputs (subports).
-    const unsigned short srcPort=i>>16;
-    const unsigned short destPort=i&0xffff;
-
-    const unsigned short srcPortSet=srcPort>>4;
-    const unsigned short destPortSet=destPort>>4;
-    const unsigned char srcSubPort=srcPort&15;
-    const unsigned char destSubPort=destPort&15;
-
-    // null portset (disconnected)
-    if (destPortSet==0xfff) continue;
-
-    // system outputs (the audio buffer)
-    if (destPortSet==0x000) {
-      if (destSubPort>=outChans) continue;
-
-      // chip outputs
-      if (srcPortSet<song.systemLen && playing && !halted) {
-        if (srcSubPort<disCont[srcPortSet].dispatch->getOutputCount()) {
-          float vol=song.systemVol[srcPortSet]*disCont[srcPortSet].dispatch->getPostAmp()*song.masterVol*refPlayerVol;
-
-          // apply volume and panning
-          switch (destSubPort&3) {
-            case 0:
-              vol*=MIN(1.0f,1.0f-song.systemPan[srcPortSet])*MIN(1.0f,1.0f+song.systemPanFR[srcPortSet]);
-              break;
-            case 1:
-              vol*=MIN(1.0f,1.0f+song.systemPan[srcPortSet])*MIN(1.0f,1.0f+song.systemPanFR[srcPortSet]);
-              break;
-            case 2:
-              vol*=MIN(1.0f,1.0f-song.systemPan[srcPortSet])*MIN(1.0f,1.0f-song.systemPanFR[srcPortSet]);
-              break;
-            case 3:
-              vol*=MIN(1.0f,1.0f+song.systemPan[srcPortSet])*MIN(1.0f,1.0f-song.systemPanFR[srcPortSet]);
-              break;
-          }
-
-          for (size_t j=0; j<size; j++) {
-            out[destSubPort][j]+=((float)disCont[srcPortSet].bbOut[srcSubPort][j]/32768.0)*vol;
-          }
-        }
-      } else if (srcPortSet==0xffc) {
-        // file player
-        for (size_t j=0; j<size; j++) {
-          out[destSubPort][j]+=filePlayerBuf[srcSubPort][j];
-        }
-      } else if (srcPortSet==0xffd) {
-        // sample preview
-        for (size_t j=0; j<size; j++) {
-          out[destSubPort][j]+=previewVol*(samp_bbOut[j]/32768.0);
-        }
-      } else if (srcPortSet==0xffe && playing && !halted) {
-        // metronome
-        for (size_t j=0; j<size; j++) {
-          out[destSubPort][j]+=metroBuf[j];
-        }
+  // run effects (the graph is rebuilt by whatever changes the patchbay, and
+  // sized by prepareAudioBuffers())
+  float effectMasterVol=song.masterVol*refPlayerVol;
+  for (size_t i=0; i+1<effectGraph.levelStart.size(); i++) {
+    size_t levelBegin=effectGraph.levelStart[i];
+    size_t levelEnd=effectGraph.levelStart[i+1];
+    for (size_t j=levelBegin; j<levelEnd; j++) {
+      effectGraph.nodes[j].len=size;
+    }
+    // nodes on the same level don't depend on each other
+    if (levelEnd-levelBegin>1) {
+      for (size_t j=levelBegin; j<levelEnd; j++) {
+        renderPool->push([](void* d) {
+          DIV_AUDIO_SECTION;
+          DivEffectGraphNode* node=(DivEffectGraphNode*)d;
+          node->parent->processEffectNode(node);
+        },&effectGraph.nodes[j]);
       }
-
-      // nothing/invalid
+      renderPool->wait();
+    } else if (levelEnd>levelBegin) {
+      processEffectNode(&effectGraph.nodes[levelBegin]);
     }
+  }
 
-    // nothing/invalid
+  // now mix everything
+  for (unsigned int i: effectGraph.outConns) {
+    const unsigned char destSubPort=i&15;
+    if (destSubPort>=outChans) continue;
+    mixPort(i,out[destSubPort],size,effectMasterVol);
   }
 
   // dump to oscillator buffer (a ring buffer)
-  for (unsigned int i=0; i<size; i++) {
-    for (int j=0; j<outChans; j++) {
-      if (oscBuf[j]==NULL) continue;
-      oscBuf[j][oscWritePos]=out[j][i];
+  // (in render-ahead mode this is done by the audio callback)
+  if (!fromRenderAhead) {
+    int writePos=oscWritePos.load(std::memory_order_relaxed);
+    for (unsigned int i=0; i<size; i++) {
+      for (int j=0; j<outChans; j++) {
+        if (oscBuf[j]==NULL) continue;
+        oscBuf[j][writePos]=out[j][i];
+      }
+      if (++writePos>=32768) writePos=0;
     }
-    if (++oscWritePos>=32768) oscWritePos=0;
+    oscWritePos.store(writePos,std::memory_order_release);
+    oscSize=size;
   }
-  oscSize=size;
 
   // get per-chip peaks
   if (isRunning()) {
@@ -3468,6 +3649,17 @@ void DivEngine::nextBuf(float** in, float** out, int inChans, int outChans, unsi
       }
     }
   }
+  perfEndStage(DIV_PERF_MIX,perfStageBegin);
+
+  // commit profiler statistics
+  perfStage[DIV_PERF_TICK].add(perfTickAccum);
+  perfStage[DIV_PERF_RENDER].add(perfRenderAccum);
+  perfStage[DIV_PERF_POOL].add(perfPoolAccum);
+  for (int i=0; i<song.systemLen; i++) {
+    disCont[i].perfCommit();
+  }
+  perfEndStage(DIV_PERF_TOTAL,perfBufBegin);
+  macroReader.end();
   isBusy.unlock();
 
   std::chrono::steady_clock::time_point ts_processEnd=std::chrono::steady_clock::now();
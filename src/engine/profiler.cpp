@@ -0,0 +1,209 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "engine.h"
+#include "../ta-log.h"
+#include "../fileutils.h"
+#include <fmt/printf.h>
+#include <inttypes.h>
+
+const char* divPerfStageNames[DIV_PERF_MAX]={
+  "total",
+  "MIDI input",
+  "preview",
+  "tick",
+  "render",
+  "pool sync",
+  "mix"
+};
+
+static const char* divPerfChipStageNames[2]={
+  "acquire",
+  "fillBuf"
+};
+
+void DivPerfCounter::add(uint64_t ns) {
+  total.fetch_add(ns,std::memory_order_relaxed);
+  count.fetch_add(1,std::memory_order_relaxed);
+  last.store(ns,std::memory_order_relaxed);
+  if (ns>max.load(std::memory_order_relaxed)) max.store(ns,std::memory_order_relaxed);
+
+  uint64_t us=ns/1000;
+  int bucket=0;
+  while (us>0 && bucket<DIV_PERF_HIST_BUCKETS-1) {
+    us>>=1;
+    bucket++;
+  }
+  hist[bucket].fetch_add(1,std::memory_order_relaxed);
+}
+
+void DivPerfCounter::reset() {
+  total=0;
+  count=0;
+  max=0;
+  last=0;
+  for (int i=0; i<DIV_PERF_HIST_BUCKETS; i++) hist[i]=0;
+}
+
+double DivPerfCounter::avgMicros() const {
+  uint64_t c=count.load(std::memory_order_relaxed);
+  if (c==0) return 0.0;
+  return (double)total.load(std::memory_order_relaxed)/(1000.0*(double)c);
+}
+
+uint64_t DivEngine::perfEndStage(DivPerfStage stage, uint64_t begin) {
+  uint64_t now=divPerfNow();
+  perfStage[stage].add(now-begin);
+  if (perfTrace) perfEvents.push_back(DivPerfEvent(begin,now-begin,-1,stage));
+  return now;
+}
+
+uint64_t DivEngine::perfTraceEvent(DivPerfStage stage, uint64_t begin) {
+  uint64_t now=divPerfNow();
+  if (perfTrace) perfEvents.push_back(DivPerfEvent(begin,now-begin,-1,stage));
+  return now-begin;
+}
+
+void DivEngine::perfEndRenderSlice(uint64_t begin, uint64_t& renderAccum, uint64_t& poolAccum) {
+  uint64_t now=divPerfNow();
+  uint64_t slowest=0;
+  for (int i=0; i<song.systemLen; i++) {
+    if (disCont[i].perfSlice>slowest) slowest=disCont[i].perfSlice;
+  }
+  renderAccum+=now-begin;
+  if (now-begin>slowest) poolAccum+=(now-begin)-slowest;
+  if (perfTrace) perfEvents.push_back(DivPerfEvent(begin,now-begin,-1,DIV_PERF_RENDER));
+}
+
+DivPerfCounter* DivEngine::getPerfCounter(DivPerfStage stage) {
+  if (stage<0 || stage>=DIV_PERF_MAX) return NULL;
+  return &perfStage[stage];
+}
+
+DivPerfCounter* DivEngine::getChipPerfCounter(int chip, int which) {
+  if (chip<0 || chip>=song.systemLen) return NULL;
+  return (which==DIV_PERF_CHIP_FILLBUF)?&disCont[chip].perfFillBuf:&disCont[chip].perfAcquire;
+}
+
+void DivEngine::resetPerf() {
+  for (int i=0; i<DIV_PERF_MAX; i++) {
+    perfStage[i].reset();
+  }
+  for (int i=0; i<DIV_MAX_CHIPS; i++) {
+    disCont[i].perfAcquire.reset();
+    disCont[i].perfFillBuf.reset();
+  }
+}
+
+void DivEngine::setPerfTrace(bool enable) {
+  BUSY_BEGIN;
+  perfTrace=enable;
+  perfEvents.clear();
+  for (int i=0; i<DIV_MAX_CHIPS; i++) {
+    disCont[i].perfTrace=enable;
+    disCont[i].perfEvents.clear();
+  }
+  perfTraceBegin=divPerfNow();
+  BUSY_END;
+}
+
+static void writePerfCounterJSON(FILE* f, const char* name, DivPerfCounter& c) {
+  fprintf(f,"{\"name\":\"%s\",\"count\":%" PRIu64 ",\"totalNs\":%" PRIu64 ",\"maxNs\":%" PRIu64 ",\"avgUs\":%.3f,\"histogramUs\":[",
+    name,
+    (uint64_t)c.count.load(),
+    (uint64_t)c.total.load(),
+    (uint64_t)c.max.load(),
+    c.avgMicros()
+  );
+  for (int i=0; i<DIV_PERF_HIST_BUCKETS; i++) {
+    fprintf(f,"%s%u",(i>0)?",":"",c.hist[i].load());
+  }
+  fprintf(f,"]}");
+}
+
+bool DivEngine::writePerfTrace(const char* path) {
+  FILE* f=ps_fopen(path,"wb");
+  if (f==NULL) {
+    logE("could not open trace file! (%s)",strerror(errno));
+    return false;
+  }
+
+  fprintf(f,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  // name the lanes
+  fprintf(f,"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"engine\"}}");
+  for (int i=0; i<song.systemLen; i++) {
+    fprintf(f,",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%d: %s\"}}",i+1,i,getSystemName(song.system[i]));
+  }
+
+  for (DivPerfEvent& i: perfEvents) {
+    if (i.begin<perfTraceBegin) continue;
+    fprintf(f,",\n{\"name\":\"%s\",\"cat\":\"engine\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+      divPerfStageNames[i.stage],
+      (double)(i.begin-perfTraceBegin)/1000.0,
+      (double)i.dur/1000.0
+    );
+  }
+  for (int i=0; i<song.systemLen; i++) {
+    for (DivPerfEvent& j: disCont[i].perfEvents) {
+      if (j.begin<perfTraceBegin) continue;
+      fprintf(f,",\n{\"name\":\"%s\",\"cat\":\"chip\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+        divPerfChipStageNames[j.stage&1],
+        i+1,
+        (double)(j.begin-perfTraceBegin)/1000.0,
+        (double)j.dur/1000.0
+      );
+    }
+  }
+  fprintf(f,"\n],\n");
+
+  // statistics
+  fprintf(f,"\"furnaceStats\":{\"stages\":[");
+  for (int i=0; i<DIV_PERF_MAX; i++) {
+    if (i>0) fprintf(f,",");
+    writePerfCounterJSON(f,divPerfStageNames[i],perfStage[i]);
+  }
+  fprintf(f,"],\"chips\":[");
+  for (int i=0; i<song.systemLen; i++) {
+    if (i>0) fprintf(f,",");
+    fprintf(f,"{\"index\":%d,\"system\":\"%s\",\"acquire\":",i,getSystemName(song.system[i]));
+    writePerfCounterJSON(f,"acquire",disCont[i].perfAcquire);
+    fprintf(f,",\"fillBuf\":");
+    writePerfCounterJSON(f,"fillBuf",disCont[i].perfFillBuf);
+    fprintf(f,"}");
+  }
+  fprintf(f,"]}}\n");
+
+  fclose(f);
+  return true;
+}
+
+void DivEngine::printPerfStats() {
+  printf("%-24s %10s %10s %12s\n","stage","avg (µs)","max (µs)","total (ms)");
+  for (int i=0; i<DIV_PERF_MAX; i++) {
+    DivPerfCounter& c=perfStage[i];
+    printf("%-24s %10.2f %10.2f %12.3f\n",divPerfStageNames[i],c.avgMicros(),(double)c.max.load()/1000.0,(double)c.total.load()/1000000.0);
+  }
+  for (int i=0; i<song.systemLen; i++) {
+    for (int j=0; j<2; j++) {
+      DivPerfCounter& c=(j==DIV_PERF_CHIP_FILLBUF)?disCont[i].perfFillBuf:disCont[i].perfAcquire;
+      String name=fmt::sprintf("%d: %s %s",i,getSystemName(song.system[i]),divPerfChipStageNames[j]);
+      printf("%-24s %10.2f %10.2f %12.3f\n",name.c_str(),c.avgMicros(),(double)c.max.load()/1000.0,(double)c.total.load()/1000000.0);
+    }
+  }
+}
@@ -0,0 +1,94 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+// histogram buckets are powers of two in microseconds.
+// bucket 0 is <1µs, bucket n is [2^(n-1), 2^n)µs and the last one catches the rest.
+#define DIV_PERF_HIST_BUCKETS 24
+
+enum DivPerfStage {
+  // the entire nextBuf() call
+  DIV_PERF_TOTAL=0,
+  // MIDI input processing
+  DIV_PERF_MIDI,
+  // sample/wave preview
+  DIV_PERF_PREVIEW,
+  // nextTick()
+  DIV_PERF_TICK,
+  // chip rendering (wall time, including pool synchronization)
+  DIV_PERF_RENDER,
+  // time spent waiting on the render pool beyond the slowest chip
+  DIV_PERF_POOL,
+  // file player, metronome, patchbay mix and post-processing
+  DIV_PERF_MIX,
+
+  DIV_PERF_MAX
+};
+
+extern const char* divPerfStageNames[DIV_PERF_MAX];
+
+/**
+ * a timer with statistics.
+ * written by the audio thread and read by anyone (hence the relaxed atomics).
+ */
+struct DivPerfCounter {
+  std::atomic<uint64_t> total, count, max, last;
+  std::atomic<unsigned int> hist[DIV_PERF_HIST_BUCKETS];
+
+  void add(uint64_t ns);
+  void reset();
+  double avgMicros() const;
+
+  DivPerfCounter():
+    total(0),
+    count(0),
+    max(0),
+    last(0) {
+    for (int i=0; i<DIV_PERF_HIST_BUCKETS; i++) hist[i]=0;
+  }
+};
+
+// a single trace event (only recorded when tracing is enabled).
+// chip is -1 for engine stages.
+// stage is a DivPerfStage, or DIV_PERF_CHIP_* for chip events.
+struct DivPerfEvent {
+  uint64_t begin, dur;
+  short chip;
+  unsigned char stage;
+  DivPerfEvent(uint64_t b, uint64_t d, short c, unsigned char s):
+    begin(b),
+    dur(d),
+    chip(c),
+    stage(s) {}
+};
+
+#define DIV_PERF_CHIP_ACQUIRE 0
+#define DIV_PERF_CHIP_FILLBUF 1
+
+static inline uint64_t divPerfNow() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif
@@ -0,0 +1,196 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "regTrace.h"
+#include "engine.h"
+#include "../ta-log.h"
+#include <math.h>
+
+const unsigned char* DivRegisterTrace::getPool(int chip, size_t tick) const {
+  if (chip<0 || chip>=systemLen) return NULL;
+  if (poolSize[chip]<=0) return NULL;
+  if (tick>=getTickCount()) return NULL;
+  return &pool[chip][tick*poolSize[chip]];
+}
+
+void DivRegisterTrace::clear() {
+  writeTick.clear();
+  writeChip.clear();
+  writeAddr.clear();
+  writeVal.clear();
+  writeDelay.clear();
+  tickFirstWrite.clear();
+  tickRate.clear();
+  tickReset.clear();
+  tickOrder.clear();
+  tickRow.clear();
+  tickTicks.clear();
+  for (int i=0; i<DIV_MAX_CHIPS; i++) {
+    pool[i].clear();
+    poolSize[i]=0;
+  }
+  systemLen=0;
+  loopOrder=0;
+  loopRow=0;
+  stopped=false;
+  songRev=0;
+  subSong=0;
+}
+
+int DivRegisterTraceClock::advance(const DivRegisterTrace& t, size_t tick) {
+  if (tick>=t.getTickCount()) return 0;
+  double tickRate=t.tickRate[tick];
+  int ret=rate/tickRate;
+  if (t.tickReset[tick]) {
+    drift=0;
+  } else {
+    drift+=fmod(rate,tickRate);
+    if (drift>=tickRate) {
+      drift-=tickRate;
+      ret++;
+    }
+  }
+  frames+=ret;
+  return ret;
+}
+
+void DivEngine::captureRegisterTrace(DivRegisterTrace* t) {
+  // determine loop point
+  calcSongTimestamps();
+  t->loopOrder=curSubSong->ts.loopStart.order;
+  t->loopRow=curSubSong->ts.loopStart.row;
+  warnings="";
+
+  // reset the playback state
+  curOrder=0;
+  freelance=false;
+  playing=false;
+  extValuePresent=false;
+  remainingLoops=-1;
+
+  t->systemLen=song.systemLen;
+  for (int i=0; i<song.systemLen; i++) {
+    int size=disCont[i].dispatch->getRegisterPoolSize();
+    t->poolSize[i]=(size>0 && size<=DIV_REGTRACE_MAX_POOL)?size:0;
+    disCont[i].dispatch->getRegisterWrites().clear();
+    disCont[i].dispatch->toggleRegisterDump(true);
+  }
+
+  // writes made while seeking to the start come before tickFirstWrite[0]
+  playSub(false);
+  for (int i=0; i<song.systemLen; i++) {
+    for (DivRegWrite& j: disCont[i].dispatch->getRegisterWrites()) {
+      t->writeTick.push_back(0);
+      t->writeChip.push_back(i);
+      t->writeAddr.push_back(j.addr);
+      t->writeVal.push_back(j.val);
+      t->writeDelay.push_back(0);
+    }
+    disCont[i].dispatch->getRegisterWrites().clear();
+  }
+
+  bool done=false;
+  while (!done) {
+    unsigned int tick=t->tickRate.size();
+    t->tickOrder.push_back(curOrder);
+    t->tickRow.push_back(curRow);
+    t->tickTicks.push_back(ticks);
+
+    // the tick length comes from the tick rate before the tick, unless an
+    // effect changes it (and resets the clock) during the tick
+    double tickRate=MAX(1.0,divider);
+    clockReset=false;
+    if (nextTick(false,true) || !playing) {
+      done=true;
+    }
+    if (clockReset) tickRate=divider;
+
+    t->tickFirstWrite.push_back(t->writeAddr.size());
+    for (int i=0; i<song.systemLen; i++) {
+      std::vector<DivRegWrite>& writes=disCont[i].dispatch->getRegisterWrites();
+      unsigned int delay=0;
+      for (DivRegWrite& j: writes) {
+        t->writeTick.push_back(tick);
+        t->writeChip.push_back(i);
+        t->writeAddr.push_back(j.addr);
+        t->writeVal.push_back(j.val);
+        t->writeDelay.push_back(delay);
+        if (j.addr==0xfffffffe) delay+=j.val;
+      }
+      writes.clear();
+
+      if (t->poolSize[i]>0) {
+        unsigned char* regPool=disCont[i].dispatch->getRegisterPool();
+        if (regPool!=NULL) {
+          t->pool[i].insert(t->pool[i].end(),regPool,regPool+t->poolSize[i]);
+        } else {
+          t->pool[i].resize(t->pool[i].size()+t->poolSize[i],0);
+        }
+      }
+    }
+    t->tickRate.push_back(tickRate);
+    t->tickReset.push_back(clockReset);
+    cmdStream.clear();
+  }
+  t->tickFirstWrite.push_back(t->writeAddr.size());
+  t->stopped=!playing;
+
+  // done - close out
+  for (int i=0; i<song.systemLen; i++) {
+    disCont[i].dispatch->getRegisterWrites().clear();
+    disCont[i].dispatch->toggleRegisterDump(false);
+  }
+
+  remainingLoops=-1;
+  playing=false;
+  freelance=false;
+  extValuePresent=false;
+}
+
+void DivEngine::markSongModified() {
+  songRev.fetch_add(1,std::memory_order_relaxed);
+}
+
+std::shared_ptr<const DivRegisterTrace> DivEngine::getRegisterTrace() {
+  uint64_t rev=songRev.load(std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(regTraceLock);
+  if (regTrace && regTrace->songRev==rev && regTrace->subSong==curSubSongIndex) {
+    logV("using cached register trace (%d ticks).",(int)regTrace->getTickCount());
+    return regTrace;
+  }
+
+  logI("capturing register trace...");
+  stop();
+  repeatPattern=false;
+  shallStop=false;
+  setOrder(0);
+
+  // exports still holding the previous trace keep it until they are done
+  std::shared_ptr<DivRegisterTrace> t=std::make_shared<DivRegisterTrace>();
+  synchronizedSoft([this,&t]() {
+    captureRegisterTrace(t.get());
+  });
+  t->songRev=rev;
+  t->subSong=curSubSongIndex;
+  logI("captured %d ticks and %d writes.",(int)t->getTickCount(),(int)t->writeAddr.size());
+
+  regTrace=t;
+  return regTrace;
+}
@@ -0,0 +1,109 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _REG_TRACE_H
+#define _REG_TRACE_H
+
+#include "defines.h"
+#include <vector>
+#include <string.h>
+#include <stdint.h>
+
+// register pools larger than this are not captured
+#define DIV_REGTRACE_MAX_POOL 64
+
+/**
+ * register writes of an entire song, captured once by playing it on the engine
+ * as fast as possible (see DivEngine::getRegisterTrace()).
+ * used by SAP-R, GRUB, iPod, TIunA and ZSM export. VGM export and Amiga
+ * validation still play the song themselves.
+ * stored in columns so that exporters which only need part of it stay cache-friendly.
+ *
+ * the last tick is the one on which the song ended (looped or stopped).
+ * most exporters ignore its writes (they belong to the loop).
+ */
+struct DivRegisterTrace {
+  // per write
+  std::vector<unsigned int> writeTick;
+  std::vector<unsigned char> writeChip;
+  std::vector<unsigned int> writeAddr;
+  std::vector<unsigned int> writeVal;
+  // sum of the delay pseudo-writes (0xfffffffe) preceding this one within the tick
+  std::vector<unsigned int> writeDelay;
+
+  // per tick
+  // index of the first write in this tick (one more entry than ticks, for convenience)
+  std::vector<unsigned int> tickFirstWrite;
+  // tick rate (in Hz) the length of the tick is derived from
+  std::vector<double> tickRate;
+  // whether the tick clock was reset (by a tick rate effect) during this tick
+  std::vector<unsigned char> tickReset;
+  // playback position and tick counter before the tick
+  std::vector<short> tickOrder;
+  std::vector<short> tickRow;
+  std::vector<int> tickTicks;
+  // register pool after the tick (only for chips with a pool of up to DIV_REGTRACE_MAX_POOL bytes)
+  std::vector<unsigned char> pool[DIV_MAX_CHIPS];
+  int poolSize[DIV_MAX_CHIPS];
+
+  int systemLen;
+  int loopOrder, loopRow;
+  // whether the song stopped (as opposed to looping)
+  bool stopped;
+  // the song revision and sub-song this trace belongs to
+  uint64_t songRev;
+  size_t subSong;
+
+  size_t getTickCount() const {
+    return tickRate.size();
+  }
+  // pointer to the register pool of a chip after a tick (NULL if not captured)
+  const unsigned char* getPool(int chip, size_t tick) const;
+  void clear();
+
+  DivRegisterTrace():
+    systemLen(0),
+    loopOrder(0),
+    loopRow(0),
+    stopped(false),
+    songRev(0),
+    subSong(0) {
+    memset(poolSize,0,DIV_MAX_CHIPS*sizeof(int));
+  }
+};
+
+/**
+ * converts ticks into frames at an arbitrary rate.
+ * the remainder is carried over like in DivEngine::nextTick(), so the lengths
+ * are the same as when playing the song at that rate.
+ */
+struct DivRegisterTraceClock {
+  double rate, drift;
+  uint64_t frames;
+
+  // advance by one tick of a trace and return its length in frames
+  int advance(const DivRegisterTrace& t, size_t tick);
+
+  DivRegisterTraceClock(double r):
+    rate(r),
+    drift(0.0),
+    frames(0) {}
+};
+
+#endif
@@ -0,0 +1,171 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "renderAhead.h"
+#include "engine.h"
+#include "../ta-log.h"
+
+static void _runRenderAhead(void* d) {
+  ((DivRenderAhead*)d)->run();
+}
+
+void DivRenderAhead::run() {
+  // wake up at least twice per block in case a notification was missed
+  unsigned int waitMicros=(unsigned int)(500000.0*(double)blockSize/MAX(1.0,e->getAudioDescGot().rate));
+  if (waitMicros<500) waitMicros=500;
+
+  while (running) {
+    // render until the ring is full
+    while (running && (writePos.load(std::memory_order_relaxed)-readPos.load(std::memory_order_acquire))+blockSize<=ringLen) {
+      e->nextBuf(NULL,block,0,chans,blockSize,true);
+
+      uint64_t wp=writePos.load(std::memory_order_relaxed);
+      unsigned int pos=wp%ringLen;
+      unsigned int first=MIN(blockSize,ringLen-pos);
+      for (int i=0; i<chans; i++) {
+        memcpy(&ring[i][pos],block[i],first*sizeof(float));
+        if (first<blockSize) {
+          memcpy(ring[i],&block[i][first],(blockSize-first)*sizeof(float));
+        }
+      }
+      writePos.store(wp+blockSize,std::memory_order_release);
+    }
+
+    std::unique_lock<std::mutex> unique(notifyLock);
+    notifyCV.wait_for(unique,std::chrono::microseconds(waitMicros));
+  }
+}
+
+bool DivRenderAhead::read(float** out, int outChans, unsigned int size) {
+  uint64_t rp=readPos.load(std::memory_order_relaxed);
+  uint64_t avail=writePos.load(std::memory_order_acquire)-rp;
+  unsigned int toRead=(avail<size)?(unsigned int)avail:size;
+
+  unsigned int pos=rp%ringLen;
+  unsigned int first=MIN(toRead,ringLen-pos);
+  for (int i=0; i<outChans; i++) {
+    if (i>=chans) {
+      memset(out[i],0,size*sizeof(float));
+      continue;
+    }
+    memcpy(out[i],&ring[i][pos],first*sizeof(float));
+    if (first<toRead) {
+      memcpy(&out[i][first],ring[i],(toRead-first)*sizeof(float));
+    }
+    if (toRead<size) {
+      memset(&out[i][toRead],0,(size-toRead)*sizeof(float));
+    }
+  }
+  readPos.store(rp+toRead,std::memory_order_release);
+
+  // let the producer refill (notify doesn't need the lock)
+  notifyCV.notify_one();
+
+  if (toRead<size) {
+    underruns.fetch_add(1,std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+bool DivRenderAhead::pushMidi(const TAMidiMessage& msg) {
+  uint64_t wp=midiWritePos.load(std::memory_order_relaxed);
+  if (wp-midiReadPos.load(std::memory_order_acquire)>=DIV_RENDER_AHEAD_MIDI) return false;
+  midiRing[wp&(DIV_RENDER_AHEAD_MIDI-1)]=msg;
+  midiWritePos.store(wp+1,std::memory_order_release);
+  return true;
+}
+
+bool DivRenderAhead::popMidi(TAMidiMessage& msg) {
+  uint64_t rp=midiReadPos.load(std::memory_order_relaxed);
+  if (rp==midiWritePos.load(std::memory_order_acquire)) return false;
+  TAMidiMessage& slot=midiRing[rp&(DIV_RENDER_AHEAD_MIDI-1)];
+  msg=slot;
+  // let go of SysEx data here rather than in the audio callback
+  slot.sysExData.reset();
+  midiReadPos.store(rp+1,std::memory_order_release);
+  return true;
+}
+
+unsigned int DivRenderAhead::getLatency() {
+  return ringLen;
+}
+
+unsigned int DivRenderAhead::getUnderruns() {
+  return underruns.load(std::memory_order_relaxed);
+}
+
+bool DivRenderAhead::start(DivEngine* eng, int outChans, unsigned int bufSize, int blocks) {
+  if (running) stop();
+  if (outChans<1 || outChans>DIV_MAX_OUTPUTS || bufSize<1 || blocks<1) {
+    logE("render-ahead: invalid parameters! (%d channels, %d frames, %d blocks)",outChans,bufSize,blocks);
+    return false;
+  }
+
+  e=eng;
+  chans=outChans;
+  blockSize=bufSize;
+  ringLen=bufSize*blocks;
+  readPos=0;
+  writePos=0;
+  underruns=0;
+  midiReadPos=0;
+  midiWritePos=0;
+  if (midiRing==NULL) midiRing=new TAMidiMessage[DIV_RENDER_AHEAD_MIDI];
+
+  for (int i=0; i<DIV_MAX_OUTPUTS; i++) {
+    if (ring[i]!=NULL) {
+      delete[] ring[i];
+      ring[i]=NULL;
+    }
+    if (block[i]!=NULL) {
+      delete[] block[i];
+      block[i]=NULL;
+    }
+  }
+  for (int i=0; i<chans; i++) {
+    ring[i]=new float[ringLen];
+    block[i]=new float[blockSize];
+    memset(ring[i],0,ringLen*sizeof(float));
+    memset(block[i],0,blockSize*sizeof(float));
+  }
+
+  logI("render-ahead: %d buffers of %d frames.",blocks,bufSize);
+  running=true;
+  thread=new std::thread(_runRenderAhead,this);
+  return true;
+}
+
+void DivRenderAhead::stop() {
+  if (thread==NULL) return;
+  running=false;
+  notifyCV.notify_one();
+  thread->join();
+  delete thread;
+  thread=NULL;
+}
+
+DivRenderAhead::~DivRenderAhead() {
+  stop();
+  for (int i=0; i<DIV_MAX_OUTPUTS; i++) {
+    if (ring[i]!=NULL) delete[] ring[i];
+    if (block[i]!=NULL) delete[] block[i];
+  }
+  if (midiRing!=NULL) delete[] midiRing;
+}
@@ -0,0 +1,119 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _RENDER_AHEAD_H
+#define _RENDER_AHEAD_H
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <stdint.h>
+#include "defines.h"
+#include "../audio/taAudio.h"
+
+// size of the MIDI input ring (must be a power of 2)
+#define DIV_RENDER_AHEAD_MIDI 1024
+
+class DivEngine;
+
+/**
+ * decoupled live playback.
+ * a producer thread runs the engine (ticks and chip rendering) a fixed number
+ * of buffers ahead into a single-producer/single-consumer ring, and the audio
+ * callback only copies out of it.
+ * since the producer only renders when the callback frees a buffer, anything
+ * sent to the engine (notes, MIDI input, edits) is always heard exactly
+ * getLatency() frames later.
+ */
+class DivRenderAhead {
+  DivEngine* e;
+  std::thread* thread;
+  std::mutex notifyLock;
+  std::condition_variable notifyCV;
+  std::atomic<bool> running;
+
+  // planar float ring (ringLen frames per channel)
+  float* ring[DIV_MAX_OUTPUTS];
+  // one block rendered by the producer
+  float* block[DIV_MAX_OUTPUTS];
+  int chans;
+  unsigned int blockSize, ringLen;
+
+  std::atomic<uint64_t> readPos, writePos;
+  std::atomic<unsigned int> underruns;
+
+  // MIDI input handed from the audio callback to the producer.
+  // the backend's queue is only touched by the callback thread.
+  TAMidiMessage* midiRing;
+  std::atomic<uint64_t> midiReadPos, midiWritePos;
+
+  public:
+    void run();
+
+    /**
+     * read size frames into out (called by the audio callback).
+     * frames which aren't ready yet are filled with silence.
+     * @return false if there was an underrun.
+     */
+    bool read(float** out, int outChans, unsigned int size);
+
+    /**
+     * pass a MIDI message to the producer (called by the audio callback).
+     * @return false if the ring is full.
+     */
+    bool pushMidi(const TAMidiMessage& msg);
+
+    /**
+     * take the next MIDI message (called by the producer).
+     * @return false if there are none.
+     */
+    bool popMidi(TAMidiMessage& msg);
+
+    /**
+     * @return the distance between rendering and output in frames.
+     */
+    unsigned int getLatency();
+    unsigned int getUnderruns();
+
+    bool start(DivEngine* eng, int outChans, unsigned int bufSize, int blocks);
+    void stop();
+
+    DivRenderAhead():
+      e(NULL),
+      thread(NULL),
+      running(false),
+      chans(0),
+      blockSize(0),
+      ringLen(0),
+      readPos(0),
+      writePos(0),
+      underruns(0),
+      midiRing(NULL),
+      midiReadPos(0),
+      midiWritePos(0) {
+      for (int i=0; i<DIV_MAX_OUTPUTS; i++) {
+        ring[i]=NULL;
+        block[i]=NULL;
+      }
+    }
+    ~DivRenderAhead();
+};
+
+#endif
@@ -20,27 +20,86 @@
 #include "safeWriter.h"
 #include "../ta-log.h"
 
+// size of the first chunk
 #define WRITER_BUF_SIZE 16384
+// chunks double in size up to this
+#define WRITER_CHUNK_MAX 4194304
 
 unsigned char* SafeWriter::getFinalBuf() {
-  return buf;
+  if (chunks.empty()) return NULL;
+  if (chunks.size()>1) {
+    // merge chunks
+    unsigned char* newBuf=new unsigned char[capacity];
+    for (SafeWriterChunk& i: chunks) {
+      if (i.off<len) memcpy(newBuf+i.off,i.data,MIN(i.cap,len-i.off));
+      delete[] i.data;
+    }
+    chunks.clear();
+    SafeWriterChunk merged;
+    merged.data=newBuf;
+    merged.off=0;
+    merged.cap=capacity;
+    chunks.push_back(merged);
+    curChunk=0;
+  }
+  return chunks[0].data;
+}
+
+size_t SafeWriter::getChunkCount() {
+  return chunks.size();
+}
+
+const unsigned char* SafeWriter::getChunk(size_t index, size_t& length) {
+  if (index>=chunks.size()) {
+    length=0;
+    return NULL;
+  }
+  const SafeWriterChunk& c=chunks[index];
+  length=(c.off<len)?MIN(c.cap,len-c.off):0;
+  return c.data;
+}
+
+bool SafeWriter::writeTo(FILE* f) {
+  for (size_t i=0; i<chunks.size(); i++) {
+    size_t chunkLen=0;
+    const unsigned char* data=getChunk(i,chunkLen);
+    if (chunkLen==0) continue;
+    if (fwrite(data,1,chunkLen,f)!=chunkLen) return false;
+  }
+  return true;
 }
 
 void SafeWriter::checkSize(size_t amount) {
-  while ((curSeek+amount)>=bufLen) {
-    size_t newSize=WRITER_BUF_SIZE*(1+((curSeek+amount)/WRITER_BUF_SIZE));
-    if (newSize<(bufLen+WRITER_BUF_SIZE)) {
-      logE("REPORT NOW: newSize is too small! case 1... %d<%d",(int)newSize,(int)(bufLen+WRITER_BUF_SIZE));
-    }
-    if (newSize<(curSeek+amount)) {
-      logE("REPORT NOW: newSize is too small! case 2... %d<%d",(int)newSize,(int)(curSeek+amount));
+  if ((curSeek+amount)<=capacity) return;
+  // add a chunk large enough for the rest
+  size_t newSize=nextChunkSize;
+  if (newSize<(curSeek+amount-capacity)) newSize=curSeek+amount-capacity;
+  SafeWriterChunk c;
+  c.data=new unsigned char[newSize];
+  c.off=capacity;
+  c.cap=newSize;
+  chunks.push_back(c);
+  capacity+=newSize;
+  if (nextChunkSize<WRITER_CHUNK_MAX) nextChunkSize<<=1;
+}
+
+size_t SafeWriter::findChunk(size_t pos) {
+  // same or next chunk
+  for (size_t i=curChunk; i<chunks.size() && i<=curChunk+1; i++) {
+    if (pos>=chunks[i].off && pos<chunks[i].off+chunks[i].cap) return i;
+  }
+  // binary search
+  size_t low=0;
+  size_t high=chunks.size();
+  while (high-low>1) {
+    size_t mid=(low+high)>>1;
+    if (chunks[mid].off<=pos) {
+      low=mid;
+    } else {
+      high=mid;
     }
-    unsigned char* newBuf=new unsigned char[newSize];
-    memcpy(newBuf,buf,bufLen);
-    delete[] buf;
-    buf=newBuf;
-    bufLen=newSize;
   }
+  return low;
 }
 
 bool SafeWriter::seek(ssize_t where, int whence) {
@@ -74,9 +133,23 @@ size_t SafeWriter::size() {
 
 int SafeWriter::write(const void* what, size_t count) {
   if (!operative) return 0;
+  if (count==0) return 0;
   checkSize(count);
-  memcpy(buf+curSeek,what,count);
-  curSeek+=count;
+  const unsigned char* src=(const unsigned char*)what;
+  size_t left=count;
+  size_t c=findChunk(curSeek);
+  while (true) {
+    SafeWriterChunk& chunk=chunks[c];
+    size_t chunkPos=curSeek-chunk.off;
+    size_t amount=MIN(left,chunk.cap-chunkPos);
+    memcpy(chunk.data+chunkPos,src,amount);
+    src+=amount;
+    left-=amount;
+    curSeek+=amount;
+    if (left==0) break;
+    c++;
+  }
+  curChunk=c;
   if (curSeek>len) len=curSeek;
   return count;
 }
@@ -210,26 +283,34 @@ int SafeWriter::writeString(String val, bool pascal) {
 
 void SafeWriter::init() {
   if (operative) return;
-  buf=new unsigned char[WRITER_BUF_SIZE];
-  bufLen=WRITER_BUF_SIZE;
+  chunks.clear();
+  curChunk=0;
+  capacity=0;
+  nextChunkSize=WRITER_BUF_SIZE;
   len=0;
   curSeek=0;
+  checkSize(1);
   operative=true;
 }
 
 SafeReader* SafeWriter::toReader() {
-  return new SafeReader(buf,len);
+  return new SafeReader(getFinalBuf(),len);
 }
 
 void SafeWriter::finish() {
   if (!operative) return;
-  delete[] buf;
-  buf=NULL;
+  for (SafeWriterChunk& i: chunks) {
+    delete[] i.data;
+  }
+  chunks.clear();
+  capacity=0;
   operative=false;
 }
 
 void SafeWriter::disown() {
   if (!operative) return;
-  buf=NULL;
+  // the buffer from getFinalBuf() is now owned by the caller
+  chunks.clear();
+  capacity=0;
   operative=false;
 }
@@ -22,22 +22,63 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <vector>
 #include "safeReader.h"
 #include "../ta-utils.h"
 
+struct SafeWriterChunk {
+  unsigned char* data;
+  // position of the first byte and capacity
+  size_t off, cap;
+};
+
+/**
+ * a growable buffer for writing files.
+ * data is kept in chunks, so that growing it never copies what was written
+ * already. seeking back to patch data is cheap.
+ * getFinalBuf() merges the chunks into one buffer (once); to avoid that copy
+ * when writing to a file or compressor, use writeTo() or getChunk().
+ */
 class SafeWriter {
   bool operative;
-  unsigned char* buf;
-  size_t bufLen;
+  std::vector<SafeWriterChunk> chunks;
+  // chunk of the last write (most writes go to the same chunk)
+  size_t curChunk;
+  size_t capacity;
+  size_t nextChunkSize;
   size_t len;
 
   size_t curSeek;
 
   void checkSize(size_t amount);
+  size_t findChunk(size_t pos);
 
   public:
+    /**
+     * get the contents as a single buffer, which replaces the chunks.
+     * it is valid until the next write past the end.
+     */
     unsigned char* getFinalBuf();
 
+    /**
+     * get the number of chunks.
+     */
+    size_t getChunkCount();
+
+    /**
+     * get a chunk.
+     * @param index the chunk.
+     * @param length set to the number of bytes in it.
+     * @return the chunk's data.
+     */
+    const unsigned char* getChunk(size_t index, size_t& length);
+
+    /**
+     * write the contents to a file, chunk by chunk.
+     * @return whether all of it was written.
+     */
+    bool writeTo(FILE* f);
+
     bool seek(ssize_t where, int whence);
     size_t tell();
     size_t size();
@@ -66,8 +107,9 @@ class SafeWriter {
 
     SafeWriter():
       operative(false),
-      buf(NULL),
-      bufLen(0),
+      curChunk(0),
+      capacity(0),
+      nextChunkSize(0),
       len(0),
       curSeek(0) {}
 };
@@ -22,6 +22,7 @@
 #include "../fileutils.h"
 #include <math.h>
 #include <string.h>
+#include <atomic>
 #ifdef HAVE_SNDFILE
 #include "sfWrapper.h"
 #endif
@@ -90,6 +91,9 @@ void DivSample::putSampleData(SafeWriter* w) {
   w->seek(0,SEEK_END);
 }
 
+// used to give every rendered sample a unique revision
+static std::atomic<uint64_t> sampleRenderRev(0);
+
 // Delek why
 static double samplePitchesSD[11]={
   0.1666666666, 0.2, 0.25, 0.333333333, 0.5,
@@ -1265,6 +1269,8 @@ signed char adpcmKTable[16]={
 };
 
 void DivSample::render(unsigned int formatMask) {
+  renderRev=++sampleRenderRev;
+
   // step 1: convert to 16-bit if needed
   if (depth!=DIV_SAMPLE_DEPTH_16BIT) {
     if (!initInternal(DIV_SAMPLE_DEPTH_16BIT,samples)) return;
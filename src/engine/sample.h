@@ -153,6 +153,14 @@ struct DivSample {
 
   unsigned int samples;
 
+  // changes every time the sample is rendered (unique among all samples).
+  // used to tell whether sample memory has to be written again.
+  uint64_t renderRev;
+
+  // changes every time this sample is rendered on its own (after an edit).
+  // unlike renderRev, this doesn't change when all samples are rendered again.
+  uint64_t editRev;
+
   FixedQueue<DivSampleHistory*,128> undoHist;
   FixedQueue<DivSampleHistory*,128> redoHist;
 
@@ -378,7 +386,9 @@ struct DivSample {
     lengthIMA(0),
     length12(0),
     length4(0),
-    samples(0) {
+    samples(0),
+    renderRev(0),
+    editRev(0) {
     for (int i=0; i<DIV_MAX_CHIPS; i++) {
       for (int j=0; j<DIV_MAX_SAMPLE_TYPE; j++) {
         renderOn[j][i]=true;
@@ -0,0 +1,221 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "samplePacker.h"
+#include "dispatch.h"
+#include "../ta-log.h"
+#include <string.h>
+#include <algorithm>
+
+struct DivSamplePackRange {
+  size_t begin, end;
+  int index;
+  bool operator<(const DivSamplePackRange& other) const {
+    return begin<other.begin;
+  }
+};
+
+void DivSamplePacker::setMemory(unsigned char* m, size_t cap, size_t bank, size_t alignment, size_t guardLen) {
+  if (alignment<1) alignment=1;
+  if (m!=mem || cap!=capacity || bank!=bankSize || alignment!=align || guardLen!=guard) {
+    mem=m;
+    capacity=cap;
+    bankSize=bank;
+    align=alignment;
+    guard=guardLen;
+    reset();
+  }
+}
+
+bool DivSamplePacker::placeAll(const std::vector<DivSamplePackItem>& items, std::vector<DivSamplePackSlot>& layout) {
+  std::vector<DivSamplePackRange> used;
+  bool success=true;
+
+  layout.clear();
+  layout.resize(items.size());
+
+  // usable space in a bank (or the whole memory)
+  const size_t areaSize=(bankSize>0)?bankSize:capacity;
+  const size_t usable=(areaSize>guard*2)?(areaSize-guard*2):0;
+
+  // in sample order, so that the layout only depends on the samples
+  for (size_t i=0; i<items.size(); i++) {
+    const DivSamplePackItem& item=items[i];
+    if (!item.use) continue;
+    const size_t len=item.len+item.pad;
+    if (len==0 || item.data==NULL) {
+      // nothing to write, but still usable
+      layout[i].placed=true;
+      continue;
+    }
+
+    size_t bestPos=0;
+    size_t bestSlot=0;
+    bool found=false;
+
+    // use the first hole (the one after range j-1 and before range j) which fits
+    for (size_t j=0; j<=used.size(); j++) {
+      size_t holeBegin=(j==0)?0:used[j-1].end;
+      size_t holeEnd=(j==used.size())?capacity:used[j].begin;
+      if (holeEnd<=holeBegin) continue;
+
+      size_t pos=(holeBegin+align-1)&~(align-1);
+      if (bankSize>0) {
+        if (len>usable) {
+          // can't avoid crossing, so start at a bank
+          pos=((pos+bankSize-guard-1)/bankSize)*bankSize+guard;
+          pos=(pos+align-1)&~(align-1);
+        } else {
+          if ((pos%bankSize)<guard) {
+            pos=(pos/bankSize)*bankSize+guard;
+            pos=(pos+align-1)&~(align-1);
+          }
+          if ((pos/bankSize)!=((pos+len+guard-1)/bankSize)) {
+            pos=((pos/bankSize)+1)*bankSize+guard;
+            pos=(pos+align-1)&~(align-1);
+          }
+        }
+      } else if (pos<guard) {
+        pos=(guard+align-1)&~(align-1);
+      }
+      if (pos+len>holeEnd) continue;
+      if (pos+len+guard>capacity && len<=usable) continue;
+
+      found=true;
+      bestPos=pos;
+      bestSlot=j;
+      break;
+    }
+
+    if (!found) {
+      success=false;
+      continue;
+    }
+
+    layout[i].off=bestPos;
+    layout[i].len=len;
+    layout[i].placed=true;
+    DivSamplePackRange r;
+    r.begin=bestPos;
+    r.end=bestPos+len;
+    r.index=i;
+    used.insert(used.begin()+bestSlot,r);
+  }
+
+  return success;
+}
+
+int DivSamplePacker::pack(const std::vector<DivSamplePackItem>& items) {
+  if (mem==NULL) return 0;
+
+  std::vector<DivSamplePackSlot> layout;
+  placeAll(items,layout);
+
+  // clear what is no longer used
+  if (dirty) {
+    memset(mem,0,capacity);
+  } else {
+    for (size_t i=0; i<slots.size(); i++) {
+      if (!slots[i].placed || slots[i].len==0) continue;
+      if (i<layout.size()) {
+        if (layout[i].placed && layout[i].off==slots[i].off && layout[i].len==slots[i].len) continue;
+      }
+      memset(mem+slots[i].off,0,slots[i].len);
+    }
+  }
+
+  // write new and changed samples
+  int notPlaced=0;
+  size_t bytesWritten=0;
+  end=0;
+  written.clear();
+  written.resize(layout.size(),false);
+  for (size_t i=0; i<layout.size(); i++) {
+    if (!items[i].use) continue;
+    if (!layout[i].placed) {
+      logW("out of sample memory for sample %d!",(int)i);
+      notPlaced++;
+      continue;
+    }
+    layout[i].rev=items[i].rev;
+    if (layout[i].len==0) continue;
+
+    unsigned char* dest=mem+layout[i].off;
+    const size_t dataLen=items[i].len;
+    bool moved=true;
+    if (!dirty && i<slots.size()) {
+      moved=!(slots[i].placed && slots[i].off==layout[i].off && slots[i].len==layout[i].len);
+    }
+    if (!moved && items[i].rev!=0 && slots[i].rev==items[i].rev) {
+      // same data in the same place
+    } else if (moved || memcmp(dest,items[i].data,dataLen)!=0) {
+      memcpy(dest,items[i].data,dataLen);
+      bytesWritten+=dataLen;
+      written[i]=true;
+    }
+    if (layout[i].off+layout[i].len>end) end=layout[i].off+layout[i].len;
+  }
+  logV("packed samples: %d bytes written, end at %x",(int)bytesWritten,(int)end);
+
+  slots=layout;
+  dirty=false;
+  return notPlaced;
+}
+
+size_t DivSamplePacker::getOffset(int index) const {
+  if (index<0 || index>=(int)slots.size()) return 0;
+  return slots[index].off;
+}
+
+bool DivSamplePacker::isPlaced(int index) const {
+  if (index<0 || index>=(int)slots.size()) return false;
+  return slots[index].placed;
+}
+
+bool DivSamplePacker::wasWritten(int index) const {
+  if (index<0 || index>=(int)written.size()) return false;
+  return written[index];
+}
+
+size_t DivSamplePacker::getEnd() const {
+  return end;
+}
+
+void DivSamplePacker::fillComposition(DivMemoryComposition& compo) const {
+  std::vector<DivSamplePackRange> ranges;
+  for (size_t i=0; i<slots.size(); i++) {
+    if (!slots[i].placed || slots[i].len==0) continue;
+    DivSamplePackRange r;
+    r.begin=slots[i].off;
+    r.end=slots[i].off+slots[i].len;
+    r.index=i;
+    ranges.push_back(r);
+  }
+  std::sort(ranges.begin(),ranges.end());
+  for (DivSamplePackRange& i: ranges) {
+    compo.entries.push_back(DivMemoryEntry(DIV_MEMORY_SAMPLE,"Sample",i.index,i.begin,i.end));
+  }
+}
+
+void DivSamplePacker::reset() {
+  slots.clear();
+  written.clear();
+  dirty=true;
+  end=0;
+}
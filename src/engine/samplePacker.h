@@ -0,0 +1,148 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _SAMPLE_PACKER_H
+#define _SAMPLE_PACKER_H
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+struct DivMemoryComposition;
+
+struct DivSamplePackItem {
+  // data to copy
+  const unsigned char* data;
+  // bytes to copy and occupy (padding included)
+  size_t len;
+  // extra bytes to occupy (and leave cleared) after the data
+  size_t pad;
+  // revision of the data (see DivSample::renderRev), or 0 if unknown.
+  // if it didn't change and the sample stays in place, it isn't written again.
+  uint64_t rev;
+  // whether the sample is rendered on this memory
+  bool use;
+  DivSamplePackItem():
+    data(NULL),
+    len(0),
+    pad(0),
+    rev(0),
+    use(false) {}
+  DivSamplePackItem(const unsigned char* d, size_t l, uint64_t r=0, size_t p=0):
+    data(d),
+    len(l),
+    pad(p),
+    rev(r),
+    use(true) {}
+};
+
+struct DivSamplePackSlot {
+  size_t off, len;
+  uint64_t rev;
+  bool placed;
+  DivSamplePackSlot():
+    off(0),
+    len(0),
+    rev(0),
+    placed(false) {}
+};
+
+/**
+ * places samples in a chip's sample memory.
+ * samples are placed in order, each in the first hole that can hold it
+ * without crossing a bank boundary (unless a sample is larger than a bank, in
+ * which case it starts at one).
+ * the layout only depends on the samples (not on previous calls), so exports
+ * are the same regardless of edit history. samples before a changed one stay
+ * where they are, and only changed or moved samples (by revision, or by
+ * contents if it is unknown) and freed space are written to memory.
+ */
+class DivSamplePacker {
+  unsigned char* mem;
+  size_t capacity, bankSize, align, guard;
+  // the current layout, by sample index (used to skip unchanged samples)
+  std::vector<DivSamplePackSlot> slots;
+  // samples written by the last pack() call
+  std::vector<bool> written;
+  // whether memory contents are unknown (a full clear is needed)
+  bool dirty;
+  size_t end;
+
+  bool placeAll(const std::vector<DivSamplePackItem>& items, std::vector<DivSamplePackSlot>& layout);
+
+  public:
+    /**
+     * set the memory to pack samples into.
+     * the layout is discarded if any of the parameters changed.
+     * @param m the memory.
+     * @param cap memory capacity.
+     * @param bank bank size, or 0 if there are no banks.
+     * @param alignment start address alignment (must be a power of two).
+     * @param guardLen bytes to leave free at the start and end of every bank.
+     */
+    void setMemory(unsigned char* m, size_t cap, size_t bank, size_t alignment, size_t guardLen=0);
+
+    /**
+     * lay out samples and write them to memory.
+     * @param items samples, by sample index.
+     * @return the number of samples that didn't fit.
+     */
+    int pack(const std::vector<DivSamplePackItem>& items);
+
+    /**
+     * get a sample's offset (0 if it isn't placed).
+     */
+    size_t getOffset(int index) const;
+
+    /**
+     * whether a sample was placed in memory.
+     */
+    bool isPlaced(int index) const;
+
+    /**
+     * whether a sample was written to memory by the last pack() call.
+     */
+    bool wasWritten(int index) const;
+
+    /**
+     * get the end of the last sample in memory.
+     */
+    size_t getEnd() const;
+
+    /**
+     * add sample entries (in address order) to a memory composition.
+     */
+    void fillComposition(DivMemoryComposition& compo) const;
+
+    /**
+     * forget the layout. the next pack() call will clear the memory.
+     */
+    void reset();
+
+    DivSamplePacker():
+      mem(NULL),
+      capacity(0),
+      bankSize(0),
+      align(1),
+      guard(0),
+      dirty(true),
+      end(0) {}
+};
+
+#endif
@@ -39,7 +39,8 @@ enum DivEffectType: unsigned short {
   DIV_EFFECT_DUMMY,
   DIV_EFFECT_EXTERNAL,
   DIV_EFFECT_VOLUME,
-  DIV_EFFECT_FILTER
+  DIV_EFFECT_FILTER,
+  DIV_EFFECT_CONVOLUTION
 };
 
 enum DivFileElementType: unsigned char {
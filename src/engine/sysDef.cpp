@@ -24,6 +24,7 @@
 #include "../ta-log.h"
 
 DivSysDef* DivEngine::sysDefs[DIV_MAX_CHIP_DEFS];
+bool DivEngine::systemsRegistered=false;
 DivSystem DivEngine::sysFileMapFur[DIV_MAX_CHIP_DEFS];
 DivSystem DivEngine::sysFileMapDMF[DIV_MAX_CHIP_DEFS];
 
@@ -228,8 +228,9 @@ void DivEngine::runExportThread() {
 
       // take control of audio output
       deinitAudioBackend();
+      prepareAudioBuffers(EXPORT_BUFSIZE);
       freelance=false;
-      playSub(false);
+      playExportRange();
       freelance=false;
 
       logI("rendering to file...");
@@ -258,7 +259,7 @@ void DivEngine::runExportThread() {
             for (int j=0; j<exportOutputs; j++) {
               outBufFinal[fi++]=MAX(-1.0f,MIN(1.0f,outBuf[j][i]));
             }
-            if (lastLoopPos>-1 && i>=lastLoopPos && totalLoops>=exportLoopCount) {
+            if ((lastLoopPos>-1 && i>=lastLoopPos && totalLoops>=exportLoopCount) || exportLengthReached()) {
               logD("start fading out...");
               isFadingOut=true;
               if (fadeOutSamples==0) break;
@@ -331,8 +332,9 @@ void DivEngine::runExportThread() {
 
       // take control of audio output
       deinitAudioBackend();
+      prepareAudioBuffers(EXPORT_BUFSIZE);
       freelance=false;
-      playSub(false);
+      playExportRange();
       freelance=false;
 
       logI("rendering to files...");
@@ -372,7 +374,7 @@ void DivEngine::runExportThread() {
                 }
               }
             }
-            if (lastLoopPos>-1 && j>=lastLoopPos && totalLoops>=exportLoopCount) {
+            if ((lastLoopPos>-1 && j>=lastLoopPos && totalLoops>=exportLoopCount) || exportLengthReached()) {
               logD("start fading out...");
               isFadingOut=true;
               if (fadeOutSamples==0) break;
@@ -413,6 +415,7 @@ void DivEngine::runExportThread() {
     case DIV_EXPORT_MODE_MANY_CHAN: {
       // take control of audio output
       deinitAudioBackend();
+      prepareAudioBuffers(EXPORT_BUFSIZE);
 
       curExportChan=0;
 
@@ -492,15 +495,13 @@ void DivEngine::runExportThread() {
           }
         }
         
-        curOrder=0;
-        prevOrder=0;
         curFadeOutSample=0;
         lastLoopPos=-1;
         totalLoops=0;
         isFadingOut=false;
         remainingLoops=-1;
         freelance=false;
-        playSub(false);
+        playExportRange();
         freelance=false;
 
         while (playing) {
@@ -527,7 +528,7 @@ void DivEngine::runExportThread() {
               for (int k=0; k<exportOutputs; k++) {
                 outBufFinal[fi++]=MAX(-1.0f,MIN(1.0f,outBuf[k][j]));
               }
-              if (lastLoopPos>-1 && j>=lastLoopPos && totalLoops>=exportLoopCount) {
+              if ((lastLoopPos>-1 && j>=lastLoopPos && totalLoops>=exportLoopCount) || exportLengthReached()) {
                 logD("start fading out...");
                 isFadingOut=true;
                 if (fadeOutSamples==0) break;
@@ -598,11 +599,72 @@ bool DivEngine::shallSwitchCores() {
   return true;
 }
 
+bool DivEngine::setExportRange(const DivAudioExportOptions& options) {
+  exportBeginOrder=0;
+  exportBeginRow=0;
+  exportEndOrder=-1;
+  exportEndRow=0;
+  exportLength=0;
+  exportPos=0;
+
+  if (options.orderBegin>=0) {
+    if (options.orderBegin>=curSubSong->ordersLen || options.rowBegin<0 || options.rowBegin>=curSubSong->patLen) {
+      lastError="the range starts past the end of the song";
+      return false;
+    }
+    exportBeginOrder=options.orderBegin;
+    exportBeginRow=options.rowBegin;
+  }
+  // an end past the last order is the end of the song
+  if (options.orderEnd>=0 && options.orderEnd<curSubSong->ordersLen) {
+    if (options.rowEnd<0 || options.rowEnd>=curSubSong->patLen) {
+      lastError="invalid range end row";
+      return false;
+    }
+    if (options.orderEnd<exportBeginOrder || (options.orderEnd==exportBeginOrder && options.rowEnd<=exportBeginRow)) {
+      lastError="the range ends before it starts";
+      return false;
+    }
+    exportEndOrder=options.orderEnd;
+    exportEndRow=options.rowEnd;
+  }
+  return true;
+}
+
+// seeks to the start of the export range without rendering any audio.
+// this still plays the song from the first order up to the range start
+// (see playSub()), so the cost grows with the start position.
+void DivEngine::playExportRange() {
+  curOrder=exportBeginOrder;
+  prevOrder=curOrder;
+  exportPos=0;
+  playSub(false,exportBeginRow);
+}
+
+bool DivEngine::exportLengthReached() {
+  if (exportLength==0) return false;
+  return (++exportPos>=exportLength);
+}
+
+// whether the row about to be played is out of the export range.
+// this happens when the end is reached, or when a jump effect skips past it
+// or goes back to before the start.
+bool DivEngine::exportRangeLeft() {
+  if (exportEndOrder<0) return false;
+  if (curOrder>exportEndOrder || (curOrder==exportEndOrder && curRow>=exportEndRow)) return true;
+  if (curOrder<exportBeginOrder || (curOrder==exportBeginOrder && curRow<exportBeginRow)) return true;
+  return false;
+}
+
 bool DivEngine::saveAudio(const char* path, DivAudioExportOptions options) {
 #ifndef HAVE_SNDFILE
   logE("Furnace was not compiled with libsndfile. cannot export!");
   return false;
 #else
+  if (!setExportRange(options)) {
+    logE("invalid export range! (%s)",lastError);
+    return false;
+  }
   exportPath=path;
   exportMode=options.mode;
   exportFormat=options.format;
@@ -654,6 +716,7 @@ bool DivEngine::saveAudio(const char* path, DivAudioExportOptions options) {
   if (exportOutputs>DIV_MAX_OUTPUTS) exportOutputs=DIV_MAX_OUTPUTS;
 
   exportLoopCount=options.loops+1;
+  exportLength=(options.duration>0.0)?(size_t)(options.duration*got.rate):0;
   exportThread=new std::thread(_runExportThread,this);
   return true;
 #endif
@@ -688,3 +751,106 @@ void DivEngine::finishAudioFile() {
   }
 }
 
+
+bool DivEngine::renderBegin(const DivAudioExportOptions& options, unsigned int maxLen) {
+  if (exporting) {
+    lastError="already exporting";
+    return false;
+  }
+  if (!setExportRange(options)) return false;
+  exporting=true;
+  stopExport=false;
+  stop();
+  repeatPattern=false;
+  setOrder(0);
+  remainingLoops=-1;
+
+  // take control of audio output
+  deinitAudioBackend();
+
+  got.rate=options.sampleRate;
+  if (shallSwitchCores()) {
+    bool isMutedBefore[DIV_MAX_CHANS];
+    memcpy(isMutedBefore,isMuted,DIV_MAX_CHANS*sizeof(bool));
+    quitDispatch();
+    initDispatch(true);
+    renderSamplesP();
+    for (int i=0; i<song.chans; i++) {
+      if (isMutedBefore[i]) {
+        muteChannel(i,true);
+      }
+    }
+  }
+
+  // so that renderNext() doesn't allocate
+  prepareAudioBuffers(maxLen);
+
+  exportOutputs=options.chans;
+  if (exportOutputs<1) exportOutputs=1;
+  if (exportOutputs>DIV_MAX_OUTPUTS) exportOutputs=DIV_MAX_OUTPUTS;
+  exportLoopCount=options.loops+1;
+  exportFadeOut=options.fadeOut;
+  exportLength=(options.duration>0.0)?(size_t)(options.duration*got.rate):0;
+  renderFadeSamples=got.rate*exportFadeOut;
+  renderFadePos=0;
+  isFadingOut=false;
+
+  freelance=false;
+  playExportRange();
+  freelance=false;
+  return true;
+}
+
+size_t DivEngine::renderNext(float** out, unsigned int len) {
+  if (!exporting || !playing || stopExport) return 0;
+
+  nextBuf(NULL,out,0,exportOutputs,len);
+  size_t total=MIN(totalProcessed,len);
+  size_t ret=0;
+  for (size_t i=0; i<total; i++) {
+    ret++;
+    if (isFadingOut) {
+      double mul=(renderFadeSamples>0)?(1.0-((double)renderFadePos/(double)renderFadeSamples)):0.0;
+      for (int j=0; j<exportOutputs; j++) {
+        out[j][i]=MAX(-1.0f,MIN(1.0f,out[j][i]))*mul;
+      }
+      if (++renderFadePos>=renderFadeSamples) {
+        playing=false;
+        break;
+      }
+    } else {
+      for (int j=0; j<exportOutputs; j++) {
+        out[j][i]=MAX(-1.0f,MIN(1.0f,out[j][i]));
+      }
+      if ((lastLoopPos>-1 && (int)i>=lastLoopPos && totalLoops>=exportLoopCount) || exportLengthReached()) {
+        logD("start fading out...");
+        isFadingOut=true;
+        if (renderFadeSamples==0) {
+          playing=false;
+          break;
+        }
+      }
+    }
+  }
+  return ret;
+}
+
+void DivEngine::renderEnd() {
+  if (!exporting) return;
+  stop();
+  finishAudioFile();
+  if (initAudioBackend()) {
+    for (int i=0; i<song.systemLen; i++) {
+      disCont[i].setRates(got.rate);
+      disCont[i].setQuality(lowQuality,dcHiPass);
+    }
+    if (curFilePlayer!=NULL) {
+      curFilePlayer->setOutputRate(got.rate);
+    }
+    startRenderAhead();
+    if (!output->setRun(true)) {
+      logE("error while activating audio!");
+    }
+  }
+  exporting=false;
+}
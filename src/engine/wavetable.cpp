@@ -101,7 +101,7 @@ bool DivWavetable::save(const char* path) {
     w->finish();
     return false;
   }
-  if (fwrite(w->getFinalBuf(),1,w->size(),outFile)!=w->size()) {
+  if (!w->writeTo(outFile)) {
     logW("did not write entire wavetable!");
   }
   fclose(outFile);
@@ -140,7 +140,7 @@ bool DivWavetable::saveDMW(const char* path) {
     w->finish();
     return false;
   }
-  if (fwrite(w->getFinalBuf(),1,w->size(),outFile)!=w->size()) {
+  if (!w->writeTo(outFile)) {
     logW("did not write entire wavetable!");
   }
   fclose(outFile);
@@ -163,7 +163,7 @@ bool DivWavetable::saveRaw(const char* path) {
     w->finish();
     return false;
   }
-  if (fwrite(w->getFinalBuf(),1,w->size(),outFile)!=w->size()) {
+  if (!w->writeTo(outFile)) {
     logW("did not write entire wavetable!");
   }
   fclose(outFile);
@@ -23,6 +23,8 @@
 #include <windows.h>
 #include <shlobj.h>
 #include <shlwapi.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #else
 #include <unistd.h>
 #include <fcntl.h>
@@ -145,3 +147,16 @@ int touchFile(const char* path) {
   return 0;
 #endif
 }
+
+bool fileInfo(const char* path, uint64_t* size, int64_t* mtime) {
+#ifdef _WIN32
+  struct _stat64 st;
+  if (_wstat64(utf8To16(path).c_str(),&st)!=0) return false;
+#else
+  struct stat st;
+  if (stat(path,&st)!=0) return false;
+#endif
+  if (size!=NULL) *size=st.st_size;
+  if (mtime!=NULL) *mtime=st.st_mtime;
+  return true;
+}
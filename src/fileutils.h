@@ -20,6 +20,7 @@
 #ifndef _FILEUTILS_H
 #define _FILEUTILS_H
 #include <stdio.h>
+#include <stdint.h>
 
 FILE* ps_fopen(const char* path, const char* mode);
 bool moveFiles(const char* src, const char* dest);
@@ -30,5 +31,7 @@ int fileExists(const char* path);
 bool dirExists(const char* what);
 bool makeDir(const char* path);
 int touchFile(const char* path);
+// gets size and modification time (in seconds) of a file. returns false on error.
+bool fileInfo(const char* path, uint64_t* size, int64_t* mtime);
 
 #endif
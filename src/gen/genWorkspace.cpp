@@ -34,8 +34,15 @@ GenWorkspace::GenWorkspace():
   memset(patchDesc,0,sizeof(patchDesc));
 }
 
+GenWorkspace::~GenWorkspace() {
+  if (engine) engine->setTickCallback(NULL);
+}
+
 void GenWorkspace::init(DivEngine* e) {
   engine=e;
+  engine->setTickCallback([this]() {
+    morph.tick(engine);
+  });
   detectSystems();
   randomizeSeed();
 }
@@ -115,6 +122,27 @@ int GenWorkspace::commitPatch() {
   return idx;
 }
 
+void GenWorkspace::setMorphSlot(int slot) {
+  if (!hasPatch) return;
+  morph.setSlot(slot,currentPatch.fm);
+}
+
+void GenWorkspace::startMorph() {
+  if (!engine) return;
+  bool anyLane=false;
+  for (int i=0; i<GEN_MORPH_LANES; i++) {
+    if (morph.lanes[i].chan.load()>=0) anyLane=true;
+  }
+  if (!anyLane) morph.assignDefaultChannels(engine);
+  morph.resync();
+  morph.active=true;
+}
+
+void GenWorkspace::stopMorph() {
+  // the chip keeps the last morphed values until the instrument is reloaded
+  morph.active=false;
+}
+
 void GenWorkspace::populateParamsFromSong() {
   if (!engine||!engine->curSubSong) return;
   DivSubSong* sub=engine->curSubSong;
@@ -23,6 +23,7 @@
 #include "patchGen.h"
 #include "patternGen.h"
 #include "styleEngine.h"
+#include "patchMorph.h"
 #include "../engine/engine.h"
 
 class GenWorkspace {
@@ -32,6 +33,7 @@ public:
   PatchGenerator patchGen;
   PatternGenerator patternGen;
   StyleEngine styleEngine;
+  PatchMorph morph;
 
   // state
   bool ym2612Available;
@@ -60,6 +62,11 @@ public:
   void stopAudit();
   int commitPatch();  // returns new instrument index
 
+  // live morphing
+  void setMorphSlot(int slot);  // stores the current patch
+  void startMorph();
+  void stopMorph();
+
   // pattern generation
   void generatePattern(int channel, int patIdx);
   void generateFill(int channel, int patIdx, int startRow, int endRow);
@@ -68,6 +75,7 @@ public:
   void randomizeSeed();
 
   GenWorkspace();
+  ~GenWorkspace();
 };
 
 #endif
@@ -21,6 +21,7 @@
 #include "genWorkspace.h"
 #include "guiGen.h"
 #include "imgui.h"
+#include <fmt/printf.h>
 
 static const char* algoNames[]={
   "0: 1>2>3>4",
@@ -177,6 +178,107 @@ void FurnaceGUI::drawGenWorkspace() {
       }
     }
 
+    // === MORPH ===
+    ImGui::SeparatorText("Morph");
+    {
+      // slots
+      int slotCount=genWorkspace->morph.getSlotCount();
+      for (int i=0; i<GEN_MORPH_SLOTS; i++) {
+        if (i>0) ImGui::SameLine();
+        ImGui::BeginDisabled(!genWorkspace->hasPatch);
+        if (ImGui::Button(fmt::sprintf("%s %d##MorphSlot%d",(i<slotCount)?"Set":"Add",i+1,i).c_str())) {
+          genWorkspace->setMorphSlot(i);
+        }
+        ImGui::EndDisabled();
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+          ImGui::SetTooltip("Store the current patch in slot %d",i+1);
+        }
+      }
+      ImGui::SameLine();
+      if (ImGui::Button("Clear##MorphClear")) {
+        genWorkspace->stopMorph();
+        genWorkspace->morph.clearSlots();
+      }
+      ImGui::Text("%d slots",slotCount);
+
+      // start/stop
+      bool morphActive=genWorkspace->morph.active.load();
+      ImGui::BeginDisabled(slotCount<1);
+      if (ImGui::Checkbox("Active##MorphActive",&morphActive)) {
+        if (morphActive) {
+          genWorkspace->startMorph();
+        } else {
+          genWorkspace->stopMorph();
+        }
+      }
+      ImGui::EndDisabled();
+      ImGui::SameLine();
+      if (ImGui::Button("Default Channels##MorphDefChans")) {
+        genWorkspace->morph.assignDefaultChannels(e);
+      }
+      ImGui::SameLine();
+      int midiChan=genWorkspace->morph.midiChan.load();
+      ImGui::SetNextItemWidth(100.0f*dpiScale);
+      if (ImGui::BeginCombo("MIDI Channel##MorphMidiChan",(midiChan<0)?"omni":fmt::sprintf("%d",midiChan+1).c_str())) {
+        if (ImGui::Selectable("omni",midiChan<0)) genWorkspace->morph.midiChan=-1;
+        for (int j=0; j<16; j++) {
+          if (ImGui::Selectable(fmt::sprintf("%d",j+1).c_str(),j==midiChan)) {
+            genWorkspace->morph.midiChan=j;
+          }
+        }
+        ImGui::EndCombo();
+      }
+
+      // lanes
+      if (ImGui::BeginTable("MorphLanes",4,ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("c0",ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("c1",ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("c2",ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("c3",ImGuiTableColumnFlags_WidthStretch);
+        for (int i=0; i<GEN_MORPH_LANES; i++) {
+          PatchMorphLane& lane=genWorkspace->morph.lanes[i];
+          ImGui::PushID(i);
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn();
+          ImGui::AlignTextToFramePadding();
+          ImGui::Text("%d",i+1);
+
+          // channel
+          ImGui::TableNextColumn();
+          int ch=lane.chan.load();
+          ImGui::SetNextItemWidth(150.0f*dpiScale);
+          if (ImGui::BeginCombo("##MorphChan",(ch>=0&&ch<e->getTotalChannelCount())?e->getChannelName(ch):"off")) {
+            if (ImGui::Selectable("off",ch<0)) lane.chan=-1;
+            for (int j=0; j<e->getTotalChannelCount(); j++) {
+              if (e->getChannelType(j)!=DIV_CH_FM) continue;
+              if (ImGui::Selectable(fmt::sprintf("%d: %s",j+1,e->getChannelName(j)).c_str(),j==ch)) {
+                lane.chan=j;
+              }
+            }
+            ImGui::EndCombo();
+          }
+
+          // MIDI CC
+          ImGui::TableNextColumn();
+          int cc=lane.cc.load();
+          ImGui::SetNextItemWidth(80.0f*dpiScale);
+          if (ImGui::InputInt("CC##MorphCC",&cc)) {
+            lane.cc=genClamp(cc,-1,127);
+          }
+
+          // position
+          ImGui::TableNextColumn();
+          float pos=lane.pos.load();
+          ImGui::SetNextItemWidth(-FLT_MIN);
+          if (ImGui::SliderFloat("##MorphPos",&pos,0.0f,1.0f,"%.2f")) {
+            lane.pos=pos;
+          }
+          ImGui::PopID();
+        }
+        ImGui::EndTable();
+      }
+    }
+
     // === PATTERN GENERATOR ===
     ImGui::SeparatorText("Pattern Generator");
     {
@@ -0,0 +1,274 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "patchMorph.h"
+#include "../engine/engine.h"
+#include <cstring>
+#include <cmath>
+
+struct PatchMorphParam {
+  DivDispatchCmds cmd;
+  int op;         // operator (in instrument order), or -1 for channel parameters
+  bool discrete;  // switch at the midpoint instead of interpolating
+};
+
+// order of the parameters in a flattened patch
+static const PatchMorphParam morphChanParams[4]={
+  {DIV_CMD_FM_ALG,-1,true},
+  {DIV_CMD_FM_FB,-1,false},
+  {DIV_CMD_FM_FMS,-1,false},
+  {DIV_CMD_FM_AMS,-1,false}
+};
+
+static const PatchMorphParam morphOpParams[11]={
+  {DIV_CMD_FM_TL,0,false},
+  {DIV_CMD_FM_AR,0,false},
+  {DIV_CMD_FM_DR,0,false},
+  {DIV_CMD_FM_D2R,0,false},
+  {DIV_CMD_FM_SL,0,false},
+  {DIV_CMD_FM_RR,0,false},
+  {DIV_CMD_FM_MULT,0,false},
+  {DIV_CMD_FM_DT,0,true},
+  {DIV_CMD_FM_RS,0,false},
+  {DIV_CMD_FM_AM,0,true},
+  {DIV_CMD_FM_SSG,0,true}
+};
+
+// operator commands take the operator in display order
+static const int morphCmdOp[4]={0,2,1,3};
+
+static PatchMorphParam morphParam(int index) {
+  if (index<4) return morphChanParams[index];
+  PatchMorphParam p=morphOpParams[(index-4)%11];
+  p.op=(index-4)/11;
+  return p;
+}
+
+static bool isYM2612System(DivSystem sys) {
+  return (sys==DIV_SYSTEM_YM2612||
+          sys==DIV_SYSTEM_YM2612_EXT||
+          sys==DIV_SYSTEM_YM2612_DUALPCM||
+          sys==DIV_SYSTEM_YM2612_DUALPCM_EXT||
+          sys==DIV_SYSTEM_YM2612_CSM||
+          sys==DIV_SYSTEM_GENESIS||
+          sys==DIV_SYSTEM_GENESIS_EXT);
+}
+
+static bool isMorphableChan(DivEngine* e, int ch) {
+  if (ch<0||ch>=e->song.chans) return false;
+  if (!isYM2612System(e->song.sysOfChan[ch])) return false;
+  // extended channel 3 operators and PSG channels are left alone
+  return e->getChannelType(ch)==DIV_CH_FM;
+}
+
+PatchMorphLane::PatchMorphLane():
+  chan(-1),
+  cc(-1),
+  pos(0.0f),
+  lastPos(-1.0f),
+  lastChan(-1),
+  lastInsCmds(0),
+  sentValid(false) {
+  memset(sent,0,sizeof(sent));
+}
+
+PatchMorph::PatchMorph():
+  pendingCount(0),
+  slotRev(0),
+  liveCount(0),
+  liveRev(0),
+  resyncReq(false),
+  active(false),
+  midiChan(-1) {
+  memset(liveSlots,0,sizeof(liveSlots));
+  // undefined controllers 20-25, one per lane
+  for (int i=0; i<GEN_MORPH_LANES; i++) {
+    lanes[i].cc=20+i;
+  }
+}
+
+void PatchMorph::flatten(const DivInstrumentFM& fm, int* out) {
+  out[0]=fm.alg&7;
+  out[1]=fm.fb&7;
+  out[2]=fm.fms&7;
+  out[3]=fm.ams&3;
+  for (int i=0; i<4; i++) {
+    const DivInstrumentFM::Operator& op=fm.op[i];
+    int* o=out+4+i*11;
+    o[0]=op.tl&127;
+    o[1]=op.ar&31;
+    o[2]=op.dr&31;
+    o[3]=op.d2r&31;
+    o[4]=op.sl&15;
+    o[5]=op.rr&15;
+    o[6]=op.mult&15;
+    o[7]=op.dt&7;
+    o[8]=op.rs&3;
+    o[9]=op.am&1;
+    o[10]=op.ssgEnv&15;
+  }
+}
+
+void PatchMorph::compute(float pos, int* out) {
+  if (liveCount<2) {
+    memcpy(out,liveSlots[0],GEN_MORPH_PARAMS*sizeof(int));
+    return;
+  }
+
+  // position spans all slots in order
+  float x=pos*(float)(liveCount-1);
+  int a=(int)x;
+  if (a<0) a=0;
+  if (a>liveCount-2) a=liveCount-2;
+  float t=x-(float)a;
+  if (t<0.0f) t=0.0f;
+  if (t>1.0f) t=1.0f;
+
+  const int* from=liveSlots[a];
+  const int* to=liveSlots[a+1];
+  for (int i=0; i<GEN_MORPH_PARAMS; i++) {
+    if (morphParam(i).discrete) {
+      out[i]=(t<0.5f)?from[i]:to[i];
+    } else {
+      out[i]=from[i]+(int)floorf((float)(to[i]-from[i])*t+0.5f);
+    }
+  }
+}
+
+void PatchMorph::applyLane(DivEngine* e, PatchMorphLane& lane) {
+  int ch=lane.chan.load();
+  if (!isMorphableChan(e,ch)) {
+    lane.sentValid=false;
+    return;
+  }
+
+  // the chip reloads the instrument after an instrument command, so send everything again
+  unsigned int insCmds=e->getChanState(ch)->insCmds;
+  bool force=(!lane.sentValid||ch!=lane.lastChan||insCmds!=lane.lastInsCmds);
+  float pos=lane.pos.load();
+  if (pos<0.0f) pos=0.0f;
+  if (pos>1.0f) pos=1.0f;
+  if (!force&&pos==lane.lastPos) return;
+
+  int vals[GEN_MORPH_PARAMS];
+  compute(pos,vals);
+
+  for (int i=0; i<GEN_MORPH_PARAMS; i++) {
+    if (!force&&vals[i]==lane.sent[i]) continue;
+    PatchMorphParam p=morphParam(i);
+    if (p.op<0) {
+      e->dispatchCmd(DivCommand(p.cmd,ch,vals[i]));
+    } else {
+      // the SSG-EG command value has the enable bit inverted
+      int val=(p.cmd==DIV_CMD_FM_SSG)?(vals[i]^8):vals[i];
+      e->dispatchCmd(DivCommand(p.cmd,ch,morphCmdOp[p.op],val));
+    }
+    lane.sent[i]=vals[i];
+  }
+
+  lane.lastPos=pos;
+  lane.lastChan=ch;
+  lane.lastInsCmds=insCmds;
+  lane.sentValid=true;
+}
+
+void PatchMorph::setSlot(int index, const DivInstrumentFM& fm) {
+  if (index<0||index>=GEN_MORPH_SLOTS) return;
+  std::lock_guard<std::mutex> lock(slotLock);
+  pendingSlots[index]=fm;
+  // fill skipped slots so that the morph doesn't go through empty patches
+  for (int i=pendingCount; i<index; i++) {
+    pendingSlots[i]=fm;
+  }
+  if (index>=pendingCount) pendingCount=index+1;
+  slotRev++;
+}
+
+void PatchMorph::clearSlots() {
+  std::lock_guard<std::mutex> lock(slotLock);
+  pendingCount=0;
+  slotRev++;
+}
+
+int PatchMorph::getSlotCount() {
+  std::lock_guard<std::mutex> lock(slotLock);
+  return pendingCount;
+}
+
+void PatchMorph::assignDefaultChannels(DivEngine* e) {
+  int lane=0;
+  for (int i=0; i<e->song.chans&&lane<GEN_MORPH_LANES; i++) {
+    if (!isMorphableChan(e,i)) continue;
+    // stay on the first chip
+    if (lane>0&&e->song.dispatchOfChan[i]!=e->song.dispatchOfChan[lanes[0].chan.load()]) break;
+    lanes[lane++].chan=i;
+  }
+  for (; lane<GEN_MORPH_LANES; lane++) {
+    lanes[lane].chan=-1;
+  }
+}
+
+void PatchMorph::resync() {
+  resyncReq=true;
+}
+
+bool PatchMorph::handleMidi(const TAMidiMessage& msg) {
+  if (!active.load()) return false;
+  if ((msg.type&0xf0)!=TA_MIDI_CONTROL) return false;
+  int ch=midiChan.load();
+  if (ch>=0 && (msg.type&15)!=ch) return false;
+  bool handled=false;
+  for (int i=0; i<GEN_MORPH_LANES; i++) {
+    if (lanes[i].cc.load()!=msg.data[0]) continue;
+    lanes[i].pos=(float)msg.data[1]/127.0f;
+    handled=true;
+  }
+  return handled;
+}
+
+void PatchMorph::tick(DivEngine* e) {
+  if (!active.load()) return;
+
+  // pick up slot changes, unless the GUI is writing them right now
+  if (slotRev.load()!=liveRev) {
+    if (slotLock.try_lock()) {
+      for (int i=0; i<pendingCount; i++) {
+        flatten(pendingSlots[i],liveSlots[i]);
+      }
+      liveCount=pendingCount;
+      liveRev=slotRev.load();
+      slotLock.unlock();
+      // recompute every lane (only the differences are sent)
+      for (int i=0; i<GEN_MORPH_LANES; i++) {
+        lanes[i].lastPos=-1.0f;
+      }
+    }
+  }
+  if (liveCount<1) return;
+
+  if (resyncReq.exchange(false)) {
+    for (int i=0; i<GEN_MORPH_LANES; i++) {
+      lanes[i].sentValid=false;
+    }
+  }
+
+  for (int i=0; i<GEN_MORPH_LANES; i++) {
+    applyLane(e,lanes[i]);
+  }
+}
@@ -0,0 +1,105 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _PATCH_MORPH_H
+#define _PATCH_MORPH_H
+
+#include "../engine/instrument.h"
+#include <atomic>
+#include <mutex>
+
+class DivEngine;
+struct TAMidiMessage;
+
+#define GEN_MORPH_SLOTS 4
+#define GEN_MORPH_LANES 6
+// ALG, FB, FMS, AMS + 11 parameters per operator
+#define GEN_MORPH_PARAMS (4+4*11)
+
+// one morphing channel
+struct PatchMorphLane {
+  // written by the GUI and MIDI input, read by the audio thread
+  std::atomic<int> chan;      // tracker channel, or -1 if off
+  std::atomic<int> cc;        // MIDI CC controlling the position, or -1
+  std::atomic<float> pos;     // 0.0 (first slot) to 1.0 (last slot)
+
+  // audio thread only
+  float lastPos;
+  int lastChan;
+  unsigned int lastInsCmds;
+  bool sentValid;
+  int sent[GEN_MORPH_PARAMS];
+
+  PatchMorphLane();
+};
+
+// interpolates between generated FM patches at tick rate.
+// the GUI fills the slots and moves lanes; on every tick the audio thread
+// computes each lane's patch and sends only the parameters which changed
+// to the chip through dispatch commands (DIV_CMD_FM_TL, DIV_CMD_FM_AR...).
+// the audio thread never waits: slot changes are picked up with try_lock,
+// and lane positions are atomics (so MIDI CC can move them from the MIDI
+// callback directly).
+class PatchMorph {
+  // slots as edited by the GUI (protected by slotLock)
+  std::mutex slotLock;
+  DivInstrumentFM pendingSlots[GEN_MORPH_SLOTS];
+  int pendingCount;
+  std::atomic<unsigned int> slotRev;
+
+  // audio thread copy
+  int liveSlots[GEN_MORPH_SLOTS][GEN_MORPH_PARAMS];
+  int liveCount;
+  unsigned int liveRev;
+  std::atomic<bool> resyncReq;
+
+  static void flatten(const DivInstrumentFM& fm, int* out);
+  void compute(float pos, int* out);
+  void applyLane(DivEngine* e, PatchMorphLane& lane);
+
+public:
+  PatchMorphLane lanes[GEN_MORPH_LANES];
+
+  // whether morphing is running (ticks do nothing otherwise)
+  std::atomic<bool> active;
+
+  // MIDI channel (0-15) which lane CCs are read from, or -1 for any (omni)
+  std::atomic<int> midiChan;
+
+  // set a slot. the slot count grows to include it.
+  void setSlot(int index, const DivInstrumentFM& fm);
+  // remove all slots
+  void clearSlots();
+  int getSlotCount();
+
+  // point lanes at the first six FM channels of a YM2612 system
+  void assignDefaultChannels(DivEngine* e);
+  // resend every parameter on the next tick
+  void resync();
+
+  // MIDI input (called from the MIDI callback). returns true if the message moved a lane.
+  bool handleMidi(const TAMidiMessage& msg);
+
+  // called by the engine on every tick, with the engine locked
+  void tick(DivEngine* e);
+
+  PatchMorph();
+};
+
+#endif
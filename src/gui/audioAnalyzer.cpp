@@ -0,0 +1,303 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define _USE_MATH_DEFINES
+#include "audioAnalyzer.h"
+#include "../engine/fftPlan.h"
+#include "../ta-log.h"
+#include <math.h>
+#include <string.h>
+#include <chrono>
+
+FurnaceAudioAnalyzer::FFT::FFT(int s, int c):
+  size(s),
+  chan(c),
+  in(NULL),
+  out(NULL),
+  plan(NULL) {
+  in=(double*)fftw_malloc(sizeof(double)*size);
+  out=(fftw_complex*)fftw_malloc(sizeof(fftw_complex)*(size/2+1));
+  if (in!=NULL && out!=NULL) {
+    memset(in,0,sizeof(double)*size);
+    plan=divPlanR2C(size,in,out);
+  }
+  if (plan==NULL) {
+    logE("could not create analyzer FFT of size %d!",size);
+  }
+  window.resize(size);
+  for (int i=0; i<size; i++) {
+    window[i]=0.5*(1.0-cos(2.0*M_PI*i/(size-1)));
+  }
+  mag.resize(size/2,0.0f);
+}
+
+FurnaceAudioAnalyzer::FFT::~FFT() {
+  divDestroyPlan(plan);
+  if (in!=NULL) fftw_free(in);
+  if (out!=NULL) fftw_free(out);
+}
+
+FurnaceAudioAnalyzer::Plan::Plan():
+  spectrumChans(0),
+  tunerFFT(-1),
+  monoSize(0) {
+  memset(spectrumFFT,0,DIV_MAX_OUTPUTS*sizeof(int));
+}
+
+FurnaceAudioAnalyzer::Plan::~Plan() {
+  for (FFT* i: ffts) {
+    delete i;
+  }
+  ffts.clear();
+}
+
+void FurnaceAudioAnalyzer::updateMeters(int pos, int len, int chans, double hopTime) {
+  float decay=0.05f*60.0f*hopTime;
+  if (decay>1.0f) decay=1.0f;
+  for (int i=0; i<DIV_MAX_OUTPUTS; i++) {
+    if (i>=chans || e->oscBuf[i]==NULL) {
+      back.peak[i]=0.0f;
+      continue;
+    }
+    float p=back.peak[i]*(1.0f-decay);
+    if (p<0.0001f) p=0.0f;
+    float newPeak=p;
+    const float* buf=e->oscBuf[i];
+    for (int j=0; j<len; j++) {
+      float val=fabs(buf[(pos+j)&0x7fff]);
+      if (val>newPeak) newPeak=val;
+    }
+    back.peak[i]=p+(newPeak-p)*0.9f;
+  }
+}
+
+void FurnaceAudioAnalyzer::runFFTs(Plan* p, int endPos) {
+  const int chans=p->conf.chans;
+
+  // mix down once for every mono FFT
+  if (p->monoSize>0) {
+    if ((int)mono.size()<p->monoSize) mono.resize(p->monoSize);
+    for (int j=0; j<p->monoSize; j++) {
+      int pos=(endPos-p->monoSize+j)&0x7fff;
+      double sample=0.0;
+      for (int ch=0; ch<chans; ch++) {
+        if (e->oscBuf[ch]==NULL) continue;
+        sample+=e->oscBuf[ch][pos];
+      }
+      mono[j]=sample/chans;
+    }
+  }
+
+  for (FFT* i: p->ffts) {
+    if (i->plan==NULL) continue;
+    const double* window=i->window.data();
+    if (i->chan<0) {
+      const double* src=mono.data()+(p->monoSize-i->size);
+      for (int j=0; j<i->size; j++) {
+        i->in[j]=src[j]*window[j];
+      }
+    } else {
+      const float* buf=e->oscBuf[i->chan];
+      if (buf==NULL) continue;
+      for (int j=0; j<i->size; j++) {
+        i->in[j]=buf[(endPos-i->size+j)&0x7fff]*window[j];
+      }
+    }
+    fftw_execute(i->plan);
+    const int count=i->size/2;
+    for (int j=0; j<count; j++) {
+      i->mag[j]=2.0*sqrt(i->out[j][0]*i->out[j][0]+i->out[j][1]*i->out[j][1])/count;
+    }
+  }
+}
+
+double FurnaceAudioAnalyzer::findPitch(const FFT* fft, int rate) {
+  const std::vector<float>& mag=fft->mag;
+  // skip some of the low frequencies
+  int peakIndex=0;
+  float peakMag=0.0f;
+  for (int k=4; k<(int)mag.size(); k++) {
+    if (mag[k]>peakMag) {
+      peakMag=mag[k];
+      peakIndex=k;
+    }
+  }
+
+  // peak with interpolation
+  if (peakIndex>0 && peakIndex<(int)mag.size()-1) {
+    double alpha=mag[peakIndex-1];
+    double beta=mag[peakIndex];
+    double gamma=mag[peakIndex+1];
+    double p=0.5*(alpha-gamma)/(alpha-2.0*beta+gamma);
+    return (peakIndex+p)*((double)rate/(double)fft->size);
+  }
+  return (double)peakIndex*((double)rate/(double)fft->size);
+}
+
+void FurnaceAudioAnalyzer::runThread() {
+  std::chrono::steady_clock::time_point lastPass=std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> quitGuard(quitLock);
+  while (!quitting) {
+    notify.wait_for(quitGuard,std::chrono::milliseconds(4));
+    if (quitting) break;
+    quitGuard.unlock();
+
+    planLock.lock();
+    Plan* p=plan;
+    if (p==NULL || p->conf.rate<1) {
+      planLock.unlock();
+      quitGuard.lock();
+      continue;
+    }
+    const double hopTime=(double)FURNACE_ANALYZER_HOP/(double)p->conf.rate;
+    std::chrono::steady_clock::time_point now=std::chrono::steady_clock::now();
+    double sinceLast=std::chrono::duration<double>(now-lastPass).count();
+
+    int avail=(e->oscWritePos.load(std::memory_order_acquire)-readPos)&0x7fff;
+    if (avail>=FURNACE_ANALYZER_HOP) {
+      // meters see every sample, FFTs only the latest window
+      while (avail>=FURNACE_ANALYZER_HOP) {
+        updateMeters(readPos,FURNACE_ANALYZER_HOP,p->conf.chans,hopTime);
+        readPos=(readPos+FURNACE_ANALYZER_HOP)&0x7fff;
+        avail-=FURNACE_ANALYZER_HOP;
+      }
+      runFFTs(p,readPos);
+      back.spectrumChans=p->spectrumChans;
+      for (int i=0; i<p->spectrumChans; i++) {
+        back.spectrum[i]=p->ffts[p->spectrumFFT[i]]->mag;
+      }
+      back.tunerFreq=(p->tunerFFT>=0)?findPitch(p->ffts[p->tunerFFT],p->conf.rate):0.0;
+      planLock.unlock();
+
+      resultLock.lock();
+      std::swap(front,back);
+      resultLock.unlock();
+      // the meters carry on from the newest levels
+      memcpy(back.peak,front.peak,DIV_MAX_OUTPUTS*sizeof(float));
+      lastPass=now;
+    } else if (sinceLast>=hopTime) {
+      // no audio is coming in. let the meters fall
+      updateMeters(readPos,0,p->conf.chans,sinceLast);
+      planLock.unlock();
+
+      resultLock.lock();
+      memcpy(front.peak,back.peak,DIV_MAX_OUTPUTS*sizeof(float));
+      resultLock.unlock();
+      lastPass=now;
+    } else {
+      planLock.unlock();
+    }
+
+    quitGuard.lock();
+  }
+}
+
+void FurnaceAudioAnalyzer::init(DivEngine* eng) {
+  if (thread!=NULL) return;
+  e=eng;
+  readPos=e->oscWritePos.load(std::memory_order_acquire);
+  quitting=false;
+  thread=new std::thread(&FurnaceAudioAnalyzer::runThread,this);
+}
+
+void FurnaceAudioAnalyzer::configure(const FurnaceAnalyzerConfig& conf) {
+  if (plan!=NULL && conf==lastConf) return;
+  lastConf=conf;
+
+  Plan* p=new Plan;
+  p->conf=conf;
+  auto addFFT=[p](int size, int chan) -> int {
+    for (size_t i=0; i<p->ffts.size(); i++) {
+      if (p->ffts[i]->size==size && p->ffts[i]->chan==chan) return i;
+    }
+    p->ffts.push_back(new FFT(size,chan));
+    return p->ffts.size()-1;
+  };
+
+  if (conf.chans>0) {
+    if (conf.spectrum) {
+      if (conf.spectrumMono) {
+        p->spectrumFFT[0]=addFFT(conf.spectrumBins,-1);
+        p->spectrumChans=1;
+      } else {
+        for (int i=0; i<conf.chans && i<DIV_MAX_OUTPUTS; i++) {
+          p->spectrumFFT[i]=addFFT(conf.spectrumBins,i);
+        }
+        p->spectrumChans=MIN(conf.chans,DIV_MAX_OUTPUTS);
+      }
+    }
+    if (conf.tuner) {
+      // any mono FFT with enough resolution will do
+      for (size_t i=0; i<p->ffts.size(); i++) {
+        if (p->ffts[i]->chan<0 && p->ffts[i]->size>=FURNACE_TUNER_FFT_SIZE) {
+          p->tunerFFT=i;
+          break;
+        }
+      }
+      if (p->tunerFFT<0) p->tunerFFT=addFFT(FURNACE_TUNER_FFT_SIZE,-1);
+    }
+  }
+  for (FFT* i: p->ffts) {
+    if (i->chan<0 && i->size>p->monoSize) p->monoSize=i->size;
+  }
+  logV("analyzer: %d FFTs (spectrum %d, tuner %d)",(int)p->ffts.size(),p->spectrumChans,p->tunerFFT);
+
+  planLock.lock();
+  Plan* old=plan;
+  plan=p;
+  planLock.unlock();
+  delete old;
+}
+
+const FurnaceAnalyzerResult& FurnaceAudioAnalyzer::lockResults() {
+  resultLock.lock();
+  return front;
+}
+
+void FurnaceAudioAnalyzer::unlockResults() {
+  resultLock.unlock();
+}
+
+void FurnaceAudioAnalyzer::quit() {
+  if (thread!=NULL) {
+    quitLock.lock();
+    quitting=true;
+    notify.notify_one();
+    quitLock.unlock();
+    thread->join();
+    delete thread;
+    thread=NULL;
+  }
+  if (plan!=NULL) {
+    delete plan;
+    plan=NULL;
+  }
+}
+
+FurnaceAudioAnalyzer::FurnaceAudioAnalyzer():
+  e(NULL),
+  thread(NULL),
+  quitting(false),
+  plan(NULL),
+  readPos(0) {
+}
+
+FurnaceAudioAnalyzer::~FurnaceAudioAnalyzer() {
+  quit();
+}
@@ -0,0 +1,164 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _AUDIO_ANALYZER_H
+#define _AUDIO_ANALYZER_H
+
+#include "../engine/engine.h"
+#include <fftw3.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+
+// samples between analysis passes
+#define FURNACE_ANALYZER_HOP 512
+#define FURNACE_TUNER_FFT_SIZE 16384
+
+// what the analysis windows want
+struct FurnaceAnalyzerConfig {
+  bool spectrum, spectrumMono, tuner;
+  int spectrumBins;
+  int chans, rate;
+  bool operator==(const FurnaceAnalyzerConfig& other) const {
+    return (spectrum==other.spectrum &&
+            spectrumMono==other.spectrumMono &&
+            tuner==other.tuner &&
+            spectrumBins==other.spectrumBins &&
+            chans==other.chans &&
+            rate==other.rate);
+  }
+  bool operator!=(const FurnaceAnalyzerConfig& other) const {
+    return !(*this==other);
+  }
+  FurnaceAnalyzerConfig():
+    spectrum(false),
+    spectrumMono(false),
+    tuner(false),
+    spectrumBins(2048),
+    chans(0),
+    rate(44100) {}
+};
+
+// results of an analysis pass
+struct FurnaceAnalyzerResult {
+  // magnitudes (bins/2 per channel), normalized so that a full-scale sine is 1.0
+  std::vector<float> spectrum[DIV_MAX_OUTPUTS];
+  int spectrumChans;
+  // detected pitch in Hz, or 0 if there is none
+  double tunerFreq;
+  // smoothed peak level of every output
+  float peak[DIV_MAX_OUTPUTS];
+  FurnaceAnalyzerResult():
+    spectrumChans(0),
+    tunerFreq(0.0) {
+    memset(peak,0,DIV_MAX_OUTPUTS*sizeof(float));
+  }
+};
+
+/**
+ * analyzes the master output for the spectrum, tuner and volume meters.
+ * the analysis thread taps the engine's oscilloscope ring buffer, and every
+ * FURNACE_ANALYZER_HOP samples it updates the meters and runs the windowed
+ * FFTs the open windows need. an FFT with the same size and source is done
+ * only once, and the tuner uses any mono FFT which is large enough, so the
+ * spectrum and the tuner share one when they can.
+ * results are double-buffered: the thread swaps them in when a pass is
+ * done, and the GUI only reads the published copy.
+ * FFTW plans are created and destroyed on the GUI thread (the planner isn't
+ * thread-safe), the analysis thread only executes them.
+ */
+class FurnaceAudioAnalyzer {
+  struct FFT {
+    int size;
+    // output channel, or -1 for the average of all channels
+    int chan;
+    double* in;
+    fftw_complex* out;
+    fftw_plan plan;
+    std::vector<double> window;
+    std::vector<float> mag;
+    FFT(int s, int c);
+    ~FFT();
+  };
+  // the FFTs to run for a configuration
+  struct Plan {
+    FurnaceAnalyzerConfig conf;
+    std::vector<FFT*> ffts;
+    int spectrumFFT[DIV_MAX_OUTPUTS];
+    int spectrumChans;
+    int tunerFFT;
+    int monoSize;
+    Plan();
+    ~Plan();
+  };
+
+  DivEngine* e;
+  std::thread* thread;
+  bool quitting;
+  std::mutex quitLock;
+  std::condition_variable notify;
+
+  // held by the thread during a pass. the GUI takes it to replace the plan.
+  std::mutex planLock;
+  Plan* plan;
+  // GUI thread only
+  FurnaceAnalyzerConfig lastConf;
+
+  // publication
+  std::mutex resultLock;
+  FurnaceAnalyzerResult front, back;
+
+  // analysis thread only
+  int readPos;
+  std::vector<double> mono;
+
+  void runThread();
+  void updateMeters(int pos, int len, int chans, double hopTime);
+  void runFFTs(Plan* p, int endPos);
+  double findPitch(const FFT* fft, int rate);
+
+  public:
+    /**
+     * start the analysis thread.
+     */
+    void init(DivEngine* eng);
+
+    /**
+     * tell the analyzer what to compute (call on every frame).
+     * FFTs are planned here when the configuration changes.
+     */
+    void configure(const FurnaceAnalyzerConfig& conf);
+
+    /**
+     * get the published results. call unlockResults() when done.
+     */
+    const FurnaceAnalyzerResult& lockResults();
+    void unlockResults();
+
+    /**
+     * stop the analysis thread and free everything.
+     */
+    void quit();
+
+    FurnaceAudioAnalyzer();
+    ~FurnaceAudioAnalyzer();
+};
+
+#endif
@@ -19,6 +19,7 @@
 
 #define _USE_MATH_DEFINES
 #include "gui.h"
+#include "../engine/fftPlan.h"
 #include "../ta-log.h"
 #include "imgui.h"
 #include "imgui_internal.h"
@@ -460,8 +461,8 @@ void FurnaceGUI::drawChanOsc() {
               fft_->inBuf=(double*)fftw_malloc(FURNACE_CHANOSC_FFT_SIZE*sizeof(double));
               fft_->outBuf=(fftw_complex*)fftw_malloc(FURNACE_CHANOSC_FFT_SIZE*sizeof(fftw_complex));
               fft_->corrBuf=(double*)fftw_malloc(FURNACE_CHANOSC_FFT_SIZE*sizeof(double));
-              fft_->plan=fftw_plan_dft_r2c_1d(FURNACE_CHANOSC_FFT_SIZE,fft_->inBuf,fft_->outBuf,FFTW_ESTIMATE);
-              fft_->planI=fftw_plan_dft_c2r_1d(FURNACE_CHANOSC_FFT_SIZE,fft_->outBuf,fft_->corrBuf,FFTW_ESTIMATE);
+              fft_->plan=divPlanR2C(FURNACE_CHANOSC_FFT_SIZE,fft_->inBuf,fft_->outBuf);
+              fft_->planI=divPlanC2R(FURNACE_CHANOSC_FFT_SIZE,fft_->outBuf,fft_->corrBuf);
               if (fft_->plan==NULL) {
                 logE(_("failed to create plan!"));
               } else if (fft_->planI==NULL) {
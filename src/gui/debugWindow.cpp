@@ -613,6 +613,9 @@ void FurnaceGUI::drawDebug() {
       ImGui::Text("- format: %d",audioGot.outFormat);
 
       ImGui::Text("last call to nextBuf(): in %d, out %d, size %d",e->lastNBIns,e->lastNBOuts,e->lastNBSize);
+      if (e->getRenderAheadLatency()>0) {
+        ImGui::Text("render-ahead: %d frames, %d underruns",e->getRenderAheadLatency(),e->getRenderAheadUnderruns());
+      }
 
       ImGui::TreePop();
     }
@@ -946,6 +949,52 @@ void FurnaceGUI::drawDebug() {
       }
       ImGui::TreePop();
     }
+    if (ImGui::TreeNode("Render Profiler")) {
+      if (ImGui::Button("Reset")) e->resetPerf();
+      if (ImGui::BeginTable("PerfTable",4,ImGuiTableFlags_Borders|ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("stage");
+        ImGui::TableSetupColumn("last");
+        ImGui::TableSetupColumn("avg");
+        ImGui::TableSetupColumn("max");
+        ImGui::TableHeadersRow();
+
+        auto perfRow=[](const char* name, DivPerfCounter* c) {
+          if (c==NULL) return;
+          ImGui::TableNextRow();
+          ImGui::TableNextColumn();
+          ImGui::TextUnformatted(name);
+          if (ImGui::IsItemHovered()) {
+            // histogram of per-buffer time (power-of-two buckets in µs)
+            float hist[DIV_PERF_HIST_BUCKETS];
+            for (int i=0; i<DIV_PERF_HIST_BUCKETS; i++) {
+              hist[i]=c->hist[i].load();
+            }
+            if (ImGui::BeginTooltip()) {
+              ImGui::PlotHistogram("##PerfHist",hist,DIV_PERF_HIST_BUCKETS,0,"1µs .. 4s (log2)",0.0f,FLT_MAX,ImVec2(240.0f,80.0f));
+              ImGui::EndTooltip();
+            }
+          }
+          ImGui::TableNextColumn();
+          ImGui::Text("%.0fµs",(double)c->last.load()/1000.0);
+          ImGui::TableNextColumn();
+          ImGui::Text("%.1fµs",c->avgMicros());
+          ImGui::TableNextColumn();
+          ImGui::Text("%.0fµs",(double)c->max.load()/1000.0);
+        };
+
+        for (int i=0; i<DIV_PERF_MAX; i++) {
+          perfRow(divPerfStageNames[i],e->getPerfCounter((DivPerfStage)i));
+        }
+        for (int i=0; i<e->song.systemLen; i++) {
+          String name=fmt::sprintf("%d: %s (acquire)",i,e->getSystemName(e->song.system[i]));
+          perfRow(name.c_str(),e->getChipPerfCounter(i,DIV_PERF_CHIP_ACQUIRE));
+          name=fmt::sprintf("%d: %s (fillBuf)",i,e->getSystemName(e->song.system[i]));
+          perfRow(name.c_str(),e->getChipPerfCounter(i,DIV_PERF_CHIP_FILLBUF));
+        }
+        ImGui::EndTable();
+      }
+      ImGui::TreePop();
+    }
     if (ImGui::TreeNode("Settings")) {
       if (ImGui::Button("Sync")) syncSettings();
       ImGui::SameLine();
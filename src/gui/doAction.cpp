@@ -972,7 +972,7 @@ void FurnaceGUI::doAction(int what) {
                 }
               }
             }
-            e->renderSamples();
+            e->renderSamples(curSample);
           });
           wantScrollListSample=true;
           MARK_MODIFIED;
@@ -1064,7 +1064,7 @@ void FurnaceGUI::doAction(int what) {
                 }
               }
             }
-            e->renderSamples();
+            e->renderSamples(curSample);
           });
           wantScrollListSample=true;
           MARK_MODIFIED;
@@ -1373,49 +1373,10 @@ void FurnaceGUI::doAction(int what) {
       if (curSample<0 || curSample>=(int)e->song.sample.size()) break;
       DivSample* sample=e->song.sample[curSample];
       if (sample->depth!=DIV_SAMPLE_DEPTH_8BIT && sample->depth!=DIV_SAMPLE_DEPTH_16BIT) break;
-      sample->prepareUndo(true);
-      e->lockEngine([this,sample]() {
-        SAMPLE_OP_BEGIN;
-        float maxVal=0.0f;
-
-        if (sample->depth==DIV_SAMPLE_DEPTH_16BIT) {
-          for (unsigned int i=start; i<end; i++) {
-            float val=fabs((float)sample->data16[i]/32767.0f);
-            if (val>maxVal) maxVal=val;
-          }
-          if (maxVal>1.0f) maxVal=1.0f;
-          if (maxVal>0.0f) {
-            float vol=1.0f/maxVal;
-            for (unsigned int i=start; i<end; i++) {
-              float val=sample->data16[i]*vol;
-              if (val<-32768) val=-32768;
-              if (val>32767) val=32767;
-              sample->data16[i]=val;
-            }
-          }
-        } else if (sample->depth==DIV_SAMPLE_DEPTH_8BIT) {
-          for (unsigned int i=start; i<end; i++) {
-            float val=fabs((float)sample->data8[i]/127.0f);
-            if (val>maxVal) maxVal=val;
-          }
-          if (maxVal>1.0f) maxVal=1.0f;
-          if (maxVal>0.0f) {
-            float vol=1.0f/maxVal;
-            for (unsigned int i=start; i<end; i++) {
-              float val=sample->data8[i]*vol;
-              if (val<-128) val=-128;
-              if (val>127) val=127;
-              sample->data8[i]=val;
-            }
-          }
-        }
-
-        updateSampleTex=true;
-        notifySampleChange=true;
-
-        e->renderSamples(curSample);
-      });
-      MARK_MODIFIED;
+      SAMPLE_OP_BEGIN;
+      FurnaceSampleJob* job=new FurnaceSampleJob(SAMPLE_JOB_NORMALIZE);
+      job->setSource(sample,curSample,start,end);
+      startSampleJob(job);
       break;
     }
     case GUI_ACTION_SAMPLE_FADE_IN: {
@@ -1442,7 +1403,8 @@ void FurnaceGUI::doAction(int what) {
           }
         }
 
-        updateSampleTex=true;
+        samplePeaks.update(sample,start,end);
+        updateSampleView=true;
         notifySampleChange=true;
 
         e->renderSamples(curSample);
@@ -1474,7 +1436,8 @@ void FurnaceGUI::doAction(int what) {
           }
         }
 
-        updateSampleTex=true;
+        samplePeaks.update(sample,start,end);
+        updateSampleView=true;
         notifySampleChange=true;
 
         e->renderSamples(curSample);
@@ -1504,7 +1467,8 @@ void FurnaceGUI::doAction(int what) {
           }
         }
 
-        updateSampleTex=true;
+        samplePeaks.update(sample,start,end);
+        updateSampleView=true;
         notifySampleChange=true;
 
         e->renderSamples(curSample);
@@ -1604,7 +1568,8 @@ void FurnaceGUI::doAction(int what) {
           }
         }
 
-        updateSampleTex=true;
+        samplePeaks.update(sample,start,end);
+        updateSampleView=true;
         notifySampleChange=true;
 
         e->renderSamples(curSample);
@@ -1630,7 +1595,8 @@ void FurnaceGUI::doAction(int what) {
           }
         }
 
-        updateSampleTex=true;
+        samplePeaks.update(sample,start,end);
+        updateSampleView=true;
         notifySampleChange=true;
 
         e->renderSamples(curSample);
@@ -1663,7 +1629,7 @@ void FurnaceGUI::doAction(int what) {
       sampleZoom=100.0/zoomPercent;
       if (sampleZoom<0.01) sampleZoom=0.01;
       sampleZoomAuto=false;
-      updateSampleTex=true;
+      updateSampleView=true;
       break;
     }
     case GUI_ACTION_SAMPLE_ZOOM_OUT: {
@@ -1675,7 +1641,7 @@ void FurnaceGUI::doAction(int what) {
       sampleZoom=100.0/zoomPercent;
       if (sampleZoom<0.01) sampleZoom=0.01;
       sampleZoomAuto=false;
-      updateSampleTex=true;
+      updateSampleView=true;
       break;
     }
     case GUI_ACTION_SAMPLE_ZOOM_AUTO:
@@ -1683,10 +1649,10 @@ void FurnaceGUI::doAction(int what) {
       if (sampleZoomAuto) {
         sampleZoom=1.0;
         sampleZoomAuto=false;
-        updateSampleTex=true;
+        updateSampleView=true;
       } else {
         sampleZoomAuto=true;
-        updateSampleTex=true;
+        updateSampleView=true;
       }
       break;
     case GUI_ACTION_SAMPLE_MAKE_INS: {
@@ -2018,7 +2018,7 @@ void FurnaceGUI::openFileDialog(FurnaceGUIFileDialogs type) {
         dpiScale,
         [this](const char* path) {
           int sampleCountBefore=e->song.sampleLen;
-          std::vector<DivInstrument*> instruments=e->instrumentFromFile(path,false);
+          std::vector<DivInstrument*> instruments=(libraryIndex!=NULL)?libraryIndex->getInstruments(path):e->instrumentFromFile(path,false);
           if (!instruments.empty()) {
             if (e->song.sampleLen!=sampleCountBefore) {
               e->renderSamplesP();
@@ -2485,28 +2485,32 @@ int FurnaceGUI::save(String path, int dmfVersion) {
       w->finish();
       return 2;
     }
-    zl.avail_in=w->size();
-    zl.next_in=w->getFinalBuf();
-    while (zl.avail_in>0) {
-      zl.avail_out=131072;
-      zl.next_out=zbuf;
-      if ((ret=deflate(&zl,Z_NO_FLUSH))==Z_STREAM_ERROR) {
-        logE("zlib stream error!");
-        lastError=_("zlib stream error");
-        deflateEnd(&zl);
-        fclose(outFile);
-        w->finish();
-        return 2;
-      }
-      size_t amount=131072-zl.avail_out;
-      if (amount>0) {
-        if (fwrite(zbuf,1,amount,outFile)!=amount) {
-          logE("did not write entirely: %s!",strerror(errno));
-          lastError=strerror(errno);
+    // compress chunk by chunk
+    for (size_t i=0; i<w->getChunkCount(); i++) {
+      size_t chunkLen=0;
+      zl.next_in=(unsigned char*)w->getChunk(i,chunkLen);
+      zl.avail_in=chunkLen;
+      while (zl.avail_in>0) {
+        zl.avail_out=131072;
+        zl.next_out=zbuf;
+        if ((ret=deflate(&zl,Z_NO_FLUSH))==Z_STREAM_ERROR) {
+          logE("zlib stream error!");
+          lastError=_("zlib stream error");
           deflateEnd(&zl);
           fclose(outFile);
           w->finish();
-          return 1;
+          return 2;
+        }
+        size_t amount=131072-zl.avail_out;
+        if (amount>0) {
+          if (fwrite(zbuf,1,amount,outFile)!=amount) {
+            logE("did not write entirely: %s!",strerror(errno));
+            lastError=strerror(errno);
+            deflateEnd(&zl);
+            fclose(outFile);
+            w->finish();
+            return 1;
+          }
         }
       }
     }
@@ -2532,7 +2536,7 @@ int FurnaceGUI::save(String path, int dmfVersion) {
     }
     deflateEnd(&zl);
   } else {
-    if (fwrite(w->getFinalBuf(),1,w->size(),outFile)!=w->size()) {
+    if (!w->writeTo(outFile)) {
       logE("did not write entirely: %s!",strerror(errno));
       lastError=strerror(errno);
       fclose(outFile);
@@ -2949,7 +2953,7 @@ void FurnaceGUI::processDrags(int dragX, int dragY) {
       if (macroDragChar) {
         MACRO_DRAG(macroDragCTarget);
       } else {
-        MACRO_DRAG(macroDragTarget);
+        MACRO_DRAG((*macroDragTarget));
       }
     }
   }
@@ -3003,7 +3007,10 @@ void FurnaceGUI::processDrags(int dragX, int dragY) {
           if (val>127) val=127;
           for (int i=x; i<=x1; i++) ((signed char*)sampleDragTarget)[i]=val;
         }
-        updateSampleTex=true;
+        if (curSample>=0 && curSample<(int)e->song.sample.size()) {
+          samplePeaks.update(e->song.sample[curSample],x,x1+1);
+        }
+        updateSampleView=true;
         notifySampleChange=true;
       }
     } else { // select
@@ -5277,6 +5284,8 @@ bool FurnaceGUI::loop() {
 #endif
 #endif
 
+    refreshLibraryInfo();
+
     if (fileDialog->render(mobileUI?ImVec2(canvasW-(portrait?0:(60.0*dpiScale)),canvasH-60.0*dpiScale):ImVec2(600.0f*dpiScale,400.0f*dpiScale),ImVec2(canvasW-((mobileUI && !portrait)?(60.0*dpiScale):0),canvasH-(mobileUI?(60.0*dpiScale):0)))) {
       bool openOpen=false;
       //ImGui::GetIO().ConfigFlags&=~ImGuiConfigFlags_NavEnableKeyboard;
@@ -5894,7 +5903,7 @@ bool FurnaceGUI::loop() {
               if (w!=NULL) {
                 FILE* f=ps_fopen(copyOfName.c_str(),"wb");
                 if (f!=NULL) {
-                  fwrite(w->getFinalBuf(),1,w->size(),f);
+                  w->writeTo(f);
                   fclose(f);
                   pushRecentSys(copyOfName.c_str());
                 } else {
@@ -5930,7 +5939,7 @@ bool FurnaceGUI::loop() {
               if (w!=NULL) {
                 FILE* f=ps_fopen(copyOfName.c_str(),"wb");
                 if (f!=NULL) {
-                  fwrite(w->getFinalBuf(),1,w->size(),f);
+                  w->writeTo(f);
                   fclose(f);
                   pushRecentSys(copyOfName.c_str());
                 } else {
@@ -6248,7 +6257,7 @@ bool FurnaceGUI::loop() {
                 }
                 FILE* outFile=ps_fopen(path.c_str(),"wb");
                 if (outFile!=NULL) {
-                  fwrite(i.data->getFinalBuf(),1,i.data->size(),outFile);
+                  i.data->writeTo(outFile);
                   fclose(outFile);
                 } else {
                   // TODO: handle failure here
@@ -6327,7 +6336,7 @@ bool FurnaceGUI::loop() {
             if (csExportResult!=NULL) {
               FILE* f=ps_fopen(csExportPath.c_str(),"wb");
               if (f!=NULL) {
-                fwrite(csExportResult->getFinalBuf(),1,csExportResult->size(),f);
+                csExportResult->writeTo(f);
                 fclose(f);
                 pushRecentSys(csExportPath.c_str());
               } else {
@@ -7451,7 +7460,7 @@ bool FurnaceGUI::loop() {
               
               FILE* outFile=ps_fopen(finalPath.c_str(),"wb");
               if (outFile!=NULL) {
-                if (fwrite(w->getFinalBuf(),1,w->size(),outFile)!=w->size()) {
+                if (!w->writeTo(outFile)) {
                   logW("did not write backup entirely: %s!",strerror(errno));
                 }
                 fclose(outFile);
@@ -7546,6 +7555,12 @@ bool FurnaceGUI::loop() {
       chordInputOffset=0;
     }
 
+    // write back finished sample operations
+    processSampleJobs();
+
+    // free macro storage replaced by edits during this frame
+    e->collectMacroValues();
+
     if (!settings.renderClearPos || renderBackend==GUI_BACKEND_METAL) {
       rend->clear(uiColors[GUI_COLOR_BACKGROUND]);
     }
@@ -7691,6 +7706,9 @@ bool FurnaceGUI::init() {
   syncSettings();
   syncTutorial();
 
+  initLibraryIndex();
+  audioAnalyzer.init(e);
+
   if (!tutorial.nprFieldTrial && newPatternRenderer) {
     showWarning(_("welcome to the New Pattern Renderer!\nit should be lighter on your CPU.\n\nif you find an issue, you can go back to the old pattern renderer by clicking the NPR button (next to Help).\nmake sure to report it!\n\nthank you!"),GUI_WARN_NPR);
   }
@@ -8126,6 +8144,8 @@ bool FurnaceGUI::init() {
     midiLock.unlock();
     e->setMidiBaseChan(cursor.xCoarse);
     if (msg.type==TA_MIDI_SYSEX) return -3;
+    // morph lanes are moved right away (this runs in the audio thread)
+    if (genWorkspace!=NULL && genWorkspace->morph.handleMidi(msg)) return -3;
     if (midiMap.valueInputStyle!=0 && cursor.xFine!=0 && edit) return -3;
     if (!midiMap.noteInput) return -3;
     if (learning!=-1) return -3;
@@ -8689,6 +8709,11 @@ bool FurnaceGUI::finish(bool saveConfig) {
     delete chanOscWorkPool;
   }
 
+  quitLibraryIndex();
+  samplePeaks.quit();
+  audioAnalyzer.quit();
+  sampleJobs.quit();
+
   if (genWorkspace!=NULL) {
     delete genWorkspace;
     genWorkspace=NULL;
@@ -8697,37 +8722,6 @@ bool FurnaceGUI::finish(bool saveConfig) {
   delete[] opTouched;
   opTouched=NULL;
 
-  if (tunerFFTInBuf) {
-    delete[] tunerFFTInBuf;
-    tunerFFTInBuf=NULL;
-  }
-  if (tunerFFTOutBuf) {
-    fftw_free(tunerFFTOutBuf);
-    tunerFFTOutBuf=NULL;
-  }
-  if (tunerPlan) {
-    fftw_free(tunerPlan);
-    tunerPlan=NULL;
-  }
-  for (int i=0; i<DIV_MAX_OUTPUTS; i++) {
-    if (spectrum.buffer[i]) {
-      fftw_free(spectrum.buffer[i]);
-      spectrum.buffer[i]=NULL;
-    }
-    if (spectrum.in[i]) {
-      delete[] spectrum.in[i];
-      spectrum.in[i]=NULL;
-    }
-    if (spectrum.plan[i]) {
-      fftw_free(spectrum.plan[i]);
-      spectrum.plan[i]=NULL;
-    }
-    if (spectrum.plot[i]) {
-      delete[] spectrum.plot[i];
-      spectrum.plot[i]=NULL;
-    }
-  }
-
   return true;
 }
 
@@ -8756,6 +8750,7 @@ FurnaceGUI::FurnaceGUI():
   sampleTexW(0),
   sampleTexH(0),
   updateSampleTex(true),
+  updateSampleView(false),
   quit(false),
   warnQuit(false),
   willCommit(false),
@@ -8860,6 +8855,9 @@ FurnaceGUI::FurnaceGUI():
   mobScene(GUI_SCENE_PATTERN),
   fileDialog(NULL),
   newFilePicker(NULL),
+  libraryIndex(NULL),
+  libraryRevision(0),
+  libraryRefreshTime(0.0),
   scrW(GUI_WIDTH_DEFAULT),
   scrH(GUI_HEIGHT_DEFAULT),
   scrConfW(GUI_WIDTH_DEFAULT),
@@ -8895,7 +8893,6 @@ FurnaceGUI::FurnaceGUI():
   localeRequiresChineseTrad(false),
   localeRequiresKorean(false),
   prevInsData(NULL),
-  cachedCurInsPtr(NULL),
   insEditMayBeDirty(false),
   pendingLayoutImport(NULL),
   pendingLayoutImportLen(0),
@@ -9277,9 +9274,6 @@ FurnaceGUI::FurnaceGUI():
   xyOscDecayTime(10.0f),
   xyOscIntensity(2.0f),
   xyOscThickness(2.0f),
-  tunerFFTInBuf(NULL),
-  tunerFFTOutBuf(NULL),
-  tunerPlan(NULL),
   fpCueInput(""),
   fpCueInputFailed(false),
   fpCueInputFailReason(""),
@@ -22,6 +22,7 @@
 
 #include "../engine/engine.h"
 #include "../engine/workPool.h"
+#include "../engine/libraryIndex.h"
 #include "../engine/waveSynth.h"
 #include "imgui.h"
 #include "imgui_internal.h"
@@ -40,6 +41,9 @@
 
 #include "fileDialog.h"
 #include "newFilePicker.h"
+#include "samplePeaks.h"
+#include "audioAnalyzer.h"
+#include "sampleJobs.h"
 
 #define FURNACE_APP_ID "org.tildearrow.furnace"
 
@@ -49,7 +53,7 @@
 #define handleUnimportant if (settings.insFocusesPattern && patternOpen) {nextWindow=GUI_WINDOW_PATTERN;}
 #define unimportant(x) if (x) {handleUnimportant}
 
-#define MARK_MODIFIED modified=true;
+#define MARK_MODIFIED modified=true,e->markSongModified();
 #define WAKE_UP drawHalt=5;
 
 #define RESET_WAVE_MACRO_ZOOM \
@@ -1716,7 +1720,12 @@ class FurnaceGUI {
 
   FurnaceGUITexture* sampleTex;
   int sampleTexW, sampleTexH;
-  bool updateSampleTex;
+  // updateSampleTex: sample contents may have changed
+  // updateSampleView: only the view (or a range reported to samplePeaks) changed
+  bool updateSampleTex, updateSampleView;
+  FurnaceSamplePeakCache samplePeaks;
+  // long sample operations
+  FurnaceSampleJobRunner sampleJobs;
 
   FurnaceGUITexture* csTex;
 
@@ -1811,6 +1820,9 @@ class FurnaceGUI {
 
   FurnaceGUIFileDialog* fileDialog;
   FurnaceFilePicker* newFilePicker;
+  DivLibraryIndex* libraryIndex;
+  unsigned int libraryRevision;
+  double libraryRefreshTime;
 
   int scrW, scrH, scrConfW, scrConfH, canvasW, canvasH;
   int scrX, scrY, scrConfX, scrConfY;
@@ -2056,7 +2068,10 @@ class FurnaceGUI {
     int exportOptionsLayout;
     int wasapiEx;
     int chanOscThreads;
+    int libraryIndexThreads;
     int renderPoolThreads;
+    int parallelTick;
+    int renderAheadBufs;
     int writeInsNames;
     int readInsNames;
     int fontBackend;
@@ -2104,6 +2119,7 @@ class FurnaceGUI {
     String headFontPath;
     String patFontPath;
     String audioDevice;
+    String audioSocketPath;
     String midiInDevice;
     String midiOutDevice;
     String renderBackend;
@@ -2310,7 +2326,10 @@ class FurnaceGUI {
       exportOptionsLayout(1),
       wasapiEx(0),
       chanOscThreads(0),
+      libraryIndexThreads(2),
       renderPoolThreads(0),
+      parallelTick(0),
+      renderAheadBufs(0),
       writeInsNames(0),
       readInsNames(1),
       fontBackend(1),
@@ -2358,6 +2377,7 @@ class FurnaceGUI {
       headFontPath(""),
       patFontPath(""),
       audioDevice(""),
+      audioSocketPath(""),
       midiInDevice(""),
       midiOutDevice(""),
       renderBackend(""),
@@ -2404,8 +2424,7 @@ class FurnaceGUI {
   std::vector<ImWchar> localeExtraRanges;
 
   DivInstrument* prevInsData;
-  DivInstrument cachedCurIns;
-  DivInstrument* cachedCurInsPtr;
+  DivInstrumentChangeTracker insTracker;
   bool insEditMayBeDirty;
 
   unsigned char* pendingLayoutImport;
@@ -2573,7 +2592,7 @@ class FurnaceGUI {
   ImVec2 macroDragStart;
   ImVec2 macroDragAreaSize;
   unsigned char* macroDragCTarget;
-  int* macroDragTarget;
+  DivMacroValues* macroDragTarget;
   int macroDragLen;
   int macroDragMin, macroDragMax;
   int macroDragLastX, macroDragLastY;
@@ -2779,20 +2798,15 @@ class FurnaceGUI {
   float xyOscIntensity;
   float xyOscThickness;
 
-  // spectrum and tuner
-  double* tunerFFTInBuf;
-  fftw_complex* tunerFFTOutBuf;
-  fftw_plan tunerPlan;
+  // spectrum and tuner (analysis runs in audioAnalyzer)
+  FurnaceAudioAnalyzer audioAnalyzer;
   struct SpectrumSettings {
     int bins;
     float xZoom, xOffset;
     float yOffset;
-    fftw_plan plan[DIV_MAX_OUTPUTS];
-    double* in[DIV_MAX_OUTPUTS];
-    fftw_complex* buffer[DIV_MAX_OUTPUTS];
-    ImVec2* plot[DIV_MAX_OUTPUTS];
+    std::vector<ImVec2> plot;
     std::vector<int> frequencies;
-    bool update, running, mono;
+    bool update, mono;
     bool showXGrid, showYGrid, showXScale, showYScale;
     SpectrumSettings():
       bins(4096),
@@ -2801,17 +2815,11 @@ class FurnaceGUI {
       yOffset(0.0f),
       frequencies({}),
       update(true),
-      running(false),
       mono(false),
       showXGrid(true),
       showYGrid(true),
       showXScale(true),
-      showYScale(true) {
-        memset(plan,0,DIV_MAX_OUTPUTS*sizeof(fftw_plan*));
-        memset(in,0,DIV_MAX_OUTPUTS*sizeof(double*));
-        memset(buffer,0,DIV_MAX_OUTPUTS*sizeof(fftw_complex*));
-        memset(plot,0,DIV_MAX_OUTPUTS*sizeof(ImVec2*));
-      }
+      showYScale(true) {}
   } spectrum;
 
   // visualizer
@@ -3113,6 +3121,11 @@ class FurnaceGUI {
   void drawXYOsc();
   void drawUserPresets();
   void drawRefPlayer();
+
+  bool getLibraryInfo(const String& path, String& info);
+  void initLibraryIndex();
+  void quitLibraryIndex();
+  void refreshLibraryInfo();
   void drawMultiInsSetup();
   void drawGenWorkspace();
 
@@ -3211,6 +3224,9 @@ class FurnaceGUI {
 
   void doUndoSample();
   void doRedoSample();
+  void startSampleJob(FurnaceSampleJob* job);
+  void commitSampleJob(FurnaceSampleJob* job);
+  void processSampleJobs();
 
   void checkRecordInstrumentUndoStep();
   void doUndoInstrument();
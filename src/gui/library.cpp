@@ -0,0 +1,108 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "gui.h"
+#include "guiConst.h"
+#include <fmt/printf.h>
+#include <algorithm>
+
+static bool isFMInsType(DivInstrumentType type) {
+  switch (type) {
+    case DIV_INS_FM:
+    case DIV_INS_OPLL:
+    case DIV_INS_OPL:
+    case DIV_INS_OPL_DRUMS:
+    case DIV_INS_OPZ:
+    case DIV_INS_OPM:
+    case DIV_INS_ESFM:
+      return true;
+    default:
+      break;
+  }
+  return false;
+}
+
+// this is used for display and searching
+bool FurnaceGUI::getLibraryInfo(const String& path, String& info) {
+  if (libraryIndex==NULL) return false;
+  DivLibraryEntry entry;
+  if (!libraryIndex->lookup(path,entry)) return false;
+  if (!entry.ok || entry.assets.empty()) return false;
+
+  const DivLibraryAsset& first=entry.assets[0];
+  if (first.kind==DIV_LIBRARY_SAMPLE) {
+    if (first.sampleRate>0) {
+      info=fmt::sprintf(_("sample, %u samples, %dHz (%.2fs)"),first.sampleLen,first.sampleRate,(double)first.sampleLen/(double)first.sampleRate);
+    } else {
+      info=fmt::sprintf(_("sample, %u samples"),first.sampleLen);
+    }
+    return true;
+  }
+
+  if (entry.assets.size()>1) {
+    // list every instrument type in the bank
+    String types;
+    std::vector<DivInstrumentType> seen;
+    for (const DivLibraryAsset& i: entry.assets) {
+      if (i.kind!=DIV_LIBRARY_INS) continue;
+      if (std::find(seen.begin(),seen.end(),i.insType)!=seen.end()) continue;
+      seen.push_back(i.insType);
+      if (!types.empty()) types+=", ";
+      types+=_(insTypes[i.insType][0]);
+    }
+    info=fmt::sprintf(_("%d instruments (%s)"),(int)entry.assets.size(),types);
+    return true;
+  }
+
+  info=_(insTypes[first.insType][0]);
+  if (isFMInsType(first.insType)) {
+    info+=fmt::sprintf(_(", %dop ALG %d FB %d"),(first.ops==2)?2:4,first.alg,first.fb);
+  }
+  return true;
+}
+
+void FurnaceGUI::initLibraryIndex() {
+  if (settings.libraryIndexThreads<1) return;
+  libraryIndex=new DivLibraryIndex;
+  libraryIndex->init(e->getConfigPath()+DIR_SEPARATOR_STR+"library.idx",settings.libraryIndexThreads);
+  newFilePicker->setInfoCallback([this](const String& path, String& info) -> bool {
+    return getLibraryInfo(path,info);
+  });
+}
+
+void FurnaceGUI::quitLibraryIndex() {
+  if (libraryIndex==NULL) return;
+  newFilePicker->setInfoCallback(NULL);
+  libraryIndex->quit();
+  delete libraryIndex;
+  libraryIndex=NULL;
+}
+
+void FurnaceGUI::refreshLibraryInfo() {
+  if (libraryIndex==NULL) return;
+  if (!newFilePicker->isOpened()) return;
+  unsigned int rev=libraryIndex->getRevision();
+  if (rev==libraryRevision) return;
+  // don't filter the file list again on every indexed file
+  double now=ImGui::GetTime();
+  if ((now-libraryRefreshTime)<0.25) return;
+  libraryRevision=rev;
+  libraryRefreshTime=now;
+  newFilePicker->refreshInfo();
+}
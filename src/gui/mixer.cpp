@@ -312,7 +312,7 @@ void FurnaceGUI::drawMixer() {
       if (ImGui::BeginTabItem(_("Patchbay"))) {
         std::map<unsigned int,ImVec2> portPos;
 
-        if (ImGui::BeginTable("PatchbayOptions",3)) {
+        if (ImGui::BeginTable("PatchbayOptions",4)) {
           ImGui::TableNextRow();
           ImGui::TableNextColumn();
           if (ImGui::Checkbox(_("Automatic patchbay"),&e->song.patchbayAuto)) {
@@ -323,6 +323,22 @@ void FurnaceGUI::drawMixer() {
           ImGui::Checkbox(_("Display hidden ports"),&displayHiddenPorts);
           ImGui::TableNextColumn();
           ImGui::Checkbox(_("Display internal"),&displayInternalPorts);
+          ImGui::TableNextColumn();
+          if (ImGui::Button(_("Add effect"))) {
+            ImGui::OpenPopup("AddEffect");
+          }
+          if (ImGui::BeginPopup("AddEffect")) {
+            DivEffectType addType=DIV_EFFECT_NULL;
+            if (ImGui::MenuItem(_("Passthrough"))) addType=DIV_EFFECT_DUMMY;
+            if (ImGui::MenuItem(_("Convolution reverb"))) addType=DIV_EFFECT_CONVOLUTION;
+            if (addType!=DIV_EFFECT_NULL) {
+              if (!e->addEffect(addType)) {
+                showError(fmt::sprintf(_("cannot add effect! (%s)"),e->getLastError()));
+              }
+              MARK_MODIFIED;
+            }
+            ImGui::EndPopup();
+          }
           ImGui::EndTable();
         }
 
@@ -362,6 +378,42 @@ void FurnaceGUI::drawMixer() {
             }
           }
 
+          // effects (inputs and outputs are separate portsets)
+          for (size_t i=0; i<e->song.effects.size(); i++) {
+            DivEffect* effect=e->getEffect(i);
+            if (effect==NULL) continue;
+            unsigned int effectPortSet=DIV_PORTSET_EFFECT+i;
+            int ins=MIN(effect->getInputCount(),DIV_MAX_OUTPUTS);
+            int outs=MIN(effect->getOutputCount(),DIV_MAX_OUTPUTS);
+            if (portSet(fmt::sprintf(_("FX %d (in)"),(int)i+1),0x1000|effectPortSet,ins,0,ins,0,selectedSubPort,portPos)) {
+              selectedPortSet=0x1000|effectPortSet;
+              if (selectedSubPort>=0) {
+                portDragActive=true;
+                ImGui::InhibitInertialScroll();
+                auto subPortI=portPos.find((selectedPortSet<<4)|selectedSubPort);
+                if (subPortI!=portPos.cend()) {
+                  subPortPos=subPortI->second;
+                } else {
+                  portDragActive=false;
+                }
+              }
+            }
+            ImGui::SameLine();
+            if (portSet(fmt::sprintf(_("FX %d (out)"),(int)i+1),effectPortSet,0,outs,0,outs,selectedSubPort,portPos)) {
+              selectedPortSet=effectPortSet;
+              if (selectedSubPort>=0) {
+                portDragActive=true;
+                ImGui::InhibitInertialScroll();
+                auto subPortI=portPos.find((selectedPortSet<<4)|selectedSubPort);
+                if (subPortI!=portPos.cend()) {
+                  subPortPos=subPortI->second;
+                } else {
+                  portDragActive=false;
+                }
+              }
+            }
+          }
+
           // file player/metronome/sample preview
           if (displayInternalPorts) {
             if (portSet(_("Music Player"),0xffc,0,16,0,16,selectedSubPort,portPos)) {
@@ -473,6 +525,50 @@ void FurnaceGUI::drawMixer() {
             e->patchDisconnectAll(selectedPortSet);
             MARK_MODIFIED;
           }
+          unsigned int selectedEffect=(selectedPortSet&0xfff)-DIV_PORTSET_EFFECT;
+          if ((selectedPortSet&0xfff)>=DIV_PORTSET_EFFECT && selectedEffect<e->song.effects.size()) {
+            DivEffect* effect=e->getEffect(selectedEffect);
+            if (effect!=NULL && effect->getParamCount()>0) {
+              ImGui::Separator();
+              // parameter names are the third field of each line in getParams()
+              std::vector<String> paramNames;
+              const char* params=effect->getParams();
+              if (params!=NULL) {
+                String line;
+                for (const char* i=params; ; i++) {
+                  if (*i=='\n' || *i==0) {
+                    size_t first=line.find(':');
+                    size_t second=(first==String::npos)?String::npos:line.find(':',first+1);
+                    size_t third=(second==String::npos)?String::npos:line.find(':',second+1);
+                    paramNames.push_back((second==String::npos)?line:line.substr(second+1,third-second-1));
+                    line="";
+                    if (*i==0) break;
+                  } else {
+                    line+=*i;
+                  }
+                }
+              }
+              for (size_t i=0; i<effect->getParamCount(); i++) {
+                String value=effect->getParam(i);
+                char buf[256];
+                strncpy(buf,value.c_str(),255);
+                buf[255]=0;
+                ImGui::PushID(i);
+                ImGui::SetNextItemWidth(120.0f*dpiScale);
+                if (ImGui::InputText((i<paramNames.size())?paramNames[i].c_str():"##Param",buf,256,ImGuiInputTextFlags_EnterReturnsTrue)) {
+                  effect->setParam(i,buf);
+                  MARK_MODIFIED;
+                }
+                ImGui::PopID();
+              }
+              ImGui::Separator();
+            }
+            if (ImGui::MenuItem(_("remove effect"))) {
+              e->removeEffect(selectedEffect);
+              selectedPortSet=0x1fff;
+              MARK_MODIFIED;
+            }
+          }
           ImGui::EndPopup();
         }
         ImGui::EndChild();
@@ -409,7 +409,12 @@ void FurnaceFilePicker::searchSub(String subPath, int depth) {
       if (i>='A' && i<='Z') i+='a'-'A';
     }
 
-    if (lower.find(searchQueryW)!=WString::npos) {
+    bool matches=(lower.find(searchQueryW)!=WString::npos);
+    if (!matches && !(entry.dwFileAttributes&FILE_ATTRIBUTE_DIRECTORY)) {
+      matches=infoMatches(actualPath+String("\\")+utf16To8(entry.cFileName));
+    }
+
+    if (matches) {
       FileEntry* newEntry=makeEntry(&entry,subPath.c_str());
       entryLock.lock();
       entries.push_back(newEntry);
@@ -460,7 +465,12 @@ void FurnaceFilePicker::searchSub(String subPath, int depth) {
       if (i>='A' && i<='Z') i+='a'-'A';
     }
 
-    if (lower.find(searchQuery)!=String::npos) {
+    bool matches=(lower.find(searchQuery)!=String::npos);
+    if (!matches && entry->d_type!=DT_DIR) {
+      matches=infoMatches(actualPath+String("/")+entry->d_name);
+    }
+
+    if (matches) {
       FileEntry* newEntry=makeEntry(entry,subPath.c_str());
       entryLock.lock();
       entries.push_back(newEntry);
@@ -680,6 +690,13 @@ void FurnaceFilePicker::sortFiles() {
     }
   }
 
+  // get file information
+  if (infoCallback!=NULL) {
+    for (FileEntry* i: sortedEntries) {
+      fetchInfo(i);
+    }
+  }
+
   // sort by name
   std::sort(sortedEntries.begin(),sortedEntries.end(),[this](const FileEntry* a, const FileEntry* b) -> bool {
     if (sortDirsFirst) {
@@ -760,6 +777,38 @@ void FurnaceFilePicker::filterFiles() {
   for (FileEntry* i: sortedEntries) {
     if (i->nameLower.find(lowerFilter)!=String::npos) {
       filteredEntries.push_back(i);
+    } else if (i->hasInfo && i->infoLower.find(lowerFilter)!=String::npos) {
+      filteredEntries.push_back(i);
+    }
+  }
+}
+
+String FurnaceFilePicker::getEntryPath(FileEntry* entry) {
+  if (path.empty()) return entry->name;
+  if (*path.rbegin()==DIR_SEPARATOR) return path+entry->name;
+  return path+DIR_SEPARATOR+entry->name;
+}
+
+bool FurnaceFilePicker::infoMatches(const String& entryPath) {
+  if (infoCallback==NULL) return false;
+  String info;
+  if (!infoCallback(entryPath,info)) return false;
+  for (char& i: info) {
+    if (i>='A' && i<='Z') i+='a'-'A';
+  }
+  return (info.find(searchQuery)!=String::npos);
+}
+
+void FurnaceFilePicker::fetchInfo(FileEntry* entry) {
+  if (entry->hasInfo) return;
+  entry->hasInfo=true;
+  entry->info="";
+  entry->infoLower="";
+  if (entry->isDir || infoCallback==NULL) return;
+  if (infoCallback(getEntryPath(entry),entry->info)) {
+    entry->infoLower=entry->info;
+    for (char& i: entry->infoLower) {
+      if (i>='A' && i<='Z') i+='a'-'A';
     }
   }
 }
@@ -883,12 +932,15 @@ void FurnaceFilePicker::drawFileList(ImVec2& tableSize, bool& acknowledged) {
     if (displayType) columns++;
     if (displaySize) columns++;
     if (displayDate) columns++;
+    bool showInfo=(displayInfo && infoCallback!=NULL);
+    if (showInfo) columns++;
     if (ImGui::BeginTable("FileList",columns,ImGuiTableFlags_BordersOuter|ImGuiTableFlags_NoBordersInBody|ImGuiTableFlags_Resizable|ImGuiTableFlags_ScrollY|ImGuiTableFlags_RowBg,tableSize)) {
       float rowHeight=ImGui::GetTextLineHeight()+ImGui::GetStyle().CellPadding.y*2.0f;
       ImGui::TableSetupColumn("c0",ImGuiTableColumnFlags_WidthStretch);
       if (displayType) ImGui::TableSetupColumn("c1",ImGuiTableColumnFlags_WidthFixed,ImGui::CalcTextSize(" .eeee").x);
       if (displaySize) ImGui::TableSetupColumn("c2",ImGuiTableColumnFlags_WidthFixed,ImGui::CalcTextSize(" 999.99G").x);
       if (displayDate) ImGui::TableSetupColumn("c3",ImGuiTableColumnFlags_WidthFixed,ImGui::CalcTextSize(" 6969/69/69 04:20").x);
+      if (showInfo) ImGui::TableSetupColumn("c4",ImGuiTableColumnFlags_WidthStretch,0.6f);
       ImGui::TableSetupScrollFreeze(0,1);
 
       // header (sort options)
@@ -974,6 +1026,10 @@ void FurnaceFilePicker::drawFileList(ImVec2& tableSize, bool& acknowledged) {
           }
         }
       }
+      if (showInfo) {
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(_("Info"));
+      }
 
       // file list
       entryLock.lock();
@@ -1036,16 +1092,7 @@ void FurnaceFilePicker::drawFileList(ImVec2& tableSize, bool& acknowledged) {
 
               // trigger callback if set
               if (selCallback!=NULL) {
-                String callbackPath;
-                if (path.empty()) {
-                  callbackPath=i->name;
-                } else {
-                  if (*path.rbegin()==DIR_SEPARATOR) {
-                    callbackPath=path+i->name;
-                  } else {
-                    callbackPath=path+DIR_SEPARATOR+i->name;
-                  }
-                }
+                String callbackPath=getEntryPath(i);
                 selCallback(callbackPath.c_str());
               }
             }
@@ -1098,6 +1145,13 @@ void FurnaceFilePicker::drawFileList(ImVec2& tableSize, bool& acknowledged) {
             }
           }
 
+          // info
+          if (showInfo) {
+            ImGui::TableNextColumn();
+            fetchInfo(i);
+            ImGui::TextNoHashHide("%s",i->info.c_str());
+          }
+
           ImGui::PopStyleColor();
         }
       }
@@ -1484,6 +1538,9 @@ bool FurnaceFilePicker::draw(ImGuiWindowFlags winFlags) {
       ImGui::Checkbox(_("Type"),&displayType);
       ImGui::Checkbox(_("Size"),&displaySize);
       ImGui::Checkbox(_("Date"),&displayDate);
+      if (infoCallback!=NULL) {
+        ImGui::Checkbox(_("Info"),&displayInfo);
+      }
       ImGui::Unindent();
       ImGui::EndPopup();
     }
@@ -1528,6 +1585,19 @@ bool FurnaceFilePicker::draw(ImGuiWindowFlags winFlags) {
       ImGui::GetIO().IsSomethingHappening=true;
     }
 
+    if (infoChanged) {
+      infoChanged=false;
+      entryLock.lock();
+      for (FileEntry* i: entries) {
+        i->hasInfo=false;
+      }
+      for (FileEntry* i: sortedEntries) {
+        fetchInfo(i);
+      }
+      entryLock.unlock();
+      if (!isSearch) filterFiles();
+    }
+
     if (haveStat && scheduledSort>1) scheduledSort=1;
     if (scheduledSort>0) {
       if (--scheduledSort==0) {
@@ -1824,7 +1894,7 @@ bool FurnaceFilePicker::open(String name, String pa, String hint, int flags, con
   }
   curFilterType=0;
 
-  selectCallback=selCallback;
+  selCallback=selectCallback;
 
   if (!isSearch || windowName!=name) {
     if (isSearch) this->filter="";
@@ -1868,6 +1938,7 @@ void FurnaceFilePicker::loadSettings(DivConfig& conf) {
   displayType=conf.getBool(configPrefix+"displayType",true);
   displaySize=conf.getBool(configPrefix+"displaySize",true);
   displayDate=conf.getBool(configPrefix+"displayDate",true);
+  displayInfo=conf.getBool(configPrefix+"displayInfo",true);
   bookmarks=conf.getStringList(configPrefix+"bookmarks",{});
 }
 
@@ -1881,6 +1952,7 @@ void FurnaceFilePicker::saveSettings(DivConfig& conf) {
   conf.set(configPrefix+"displayType",displayType);
   conf.set(configPrefix+"displaySize",displaySize);
   conf.set(configPrefix+"displayDate",displayDate);
+  conf.set(configPrefix+"displayInfo",displayInfo);
   conf.set(configPrefix+"bookmarks",bookmarks);
 }
 
@@ -1888,6 +1960,15 @@ void FurnaceFilePicker::setConfigPrefix(String prefix) {
   configPrefix=prefix;
 }
 
+void FurnaceFilePicker::setInfoCallback(FilePickerInfoCallback callback) {
+  infoCallback=callback;
+  infoChanged=true;
+}
+
+void FurnaceFilePicker::refreshInfo() {
+  infoChanged=true;
+}
+
 const String& FurnaceFilePicker::getPath() {
   return path;
 }
@@ -1944,6 +2025,8 @@ FurnaceFilePicker::FurnaceFilePicker():
   sortMode(FP_SORT_NAME),
   curStatus(FP_STATUS_WAITING),
   selCallback(NULL),
+  infoCallback(NULL),
+  infoChanged(false),
   editingPath(false),
   showBookmarks(true),
   showHiddenFiles(true),
@@ -1953,7 +2036,8 @@ FurnaceFilePicker::FurnaceFilePicker():
   naturalSort(false),
   displayType(true),
   displaySize(true),
-  displayDate(true) {
+  displayDate(true),
+  displayInfo(true) {
   memset(sortInvert,0,FP_SORT_MAX*sizeof(bool));
   sortInvert[FP_SORT_SIZE]=true;
   sortInvert[FP_SORT_DATE]=true;
@@ -63,6 +63,8 @@ enum FilePickerFlags {
 };
 
 typedef std::function<void(const char*)> FilePickerSelectCallback;
+// fills in extra information about a file (used for display and searching).
+typedef std::function<bool(const String&,String&)> FilePickerInfoCallback;
 
 class FurnaceFilePicker {
   enum SortModes {
@@ -85,12 +87,14 @@ class FurnaceFilePicker {
     String name;
     String nameLower;
     String ext;
-    bool hasSize, hasTime, isDir, isHidden, isSelected;
+    String info;
+    String infoLower;
+    bool hasSize, hasTime, isDir, isHidden, isSelected, hasInfo;
     uint64_t size;
     struct tm time;
     FileType type;
     FileEntry():
-      hasSize(false), hasTime(false), isDir(false), isHidden(false), isSelected(false),
+      hasSize(false), hasTime(false), isDir(false), isHidden(false), isSelected(false), hasInfo(false),
       size(0), type(FP_TYPE_UNKNOWN) {}
   };
   std::vector<FileEntry*> entries;
@@ -120,6 +124,8 @@ class FurnaceFilePicker {
   SortModes sortMode;
   FilePickerStatus curStatus;
   FilePickerSelectCallback selCallback;
+  FilePickerInfoCallback infoCallback;
+  bool infoChanged;
 
   std::vector<FileTypeStyle> fileTypeRegistry;
   FileTypeStyle defaultTypeStyle[FP_TYPE_MAX];
@@ -143,7 +149,7 @@ class FurnaceFilePicker {
   bool clearSearchOnDirChange;
   bool sortDirsFirst;
   bool naturalSort;
-  bool displayType, displaySize, displayDate;
+  bool displayType, displaySize, displayDate, displayInfo;
 
   void sortFiles();
   void filterFiles();
@@ -154,6 +160,9 @@ class FurnaceFilePicker {
   bool isPathAbsolute(const String& p);
   void addBookmark(const String& p, String n="");
   FileEntry* makeEntry(void* _entry, const char* prefix=NULL);
+  String getEntryPath(FileEntry* entry);
+  void fetchInfo(FileEntry* entry);
+  bool infoMatches(const String& entryPath);
   void completeStat();
 
   void drawFileList(ImVec2& tableSize, bool& acknowledged);
@@ -181,6 +190,9 @@ class FurnaceFilePicker {
     void registerType(String ext, ImVec4 color, String icon);
     void clearTypes();
     void setConfigPrefix(String prefix);
+    void setInfoCallback(FilePickerInfoCallback callback);
+    // call when information given by the info callback changes
+    void refreshInfo();
     FurnaceFilePicker();
 };
 
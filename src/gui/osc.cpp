@@ -117,23 +117,22 @@ void FurnaceGUI::readOsc() {
     oscValues[i]=(i&1)?0.3:0;
   }*/
 
-  float peakDecay=0.05f*60.0f*ImGui::GetIO().DeltaTime;
+  // tell the analyzer which windows are open, and pick up the meters
+  FurnaceAnalyzerConfig analyzerConf;
+  analyzerConf.spectrum=spectrumOpen;
+  analyzerConf.spectrumMono=spectrum.mono;
+  analyzerConf.spectrumBins=spectrum.bins;
+  analyzerConf.tuner=tunerOpen;
+  analyzerConf.chans=e->getAudioDescGot().outChans;
+  analyzerConf.rate=e->getAudioDescGot().rate;
+  audioAnalyzer.configure(analyzerConf);
+
+  const FurnaceAnalyzerResult& analysis=audioAnalyzer.lockResults();
   for (int i=0; i<e->getAudioDescGot().outChans; i++) {
-    peak[i]*=1.0-peakDecay;
-    if (peak[i]<0.0001) {
-      peak[i]=0.0;
-    } else {
-      WAKE_UP;
-    }
-    float newPeak=peak[i];
-    for (int j=0; j<total; j++) {
-      int pos=(readPos+j)&0x7fff;
-      if (fabs(e->oscBuf[i][pos])>newPeak) {
-        newPeak=fabs(e->oscBuf[i][pos]);
-      }
-    }
-    peak[i]+=(newPeak-peak[i])*0.9;
+    peak[i]=analysis.peak[i];
+    if (peak[i]>=0.0001) WAKE_UP;
   }
+  audioAnalyzer.unlockResults();
 
   readPos=(readPos+total)&0x7fff;
   e->oscReadPos=readPos;
@@ -1154,18 +1154,23 @@ void FurnaceGUI::drawSampleEdit() {
         }
         ImGui::Combo(_("Filter"),&resampleStrat,LocalizedComboGetter,resampleStrats,6);
         if (ImGui::Button(_("Resample"))) {
-          sample->prepareUndo(true);
-          e->lockEngine([this,sample,targetRate]() {
-            if (!sample->resample(targetRate,resampleTarget,resampleStrat)) {
-              showError(_("couldn't resample! make sure your sample is 8 or 16-bit and that the target rate is at least 100Hz."));
-            }
-            e->renderSamples(curSample);
-          });
-          updateSampleTex=true;
-          notifySampleChange=true;
-          sampleSelStart=-1;
-          sampleSelEnd=-1;
-          MARK_MODIFIED;
+          FurnaceSampleJob* job=new FurnaceSampleJob(SAMPLE_JOB_RESAMPLE);
+          job->setSource(sample,curSample,0,0);
+          job->rateFrom=targetRate;
+          job->rateTo=resampleTarget;
+          job->filter=resampleStrat;
+          // resample a copy
+          job->resampled=new DivSample;
+          job->resampled->depth=sample->depth;
+          job->resampled->centerRate=sample->centerRate;
+          job->resampled->loop=sample->loop;
+          if (sample->samples>0 && sample->getCurBuf()!=NULL) {
+            job->resampled->init(sample->samples);
+            memcpy(job->resampled->getCurBuf(),sample->getCurBuf(),sample->getCurBufLen());
+          }
+          job->resampled->loopStart=sample->loopStart;
+          job->resampled->loopEnd=sample->loopEnd;
+          startSampleJob(job);
           ImGui::CloseCurrentPopup();
         }
         ImGui::EndPopup();
@@ -1213,35 +1218,14 @@ void FurnaceGUI::drawSampleEdit() {
           if (amplifyOff>100) amplifyOff=100;
         }
         if (ImGui::Button(_("Apply"))) {
-          sample->prepareUndo(true);
-          e->lockEngine([this,sample]() {
+          if (sample->depth==DIV_SAMPLE_DEPTH_8BIT || sample->depth==DIV_SAMPLE_DEPTH_16BIT) {
             SAMPLE_OP_BEGIN;
-            float vol=amplifyVol/100.0f;
-
-            if (sample->depth==DIV_SAMPLE_DEPTH_16BIT) {
-              float off=32767.0f*(amplifyOff/100.0f);
-              for (unsigned int i=start; i<end; i++) {
-                float val=off+sample->data16[i]*vol;
-                if (val<-32768) val=-32768;
-                if (val>32767) val=32767;
-                sample->data16[i]=val;
-              }
-            } else if (sample->depth==DIV_SAMPLE_DEPTH_8BIT) {
-              float off=127.0f*(amplifyOff/100.0f);
-              for (unsigned int i=start; i<end; i++) {
-                float val=off+sample->data8[i]*vol;
-                if (val<-128) val=-128;
-                if (val>127) val=127;
-                sample->data8[i]=val;
-              }
-            }
-
-            updateSampleTex=true;
-            notifySampleChange=true;
-
-            e->renderSamples(curSample);
-          });
-          MARK_MODIFIED;
+            FurnaceSampleJob* job=new FurnaceSampleJob(SAMPLE_JOB_AMPLIFY);
+            job->setSource(sample,curSample,start,end);
+            job->vol=amplifyVol/100.0f;
+            job->offset=amplifyOff/100.0f;
+            startSampleJob(job);
+          }
           ImGui::CloseCurrentPopup();
         }
         ImGui::EndPopup();
@@ -1337,66 +1321,13 @@ void FurnaceGUI::drawSampleEdit() {
           if (noiseGateThreshold>0.0f) noiseGateThreshold=0.0f;
         }
         if (ImGui::Button(_("Apply"))) {
-          sample->prepareUndo(true);
-          e->lockEngine([this,sample]() {
-            if (sample->depth==DIV_SAMPLE_DEPTH_16BIT && sample->data16!=NULL && sample->samples>0) {
-              SAMPLE_OP_BEGIN;
-              float linThreshold=powf(10.0f,noiseGateThreshold/20.0f)*32767.0f;
-              unsigned int newStart=start;
-              unsigned int newEnd=end;
-              unsigned int windowSize=128;
-              if (windowSize>(end-start)) windowSize=end-start;
-              unsigned int minCount=windowSize/4;
-              if (minCount<1) minCount=1;
-
-              for (unsigned int i=start; i+windowSize<=end; i++) {
-                unsigned int count=0;
-                for (unsigned int j=0; j<windowSize; j++) {
-                  if (fabsf((float)sample->data16[i+j])>=linThreshold) {
-                    count++;
-                  }
-                }
-                if (count>=minCount) {
-                  newStart=i;
-                  break;
-                }
-              }
-
-              for (unsigned int i=end; i>=start+windowSize; i--) {
-                unsigned int count=0;
-                for (unsigned int j=0; j<windowSize; j++) {
-                  if (fabsf((float)sample->data16[i-windowSize+j])>=linThreshold) {
-                    count++;
-                  }
-                }
-                if (count>=minCount) {
-                  newEnd=i;
-                  break;
-                }
-              }
-
-              if (newStart<newEnd && (newStart>start || newEnd<end)) {
-                if (start==0 && end==sample->samples) {
-                  sample->trim(newStart,newEnd);
-                } else {
-                  if (newEnd<end) {
-                    sample->strip(newEnd,end);
-                  }
-                  if (newStart>start) {
-                    sample->strip(start,newStart);
-                  }
-                  sampleSelStart=start;
-                  sampleSelEnd=start+(newEnd-newStart);
-                }
-              }
-            }
-
-            updateSampleTex=true;
-            notifySampleChange=true;
-
-            e->renderSamples(curSample);
-          });
-          MARK_MODIFIED;
+          if (sample->depth==DIV_SAMPLE_DEPTH_16BIT && sample->data16!=NULL && sample->samples>0) {
+            SAMPLE_OP_BEGIN;
+            FurnaceSampleJob* job=new FurnaceSampleJob(SAMPLE_JOB_NOISE_GATE);
+            job->setSource(sample,curSample,start,end);
+            job->threshold=noiseGateThreshold;
+            startSampleJob(job);
+          }
           ImGui::CloseCurrentPopup();
         }
         ImGui::EndPopup();
@@ -1499,61 +1430,26 @@ void FurnaceGUI::drawSampleEdit() {
         }
 
         if (ImGui::Button(_("Apply"))) {
-          sample->prepareUndo(true);
-          e->lockEngine([this,sample]() {
-            SAMPLE_OP_BEGIN;
-            float res=1.0-pow(sampleFilterRes,0.5f);
-            float low=0;
-            float band=0;
-            float high=0;
-
-            if (sampleFilterCutStart<0.0) sampleFilterCutStart=0.0;
-            if (sampleFilterCutStart>sample->centerRate*0.5) sampleFilterCutStart=sample->centerRate*0.5;
-            if (sampleFilterCutEnd<0.0) sampleFilterCutEnd=0.0;
-            if (sampleFilterCutEnd>sample->centerRate*0.5) sampleFilterCutEnd=sample->centerRate*0.5;
-
-            double power=(sampleFilterCutStart>sampleFilterCutEnd)?0.5:2.0;
-
-            if (sample->depth==DIV_SAMPLE_DEPTH_16BIT) {
-              for (unsigned int i=start; i<end; i++) {
-                double freq=sampleFilterCutStart+(sampleFilterSweep?((sampleFilterCutEnd-sampleFilterCutStart)*pow(double(i-start)/double(end-start),power)):0);
-                double cut=sin((freq/double(sample->centerRate))*M_PI);
-
-                for (int j=0; j<sampleFilterPower; j++) {
-                  low=low+cut*band;
-                  high=float(sample->data16[i])-low-(res*band);
-                  band=cut*high+band;
-                }
-
-                float val=low*sampleFilterL+band*sampleFilterB+high*sampleFilterH;
-                if (val<-32768) val=-32768;
-                if (val>32767) val=32767;
-                sample->data16[i]=val;
-              }
-            } else if (sample->depth==DIV_SAMPLE_DEPTH_8BIT) {
-              for (unsigned int i=start; i<end; i++) {
-                double freq=sampleFilterCutStart+(sampleFilterSweep?((sampleFilterCutEnd-sampleFilterCutStart)*pow(double(i-start)/double(end-start),power)):0);
-                double cut=sin((freq/double(sample->centerRate))*M_PI);
-
-                for (int j=0; j<sampleFilterPower; j++) {
-                  low=low+cut*band;
-                  high=float(sample->data8[i])-low-(res*band);
-                  band=cut*high+band;
-                }
-
-                float val=low*sampleFilterL+band*sampleFilterB+high*sampleFilterH;
-                if (val<-128) val=-128;
-                if (val>127) val=127;
-                sample->data8[i]=val;
-              }
-            }
-
-            updateSampleTex=true;
-            notifySampleChange=true;
+          if (sampleFilterCutStart<0.0) sampleFilterCutStart=0.0;
+          if (sampleFilterCutStart>sample->centerRate*0.5) sampleFilterCutStart=sample->centerRate*0.5;
+          if (sampleFilterCutEnd<0.0) sampleFilterCutEnd=0.0;
+          if (sampleFilterCutEnd>sample->centerRate*0.5) sampleFilterCutEnd=sample->centerRate*0.5;
 
-            e->renderSamples(curSample);
-          });
-          MARK_MODIFIED;
+          if (sample->depth==DIV_SAMPLE_DEPTH_8BIT || sample->depth==DIV_SAMPLE_DEPTH_16BIT) {
+            SAMPLE_OP_BEGIN;
+            FurnaceSampleJob* job=new FurnaceSampleJob(SAMPLE_JOB_FILTER);
+            job->setSource(sample,curSample,start,end);
+            job->res=1.0-pow(sampleFilterRes,0.5f);
+            job->cutStart=sampleFilterCutStart;
+            job->cutEnd=sampleFilterCutEnd;
+            job->centerRate=sample->centerRate;
+            job->sweep=sampleFilterSweep;
+            job->power=sampleFilterPower;
+            job->lowPass=sampleFilterL;
+            job->bandPass=sampleFilterB;
+            job->highPass=sampleFilterH;
+            startSampleJob(job);
+          }
           ImGui::CloseCurrentPopup();
         }
 
@@ -1600,40 +1496,15 @@ void FurnaceGUI::drawSampleEdit() {
             showError(_("Crossfade: length would overflow loopStart. Try a smaller random value."));
             ImGui::CloseCurrentPopup();
           } else {
-            sample->prepareUndo(true);
-            e->lockEngine([this,sample] {
-              SAMPLE_OP_BEGIN;
-              double l=1.0/(double)sampleCrossFadeLoopLength;
-              double evar=1.0-sampleCrossFadeLoopLaw/200.0;
-              if (sample->depth==DIV_SAMPLE_DEPTH_8BIT) {
-                unsigned int crossFadeInput=sample->loopStart-sampleCrossFadeLoopLength;
-                unsigned int crossFadeOutput=sample->loopEnd-sampleCrossFadeLoopLength;
-                for (int i=0; i<sampleCrossFadeLoopLength; i++) {
-                  double f1=pow(i*l,evar);
-                  double f2=pow((sampleCrossFadeLoopLength-i)*l,evar);
-                  double out=((double)sample->data8[crossFadeInput])*f1+((double)sample->data8[crossFadeOutput])*f2;
-                  sample->data8[crossFadeOutput]=(signed char)CLAMP(out,-128,127);
-                  crossFadeInput++;
-                  crossFadeOutput++;
-                }
-              } else if (sample->depth==DIV_SAMPLE_DEPTH_16BIT) {
-                unsigned int crossFadeInput=sample->loopStart-sampleCrossFadeLoopLength;
-                unsigned int crossFadeOutput=sample->loopEnd-sampleCrossFadeLoopLength;
-                for (int i=0; i<sampleCrossFadeLoopLength; i++) {
-                  double f1=std::pow(i*l,evar);
-                  double f2=std::pow((sampleCrossFadeLoopLength-i)*l,evar);
-                  double out=((double)sample->data16[crossFadeInput])*f1+((double)sample->data16[crossFadeOutput])*f2;
-                  sample->data16[crossFadeOutput]=(short)CLAMP(out,-32768,32767);
-                  crossFadeInput++;
-                  crossFadeOutput++;
-                }
-              }
-              updateSampleTex=true;
-              notifySampleChange=true;
-
-              e->renderSamples(curSample);
-            });
-            MARK_MODIFIED;
+            if ((sample->depth==DIV_SAMPLE_DEPTH_8BIT || sample->depth==DIV_SAMPLE_DEPTH_16BIT) && sampleCrossFadeLoopLength>0) {
+              // mix the part before the loop start into the end of the loop
+              FurnaceSampleJob* job=new FurnaceSampleJob(SAMPLE_JOB_CROSSFADE);
+              job->setSource(sample,curSample,sample->loopStart-sampleCrossFadeLoopLength,sample->loopStart);
+              job->aux.swap(job->data);
+              job->setSource(sample,curSample,sample->loopEnd-sampleCrossFadeLoopLength,sample->loopEnd);
+              job->law=sampleCrossFadeLoopLaw;
+              startSampleJob(job);
+            }
             ImGui::CloseCurrentPopup();
           }
         }
@@ -1681,7 +1552,7 @@ void FurnaceGUI::drawSampleEdit() {
         sampleZoom=100.0/zoomPercent;
         sampleZoomAuto=false;
         checkZoomLimit=true;
-        updateSampleTex=true;
+        updateSampleView=true;
       }
       ImGui::SameLine();
       if (sampleZoomAuto) {
@@ -1689,14 +1560,14 @@ void FurnaceGUI::drawSampleEdit() {
         if (ImGui::Button("100%")) {
           sampleZoom=1.0;
           sampleZoomAuto=false;
-          updateSampleTex=true;
+          updateSampleView=true;
           checkZoomLimit=true;
         }
         ImGui::EndDisabled();
       } else {
         if (ImGui::Button("Auto")) {
           sampleZoomAuto=true;
-          updateSampleTex=true;
+          updateSampleView=true;
         }
       }
 
@@ -1707,6 +1578,21 @@ void FurnaceGUI::drawSampleEdit() {
         }
       }
 
+      // operation running in the background
+      FurnaceSampleJob* runningJob=sampleJobs.getJob();
+      if (runningJob!=NULL) {
+        ImGui::AlignTextToFramePadding();
+        ImGui::TextUnformatted(_("Processing..."));
+        ImGui::SameLine();
+        float cancelWidth=ImGui::CalcTextSize(_("Cancel")).x+ImGui::GetStyle().FramePadding.x*2.0f+ImGui::GetStyle().ItemSpacing.x;
+        // no progress is known for resampling
+        ImGui::ProgressBar(runningJob->getProgress(),ImVec2(-cancelWidth,0.0f),(runningJob->workTotal==0)?"":NULL);
+        ImGui::SameLine();
+        if (ImGui::Button(_("Cancel"))) {
+          sampleJobs.cancel();
+        }
+      }
+
       ImGui::Separator();
 
       // time
@@ -1803,7 +1689,7 @@ void FurnaceGUI::drawSampleEdit() {
         }
         if (sampleZoom!=prevSampleZoom) {
           prevSampleZoom=sampleZoom;
-          updateSampleTex=true;
+          updateSampleView=true;
         }
       }
 
@@ -1820,13 +1706,19 @@ void FurnaceGUI::drawSampleEdit() {
           if (sampleTex==NULL) {
             logE("error while creating sample texture! %s",SDL_GetError());
           } else {
-            updateSampleTex=true;
+            updateSampleView=true;
           }
         }
       }
 
+      // pick up waveform peaks built in the background
+      samplePeaks.prune(e->song.sample);
+      if (samplePeaks.collect()) updateSampleView=true;
+      if (samplePeaks.isBusy()) WAKE_UP;
+      if (updateSampleTex) samplePeaks.invalidate(sample);
+
       if (sampleTex!=NULL) {
-        if (updateSampleTex) {
+        if (updateSampleTex || updateSampleView) {
           unsigned int* dataT=NULL;
           int pitch=0;
           logD("updating sample texture.");
@@ -1882,6 +1774,8 @@ void FurnaceGUI::drawSampleEdit() {
               }
             }
 
+            // find the peaks under every column, from the pyramid if it is ready
+            const FurnaceSamplePeaks* peaks=samplePeaks.get(sample);
             unsigned int xCoarse=samplePos;
             unsigned int xFine=0;
             unsigned int xAdvanceCoarse=sampleZoom;
@@ -1892,22 +1786,17 @@ void FurnaceGUI::drawSampleEdit() {
               int candMin=INT_MAX;
               int candMax=INT_MIN;
               int totalAdvance=0;
-              if (sample->depth==DIV_SAMPLE_DEPTH_8BIT) {
-                if (candMin>sample->data8[xCoarse]) candMin=sample->data8[xCoarse];
-                if (candMax<sample->data8[xCoarse]) candMax=sample->data8[xCoarse];
-              } else {
-                if (candMin>sample->data16[xCoarse]) candMin=sample->data16[xCoarse];
-                if (candMax<sample->data16[xCoarse]) candMax=sample->data16[xCoarse];
-              }
               xFine+=xAdvanceFine;
               if (xFine>=16777216) {
                 xFine-=16777216;
                 totalAdvance++;
               }
               totalAdvance+=xAdvanceCoarse;
-              if (xCoarse>=sample->samples) break;
-              do {
-                if (xCoarse>=sample->samples) break;
+              if (peaks!=NULL) {
+                // this column covers xCoarse to xCoarse+totalAdvance (inclusive)
+                peaks->query(sample,xCoarse,xCoarse+totalAdvance+1,candMin,candMax);
+                xCoarse+=totalAdvance;
+              } else {
                 if (sample->depth==DIV_SAMPLE_DEPTH_8BIT) {
                   if (candMin>sample->data8[xCoarse]) candMin=sample->data8[xCoarse];
                   if (candMax<sample->data8[xCoarse]) candMax=sample->data8[xCoarse];
@@ -1915,15 +1804,25 @@ void FurnaceGUI::drawSampleEdit() {
                   if (candMin>sample->data16[xCoarse]) candMin=sample->data16[xCoarse];
                   if (candMax<sample->data16[xCoarse]) candMax=sample->data16[xCoarse];
                 }
-                if (totalAdvance>0) xCoarse++;
-              } while ((totalAdvance--)>0);
-              if (sample->depth==DIV_SAMPLE_DEPTH_8BIT) {
-                y1=(((unsigned char)candMin^0x80)*availY)>>8;
-                y2=(((unsigned char)candMax^0x80)*availY)>>8;
-              } else {
-                y1=(((unsigned short)candMin^0x8000)*availY)>>16;
-                y2=(((unsigned short)candMax^0x8000)*availY)>>16;
+                do {
+                  if (xCoarse>=sample->samples) break;
+                  if (sample->depth==DIV_SAMPLE_DEPTH_8BIT) {
+                    if (candMin>sample->data8[xCoarse]) candMin=sample->data8[xCoarse];
+                    if (candMax<sample->data8[xCoarse]) candMax=sample->data8[xCoarse];
+                  } else {
+                    if (candMin>sample->data16[xCoarse]) candMin=sample->data16[xCoarse];
+                    if (candMax<sample->data16[xCoarse]) candMax=sample->data16[xCoarse];
+                  }
+                  if (totalAdvance>0) xCoarse++;
+                } while ((totalAdvance--)>0);
+                // the pyramid holds 16-bit values
+                if (sample->depth==DIV_SAMPLE_DEPTH_8BIT) {
+                  candMin*=256;
+                  candMax*=256;
+                }
               }
+              y1=(((unsigned short)candMin^0x8000)*availY)>>16;
+              y2=(((unsigned short)candMax^0x8000)*availY)>>16;
               if (y1>y2) {
                 y2^=y1;
                 y1^=y2;
@@ -1957,6 +1856,7 @@ void FurnaceGUI::drawSampleEdit() {
             delete[] data;
           }
           updateSampleTex=false;
+          updateSampleView=false;
         }
 
         ImGui::PushStyleVar(ImGuiStyleVar_FramePadding,ImVec2(0,0));
@@ -2047,7 +1947,7 @@ void FurnaceGUI::drawSampleEdit() {
             int bounds=((int)sample->samples-round(avail.x*sampleZoom));
             if (bounds<0) bounds=0;
             if (samplePos>bounds) samplePos=bounds;
-            updateSampleTex=true;
+            updateSampleView=true;
             processDrags(ImGui::GetMousePos().x,ImGui::GetMousePos().y);
             WAKE_UP;
           }
@@ -2055,7 +1955,7 @@ void FurnaceGUI::drawSampleEdit() {
             double delta=pow(MAX(1.0,(rectMin.x-ImGui::GetMousePos().x)*0.04),2.0);
             samplePos-=MAX(1.0,sampleZoom*delta);
             if (samplePos<0) samplePos=0;
-            updateSampleTex=true;
+            updateSampleView=true;
             processDrags(ImGui::GetMousePos().x,ImGui::GetMousePos().y);
             WAKE_UP;
           }
@@ -2159,7 +2059,7 @@ void FurnaceGUI::drawSampleEdit() {
             int bounds=((int)sample->samples-round(rectSize.x*sampleZoom));
             if (bounds<0) bounds=0;
             if (samplePos>bounds) samplePos=bounds;
-            updateSampleTex=true;
+            updateSampleView=true;
             if (sampleZoom>minSampleZoom) {
               sampleZoomAuto=true;
             }
@@ -2176,7 +2076,7 @@ void FurnaceGUI::drawSampleEdit() {
                 int bounds=((int)sample->samples-round(rectSize.x*sampleZoom));
                 if (bounds<0) bounds=0;
                 if (samplePos>bounds) samplePos=bounds;
-                updateSampleTex=true;
+                updateSampleView=true;
               }
             }
           }
@@ -2518,7 +2418,7 @@ void FurnaceGUI::drawSampleEdit() {
         if (ImGui::ScrollbarEx(ImRect(ImVec2(rectMin.x,rectMax.y),ImVec2(rectMax.x,rectMax.y+ImGui::GetStyle().ScrollbarSize)),scrollbarID,ImGuiAxis_X,&scrollV,availV,contentsV,0)) {
           if (!sampleZoomAuto && samplePos!=scrollV) {
             samplePos=scrollV;
-            updateSampleTex=true;
+            updateSampleView=true;
           }
         }
 
@@ -2610,6 +2510,109 @@ void FurnaceGUI::doUndoSample() {
   });
 }
 
+void FurnaceGUI::startSampleJob(FurnaceSampleJob* job) {
+  // short jobs are done right away
+  if (job->getSize()<SAMPLE_JOB_ASYNC_MIN) {
+    FurnaceSampleJobRunner::process(job,NULL);
+    commitSampleJob(job);
+    delete job;
+    return;
+  }
+  if (!sampleJobs.start(job)) {
+    showError(_("please wait for the current sample operation to finish."));
+    delete job;
+  }
+}
+
+void FurnaceGUI::commitSampleJob(FurnaceSampleJob* job) {
+  if (job->cancelled.load()) return;
+  if (!job->ok) {
+    if (job->type==SAMPLE_JOB_RESAMPLE) {
+      showError(_("couldn't resample! make sure your sample is 8 or 16-bit and that the target rate is at least 100Hz."));
+    }
+    return;
+  }
+  if (job->sampleIndex<0 || job->sampleIndex>=(int)e->song.sample.size()) return;
+  DivSample* sample=e->song.sample[job->sampleIndex];
+  if (!job->isCurrent(sample)) {
+    showError(_("the sample was changed while it was being processed. the operation was cancelled."));
+    return;
+  }
+
+  sample->prepareUndo(true);
+  e->lockEngine([this,sample,job]() {
+    switch (job->type) {
+      case SAMPLE_JOB_NOISE_GATE: {
+        unsigned int start=job->start;
+        unsigned int end=job->end;
+        unsigned int newStart=job->newStart;
+        unsigned int newEnd=job->newEnd;
+        if (newStart<newEnd && (newStart>start || newEnd<end)) {
+          if (start==0 && end==sample->samples) {
+            sample->trim(newStart,newEnd);
+          } else {
+            if (newEnd<end) {
+              sample->strip(newEnd,end);
+            }
+            if (newStart>start) {
+              sample->strip(start,newStart);
+            }
+            sampleSelStart=start;
+            sampleSelEnd=start+(newEnd-newStart);
+          }
+        }
+        updateSampleTex=true;
+        break;
+      }
+      case SAMPLE_JOB_RESAMPLE: {
+        // take the new data (the old one goes away with the job)
+        DivSample* res=job->resampled;
+        if (sample->depth==DIV_SAMPLE_DEPTH_16BIT) {
+          std::swap(sample->data16,res->data16);
+          std::swap(sample->length16,res->length16);
+        } else {
+          std::swap(sample->data8,res->data8);
+          std::swap(sample->length8,res->length8);
+        }
+        sample->samples=res->samples;
+        sample->loopStart=res->loopStart;
+        sample->loopEnd=res->loopEnd;
+        sample->centerRate=res->centerRate;
+        sampleSelStart=-1;
+        sampleSelEnd=-1;
+        updateSampleTex=true;
+        break;
+      }
+      default: {
+        unsigned int len=job->end-job->start;
+        if (sample->depth==DIV_SAMPLE_DEPTH_16BIT && job->out16.size()==len) {
+          memcpy(sample->data16+job->start,job->out16.data(),len*sizeof(short));
+        } else if (sample->depth==DIV_SAMPLE_DEPTH_8BIT && job->out8.size()==len) {
+          memcpy(sample->data8+job->start,job->out8.data(),len);
+        }
+        samplePeaks.update(sample,job->start,job->end);
+        updateSampleView=true;
+        break;
+      }
+    }
+    notifySampleChange=true;
+
+    e->renderSamples(job->sampleIndex);
+  });
+  MARK_MODIFIED;
+}
+
+void FurnaceGUI::processSampleJobs() {
+  FurnaceSampleJob* job=sampleJobs.collect();
+  if (job!=NULL) {
+    commitSampleJob(job);
+    delete job;
+  }
+  if (sampleJobs.isBusy()) {
+    WAKE_UP;
+  }
+}
+
 void FurnaceGUI::doRedoSample() {
   if (!sampleEditOpen) return;
   if (curSample<0 || curSample>=(int)e->song.sample.size()) return;
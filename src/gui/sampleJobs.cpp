@@ -0,0 +1,509 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define _USE_MATH_DEFINES
+#include "sampleJobs.h"
+#include "../ta-log.h"
+#include <math.h>
+#include <string.h>
+#include <functional>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// smallest piece of a job given to a work thread
+#define SAMPLE_JOB_CHUNK 16384
+
+/// kernels
+
+// data=clamp(data*vol+off)
+static void kernelGain(float* data, size_t len, float vol, float off, float lo, float hi) {
+  size_t i=0;
+#ifdef __SSE2__
+  const __m128 vVol=_mm_set1_ps(vol);
+  const __m128 vOff=_mm_set1_ps(off);
+  const __m128 vLo=_mm_set1_ps(lo);
+  const __m128 vHi=_mm_set1_ps(hi);
+  for (; i+4<=len; i+=4) {
+    __m128 x=_mm_loadu_ps(data+i);
+    x=_mm_add_ps(_mm_mul_ps(x,vVol),vOff);
+    x=_mm_min_ps(_mm_max_ps(x,vLo),vHi);
+    _mm_storeu_ps(data+i,x);
+  }
+#endif
+  for (; i<len; i++) {
+    float val=off+data[i]*vol;
+    if (val<lo) val=lo;
+    if (val>hi) val=hi;
+    data[i]=val;
+  }
+}
+
+// data=clamp(in*gainIn+data*gainOut)
+static void kernelMix(float* data, const float* in, const float* gainIn, const float* gainOut, size_t len, float lo, float hi) {
+  size_t i=0;
+#ifdef __SSE2__
+  const __m128 vLo=_mm_set1_ps(lo);
+  const __m128 vHi=_mm_set1_ps(hi);
+  for (; i+4<=len; i+=4) {
+    __m128 x=_mm_add_ps(
+      _mm_mul_ps(_mm_loadu_ps(in+i),_mm_loadu_ps(gainIn+i)),
+      _mm_mul_ps(_mm_loadu_ps(data+i),_mm_loadu_ps(gainOut+i))
+    );
+    x=_mm_min_ps(_mm_max_ps(x,vLo),vHi);
+    _mm_storeu_ps(data+i,x);
+  }
+#endif
+  for (; i<len; i++) {
+    float val=in[i]*gainIn[i]+data[i]*gainOut[i];
+    if (val<lo) val=lo;
+    if (val>hi) val=hi;
+    data[i]=val;
+  }
+}
+
+// largest absolute value
+static float kernelPeak(const float* data, size_t len) {
+  size_t i=0;
+  float ret=0.0f;
+#ifdef __SSE2__
+  const __m128 absMask=_mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 vMax=_mm_setzero_ps();
+  for (; i+4<=len; i+=4) {
+    vMax=_mm_max_ps(vMax,_mm_and_ps(_mm_loadu_ps(data+i),absMask));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes,vMax);
+  for (int j=0; j<4; j++) {
+    if (lanes[j]>ret) ret=lanes[j];
+  }
+#endif
+  for (; i<len; i++) {
+    float val=fabs(data[i]);
+    if (val>ret) ret=val;
+  }
+  return ret;
+}
+
+/// chunking
+
+struct FurnaceSampleJobChunk {
+  FurnaceSampleJob* job;
+  const std::function<void(size_t,size_t)>* func;
+  size_t begin, end;
+};
+
+static void runChunk(void* arg) {
+  FurnaceSampleJobChunk* chunk=(FurnaceSampleJobChunk*)arg;
+  if (chunk->job->cancelled.load()) return;
+  (*chunk->func)(chunk->begin,chunk->end);
+  chunk->job->workDone+=chunk->end-chunk->begin;
+}
+
+// run func over [0,len) in chunks, across the pool if there is one
+static void parallelFor(FurnaceSampleJob* job, DivWorkPool* pool, size_t len, const std::function<void(size_t,size_t)>& func) {
+  size_t chunkSize=len/64;
+  if (chunkSize<SAMPLE_JOB_CHUNK) chunkSize=SAMPLE_JOB_CHUNK;
+  std::vector<FurnaceSampleJobChunk> chunks;
+  for (size_t i=0; i<len; i+=chunkSize) {
+    FurnaceSampleJobChunk c;
+    c.job=job;
+    c.func=&func;
+    c.begin=i;
+    c.end=MIN(i+chunkSize,len);
+    chunks.push_back(c);
+  }
+  if (pool==NULL) {
+    for (FurnaceSampleJobChunk& i: chunks) {
+      runChunk(&i);
+    }
+    return;
+  }
+  for (FurnaceSampleJobChunk& i: chunks) {
+    pool->push(runChunk,&i);
+  }
+  pool->wait();
+}
+
+/// jobs
+
+void FurnaceSampleJob::setSource(DivSample* s, int index, unsigned int rangeStart, unsigned int rangeEnd) {
+  sample=s;
+  sampleIndex=index;
+  source=s->getCurBuf();
+  samples=s->samples;
+  depth=s->depth;
+  rev=s->editRev;
+  if (rangeEnd>s->samples) rangeEnd=s->samples;
+  if (rangeStart>rangeEnd) rangeStart=rangeEnd;
+  start=rangeStart;
+  end=rangeEnd;
+
+  data.resize(end-start);
+  if (depth==DIV_SAMPLE_DEPTH_16BIT) {
+    const short* src=s->data16+start;
+    for (unsigned int i=0; i<end-start; i++) {
+      data[i]=src[i];
+    }
+  } else if (depth==DIV_SAMPLE_DEPTH_8BIT) {
+    const signed char* src=s->data8+start;
+    for (unsigned int i=0; i<end-start; i++) {
+      data[i]=src[i];
+    }
+  }
+}
+
+bool FurnaceSampleJob::isCurrent(DivSample* s) const {
+  return (s==sample && s->getCurBuf()==source && s->samples==samples && s->depth==depth && s->editRev==rev);
+}
+
+float FurnaceSampleJob::getProgress() const {
+  if (workTotal==0) return 0.0f;
+  float ret=(float)workDone.load()/(float)workTotal;
+  if (ret>1.0f) ret=1.0f;
+  return ret;
+}
+
+unsigned int FurnaceSampleJob::getSize() const {
+  if (type==SAMPLE_JOB_RESAMPLE) return samples;
+  if (type==SAMPLE_JOB_FILTER) return (end-start)*MAX(power,1);
+  return end-start;
+}
+
+FurnaceSampleJob::FurnaceSampleJob(FurnaceSampleJobType t):
+  type(t),
+  sampleIndex(-1),
+  sample(NULL),
+  source(NULL),
+  samples(0),
+  depth(DIV_SAMPLE_DEPTH_16BIT),
+  rev(0),
+  start(0),
+  end(0),
+  vol(1.0f),
+  offset(0.0f),
+  cutStart(0.0),
+  cutEnd(0.0),
+  centerRate(0.0),
+  res(0.0f),
+  lowPass(1.0f),
+  bandPass(0.0f),
+  highPass(0.0f),
+  power(1),
+  sweep(false),
+  law(0),
+  threshold(0.0f),
+  newStart(0),
+  newEnd(0),
+  rateFrom(0.0),
+  rateTo(0.0),
+  filter(0),
+  resampled(NULL),
+  workDone(0),
+  workTotal(0),
+  cancelled(false),
+  ok(false) {
+}
+
+FurnaceSampleJob::~FurnaceSampleJob() {
+  if (resampled!=NULL) {
+    delete resampled;
+    resampled=NULL;
+  }
+}
+
+/// runner
+
+void FurnaceSampleJobRunner::process(FurnaceSampleJob* j, DivWorkPool* p) {
+  const size_t len=j->data.size();
+  float* data=j->data.data();
+  const float lo=(j->depth==DIV_SAMPLE_DEPTH_8BIT)?-128.0f:-32768.0f;
+  const float hi=(j->depth==DIV_SAMPLE_DEPTH_8BIT)?127.0f:32767.0f;
+  bool convert=true;
+  j->workDone=0;
+
+  switch (j->type) {
+    case SAMPLE_JOB_AMPLIFY: {
+      j->workTotal=len*2;
+      const float vol=j->vol;
+      const float off=hi*j->offset;
+      parallelFor(j,p,len,[=](size_t begin, size_t end) {
+        kernelGain(data+begin,end-begin,vol,off,lo,hi);
+      });
+      break;
+    }
+    case SAMPLE_JOB_NORMALIZE: {
+      j->workTotal=len*3;
+      std::vector<float> peaks((len+SAMPLE_JOB_CHUNK-1)/SAMPLE_JOB_CHUNK,0.0f);
+      float* peaksData=peaks.data();
+      parallelFor(j,p,len,[=](size_t begin, size_t end) {
+        // chunks are at least SAMPLE_JOB_CHUNK apart, so they never share a slot
+        peaksData[begin/SAMPLE_JOB_CHUNK]=kernelPeak(data+begin,end-begin);
+      });
+      float maxVal=0.0f;
+      for (float i: peaks) {
+        if (i>maxVal) maxVal=i;
+      }
+      maxVal/=hi;
+      if (maxVal>1.0f) maxVal=1.0f;
+      if (maxVal>0.0f) {
+        const float vol=1.0f/maxVal;
+        parallelFor(j,p,len,[=](size_t begin, size_t end) {
+          kernelGain(data+begin,end-begin,vol,0.0f,lo,hi);
+        });
+      } else {
+        convert=false;
+      }
+      break;
+    }
+    case SAMPLE_JOB_FILTER: {
+      // the filter depends on its previous output, so only the sweep can be split up
+      j->workTotal=len*(j->sweep?3:2);
+      const double power=(j->cutStart>j->cutEnd)?0.5:2.0;
+      const double cutStart=j->cutStart;
+      const double cutEnd=j->cutEnd;
+      const double rate=(j->centerRate>0)?j->centerRate:1;
+      std::vector<double> cuts;
+      if (j->sweep) {
+        cuts.resize(len);
+        double* cutsData=cuts.data();
+        parallelFor(j,p,len,[=](size_t begin, size_t end) {
+          for (size_t i=begin; i<end; i++) {
+            double freq=cutStart+((cutEnd-cutStart)*pow(double(i)/double(len),power));
+            cutsData[i]=sin((freq/rate)*M_PI);
+          }
+        });
+      }
+      const double fixedCut=sin((cutStart/rate)*M_PI);
+      const float res=j->res;
+      float low=0;
+      float band=0;
+      float high=0;
+      for (size_t i=0; i<len; i++) {
+        double cut=j->sweep?cuts[i]:fixedCut;
+        for (int k=0; k<j->power; k++) {
+          low=low+cut*band;
+          high=data[i]-low-(res*band);
+          band=cut*high+band;
+        }
+        float val=low*j->lowPass+band*j->bandPass+high*j->highPass;
+        if (val<lo) val=lo;
+        if (val>hi) val=hi;
+        data[i]=val;
+        if ((i&(SAMPLE_JOB_CHUNK-1))==SAMPLE_JOB_CHUNK-1) {
+          j->workDone+=SAMPLE_JOB_CHUNK;
+          if (j->cancelled.load()) return;
+        }
+      }
+      j->workDone+=len&(SAMPLE_JOB_CHUNK-1);
+      break;
+    }
+    case SAMPLE_JOB_CROSSFADE: {
+      j->workTotal=len*2;
+      if (j->aux.size()<len) return;
+      const float* in=j->aux.data();
+      const double l=1.0/(double)len;
+      const double evar=1.0-j->law/200.0;
+      parallelFor(j,p,len,[=](size_t begin, size_t end) {
+        float gainIn[256];
+        float gainOut[256];
+        for (size_t i=begin; i<end; i+=256) {
+          size_t n=MIN(end-i,256);
+          for (size_t k=0; k<n; k++) {
+            gainIn[k]=pow((i+k)*l,evar);
+            gainOut[k]=pow((len-i-k)*l,evar);
+          }
+          kernelMix(data+i,in+i,gainIn,gainOut,n,lo,hi);
+        }
+      });
+      break;
+    }
+    case SAMPLE_JOB_NOISE_GATE: {
+      j->workTotal=len;
+      convert=false;
+      j->newStart=j->start;
+      j->newEnd=j->end;
+      unsigned int windowSize=128;
+      if (windowSize>len) windowSize=len;
+      if (windowSize<1) break;
+      unsigned int minCount=windowSize/4;
+      if (minCount<1) minCount=1;
+      const float linThreshold=powf(10.0f,j->threshold/20.0f)*32767.0f;
+
+      // slide a window from each end, counting samples above the threshold
+      unsigned int count=0;
+      for (unsigned int i=0; i<windowSize; i++) {
+        if (fabsf(data[i])>=linThreshold) count++;
+      }
+      for (unsigned int i=0; i+windowSize<=len; i++) {
+        if (count>=minCount) {
+          j->newStart=j->start+i;
+          break;
+        }
+        if (i+windowSize<len) {
+          if (fabsf(data[i+windowSize])>=linThreshold) count++;
+          if (fabsf(data[i])>=linThreshold) count--;
+        }
+      }
+      if (j->cancelled.load()) return;
+      j->workDone+=len/2;
+
+      count=0;
+      for (unsigned int i=len-windowSize; i<len; i++) {
+        if (fabsf(data[i])>=linThreshold) count++;
+      }
+      for (unsigned int i=len; i>=windowSize; i--) {
+        if (count>=minCount) {
+          j->newEnd=j->start+i;
+          break;
+        }
+        if (i>windowSize) {
+          if (fabsf(data[i-windowSize-1])>=linThreshold) count++;
+          if (fabsf(data[i-1])>=linThreshold) count--;
+        }
+      }
+      j->workDone+=len-len/2;
+      break;
+    }
+    case SAMPLE_JOB_RESAMPLE:
+      // DivSample::resample() doesn't report progress
+      j->workTotal=0;
+      convert=false;
+      if (j->resampled==NULL) return;
+      if (!j->resampled->resample(j->rateFrom,j->rateTo,j->filter)) return;
+      break;
+  }
+
+  if (j->cancelled.load()) return;
+
+  if (convert) {
+    if (j->depth==DIV_SAMPLE_DEPTH_16BIT) {
+      j->out16.resize(len);
+      short* out=j->out16.data();
+      parallelFor(j,p,len,[=](size_t begin, size_t end) {
+        for (size_t i=begin; i<end; i++) {
+          out[i]=data[i];
+        }
+      });
+    } else {
+      j->out8.resize(len);
+      signed char* out=j->out8.data();
+      parallelFor(j,p,len,[=](size_t begin, size_t end) {
+        for (size_t i=begin; i<end; i++) {
+          out[i]=data[i];
+        }
+      });
+    }
+    if (j->cancelled.load()) return;
+  }
+  j->ok=true;
+}
+
+void FurnaceSampleJobRunner::runWorker() {
+  std::unique_lock<std::mutex> guard(lock);
+  while (true) {
+    while (!quitting && (job==NULL || jobDone)) {
+      notify.wait(guard);
+    }
+    if (quitting) break;
+    FurnaceSampleJob* j=job;
+    guard.unlock();
+
+    if (pool==NULL) {
+      unsigned int threads=std::thread::hardware_concurrency();
+      if (threads>8) threads=8;
+      pool=new DivWorkPool((threads>1)?threads:0);
+    }
+    logV("processing sample job %d (%d samples)...",(int)j->type,j->getSize());
+    process(j,pool);
+
+    guard.lock();
+    jobDone=true;
+  }
+}
+
+bool FurnaceSampleJobRunner::start(FurnaceSampleJob* j) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (job!=NULL) return false;
+  job=j;
+  jobDone=false;
+  if (thread==NULL) {
+    quitting=false;
+    thread=new std::thread(&FurnaceSampleJobRunner::runWorker,this);
+  }
+  notify.notify_one();
+  return true;
+}
+
+FurnaceSampleJob* FurnaceSampleJobRunner::getJob() {
+  std::lock_guard<std::mutex> guard(lock);
+  return job;
+}
+
+FurnaceSampleJob* FurnaceSampleJobRunner::collect() {
+  std::lock_guard<std::mutex> guard(lock);
+  if (job==NULL || !jobDone) return NULL;
+  FurnaceSampleJob* ret=job;
+  job=NULL;
+  jobDone=false;
+  return ret;
+}
+
+void FurnaceSampleJobRunner::cancel() {
+  std::lock_guard<std::mutex> guard(lock);
+  if (job!=NULL) job->cancelled=true;
+}
+
+bool FurnaceSampleJobRunner::isBusy() {
+  std::lock_guard<std::mutex> guard(lock);
+  return job!=NULL;
+}
+
+void FurnaceSampleJobRunner::quit() {
+  if (thread!=NULL) {
+    lock.lock();
+    quitting=true;
+    if (job!=NULL) job->cancelled=true;
+    notify.notify_one();
+    lock.unlock();
+    thread->join();
+    delete thread;
+    thread=NULL;
+  }
+  if (job!=NULL) {
+    delete job;
+    job=NULL;
+  }
+  if (pool!=NULL) {
+    delete pool;
+    pool=NULL;
+  }
+}
+
+FurnaceSampleJobRunner::FurnaceSampleJobRunner():
+  thread(NULL),
+  pool(NULL),
+  job(NULL),
+  jobDone(false),
+  quitting(false) {
+}
+
+FurnaceSampleJobRunner::~FurnaceSampleJobRunner() {
+  quit();
+}
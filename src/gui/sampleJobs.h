@@ -0,0 +1,181 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _SAMPLE_JOBS_H
+#define _SAMPLE_JOBS_H
+
+#include "../engine/sample.h"
+#include "../engine/workPool.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+
+// jobs on at least this many samples run in the background
+#define SAMPLE_JOB_ASYNC_MIN 131072
+
+enum FurnaceSampleJobType {
+  SAMPLE_JOB_AMPLIFY=0,
+  SAMPLE_JOB_NORMALIZE,
+  SAMPLE_JOB_FILTER,
+  SAMPLE_JOB_CROSSFADE,
+  SAMPLE_JOB_NOISE_GATE,
+  SAMPLE_JOB_RESAMPLE
+};
+
+/**
+ * a sample editor operation, done on a copy of the sample.
+ * the GUI fills it in, it is processed (in the background if it is long)
+ * and the GUI writes the result back to the sample in one go.
+ */
+struct FurnaceSampleJob {
+  FurnaceSampleJobType type;
+
+  // the sample as it was when the job was made (the result is dropped if it changed)
+  int sampleIndex;
+  DivSample* sample;
+  const void* source;
+  unsigned int samples;
+  DivSampleDepth depth;
+  // DivSample::editRev
+  uint64_t rev;
+
+  // range to process (the result replaces it)
+  unsigned int start, end;
+  // copy of the range, in sample units (-32768 to 32767 or -128 to 127)
+  std::vector<float> data;
+  // crossfade input (before the loop start)
+  std::vector<float> aux;
+  // result in sample format
+  std::vector<short> out16;
+  std::vector<signed char> out8;
+
+  // amplify
+  float vol, offset;
+  // filter
+  double cutStart, cutEnd, centerRate;
+  float res, lowPass, bandPass, highPass;
+  int power;
+  bool sweep;
+  // crossfade
+  int law;
+  // noise gate (the result is newStart/newEnd)
+  float threshold;
+  unsigned int newStart, newEnd;
+  // resample (the result is a new sample)
+  double rateFrom, rateTo;
+  int filter;
+  DivSample* resampled;
+
+  std::atomic<unsigned int> workDone;
+  unsigned int workTotal;
+  std::atomic<bool> cancelled;
+  bool ok;
+
+  /**
+   * take a snapshot of a sample range.
+   * @param s the sample.
+   * @param index the sample index.
+   * @param rangeStart range start.
+   * @param rangeEnd range end.
+   */
+  void setSource(DivSample* s, int index, unsigned int rangeStart, unsigned int rangeEnd);
+
+  /**
+   * whether the sample is still what the job was made from.
+   */
+  bool isCurrent(DivSample* s) const;
+
+  /**
+   * get progress (0 to 1).
+   */
+  float getProgress() const;
+
+  /**
+   * get the number of samples this job goes through.
+   */
+  unsigned int getSize() const;
+
+  FurnaceSampleJob(FurnaceSampleJobType t);
+  ~FurnaceSampleJob();
+};
+
+/**
+ * runs sample jobs one at a time in a worker thread.
+ * jobs which can be split are processed in chunks across a work pool.
+ */
+class FurnaceSampleJobRunner {
+  std::thread* thread;
+  DivWorkPool* pool;
+  std::mutex lock;
+  std::condition_variable notify;
+  // owned by the runner until collected
+  FurnaceSampleJob* job;
+  bool jobDone;
+  bool quitting;
+
+  void runWorker();
+
+  public:
+    /**
+     * process a job on the calling thread.
+     * @param j the job.
+     * @param p work pool to split the job across, or NULL.
+     */
+    static void process(FurnaceSampleJob* j, DivWorkPool* p);
+
+    /**
+     * start a job in the background.
+     * @return false if another job is running.
+     */
+    bool start(FurnaceSampleJob* j);
+
+    /**
+     * get the job in progress (or done but not collected), or NULL.
+     * only valid until collect() returns it.
+     */
+    FurnaceSampleJob* getJob();
+
+    /**
+     * get the finished job. the caller owns it.
+     * @return the job, or NULL if none finished.
+     */
+    FurnaceSampleJob* collect();
+
+    /**
+     * cancel the job in progress.
+     */
+    void cancel();
+
+    /**
+     * whether a job is in progress.
+     */
+    bool isBusy();
+
+    /**
+     * cancel the job in progress and stop the worker.
+     */
+    void quit();
+
+    FurnaceSampleJobRunner();
+    ~FurnaceSampleJobRunner();
+};
+
+#endif
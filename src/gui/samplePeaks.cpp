@@ -0,0 +1,361 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "samplePeaks.h"
+#include "../ta-log.h"
+#include <limits.h>
+#include <algorithm>
+
+static inline void takeBlock(const short* block, int& min, int& max) {
+  if (block[0]<min) min=block[0];
+  if (block[1]>max) max=block[1];
+}
+
+const void* FurnaceSamplePeaks::getSource(const DivSample* s) {
+  if (s->depth==DIV_SAMPLE_DEPTH_8BIT) return s->data8;
+  return s->data16;
+}
+
+bool FurnaceSamplePeaks::matches(const DivSample* s) const {
+  return (source!=NULL && source==getSource(s) && len==s->samples && depth==s->depth);
+}
+
+void FurnaceSamplePeaks::allocate() {
+  levels.clear();
+  unsigned int count=(len+SAMPLE_PEAKS_BLOCK-1)>>SAMPLE_PEAKS_BLOCK_SHIFT;
+  while (count>0) {
+    levels.push_back(std::vector<short>(count*2));
+    if (count==1) break;
+    count=(count+1)>>1;
+  }
+}
+
+void FurnaceSamplePeaks::buildLevel0(const DivSample* s, unsigned int startBlock, unsigned int endBlock) {
+  short* out=levels[0].data();
+  for (unsigned int i=startBlock; i<endBlock; i++) {
+    unsigned int start=i<<SAMPLE_PEAKS_BLOCK_SHIFT;
+    unsigned int end=MIN(start+SAMPLE_PEAKS_BLOCK,len);
+    int min=INT_MAX;
+    int max=INT_MIN;
+    if (depth==DIV_SAMPLE_DEPTH_8BIT) {
+      for (unsigned int j=start; j<end; j++) {
+        if (s->data8[j]<min) min=s->data8[j];
+        if (s->data8[j]>max) max=s->data8[j];
+      }
+      min*=256;
+      max*=256;
+    } else {
+      for (unsigned int j=start; j<end; j++) {
+        if (s->data16[j]<min) min=s->data16[j];
+        if (s->data16[j]>max) max=s->data16[j];
+      }
+    }
+    out[i*2]=min;
+    out[i*2+1]=max;
+  }
+}
+
+void FurnaceSamplePeaks::buildLevels(unsigned int startBlock, unsigned int endBlock) {
+  for (size_t i=1; i<levels.size(); i++) {
+    const std::vector<short>& below=levels[i-1];
+    std::vector<short>& level=levels[i];
+    unsigned int belowCount=below.size()>>1;
+    startBlock>>=1;
+    endBlock=(endBlock+1)>>1;
+    for (unsigned int j=startBlock; j<endBlock; j++) {
+      unsigned int a=j*2;
+      unsigned int b=MIN(a+1,belowCount-1);
+      level[j*2]=MIN(below[a*2],below[b*2]);
+      level[j*2+1]=MAX(below[a*2+1],below[b*2+1]);
+    }
+  }
+}
+
+void FurnaceSamplePeaks::build(const DivSample* s) {
+  source=getSource(s);
+  len=s->samples;
+  depth=s->depth;
+  allocate();
+  if (source==NULL || levels.empty()) return;
+  unsigned int count=levels[0].size()>>1;
+  buildLevel0(s,0,count);
+  buildLevels(0,count);
+}
+
+void FurnaceSamplePeaks::build(const short* data, const void* src, unsigned int length, DivSampleDepth d) {
+  source=src;
+  len=length;
+  depth=d;
+  allocate();
+  if (levels.empty()) return;
+  unsigned int count=levels[0].size()>>1;
+  short* out=levels[0].data();
+  for (unsigned int i=0; i<count; i++) {
+    unsigned int start=i<<SAMPLE_PEAKS_BLOCK_SHIFT;
+    unsigned int end=MIN(start+SAMPLE_PEAKS_BLOCK,len);
+    short min=data[start];
+    short max=data[start];
+    for (unsigned int j=start+1; j<end; j++) {
+      if (data[j]<min) min=data[j];
+      if (data[j]>max) max=data[j];
+    }
+    out[i*2]=min;
+    out[i*2+1]=max;
+  }
+  buildLevels(0,count);
+}
+
+void FurnaceSamplePeaks::update(const DivSample* s, unsigned int start, unsigned int end) {
+  if (!matches(s)) {
+    build(s);
+    return;
+  }
+  if (levels.empty()) return;
+  unsigned int count=levels[0].size()>>1;
+  unsigned int startBlock=start>>SAMPLE_PEAKS_BLOCK_SHIFT;
+  unsigned int endBlock=MIN(count,(end+SAMPLE_PEAKS_BLOCK-1)>>SAMPLE_PEAKS_BLOCK_SHIFT);
+  if (startBlock>=endBlock) return;
+  buildLevel0(s,startBlock,endBlock);
+  buildLevels(startBlock,endBlock);
+}
+
+bool FurnaceSamplePeaks::query(const DivSample* s, unsigned int start, unsigned int end, int& min, int& max) const {
+  if (end>len) end=len;
+  if (start>=end || levels.empty()) return false;
+  min=INT_MAX;
+  max=INT_MIN;
+
+  // samples at the edges which don't fill a block (the last block may be short)
+  if (depth==DIV_SAMPLE_DEPTH_8BIT) {
+    while (start<end && (start&(SAMPLE_PEAKS_BLOCK-1))) {
+      int val=s->data8[start++]*256;
+      if (val<min) min=val;
+      if (val>max) max=val;
+    }
+    while (end>start && (end&(SAMPLE_PEAKS_BLOCK-1)) && end!=len) {
+      int val=s->data8[--end]*256;
+      if (val<min) min=val;
+      if (val>max) max=val;
+    }
+  } else {
+    while (start<end && (start&(SAMPLE_PEAKS_BLOCK-1))) {
+      int val=s->data16[start++];
+      if (val<min) min=val;
+      if (val>max) max=val;
+    }
+    while (end>start && (end&(SAMPLE_PEAKS_BLOCK-1)) && end!=len) {
+      int val=s->data16[--end];
+      if (val<min) min=val;
+      if (val>max) max=val;
+    }
+  }
+
+  if (start>=end) return true;
+
+  // whole blocks, going up a level whenever they pair up
+  unsigned int startBlock=start>>SAMPLE_PEAKS_BLOCK_SHIFT;
+  unsigned int endBlock=(end==len)?(levels[0].size()>>1):(end>>SAMPLE_PEAKS_BLOCK_SHIFT);
+  for (size_t i=0; i<levels.size() && startBlock<endBlock; i++) {
+    const short* level=levels[i].data();
+    if (i==levels.size()-1) {
+      for (unsigned int j=startBlock; j<endBlock; j++) {
+        takeBlock(&level[j*2],min,max);
+      }
+      break;
+    }
+    if (startBlock&1) takeBlock(&level[(startBlock++)*2],min,max);
+    if (endBlock&1) takeBlock(&level[(--endBlock)*2],min,max);
+    startBlock>>=1;
+    endBlock>>=1;
+  }
+  return true;
+}
+
+size_t FurnaceSamplePeaks::getMemoryUsage() const {
+  size_t ret=0;
+  for (const std::vector<short>& i: levels) {
+    ret+=i.size()*sizeof(short);
+  }
+  return ret;
+}
+
+/// cache
+
+FurnaceSamplePeakCache::~FurnaceSamplePeakCache() {
+  quit();
+}
+
+void FurnaceSamplePeakCache::runWorker() {
+  std::unique_lock<std::mutex> unique(lock);
+  while (true) {
+    notify.wait(unique,[this]() {
+      return quitting || !jobs.empty();
+    });
+    if (quitting) break;
+    Job* job=jobs.front();
+    jobs.pop_front();
+    unique.unlock();
+
+    job->result=new FurnaceSamplePeaks;
+    job->result->build(job->data.data(),job->source,job->data.size(),job->depth);
+    std::vector<short>().swap(job->data);
+
+    unique.lock();
+    done.push_back(job);
+  }
+}
+
+void FurnaceSamplePeakCache::startJob(const DivSample* s, Entry& entry) {
+  Job* job=new Job;
+  job->key=s;
+  job->gen=++entry.gen;
+  job->source=FurnaceSamplePeaks::getSource(s);
+  job->depth=s->depth;
+  job->result=NULL;
+  // the sample may change while the worker reads it, so it gets a copy
+  job->data.resize(s->samples);
+  if (s->depth==DIV_SAMPLE_DEPTH_8BIT) {
+    for (unsigned int i=0; i<s->samples; i++) {
+      job->data[i]=s->data8[i]*256;
+    }
+  } else {
+    memcpy(job->data.data(),s->data16,s->samples*sizeof(short));
+  }
+  entry.building=true;
+
+  std::lock_guard<std::mutex> guard(lock);
+  if (worker==NULL) {
+    quitting=false;
+    worker=new std::thread(&FurnaceSamplePeakCache::runWorker,this);
+  }
+  jobs.push_back(job);
+  notify.notify_one();
+}
+
+const FurnaceSamplePeaks* FurnaceSamplePeakCache::get(const DivSample* s) {
+  if (s==NULL || s->samples<1 || FurnaceSamplePeaks::getSource(s)==NULL) return NULL;
+  Entry& entry=entries[s];
+  if (entry.peaks!=NULL && entry.peaks->matches(s)) return entry.peaks;
+  if (entry.building) return NULL;
+
+  if (s->samples<SAMPLE_PEAKS_ASYNC_MIN) {
+    if (entry.peaks==NULL) entry.peaks=new FurnaceSamplePeaks;
+    entry.peaks->build(s);
+    return entry.peaks;
+  }
+  logV("building sample peaks in the background (%d samples)",s->samples);
+  startJob(s,entry);
+  return NULL;
+}
+
+bool FurnaceSamplePeakCache::collect() {
+  std::deque<Job*> arrived;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (done.empty()) return false;
+    arrived.swap(done);
+  }
+  bool ret=false;
+  for (Job* i: arrived) {
+    auto entry=entries.find(i->key);
+    if (entry!=entries.end() && entry->second.building && entry->second.gen==i->gen) {
+      delete entry->second.peaks;
+      entry->second.peaks=i->result;
+      entry->second.building=false;
+      ret=true;
+    } else {
+      // the sample changed or went away in the meantime
+      delete i->result;
+    }
+    delete i;
+  }
+  return ret;
+}
+
+bool FurnaceSamplePeakCache::isBusy() {
+  for (auto& i: entries) {
+    if (i.second.building) return true;
+  }
+  return false;
+}
+
+void FurnaceSamplePeakCache::invalidate(const DivSample* s) {
+  auto entry=entries.find(s);
+  if (entry==entries.end()) return;
+  delete entry->second.peaks;
+  entry->second.peaks=NULL;
+  entry->second.building=false;
+  entry->second.gen++;
+
+  // drop pending work for it
+  std::lock_guard<std::mutex> guard(lock);
+  for (auto i=jobs.begin(); i!=jobs.end();) {
+    if ((*i)->key==s) {
+      delete *i;
+      i=jobs.erase(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
+void FurnaceSamplePeakCache::update(const DivSample* s, unsigned int start, unsigned int end) {
+  auto entry=entries.find(s);
+  if (entry==entries.end()) return;
+  if (entry->second.building || entry->second.peaks==NULL || !entry->second.peaks->matches(s)) {
+    invalidate(s);
+    return;
+  }
+  entry->second.peaks->update(s,start,end);
+}
+
+void FurnaceSamplePeakCache::prune(const std::vector<DivSample*>& samples) {
+  for (auto i=entries.begin(); i!=entries.end();) {
+    if (std::find(samples.begin(),samples.end(),i->first)==samples.end()) {
+      invalidate(i->first);
+      i=entries.erase(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
+void FurnaceSamplePeakCache::quit() {
+  if (worker!=NULL) {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      quitting=true;
+    }
+    notify.notify_all();
+    worker->join();
+    delete worker;
+    worker=NULL;
+  }
+  for (Job* i: jobs) delete i;
+  jobs.clear();
+  for (Job* i: done) {
+    delete i->result;
+    delete i;
+  }
+  done.clear();
+  for (auto& i: entries) {
+    delete i.second.peaks;
+  }
+  entries.clear();
+}
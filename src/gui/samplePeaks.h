@@ -0,0 +1,183 @@
+/**
+ * Furnace Tracker - multi-system chiptune tracker
+ * Copyright (C) 2021-2026 tildearrow and contributors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef _SAMPLE_PEAKS_H
+#define _SAMPLE_PEAKS_H
+
+#include "../engine/sample.h"
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// samples per block in the finest level (as a shift)
+#define SAMPLE_PEAKS_BLOCK_SHIFT 4
+#define SAMPLE_PEAKS_BLOCK (1<<SAMPLE_PEAKS_BLOCK_SHIFT)
+// samples this long or longer are analyzed in the background
+#define SAMPLE_PEAKS_ASYNC_MIN 262144
+
+/**
+ * a multi-resolution min/max pyramid of a sample's waveform.
+ * level 0 holds the minimum and maximum of every SAMPLE_PEAKS_BLOCK samples,
+ * and every level above halves the one below, so the peaks of any range can
+ * be found by looking at O(log n) entries.
+ * values are 16-bit (8-bit samples are scaled up).
+ */
+class FurnaceSamplePeaks {
+  // min/max pairs, by level
+  std::vector<std::vector<short>> levels;
+  // what this was built from
+  const void* source;
+  unsigned int len;
+  DivSampleDepth depth;
+
+  void buildLevel0(const DivSample* s, unsigned int startBlock, unsigned int endBlock);
+  void buildLevels(unsigned int startBlock, unsigned int endBlock);
+  void allocate();
+
+  public:
+    /**
+     * get the data a sample is displayed from (8-bit or 16-bit), or NULL.
+     */
+    static const void* getSource(const DivSample* s);
+
+    /**
+     * whether this was built from a sample in its current state (same data
+     * buffer, length and depth).
+     */
+    bool matches(const DivSample* s) const;
+
+    /**
+     * build from a sample.
+     */
+    void build(const DivSample* s);
+
+    /**
+     * build from a 16-bit copy of a sample's data.
+     * identity is taken from the sample, which is not read.
+     */
+    void build(const short* data, const void* src, unsigned int length, DivSampleDepth d);
+
+    /**
+     * rebuild the part covering a range after the sample was modified in place.
+     */
+    void update(const DivSample* s, unsigned int start, unsigned int end);
+
+    /**
+     * get the minimum and maximum of a range of the sample.
+     * samples at the edges of the range are read from the sample itself.
+     * @return false if the range is empty.
+     */
+    bool query(const DivSample* s, unsigned int start, unsigned int end, int& min, int& max) const;
+
+    /**
+     * get the number of bytes used by the pyramid.
+     */
+    size_t getMemoryUsage() const;
+
+    FurnaceSamplePeaks():
+      source(NULL),
+      len(0),
+      depth(DIV_SAMPLE_DEPTH_16BIT) {}
+};
+
+/**
+ * keeps a pyramid for every sample which has been looked at.
+ * long samples are copied and analyzed in a worker thread, so the GUI never
+ * stalls on them.
+ * everything but the worker runs on the GUI thread.
+ */
+class FurnaceSamplePeakCache {
+  struct Entry {
+    FurnaceSamplePeaks* peaks;
+    unsigned int gen;
+    bool building;
+    Entry():
+      peaks(NULL),
+      gen(0),
+      building(false) {}
+  };
+  struct Job {
+    const DivSample* key;
+    unsigned int gen;
+    std::vector<short> data;
+    const void* source;
+    DivSampleDepth depth;
+    FurnaceSamplePeaks* result;
+  };
+
+  std::map<const DivSample*,Entry> entries;
+
+  std::mutex lock;
+  std::condition_variable notify;
+  std::deque<Job*> jobs;
+  std::deque<Job*> done;
+  std::thread* worker;
+  bool quitting;
+
+  void runWorker();
+  void startJob(const DivSample* s, Entry& entry);
+
+  public:
+    /**
+     * get the pyramid of a sample.
+     * @return the pyramid, or NULL if it is being built.
+     */
+    const FurnaceSamplePeaks* get(const DivSample* s);
+
+    /**
+     * pick up pyramids built in the background.
+     * @return whether any arrived.
+     */
+    bool collect();
+
+    /**
+     * whether pyramids are being built.
+     */
+    bool isBusy();
+
+    /**
+     * the sample was modified. its pyramid is rebuilt on the next get().
+     */
+    void invalidate(const DivSample* s);
+
+    /**
+     * part of the sample was modified in place.
+     */
+    void update(const DivSample* s, unsigned int start, unsigned int end);
+
+    /**
+     * forget samples which are no longer in the song.
+     */
+    void prune(const std::vector<DivSample*>& samples);
+
+    /**
+     * forget everything and stop the worker.
+     */
+    void quit();
+
+    FurnaceSamplePeakCache():
+      worker(NULL),
+      quitting(false) {}
+    ~FurnaceSamplePeakCache();
+};
+
+#endif
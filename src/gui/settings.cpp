@@ -133,7 +133,8 @@ const char* audioBackends[]={
   "PortAudio",
   // pipe (invalid choice in GUI)
   "Uhh, can you explain to me what exactly you were trying to do?",
-  "ASIO"
+  "ASIO",
+  "Socket"
 };
 
 const char* audioQualities[]={
@@ -841,6 +842,15 @@ void FurnaceGUI::drawSettings() {
           settingsChanged=true;
         }
 
+        if (ImGui::InputInt(_("Instrument/sample indexing threads"),&settings.libraryIndexThreads)) {
+          if (settings.libraryIndexThreads<0) settings.libraryIndexThreads=0;
+          if (settings.libraryIndexThreads>16) settings.libraryIndexThreads=16;
+          settingsChanged=true;
+        }
+        if (ImGui::IsItemHovered()) {
+          ImGui::SetTooltip(_("instruments and samples shown in the file picker are indexed in the background, so that they can be searched by type and previewed quickly.\nset to 0 to disable.\nyou may need to restart Furnace for this setting to take effect."));
+        }
+
         bool compressB=settings.compress;
         if (ImGui::Checkbox(_("Compress when saving"),&compressB)) {
           settings.compress=compressB;
@@ -1251,7 +1261,7 @@ void FurnaceGUI::drawSettings() {
         if (ImGui::BeginTable("##Output",2)) {
           ImGui::TableSetupColumn("##Label",ImGuiTableColumnFlags_WidthFixed);
           ImGui::TableSetupColumn("##Combo",ImGuiTableColumnFlags_WidthStretch);
-#if defined(HAVE_JACK) || defined(HAVE_PA) || defined(HAVE_ASIO)
+#if defined(HAVE_JACK) || defined(HAVE_PA) || defined(HAVE_ASIO) || defined(HAVE_SOCKET_AUDIO)
           ImGui::TableNextRow();
           ImGui::TableNextColumn();
           ImGui::AlignTextToFramePadding();
@@ -1280,6 +1290,15 @@ void FurnaceGUI::drawSettings() {
               settings.audioEngine=DIV_AUDIO_ASIO;
               settingsChanged=true;
             }
+#endif
+#ifdef HAVE_SOCKET_AUDIO
+            if (ImGui::Selectable("Socket",settings.audioEngine==DIV_AUDIO_SOCKET)) {
+              settings.audioEngine=DIV_AUDIO_SOCKET;
+              settingsChanged=true;
+            }
+            if (ImGui::IsItemHovered()) {
+              ImGui::SetTooltip(_("streams audio to programs connected to a local socket instead of playing it."));
+            }
 #endif
             if (settings.audioEngine!=prevAudioEngine) {
               audioEngineChanged=true;
@@ -1314,44 +1333,54 @@ void FurnaceGUI::drawSettings() {
             }
           }
 
-          ImGui::TableNextRow();
-          ImGui::TableNextColumn();
-          ImGui::AlignTextToFramePadding();
-          ImGui::Text(_("Device"));
-          ImGui::TableNextColumn();
-          if (audioEngineChanged) {
-            ImGui::BeginDisabled();
-            if (ImGui::BeginCombo("##AudioDevice",_("<click on OK or Apply first>"))) {
-              ImGui::Text(_("ALERT - TRESPASSER DETECTED"));
-              if (ImGui::IsItemHovered()) {
-                showError(_("you have been arrested for trying to engage with a disabled combo box."));
-                ImGui::CloseCurrentPopup();
-              }
-              ImGui::EndCombo();
-            }
-            ImGui::EndDisabled();
+          if (settings.audioEngine==DIV_AUDIO_SOCKET) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::AlignTextToFramePadding();
+            ImGui::Text(_("Socket path"));
+            ImGui::TableNextColumn();
+            ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x);
+            if (ImGui::InputTextWithHint("##AudioSocketPath","/tmp/furnace-audio.sock",&settings.audioSocketPath)) settingsChanged=true;
           } else {
-            String audioDevName=settings.audioDevice.empty()?_("<System default>"):settings.audioDevice;
-            if (ImGui::BeginCombo("##AudioDevice",audioDevName.c_str())) {
-              if (ImGui::Selectable(_("<System default>"),settings.audioDevice.empty())) {
-                settings.audioDevice="";
-                settingsChanged=true;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::AlignTextToFramePadding();
+            ImGui::Text(_("Device"));
+            ImGui::TableNextColumn();
+            if (audioEngineChanged) {
+              ImGui::BeginDisabled();
+              if (ImGui::BeginCombo("##AudioDevice",_("<click on OK or Apply first>"))) {
+                ImGui::Text(_("ALERT - TRESPASSER DETECTED"));
+                if (ImGui::IsItemHovered()) {
+                  showError(_("you have been arrested for trying to engage with a disabled combo box."));
+                  ImGui::CloseCurrentPopup();
+                }
+                ImGui::EndCombo();
               }
-              for (String& i: e->getAudioDevices()) {
-                if (ImGui::Selectable(i.c_str(),i==settings.audioDevice)) {
-                  settings.audioDevice=i;
+              ImGui::EndDisabled();
+            } else {
+              String audioDevName=settings.audioDevice.empty()?_("<System default>"):settings.audioDevice;
+              if (ImGui::BeginCombo("##AudioDevice",audioDevName.c_str())) {
+                if (ImGui::Selectable(_("<System default>"),settings.audioDevice.empty())) {
+                  settings.audioDevice="";
                   settingsChanged=true;
                 }
+                for (String& i: e->getAudioDevices()) {
+                  if (ImGui::Selectable(i.c_str(),i==settings.audioDevice)) {
+                    settings.audioDevice=i;
+                    settingsChanged=true;
+                  }
+                }
+                ImGui::EndCombo();
               }
-              ImGui::EndCombo();
             }
-          }
 
-          if (settings.audioEngine==DIV_AUDIO_ASIO) {
-            ImGui::SameLine();
-            if (ImGui::Button(_("Control panel"))) {
-              if (e->audioBackendCommand(TA_AUDIO_CMD_SETUP)!=1) {
-                showError(_("this driver doesn't have a control panel."));
+            if (settings.audioEngine==DIV_AUDIO_ASIO) {
+              ImGui::SameLine();
+              if (ImGui::Button(_("Control panel"))) {
+                if (e->audioBackendCommand(TA_AUDIO_CMD_SETUP)!=1) {
+                  showError(_("this driver doesn't have a control panel."));
+                }
               }
             }
           }
@@ -1437,6 +1466,37 @@ void FurnaceGUI::drawSettings() {
             }
           }
           popWarningColor();
+
+          bool parallelTickB=settings.parallelTick;
+          if (ImGui::Checkbox(_("Tick chips in parallel (EXPERIMENTAL)"),&parallelTickB)) {
+            settings.parallelTick=parallelTickB;
+            settingsChanged=true;
+          }
+          if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip(_("also runs macros and frequency updates of each chip on separate threads.\nonly used with 4 or more chips."));
+          }
+        }
+
+        bool renderAheadB=(settings.renderAheadBufs>0);
+        if (ImGui::Checkbox(_("Render ahead (EXPERIMENTAL)"),&renderAheadB)) {
+          if (renderAheadB) {
+            settings.renderAheadBufs=2;
+          } else {
+            settings.renderAheadBufs=0;
+          }
+          settingsChanged=true;
+        }
+        if (ImGui::IsItemHovered()) {
+          ImGui::SetTooltip(_("renders audio on a separate thread, a few buffers ahead of the output.\nthe audio callback only copies the result, so a heavy chip no longer causes dropouts as long as it keeps up on average.\nunless the thread count above is set, each chip renders on its own thread.\n\nwarnings:\n- experimental!\n- adds latency (the number of buffers ahead times the buffer size)."));
+        }
+
+        if (renderAheadB) {
+          if (ImGui::InputInt(_("Buffers ahead"),&settings.renderAheadBufs)) {
+            if (settings.renderAheadBufs<1) settings.renderAheadBufs=1;
+            if (settings.renderAheadBufs>16) settings.renderAheadBufs=16;
+            settingsChanged=true;
+          }
+          ImGui::Text(_("added latency: ~%.1fms"),1000.0*(double)(settings.renderAheadBufs*settings.audioBufSize)/(double)MAX(1,settings.audioRate));
         }
 
         bool lowLatencyB=settings.lowLatency;
@@ -4925,7 +4985,10 @@ void FurnaceGUI::readConfig(DivConfig& conf, FurnaceGUISettingGroups groups) {
     settings.displayRenderTime=conf.getInt("displayRenderTime",0);
 
     settings.chanOscThreads=conf.getInt("chanOscThreads",0);
+    settings.libraryIndexThreads=conf.getInt("libraryIndexThreads",2);
     settings.renderPoolThreads=conf.getInt("renderPoolThreads",0);
+    settings.parallelTick=conf.getInt("parallelTick",0);
+    settings.renderAheadBufs=conf.getInt("renderAheadBufs",0);
     settings.shaderOsc=conf.getInt("shaderOsc",0);
     settings.writeInsNames=conf.getInt("writeInsNames",0);
     settings.readInsNames=conf.getInt("readInsNames",1);
@@ -4986,10 +5049,13 @@ void FurnaceGUI::readConfig(DivConfig& conf, FurnaceGUISettingGroups groups) {
       settings.audioEngine=DIV_AUDIO_PORTAUDIO;
     } else if (conf.getString("audioEngine","SDL")=="ASIO") {
       settings.audioEngine=DIV_AUDIO_ASIO;
+    } else if (conf.getString("audioEngine","SDL")=="Socket") {
+      settings.audioEngine=DIV_AUDIO_SOCKET;
     } else {
       settings.audioEngine=DIV_AUDIO_SDL;
     }
     settings.audioDevice=conf.getString("audioDevice","");
+    settings.audioSocketPath=conf.getString("audioSocketPath","");
     settings.sdlAudioDriver=conf.getString("sdlAudioDriver","");
     settings.audioQuality=conf.getInt("audioQuality",0);
     settings.audioHiPass=conf.getInt("audioHiPass",1);
@@ -5271,7 +5337,7 @@ void FurnaceGUI::readConfig(DivConfig& conf, FurnaceGUISettingGroups groups) {
   clampSetting(settings.headFontSize,2,96);
   clampSetting(settings.patFontSize,2,96);
   clampSetting(settings.iconSize,2,48);
-  clampSetting(settings.audioEngine,0,4);
+  clampSetting(settings.audioEngine,0,5);
   clampSetting(settings.audioQuality,0,1);
   clampSetting(settings.audioHiPass,0,1);
   clampSetting(settings.audioBufSize,32,4096);
@@ -5446,7 +5512,10 @@ void FurnaceGUI::readConfig(DivConfig& conf, FurnaceGUISettingGroups groups) {
   clampSetting(settings.exportOptionsLayout,0,2);
   clampSetting(settings.wasapiEx,0,1);
   clampSetting(settings.chanOscThreads,0,256);
+  clampSetting(settings.libraryIndexThreads,0,16);
   clampSetting(settings.renderPoolThreads,0,DIV_MAX_CHIPS);
+  clampSetting(settings.parallelTick,0,1);
+  clampSetting(settings.renderAheadBufs,0,16);
   clampSetting(settings.writeInsNames,0,1);
   clampSetting(settings.readInsNames,0,1);
   clampSetting(settings.fontBackend,0,1);
@@ -5527,7 +5596,10 @@ void FurnaceGUI::writeConfig(DivConfig& conf, FurnaceGUISettingGroups groups) {
     conf.set("displayRenderTime",settings.displayRenderTime);
 
     conf.set("chanOscThreads",settings.chanOscThreads);
+    conf.set("libraryIndexThreads",settings.libraryIndexThreads);
     conf.set("renderPoolThreads",settings.renderPoolThreads);
+    conf.set("parallelTick",settings.parallelTick);
+    conf.set("renderAheadBufs",settings.renderAheadBufs);
     conf.set("shaderOsc",settings.shaderOsc);
     conf.set("writeInsNames",settings.writeInsNames);
     conf.set("readInsNames",settings.readInsNames);
@@ -5584,6 +5656,7 @@ void FurnaceGUI::writeConfig(DivConfig& conf, FurnaceGUISettingGroups groups) {
   if (groups&GUI_SETTINGS_AUDIO) {
     conf.set("audioEngine",String(audioBackends[settings.audioEngine]));
     conf.set("audioDevice",settings.audioDevice);
+    conf.set("audioSocketPath",settings.audioSocketPath);
     conf.set("sdlAudioDriver",settings.sdlAudioDriver);
     conf.set("audioQuality",settings.audioQuality);
     conf.set("audioHiPass",settings.audioHiPass);
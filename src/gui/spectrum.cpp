@@ -22,7 +22,6 @@
 #include "gui.h"
 #include "imgui_internal.h"
 #include "IconsFontAwesome4.h"
-#include <fftw3.h>
 #include <math.h> // fmod
 
 inline float scaleFuncLog(float x) {
@@ -110,38 +109,8 @@ void FurnaceGUI::drawSpectrum() {
         prevPos=pos;
       }
     }
-    int chans=e->getAudioDescGot().outChans;
     if (spectrum.update) {
       spectrum.update=false;
-      spectrum.running=true;
-      for (int i=0; i<DIV_MAX_OUTPUTS; i++) {
-        if (spectrum.buffer[i]) {
-          fftw_free(spectrum.buffer[i]);
-          spectrum.buffer[i]=NULL;
-        }
-        if (spectrum.in[i]) {
-          delete[] spectrum.in[i];
-          spectrum.in[i]=NULL;
-        }
-        if (spectrum.plan[i]) {
-          fftw_free(spectrum.plan[i]);
-          spectrum.plan[i]=NULL;
-        }
-        if (spectrum.plot[i]) {
-          delete[] spectrum.plot[i];
-          spectrum.plot[i]=NULL;
-        }
-      }
-      for (int i=0; i<(spectrum.mono?1:chans); i++) {
-        spectrum.buffer[i]=(fftw_complex*)fftw_malloc(sizeof(fftw_complex)*spectrum.bins);
-        if (!spectrum.buffer[i]) spectrum.running=false;
-        spectrum.in[i]=new double[spectrum.bins];
-        if (!spectrum.in[i]) spectrum.running=false;
-        spectrum.plan[i]=fftw_plan_dft_r2c_1d(spectrum.bins,spectrum.in[i],spectrum.buffer[i],FFTW_ESTIMATE);
-        if (!spectrum.plan[i]) spectrum.running=false;
-        spectrum.plot[i]=new ImVec2[spectrum.bins/2];
-        if (!spectrum.plot[i]) spectrum.running=false;
-      }
       spectrum.frequencies.clear();
       float freq;
       float maxRate=e->getAudioDescGot().rate/2;
@@ -153,65 +122,28 @@ void FurnaceGUI::drawSpectrum() {
         }
         if (freq>maxRate) break;
       }
-      if (spectrum.running) logV("spectrum ready!");
     }
-    if (spectrum.running) {
-      for (int z=spectrum.mono?0:(chans-1); z>=0; z--) {
-        if (!spectrum.buffer[z]) {
-          spectrum.buffer[z]=(fftw_complex*)fftw_malloc(sizeof(fftw_complex)*spectrum.bins);
-          if (!spectrum.buffer[z]) spectrum.running=false;
-        }
-        if (!spectrum.in[z]) {
-          spectrum.in[z]=new double[spectrum.bins];
-          if (!spectrum.in[z]) spectrum.running=false;
-        }
-        if (!spectrum.plan[z]) {
-          spectrum.plan[z]=fftw_plan_dft_r2c_1d(spectrum.bins,spectrum.in[z],spectrum.buffer[z],FFTW_ESTIMATE);
-          if (!spectrum.plan[z]) spectrum.running=false;
-        }
-        if (!spectrum.plot[z]) {
-          spectrum.plot[z]=new ImVec2[spectrum.bins/2];
-          if (!spectrum.plot[z]) spectrum.running=false;
-        }
-        if (!spectrum.running) {
-          logE("oh no what why");
-          break;
-        }
-        // get buffer
-        memset(spectrum.in[z],0,sizeof(double)*spectrum.bins);
-        int needle=e->oscReadPos-spectrum.bins;
-
-        for (int j=0; j<spectrum.bins; j++) {
-          int pos=(needle+j)&0x7fff;
-          double sample=0.0;
-          if (spectrum.mono) {
-            for (int i=0; i<chans; i++) {
-              sample+=e->oscBuf[i][pos];
-            }
-            sample/=chans;
-          } else {
-            sample+=e->oscBuf[z][pos];
-          }
-          spectrum.in[z][j]=sample*(0.5*(1.0-cos(2.0*M_PI*j/(spectrum.bins-1))));
-        }
-        fftw_execute(spectrum.plan[z]);
-        unsigned int count=0;
-        double mag=0.0f;
-        float x=0.0f, y=0.0f;
-        count=spectrum.bins/2;
-        for (unsigned int i=0; i<count; i++) {
-          x=spectrum.xZoom*size.x*(scaleFuncLog((float)i/count)-spectrum.xOffset);
-          mag=2.0f*sqrt(spectrum.buffer[z][i][0]*spectrum.buffer[z][i][0]+spectrum.buffer[z][i][1]*spectrum.buffer[z][i][1])/count;
-          y=1.0-scaleFuncDb(mag);
-          spectrum.plot[z][i].x=origin.x+x;
-          spectrum.plot[z][i].y=origin.y+size.y*(y-spectrum.yOffset);
-        }
-        ImGui::PushClipRect(origin,origin+size,true);
-        dl->AddPolyline(spectrum.plot[z],count,ImGui::GetColorU32(uiColors[spectrum.mono?GUI_COLOR_OSC_WAVE:GUI_COLOR_OSC_WAVE_CH0+z]),0,dpiScale);
-        dl->PathFillConcave(ImGui::GetColorU32(uiColors[spectrum.mono?GUI_COLOR_OSC_WAVE:GUI_COLOR_OSC_WAVE_CH0+z]));
-        ImGui::PopClipRect();
+    // the FFTs are done by the analysis thread
+    const FurnaceAnalyzerResult& analysis=audioAnalyzer.lockResults();
+    for (int z=analysis.spectrumChans-1; z>=0; z--) {
+      const std::vector<float>& mag=analysis.spectrum[z];
+      unsigned int count=mag.size();
+      if (count<1) continue;
+      if (spectrum.plot.size()<count) spectrum.plot.resize(count);
+      ImVec2* plot=spectrum.plot.data();
+      for (unsigned int i=0; i<count; i++) {
+        float x=spectrum.xZoom*size.x*(scaleFuncLog((float)i/count)-spectrum.xOffset);
+        float y=1.0-scaleFuncDb(mag[i]);
+        plot[i].x=origin.x+x;
+        plot[i].y=origin.y+size.y*(y-spectrum.yOffset);
       }
+      ImU32 color=ImGui::GetColorU32(uiColors[spectrum.mono?GUI_COLOR_OSC_WAVE:GUI_COLOR_OSC_WAVE_CH0+z]);
+      ImGui::PushClipRect(origin,origin+size,true);
+      dl->AddPolyline(plot,count,color,0,dpiScale);
+      dl->PathFillConcave(color);
+      ImGui::PopClipRect();
     }
+    audioAnalyzer.unlockResults();
     ImGui::PopStyleVar();
     if (ImGui::IsWindowHovered()) {
       ImGui::SetCursorPosX(ImGui::GetWindowSize().x-ImGui::GetStyle().ItemSpacing.x-ImGui::CalcTextSize(ICON_FA_BARS).x);
@@ -2960,6 +2960,35 @@ bool FurnaceGUI::drawSysConf(int chan, int sysPos, DivSystem type, DivConfig& fl
     }
   }
 
+  // resampling path (see DivDispatchContainer::setRates)
+  if (!separatedYet && !supportsCustomRate) ImGui::Separator();
+  int resampler=flags.getInt("resampler",DIV_RESAMPLER_AUTO);
+  bool resamplerChanged=false;
+  ImGui::Text(_("Resampling:"));
+  if (ImGui::IsItemHovered()) {
+    ImGui::SetTooltip(_("chips whose rate is the output rate (or an integer multiple of it) may skip blip_buf.\nthis is faster and only applies when the rates match."));
+  }
+  ImGui::Indent();
+  if (ImGui::RadioButton(_("Automatic"),resampler==DIV_RESAMPLER_AUTO)) {
+    resampler=DIV_RESAMPLER_AUTO;
+    resamplerChanged=true;
+  }
+  if (ImGui::RadioButton(_("Always use blip_buf"),resampler==DIV_RESAMPLER_BLIP)) {
+    resampler=DIV_RESAMPLER_BLIP;
+    resamplerChanged=true;
+  }
+  if (ImGui::RadioButton(_("Fast (no band-limiting)"),resampler==DIV_RESAMPLER_NATIVE_FAST)) {
+    resampler=DIV_RESAMPLER_NATIVE_FAST;
+    resamplerChanged=true;
+  }
+  ImGui::Unindent();
+  if (resamplerChanged) {
+    e->lockSave([&]() {
+      flags.set("resampler",resampler);
+    });
+    altered=true;
+  }
+
   if (altered) {
     if (chan>=0) {
       e->updateSysFlags(chan,restart,mustRender);
@@ -24,8 +24,6 @@
 #include "imgui_internal.h"
 #include "misc/cpp/imgui_stdlib.h"
 
-#define FURNACE_TUNER_FFT_SIZE 16384
-
 void FurnaceGUI::drawTuner() {
   if (nextWindow==GUI_WINDOW_TUNER) {
     tunerOpen=true;
@@ -34,61 +32,10 @@ void FurnaceGUI::drawTuner() {
   }
   if (!tunerOpen) return;
   if (ImGui::Begin("Tuner",&tunerOpen,globalWinFlags|ImGuiWindowFlags_NoScrollbar,_("Tuner"))) {
-    // fft buffer
-    if (!tunerFFTInBuf) tunerFFTInBuf=new double[FURNACE_TUNER_FFT_SIZE];
-    if (!tunerFFTOutBuf) tunerFFTOutBuf=(fftw_complex*)fftw_malloc(sizeof(fftw_complex)*FURNACE_TUNER_FFT_SIZE);
-
-    if (!tunerPlan) {
-      tunerPlan=fftw_plan_dft_r2c_1d(FURNACE_TUNER_FFT_SIZE,tunerFFTInBuf,tunerFFTOutBuf,FFTW_ESTIMATE);
-    }
-
-    int chans=e->getAudioDescGot().outChans;
-    int needle=e->oscReadPos;
-
-    for (int j=0; j<FURNACE_TUNER_FFT_SIZE; j++) {
-      int pos=(needle-FURNACE_TUNER_FFT_SIZE+j)&0x7fff;
-      double sample=0.0;
-      for (int ch=0; ch<chans; ch++) {
-        sample+=e->oscBuf[ch][pos];
-      }
-      sample=sample/chans;
-
-      tunerFFTInBuf[j]=sample*(0.5*(1.0-cos(2.0*M_PI*j/(FURNACE_TUNER_FFT_SIZE-1))));
-    }
-
-    fftw_execute(tunerPlan);
-
-    std::vector<double> mag(FURNACE_TUNER_FFT_SIZE/2);
-    mag[0]=0;
-    mag[1]=0;
-    mag[2]=0;
-    mag[3]=0; // skip some of the low frequencies
-    for (int k=4; k<FURNACE_TUNER_FFT_SIZE/2; k++) {
-      mag[k]=sqrt(tunerFFTOutBuf[k][0]*tunerFFTOutBuf[k][0]+tunerFFTOutBuf[k][1]*tunerFFTOutBuf[k][1]);
-    }
-
-    // harmonic product spectrum
-    int harmonics=1; // disabled for now...
-    for (int h=2; h<=harmonics; h++) {
-      for (int k=8; k<FURNACE_TUNER_FFT_SIZE/(2*h); k++) {
-        mag[k]*=mag[k*h];
-      }
-    }
-
-    double sampleRate=e->getAudioDescGot().rate;
-    // peak with interpolation
-    int peakIndex=std::distance(mag.begin(),std::max_element(mag.begin(),mag.end()));
-
-    double freq=0.0;
-    if (peakIndex>0 && peakIndex<(int)mag.size()-1) {
-      double alpha=mag[peakIndex-1];
-      double beta=mag[peakIndex];
-      double gamma=mag[peakIndex+1];
-      double p=0.5*(alpha-gamma)/(alpha-2.0*beta+gamma);
-      freq=(peakIndex+p)*(sampleRate/(double)FURNACE_TUNER_FFT_SIZE);
-    } else {
-      freq=(double)peakIndex*(sampleRate/(double)FURNACE_TUNER_FFT_SIZE);
-    }
+    // pitch detection runs in the analysis thread
+    const FurnaceAnalyzerResult& analysis=audioAnalyzer.lockResults();
+    double freq=analysis.tunerFreq;
+    audioAnalyzer.unlockResults();
 
     // tuning formulas
     double noteExact=0.0;
@@ -110,20 +57,6 @@ void FurnaceGUI::drawTuner() {
       float titleBar=ImGui::GetCurrentWindow()->TitleBarHeight;
       origin.y+=titleBar;
       size.y-=titleBar;
-      // debug stuff
-      // ImVec2* plot=new ImVec2[FURNACE_TUNER_FFT_SIZE];
-      // for (size_t i=0; i<FURNACE_TUNER_FFT_SIZE; i++) {
-      //   plot[i].x=origin.x+size.x*(float)i/FURNACE_TUNER_FFT_SIZE;
-      //   plot[i].y=origin.y+size.y-size.y*(tunerFFTInBuf[i]+1.0f)/2.0f;
-      // }
-      // dl->AddPolyline(plot, FURNACE_TUNER_FFT_SIZE, 0xff00ff00, 0, 1.0f);
-      // for (size_t i=0; i<mag.size(); i++) {
-      //   plot[i].x=origin.x+size.x*scaleFuncLog((float)i/mag.size());
-      //   plot[i].y=origin.y+size.y-size.y*(mag[i]/FURNACE_TUNER_FFT_SIZE);
-      // }
-      // dl->AddPolyline(plot, mag.size(), 0xffffffff, 0, 1.0f);
-      // dl->AddLine(origin+ImVec2(size.x*scaleFuncLog((double)peakIndex/(mag.size()-1)),0),origin+ImVec2(size.x*scaleFuncLog((double)peakIndex/(mag.size()-1)),size.y), 0xff000fff);
-      // delete[] plot;
       const float boxHeight=20.0f*dpiScale;
       const float needleHeight=18.0f*dpiScale;
       ImU32 lowColor=ImGui::GetColorU32(uiColors[GUI_COLOR_TUNER_SCALE_LOW]);
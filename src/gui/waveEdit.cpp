@@ -467,7 +467,7 @@ void FurnaceGUI::drawWaveEdit() {
           waveDragTarget=wave->data;
           processDrags(ImGui::GetMousePos().x,ImGui::GetMousePos().y);
           e->notifyWaveChange(curWave);
-          modified=true;
+          MARK_MODIFIED;
         }
         ImGui::PopStyleVar();
 
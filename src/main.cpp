@@ -73,6 +73,9 @@ struct sigaction termsa;
 #endif
 
 #include "cli/cli.h"
+#ifdef HAVE_RENDER_SERVER
+#include "cli/renderServer.h"
+#endif
 
 #ifdef HAVE_GUI
 #include "gui/gui.h"
@@ -91,7 +94,14 @@ String vgmOutName;
 String cmdOutName;
 String romOutName;
 String txtOutName;
+String benchTraceName;
+String benchSuiteName;
+String benchReportName;
+String benchBaselineName;
+double benchThreshold=10.0;
 int benchMode=0;
+String serverPath;
+int serverEngines=0;
 int subsong=-1;
 DivCSOptions csExportOptions;
 DivAudioExportOptions exportOptions;
@@ -185,13 +195,25 @@ TAParamResult pAudio(String val) {
   } else if (val=="pipe") {
     e.setAudio(DIV_AUDIO_PIPE);
     changeLogOutput(stderr);
+  } else if (val=="socket") {
+#ifdef HAVE_SOCKET_AUDIO
+    e.setAudio(DIV_AUDIO_SOCKET);
+#else
+    logE("Furnace was compiled without socket server support.");
+    return TA_PARAM_ERROR;
+#endif
   } else {
-    logE("invalid value for audio engine! valid values are: jack, sdl, portaudio, asio, pipe.");
+    logE("invalid value for audio engine! valid values are: jack, sdl, portaudio, asio, pipe, socket.");
     return TA_PARAM_ERROR;
   }
   return TA_PARAM_SUCCESS;
 }
 
+TAParamResult pSocketPath(String val) {
+  e.setAudioSocketPath(val);
+  return TA_PARAM_SUCCESS;
+}
+
 TAParamResult pView(String val) {
   if (val=="pattern") {
     e.setView(DIV_STATUS_PATTERN);
@@ -424,6 +446,47 @@ TAParamResult pLoops(String val) {
   return TA_PARAM_SUCCESS;
 }
 
+// parses order[:row]
+static bool parseSongPos(const String& val, int& order, int& row) {
+  size_t sepPos=val.find(':');
+  try {
+    order=std::stoi(val.substr(0,sepPos));
+    row=(sepPos==String::npos)?0:std::stoi(val.substr(sepPos+1));
+  } catch (std::exception& e) {
+    return false;
+  }
+  return (order>=0 && row>=0);
+}
+
+TAParamResult pRange(String val) {
+  size_t sepPos=val.find('-');
+  if (!parseSongPos(val.substr(0,sepPos),exportOptions.orderBegin,exportOptions.rowBegin)) {
+    logE("invalid range start. it shall be order[:row].");
+    return TA_PARAM_ERROR;
+  }
+  if (sepPos!=String::npos) {
+    if (!parseSongPos(val.substr(sepPos+1),exportOptions.orderEnd,exportOptions.rowEnd)) {
+      logE("invalid range end. it shall be order[:row].");
+      return TA_PARAM_ERROR;
+    }
+  }
+  return TA_PARAM_SUCCESS;
+}
+
+TAParamResult pDuration(String val) {
+  try {
+    exportOptions.duration=std::stod(val);
+  } catch (std::exception& e) {
+    logE("duration shall be a number.");
+    return TA_PARAM_ERROR;
+  }
+  if (exportOptions.duration<0.0) {
+    logE("duration shall be positive.");
+    return TA_PARAM_ERROR;
+  }
+  return TA_PARAM_SUCCESS;
+}
+
 TAParamResult pSubSong(String val) {
   try {
     int v=std::stoi(val);
@@ -541,14 +604,76 @@ TAParamResult pBenchmark(String val) {
     benchMode=2;
   } else if (val=="walk") {
     benchMode=3;
+  } else if (val=="convolution") {
+    benchMode=5;
   } else {
-    logE("invalid value for benchmark! valid values are: render, seek and walk.");
+    logE("invalid value for benchmark! valid values are: render, seek, walk and convolution.");
     return TA_PARAM_ERROR;
   }
   e.setAudio(DIV_AUDIO_DUMMY);
   return TA_PARAM_SUCCESS;
 }
 
+TAParamResult pBenchTrace(String val) {
+  benchTraceName=val;
+  return TA_PARAM_SUCCESS;
+}
+
+TAParamResult pBenchSuite(String val) {
+  benchSuiteName=val;
+  benchMode=4;
+  e.setAudio(DIV_AUDIO_DUMMY);
+  return TA_PARAM_SUCCESS;
+}
+
+TAParamResult pBenchReport(String val) {
+  benchReportName=val;
+  return TA_PARAM_SUCCESS;
+}
+
+TAParamResult pBenchCompare(String val) {
+  benchBaselineName=val;
+  return TA_PARAM_SUCCESS;
+}
+
+TAParamResult pServer(String val) {
+#ifdef HAVE_RENDER_SERVER
+  serverPath=val;
+  return TA_PARAM_SUCCESS;
+#else
+  logE("Furnace was not compiled with render server support!");
+  return TA_PARAM_ERROR;
+#endif
+}
+
+TAParamResult pServerEngines(String val) {
+  try {
+    serverEngines=std::stoi(val);
+  } catch (std::exception& e) {
+    logE("engine count shall be a number.");
+    return TA_PARAM_ERROR;
+  }
+  if (serverEngines<0) {
+    logE("engine count shall be positive.");
+    return TA_PARAM_ERROR;
+  }
+  return TA_PARAM_SUCCESS;
+}
+
+TAParamResult pBenchThreshold(String val) {
+  try {
+    benchThreshold=std::stod(val);
+  } catch (std::exception& e) {
+    logE("threshold shall be a number.");
+    return TA_PARAM_ERROR;
+  }
+  if (benchThreshold<0) {
+    logE("threshold shall be positive.");
+    return TA_PARAM_ERROR;
+  }
+  return TA_PARAM_SUCCESS;
+}
+
 TAParamResult pOutput(String val) {
   outName=val;
   e.setAudio(DIV_AUDIO_DUMMY);
@@ -627,7 +752,8 @@ bool needsValue(String param) {
 void initParams() {
   params.push_back(TAParam("h","help",false,pHelp,"","display this help"));
 
-  params.push_back(TAParam("a","audio",true,pAudio,"jack|sdl|portaudio|pipe","set audio engine (SDL by default)"));
+  params.push_back(TAParam("a","audio",true,pAudio,"jack|sdl|portaudio|pipe|socket","set audio engine (SDL by default)"));
+  params.push_back(TAParam("","socketpath",true,pSocketPath,"<path>","set socket path for the socket audio engine"));
   params.push_back(TAParam("o","output",true,pOutput,"<filename>","output audio to file"));
   params.push_back(TAParam("f","outformat",true,pOutFormat,"u8|s16|f32|opus|flac|vorbis|mp3","set audio output format"));
   params.push_back(TAParam("b","bitrate",true,pBitRate,"<rate>","set output file bit rate (lossy compression only)"));
@@ -651,11 +777,21 @@ void initParams() {
 
   params.push_back(TAParam("l","loops",true,pLoops,"<count>","set number of loops"));
   params.push_back(TAParam("s","subsong",true,pSubSong,"<number>","set sub-song"));
+  params.push_back(TAParam("","range",true,pRange,"<order[:row]>[-<order[:row]>]","only render from the first position until the second one (not included). orders and rows are decimal"));
+  params.push_back(TAParam("","duration",true,pDuration,"<seconds>","stop rendering audio after this many seconds"));
   params.push_back(TAParam("o","outmode",true,pOutMode,"one|persys|perchan","set file output mode"));
   params.push_back(TAParam("S","safemode",false,pSafeMode,"","enable safe mode (software rendering and no audio)"));
   params.push_back(TAParam("A","safeaudio",false,pSafeModeAudio,"","enable safe mode (with audio"));
 
-  params.push_back(TAParam("B","benchmark",true,pBenchmark,"render|seek|walk","run performance test"));
+  params.push_back(TAParam("B","benchmark",true,pBenchmark,"render|seek|walk|convolution","run performance test"));
+  params.push_back(TAParam("","benchtrace",true,pBenchTrace,"<filename>","write a Chrome trace event file of the benchmark run"));
+  params.push_back(TAParam("","benchsuite",true,pBenchSuite,"<corpus>","run the benchmark suite on a list of songs"));
+  params.push_back(TAParam("","benchreport",true,pBenchReport,"<filename>","write the benchmark suite report to a file (bench-report.json by default)"));
+  params.push_back(TAParam("","benchcompare",true,pBenchCompare,"<filename>","compare benchmark suite results against a previous report"));
+  params.push_back(TAParam("","benchthreshold",true,pBenchThreshold,"<percent>","slowdown to flag as a regression when comparing (10 by default)"));
+
+  params.push_back(TAParam("","server",true,pServer,"<path>","run a headless render server on a Unix domain socket"));
+  params.push_back(TAParam("","serverengines",true,pServerEngines,"<count>","number of engines in the render server (one per CPU core by default)"));
 
   params.push_back(TAParam("V","version",false,pVersion,"","view information about Furnace."));
   params.push_back(TAParam("W","warranty",false,pWarranty,"","view warranty disclaimer."));
@@ -907,9 +1043,9 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  const bool outputMode = outName!="" || vgmOutName!="" || cmdOutName!="" || romOutName!="" || txtOutName!="";
+  const bool outputMode = outName!="" || vgmOutName!="" || cmdOutName!="" || romOutName!="" || txtOutName!="" || serverPath!="";
 
-  if (fileName.empty() && (benchMode || infoMode || outputMode)) {
+  if (fileName.empty() && ((benchMode && benchMode!=4 && benchMode!=5) || infoMode || (outputMode && serverPath==""))) {
     logE("provide a file!");
     return 1;
   }
@@ -943,6 +1079,21 @@ int main(int argc, char** argv) {
     e.setAudio(DIV_AUDIO_DUMMY);
   }
 
+#ifdef HAVE_RENDER_SERVER
+  if (serverPath!="") {
+    FurnaceRenderServer server;
+    if (!server.init(serverPath,serverEngines)) {
+      reportError(_("could not start render server!"));
+      finishLogFile();
+      return 1;
+    }
+    server.run();
+    server.quit();
+    finishLogFile();
+    return 0;
+  }
+#endif
+
 #if defined(HAVE_SDL2) && defined(ANDROID)
   if (e.getConfInt("backgroundPlay",0)!=0) {
     SDL_SetHint(SDL_HINT_ANDROID_BLOCK_ON_PAUSE,"0");
@@ -1031,8 +1182,26 @@ int main(int argc, char** argv) {
     e.changeSongP(subsong);
   }
 
+  if (benchMode==5) {
+    int ret=e.benchmarkConvolution();
+    finishLogFile();
+    return (ret==0)?0:1;
+  }
+
+  if (benchMode==4) {
+    int ret=e.benchmarkSuite(benchSuiteName.c_str(),benchReportName.empty()?"bench-report.json":benchReportName.c_str(),benchBaselineName.empty()?NULL:benchBaselineName.c_str(),benchThreshold);
+    if (ret<0) {
+      reportError(_("could not run benchmark suite!"));
+    }
+    finishLogFile();
+    return (ret==0)?0:1;
+  }
+
   if (benchMode) {
     logI("starting benchmark!");
+    if (!benchTraceName.empty()) {
+      e.setPerfTrace(true);
+    }
     if (benchMode==3) {
       e.benchmarkWalk();
     } else if (benchMode==2) {
@@ -1040,6 +1209,14 @@ int main(int argc, char** argv) {
     } else {
       e.benchmarkPlayback();
     }
+    if (!benchTraceName.empty()) {
+      if (e.writePerfTrace(benchTraceName.c_str())) {
+        logI("trace written to %s.",benchTraceName);
+      } else {
+        reportError(_("could not write trace file!"));
+      }
+      e.setPerfTrace(false);
+    }
     finishLogFile();
     return 0;
   }
@@ -1050,7 +1227,7 @@ int main(int argc, char** argv) {
       if (w!=NULL) {
         FILE* f=ps_fopen(cmdOutName.c_str(),"wb");
         if (f!=NULL) {
-          fwrite(w->getFinalBuf(),1,w->size(),f);
+          w->writeTo(f);
           fclose(f);
         } else {
           reportError(fmt::sprintf(_("could not open file! (%s)"),strerror(errno)));
@@ -1066,7 +1243,7 @@ int main(int argc, char** argv) {
       if (w!=NULL) {
         FILE* f=ps_fopen(vgmOutName.c_str(),"wb");
         if (f!=NULL) {
-          fwrite(w->getFinalBuf(),1,w->size(),f);
+          w->writeTo(f);
           fclose(f);
         } else {
           reportError(fmt::sprintf(_("could not open file! (%s)"),strerror(errno)));
@@ -1079,8 +1256,11 @@ int main(int argc, char** argv) {
     }
     if (outName!="") {
       e.setConsoleMode(true);
-      e.saveAudio(outName.c_str(),exportOptions);
-      e.waitAudioFile();
+      if (e.saveAudio(outName.c_str(),exportOptions)) {
+        e.waitAudioFile();
+      } else {
+        reportError(_("could not export audio!"));
+      }
     }
     if (romOutName!="") {
       e.setConsoleMode(true);
@@ -1122,7 +1302,7 @@ int main(int argc, char** argv) {
                 }
                 FILE* f=ps_fopen(path.c_str(),"wb");
                 if (f!=NULL) {
-                  fwrite(i.data->getFinalBuf(),1,i.data->size(),f);
+                  i.data->writeTo(f);
                   fclose(f);
                 } else {
                   reportError(fmt::sprintf(_("could not open file! (%s)"),strerror(errno)));
@@ -1145,7 +1325,7 @@ int main(int argc, char** argv) {
       if (w!=NULL) {
         FILE* f=ps_fopen(txtOutName.c_str(),"wb");
         if (f!=NULL) {
-          fwrite(w->getFinalBuf(),1,w->size(),f);
+          w->writeTo(f);
           fclose(f);
         } else {
           reportError(fmt::sprintf(_("could not open file! (%s)"),strerror(errno)));
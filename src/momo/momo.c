@@ -24,6 +24,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <stdint.h>
 #include "momo.h"
 
 #include "halfsiphash.c"
@@ -75,6 +76,16 @@ struct StackData {
   unsigned int param;
 };
 
+// must be a power of 2
+#define MOMO_CACHE_SIZE 4096
+// plural forms are precomputed for amounts below this
+#define MOMO_PLURAL_CACHE 256
+
+struct CacheEntry {
+  const char* str;
+  unsigned int index;
+};
+
 struct LocaleDomain {
   char path[4096];
   char name[64];
@@ -82,11 +93,14 @@ struct LocaleDomain {
   size_t moLen;
   const char** stringPtr;
   const char** transPtr;
-  unsigned int* hashes;
   size_t stringCount;
-  size_t firstString[256];
-  size_t lastString[256];
+  // open addressing hash table of string indices plus one (0 means empty)
+  unsigned int* table;
+  unsigned int tableMask;
+  // last lookups by string pointer
+  struct CacheEntry cache[MOMO_CACHE_SIZE];
   struct StackData pluralProgram[256];
+  unsigned int plural[MOMO_PLURAL_CACHE];
 };
 
 struct MOHeader {
@@ -541,6 +555,68 @@ unsigned char domainsRemove(struct LocaleDomain* item) {
   return 1;
 }
 
+// frees the catalog of a domain and forgets its cached lookups
+static void domainUnload(struct LocaleDomain* d) {
+  if (d->mo!=NULL) {
+    MO_FREE(d->mo);
+    d->mo=NULL;
+  }
+  if (d->stringPtr!=NULL) {
+    free(d->stringPtr);
+    d->stringPtr=NULL;
+  }
+  if (d->transPtr!=NULL) {
+    free(d->transPtr);
+    d->transPtr=NULL;
+  }
+  if (d->table!=NULL) {
+    free(d->table);
+    d->table=NULL;
+  }
+  d->moLen=0;
+  d->stringCount=0;
+  d->tableMask=0;
+  memset(d->cache,0,sizeof(d->cache));
+  memset(d->pluralProgram,0,sizeof(d->pluralProgram));
+  memset(d->plural,0,sizeof(d->plural));
+}
+
+// drops a domain which failed to load. a previously bound domain is removed
+// from the list, and if it was current, no domain is current anymore.
+// returns NULL (with errno set to err if it isn't 0).
+static const char* domainLoadFailed(struct LocaleDomain* d, unsigned char found, int err) {
+  domainUnload(d);
+  if (found) domainsRemove(d);
+  if (d==curDomain) curDomain=NULL;
+  free(d);
+  if (err) errno=err;
+  return NULL;
+}
+
+// returns the index of a string in the domain, or stringCount if it isn't there
+static size_t findString(struct LocaleDomain* d, const char* str) {
+  struct CacheEntry* c=&d->cache[(((uintptr_t)str)^(((uintptr_t)str)>>12))&(MOMO_CACHE_SIZE-1)];
+  // the same pointer may hold another string now (or the entry may be
+  // half-written by another thread), so check it against the catalog
+  if (c->str==str) {
+    unsigned int index=c->index;
+    if (index<d->stringCount && strcmp(d->stringPtr[index],str)==0) return index;
+  }
+
+  if (d->table==NULL) return d->stringCount;
+  unsigned int pos=halfsiphash(str,strlen(str),0)&d->tableMask;
+  while (d->table[pos]) {
+    unsigned int index=d->table[pos]-1;
+    if (strcmp(d->stringPtr[index],str)==0) {
+      c->index=index;
+      c->str=str;
+      return index;
+    }
+    pos=(pos+1)&d->tableMask;
+  }
+  return d->stringCount;
+}
+
 // implementation
 
 const char* momo_setlocale(int type, const char* locale) {
@@ -598,6 +674,8 @@ const char* momo_setlocale(int type, const char* locale) {
   return curLocale;
 }
 
+// binding (and momo_textdomain()) is not thread-safe: it must not run while
+// another thread binds or looks up a string. Furnace does it on startup only.
 const char* momo_bindtextdomain(const char* domainName, const char* dirName) {
   if (strcmp(curLocale,"C")==0) return dirName;
   if (strcmp(curLocale,"POSIX")==0) return dirName;
@@ -606,6 +684,7 @@ const char* momo_bindtextdomain(const char* domainName, const char* dirName) {
 
   struct LocaleDomain* newDomain=NULL;
   unsigned char found=0;
+  unsigned char wasCurrent=0;
   if (domains!=NULL) {
     // search for domain
     for (size_t i=0; i<domainsLen; i++) {
@@ -636,6 +715,16 @@ const char* momo_bindtextdomain(const char* domainName, const char* dirName) {
     strncpy(newDomain->path,dirName,4096);
   }
 
+  // rebinding reloads the catalog (the locale or directory may be different).
+  // if it was the current domain, it is current again once it is loaded.
+  if (found) {
+    if (newDomain==curDomain) {
+      wasCurrent=1;
+      curDomain=NULL;
+    }
+    domainUnload(newDomain);
+  }
+
   // load domain
   if (newDomain->mo==NULL) {
     snprintf(tempPath,4096,"%s/%s/LC_MESSAGES/%s.mo",newDomain->path,curLocale,newDomain->name);
@@ -648,12 +737,7 @@ const char* momo_bindtextdomain(const char* domainName, const char* dirName) {
       newDomain->mo=SDL_LoadFile(tempPath,&newDomain->moLen);
       if (newDomain->mo==NULL) {
         // give up
-        if (found) {
-          if (newDomain==curDomain) curDomain=NULL;
-          domainsRemove(newDomain);
-        }
-        free(newDomain);
-        return NULL;
+        return domainLoadFailed(newDomain,found,0);
       }
 
    }
@@ -665,36 +749,21 @@ const char* momo_bindtextdomain(const char* domainName, const char* dirName) {
       f=fopen(tempPath,"rb");
       if (f==NULL) {
         // give up
-        if (found) {
-          if (newDomain==curDomain) curDomain=NULL;
-          domainsRemove(newDomain);
-        }
-        free(newDomain);
-        return NULL;
+        return domainLoadFailed(newDomain,found,0);
       }
     }
 
     if (fseek(f,0,SEEK_END)!=0) {
       // give up
       fclose(f);
-      if (found) {
-        if (newDomain==curDomain) curDomain=NULL;
-        domainsRemove(newDomain);
-      }
-      free(newDomain);
-      return NULL;
+      return domainLoadFailed(newDomain,found,0);
     }
 
     long moSize=ftell(f);
     if (moSize<sizeof(struct MOHeader)) {
       // give up
       fclose(f);
-      if (found) {
-        if (newDomain==curDomain) curDomain=NULL;
-        domainsRemove(newDomain);
-      }
-      free(newDomain);
-      return NULL;
+      return domainLoadFailed(newDomain,found,0);
     }
 
     newDomain->moLen=moSize;
@@ -702,12 +771,7 @@ const char* momo_bindtextdomain(const char* domainName, const char* dirName) {
     if (fseek(f,0,SEEK_SET)!=0) {
       // give up
       fclose(f);
-      if (found) {
-        if (newDomain==curDomain) curDomain=NULL;
-        domainsRemove(newDomain);
-      }
-      free(newDomain);
-      return NULL;
+      return domainLoadFailed(newDomain,found,0);
     }
 
     // allocate
@@ -715,27 +779,15 @@ const char* momo_bindtextdomain(const char* domainName, const char* dirName) {
     if (newDomain->mo==NULL) {
       // give up
       fclose(f);
-      if (found) {
-        if (newDomain==curDomain) curDomain=NULL;
-        domainsRemove(newDomain);
-      }
-      free(newDomain);
-      errno=ENOMEM;
-      return NULL;
+      return domainLoadFailed(newDomain,found,ENOMEM);
     }
     memset(newDomain->mo,0,newDomain->moLen);
 
     // read
     if (fread(newDomain->mo,1,newDomain->moLen,f)!=newDomain->moLen) {
       // give up
-      free(newDomain->mo);
       fclose(f);
-      if (found) {
-        if (newDomain==curDomain) curDomain=NULL;
-        domainsRemove(newDomain);
-      }
-      free(newDomain);
-      return NULL;
+      return domainLoadFailed(newDomain,found,0);
     }
     fclose(f);
 #endif
@@ -744,65 +796,53 @@ const char* momo_bindtextdomain(const char* domainName, const char* dirName) {
     struct MOHeader* header=(struct MOHeader*)newDomain->mo;
     if (header->magic!=0x950412de) {
       // give up
-      MO_FREE(newDomain->mo);
-      if (found) {
-        if (newDomain==curDomain) curDomain=NULL;
-        domainsRemove(newDomain);
-      }
-      free(newDomain);
-      return NULL;
+      return domainLoadFailed(newDomain,found,0);
     }
 
     if (header->stringPtr+(header->stringCount*8)>newDomain->moLen ||
         header->transPtr+(header->stringCount*8)>newDomain->moLen ||
         header->hashPtr+(header->hashSize*4)>newDomain->moLen) {
       // give up
-      MO_FREE(newDomain->mo);
-      if (found) {
-        if (newDomain==curDomain) curDomain=NULL;
-        domainsRemove(newDomain);
-      }
-      free(newDomain);
-      return NULL;
+      return domainLoadFailed(newDomain,found,0);
     }
 
     newDomain->stringCount=header->stringCount;
     if (newDomain->stringCount) {
       newDomain->stringPtr=malloc(newDomain->stringCount*sizeof(const char*));
       newDomain->transPtr=malloc(newDomain->stringCount*sizeof(const char*));
-      newDomain->hashes=malloc(newDomain->stringCount*sizeof(unsigned int));
+      if (newDomain->stringPtr==NULL || newDomain->transPtr==NULL) {
+        // give up
+        return domainLoadFailed(newDomain,found,ENOMEM);
+      }
     }
 
     unsigned int* strTable=(unsigned int*)(&newDomain->mo[header->stringPtr]);
     unsigned int* transTable=(unsigned int*)(&newDomain->mo[header->transPtr]);
 
-    unsigned short curChar=0;
     for (size_t i=0; i<newDomain->stringCount; i++) {
       newDomain->stringPtr[i]=(const char*)(&newDomain->mo[strTable[1+(i<<1)]]);
       newDomain->transPtr[i]=(const char*)(&newDomain->mo[transTable[1+(i<<1)]]);
+    }
 
-      newDomain->hashes[i]=halfsiphash(newDomain->stringPtr[i],strlen(newDomain->stringPtr[i]),0);
-
-      while (curChar<=(unsigned char)newDomain->stringPtr[i][0]) {
-        newDomain->firstString[curChar]=i;
-        if (curChar>0) {
-          newDomain->lastString[curChar-1]=i;
+    // build hash table (at most half full)
+    unsigned int tableSize=16;
+    while (tableSize<newDomain->stringCount*2) tableSize<<=1;
+    newDomain->table=malloc(tableSize*sizeof(unsigned int));
+    if (newDomain->table!=NULL) {
+      memset(newDomain->table,0,tableSize*sizeof(unsigned int));
+      newDomain->tableMask=tableSize-1;
+      for (size_t i=0; i<newDomain->stringCount; i++) {
+        unsigned int pos=halfsiphash(newDomain->stringPtr[i],strlen(newDomain->stringPtr[i]),0)&newDomain->tableMask;
+        while (newDomain->table[pos]) {
+          pos=(pos+1)&newDomain->tableMask;
         }
-        curChar++;
-      }
-    }
-    while (curChar<256) {
-      newDomain->firstString[curChar]=newDomain->stringCount;
-      if (curChar>0) {
-        newDomain->lastString[curChar-1]=newDomain->stringCount;
+        newDomain->table[pos]=i+1;
       }
-      curChar++;
     }
-    newDomain->lastString[255]=newDomain->stringCount;
 
     // compile plural program
     char pluralProgram[4096];
-    const char* pluralProgramLoc=strstr(newDomain->transPtr[0],"plural=");
+    const char* pluralProgramLoc=(newDomain->stringCount>0)?strstr(newDomain->transPtr[0],"plural="):NULL;
     if (pluralProgramLoc!=NULL) {
       pluralProgramLoc+=7;
       const char* pluralProgramLocEnd=strstr(pluralProgramLoc,";");
@@ -830,17 +870,20 @@ const char* momo_bindtextdomain(const char* domainName, const char* dirName) {
         }
       }
     }
+
+    // precompute plural forms of small amounts
+    for (unsigned int i=0; i<MOMO_PLURAL_CACHE; i++) {
+      newDomain->plural[i]=runStackMachine(newDomain->pluralProgram,256,i);
+    }
   }
 
   // add to domain list
   if (!found) {
     if (!domainsInsert(newDomain)) {
-      if (newDomain->mo) MO_FREE(newDomain->mo);
-      free(newDomain);
-      errno=ENOMEM;
-      return NULL;
+      return domainLoadFailed(newDomain,found,ENOMEM);
     }
   }
+  if (wasCurrent) curDomain=newDomain;
   return newDomain->path;
 }
 
@@ -870,12 +913,9 @@ const char* momo_gettext(const char* str) {
     return str;
   }
   if (str==NULL) return NULL;
-  // TODO: optimize
-  unsigned int hash=halfsiphash(str,strlen(str),0);
-  for (size_t i=curDomain->firstString[(unsigned char)(str[0])]; i<curDomain->lastString[(unsigned char)(str[0])]; i++) {
-    if (hash==curDomain->hashes[i]) {
-      return curDomain->transPtr[i];
-    }
+  size_t index=findString(curDomain,str);
+  if (index<curDomain->stringCount) {
+    return curDomain->transPtr[index];
   }
   return str;
 }
@@ -888,17 +928,14 @@ const char* momo_ngettext(const char* str1, const char* str2, unsigned long amou
   // TODO: implement
   // gettext("") and take plural form metadata...
   // then I don't know how are plural strings stored
-  unsigned int plural=runStackMachine(curDomain->pluralProgram,256,amount);
-  // TODO: optimize
-  unsigned int hash=halfsiphash(str1,strlen(str1),0);
-  for (size_t i=curDomain->firstString[(unsigned char)(str1[0])]; i<curDomain->lastString[(unsigned char)(str1[0])]; i++) {
-    if (hash==curDomain->hashes[i]) {
-      const char* ret=curDomain->transPtr[i];
-      for (unsigned int j=0; j<plural; j++) {
-        ret+=strlen(ret)+1;
-      }
-      return ret;
+  unsigned int plural=(amount<MOMO_PLURAL_CACHE)?curDomain->plural[amount]:runStackMachine(curDomain->pluralProgram,256,amount);
+  size_t index=findString(curDomain,str1);
+  if (index<curDomain->stringCount) {
+    const char* ret=curDomain->transPtr[index];
+    for (unsigned int j=0; j<plural; j++) {
+      ret+=strlen(ret)+1;
     }
+    return ret;
   }
 
   if (amount==1) return str1;